@@ -11,29 +11,56 @@ int main() {
     std::string name = "test";
     int timeout = 10;
 
+    // 同時に送信中にしておく train リクエストの最大数
+    const size_t max_in_flight = 16;
+
     // Classifierのクライアントをインスタンス化する
     jubatus::classifier::client::classifier client(host, port, name, timeout);
 
-    // Datum の作成
-    jubatus::client::common::datum d;
-    d.add_string("name", "家康");
+    // 学習用データ (姓, 名) の作成
+    std::vector<std::pair<std::string, std::string> > shoguns;
+    shoguns.push_back(std::make_pair("徳川", "家康"));
+    shoguns.push_back(std::make_pair("徳川", "秀忠"));
+    shoguns.push_back(std::make_pair("徳川", "家光"));
+    shoguns.push_back(std::make_pair("足利", "尊氏"));
+    shoguns.push_back(std::make_pair("足利", "義詮"));
+    shoguns.push_back(std::make_pair("足利", "義満"));
+    shoguns.push_back(std::make_pair("北条", "時政"));
+    shoguns.push_back(std::make_pair("北条", "義時"));
+    shoguns.push_back(std::make_pair("北条", "泰時"));
 
-    // LabeledDatum(train メソッドで通知するデータ型) の作成
-    jubatus::classifier::labeled_datum ld("徳川", d);
+    // train_async で応答を待たずに送信し、送信中のリクエストが
+    // max_in_flight 個を超えるときだけ最も古い応答を待つ
+    jubatus::client::common::pipeline<int32_t> p(max_in_flight);
+    int32_t trained = 0;
+    for (size_t i = 0; i < shoguns.size(); ++i) {
+        jubatus::client::common::datum d;
+        d.add_string("name", shoguns[i].second);
 
-    // 学習用データの配列の作成
-    std::vector<jubatus::classifier::labeled_datum> train_data;
-    train_data.push_back(ld);
+        std::vector<jubatus::classifier::labeled_datum> train_data;
+        train_data.push_back(
+            jubatus::classifier::labeled_datum(shoguns[i].first, d));
 
-    // trainメソッドの呼び出し
-    client.train(train_data);
+        int32_t done;
+        if (p.push(client.train_async(train_data), done)) {
+            trained += done;
+        }
+    }
+    // 残りの応答を待つ
+    while (!p.empty()) {
+        trained += p.pop();
+    }
+    std::cout << "trained: " << trained << std::endl;
 
     // 分析用データの配列の作成
     std::vector<jubatus::client::common::datum> test_data;
+    jubatus::client::common::datum d;
+    d.add_string("name", "家康");
     test_data.push_back(d);
 
     // classifyメソッドの呼び出し
-    std::vector<std::vector<jubatus::classifier::estimate_result> > results = client.classify(test_data);
+    std::vector<std::vector<jubatus::classifier::estimate_result> > results =
+        client.classify_async(test_data).get();
 
     // 分析結果の出力
     for (size_t i = 0; i < results.size(); ++i) {
@@ -79,6 +79,28 @@ TEST(classifier_test, classify) {
   ASSERT_EQ(0, result.size());
 }
 
+TEST(classifier_test, train_async) {
+  classifier cli(host(), port(), cluster_name(), timeout());
+  jubatus::client::common::pipeline<int32_t> p(4);
+  int32_t trained = 0;
+  int32_t done;
+  for (int i = 0; i < 10; ++i) {
+    if (p.push(cli.train_async(make_labeled_data()), done)) {
+      trained += done;
+    }
+    ASSERT_GE(4u, p.size());
+  }
+  while (!p.empty()) {
+    trained += p.pop();
+  }
+  ASSERT_EQ(10, trained);
+}
+
+TEST(classifier_test, classify_async) {
+  classifier cli(host(), port(), cluster_name(), timeout());
+  ASSERT_EQ(0u, cli.classify_async(make_data()).get().size());
+}
+
 TEST(classifier_test, clear) {
   classifier cli(host(), port(), cluster_name(), timeout());
   ASSERT_TRUE(cli.clear());
@@ -27,37 +27,76 @@ class anomaly : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_row_async(const std::string& id) {
+    return jubatus::client::common::future<bool>(c_.call("clear_row", name_,
+        id));
+  }
+
   id_with_score add(const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("add", name_, row);
     return f.get<id_with_score>();
   }
 
+  jubatus::client::common::future<id_with_score> add_async(
+      const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<id_with_score>(c_.call("add", name_,
+        row));
+  }
+
   float update(const std::string& id,
       const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("update", name_, id, row);
     return f.get<float>();
   }
 
+  jubatus::client::common::future<float> update_async(const std::string& id,
+      const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<float>(c_.call("update", name_, id,
+        row));
+  }
+
   float overwrite(const std::string& id,
       const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("overwrite", name_, id, row);
     return f.get<float>();
   }
 
+  jubatus::client::common::future<float> overwrite_async(const std::string& id,
+      const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<float>(c_.call("overwrite", name_,
+        id, row));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
+
   float calc_score(const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("calc_score", name_, row);
     return f.get<float>();
   }
 
+  jubatus::client::common::future<float> calc_score_async(
+      const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<float>(c_.call("calc_score", name_,
+        row));
+  }
+
   std::vector<std::string> get_all_rows() {
     msgpack::rpc::future f = c_.call("get_all_rows", name_);
     return f.get<std::vector<std::string> >();
   }
+
+  jubatus::client::common::future<std::vector<std::string> >
+      get_all_rows_async() {
+    return jubatus::client::common::future<std::vector<std::string> >(c_.call(
+        "get_all_rows", name_));
+  }
 };
 
 }  // namespace client
@@ -27,16 +27,34 @@ class bandit : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> register_arm_async(
+      const std::string& arm_id) {
+    return jubatus::client::common::future<bool>(c_.call("register_arm", name_,
+        arm_id));
+  }
+
   bool delete_arm(const std::string& arm_id) {
     msgpack::rpc::future f = c_.call("delete_arm", name_, arm_id);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> delete_arm_async(
+      const std::string& arm_id) {
+    return jubatus::client::common::future<bool>(c_.call("delete_arm", name_,
+        arm_id));
+  }
+
   std::string select_arm(const std::string& player_id) {
     msgpack::rpc::future f = c_.call("select_arm", name_, player_id);
     return f.get<std::string>();
   }
 
+  jubatus::client::common::future<std::string> select_arm_async(
+      const std::string& player_id) {
+    return jubatus::client::common::future<std::string>(c_.call("select_arm",
+        name_, player_id));
+  }
+
   bool register_reward(const std::string& player_id, const std::string& arm_id,
       double reward) {
     msgpack::rpc::future f = c_.call("register_reward", name_, player_id,
@@ -44,20 +62,42 @@ class bandit : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> register_reward_async(
+      const std::string& player_id, const std::string& arm_id, double reward) {
+    return jubatus::client::common::future<bool>(c_.call("register_reward",
+        name_, player_id, arm_id, reward));
+  }
+
   std::map<std::string, arm_info> get_arm_info(const std::string& player_id) {
     msgpack::rpc::future f = c_.call("get_arm_info", name_, player_id);
     return f.get<std::map<std::string, arm_info> >();
   }
 
+  jubatus::client::common::future<std::map<std::string, arm_info> >
+      get_arm_info_async(const std::string& player_id) {
+    return jubatus::client::common::future<std::map<std::string, arm_info> >(
+        c_.call("get_arm_info", name_, player_id));
+  }
+
   bool reset(const std::string& player_id) {
     msgpack::rpc::future f = c_.call("reset", name_, player_id);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> reset_async(
+      const std::string& player_id) {
+    return jubatus::client::common::future<bool>(c_.call("reset", name_,
+        player_id));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
 };
 
 }  // namespace client
@@ -27,50 +27,107 @@ class burst : public jubatus::client::common::client {
     return f.get<int32_t>();
   }
 
+  jubatus::client::common::future<int32_t> add_documents_async(
+      const std::vector<document>& data) {
+    return jubatus::client::common::future<int32_t>(c_.call("add_documents",
+        name_, data));
+  }
+
   window get_result(const std::string& keyword) {
     msgpack::rpc::future f = c_.call("get_result", name_, keyword);
     return f.get<window>();
   }
 
+  jubatus::client::common::future<window> get_result_async(
+      const std::string& keyword) {
+    return jubatus::client::common::future<window>(c_.call("get_result", name_,
+        keyword));
+  }
+
   window get_result_at(const std::string& keyword, double pos) {
     msgpack::rpc::future f = c_.call("get_result_at", name_, keyword, pos);
     return f.get<window>();
   }
 
+  jubatus::client::common::future<window> get_result_at_async(
+      const std::string& keyword, double pos) {
+    return jubatus::client::common::future<window>(c_.call("get_result_at",
+        name_, keyword, pos));
+  }
+
   std::map<std::string, window> get_all_bursted_results() {
     msgpack::rpc::future f = c_.call("get_all_bursted_results", name_);
     return f.get<std::map<std::string, window> >();
   }
 
+  jubatus::client::common::future<std::map<std::string, window> >
+      get_all_bursted_results_async() {
+    return jubatus::client::common::future<std::map<std::string, window> >(
+        c_.call("get_all_bursted_results", name_));
+  }
+
   std::map<std::string, window> get_all_bursted_results_at(double pos) {
     msgpack::rpc::future f = c_.call("get_all_bursted_results_at", name_, pos);
     return f.get<std::map<std::string, window> >();
   }
 
+  jubatus::client::common::future<std::map<std::string, window> >
+      get_all_bursted_results_at_async(double pos) {
+    return jubatus::client::common::future<std::map<std::string, window> >(
+        c_.call("get_all_bursted_results_at", name_, pos));
+  }
+
   std::vector<keyword_with_params> get_all_keywords() {
     msgpack::rpc::future f = c_.call("get_all_keywords", name_);
     return f.get<std::vector<keyword_with_params> >();
   }
 
+  jubatus::client::common::future<std::vector<keyword_with_params> >
+      get_all_keywords_async() {
+    return jubatus::client::common::future<std::vector<keyword_with_params> >(
+        c_.call("get_all_keywords", name_));
+  }
+
   bool add_keyword(const keyword_with_params& keyword) {
     msgpack::rpc::future f = c_.call("add_keyword", name_, keyword);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> add_keyword_async(
+      const keyword_with_params& keyword) {
+    return jubatus::client::common::future<bool>(c_.call("add_keyword", name_,
+        keyword));
+  }
+
   bool remove_keyword(const std::string& keyword) {
     msgpack::rpc::future f = c_.call("remove_keyword", name_, keyword);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_keyword_async(
+      const std::string& keyword) {
+    return jubatus::client::common::future<bool>(c_.call("remove_keyword",
+        name_, keyword));
+  }
+
   bool remove_all_keywords() {
     msgpack::rpc::future f = c_.call("remove_all_keywords", name_);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_all_keywords_async() {
+    return jubatus::client::common::future<bool>(c_.call("remove_all_keywords",
+        name_));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
 };
 
 }  // namespace client
@@ -27,31 +27,65 @@ class classifier : public jubatus::client::common::client {
     return f.get<int32_t>();
   }
 
+  jubatus::client::common::future<int32_t> train_async(
+      const std::vector<labeled_datum>& data) {
+    return jubatus::client::common::future<int32_t>(c_.call("train", name_,
+        data));
+  }
+
   std::vector<std::vector<estimate_result> > classify(
       const std::vector<jubatus::client::common::datum>& data) {
     msgpack::rpc::future f = c_.call("classify", name_, data);
     return f.get<std::vector<std::vector<estimate_result> > >();
   }
 
+  jubatus::client::common::future<std::vector<std::vector<estimate_result> > >
+      classify_async(const std::vector<jubatus::client::common::datum>& data) {
+    return jubatus::client::common::future<std::vector<std::vector<estimate_result> > >(
+        c_.call("classify", name_, data));
+  }
+
   std::map<std::string, uint64_t> get_labels() {
     msgpack::rpc::future f = c_.call("get_labels", name_);
     return f.get<std::map<std::string, uint64_t> >();
   }
 
+  jubatus::client::common::future<std::map<std::string, uint64_t> >
+      get_labels_async() {
+    return jubatus::client::common::future<std::map<std::string, uint64_t> >(
+        c_.call("get_labels", name_));
+  }
+
   bool set_label(const std::string& new_label) {
     msgpack::rpc::future f = c_.call("set_label", name_, new_label);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> set_label_async(
+      const std::string& new_label) {
+    return jubatus::client::common::future<bool>(c_.call("set_label", name_,
+        new_label));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
+
   bool delete_label(const std::string& target_label) {
     msgpack::rpc::future f = c_.call("delete_label", name_, target_label);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> delete_label_async(
+      const std::string& target_label) {
+    return jubatus::client::common::future<bool>(c_.call("delete_label", name_,
+        target_label));
+  }
 };
 
 }  // namespace client
@@ -27,48 +27,100 @@ class clustering : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> push_async(
+      const std::vector<indexed_point>& points) {
+    return jubatus::client::common::future<bool>(c_.call("push", name_,
+        points));
+  }
+
   uint32_t get_revision() {
     msgpack::rpc::future f = c_.call("get_revision", name_);
     return f.get<uint32_t>();
   }
 
+  jubatus::client::common::future<uint32_t> get_revision_async() {
+    return jubatus::client::common::future<uint32_t>(c_.call("get_revision",
+        name_));
+  }
+
   std::vector<std::vector<weighted_datum> > get_core_members() {
     msgpack::rpc::future f = c_.call("get_core_members", name_);
     return f.get<std::vector<std::vector<weighted_datum> > >();
   }
 
+  jubatus::client::common::future<std::vector<std::vector<weighted_datum> > >
+      get_core_members_async() {
+    return jubatus::client::common::future<std::vector<std::vector<weighted_datum> > >(
+        c_.call("get_core_members", name_));
+  }
+
   std::vector<std::vector<weighted_index> > get_core_members_light() {
     msgpack::rpc::future f = c_.call("get_core_members_light", name_);
     return f.get<std::vector<std::vector<weighted_index> > >();
   }
 
+  jubatus::client::common::future<std::vector<std::vector<weighted_index> > >
+      get_core_members_light_async() {
+    return jubatus::client::common::future<std::vector<std::vector<weighted_index> > >(
+        c_.call("get_core_members_light", name_));
+  }
+
   std::vector<jubatus::client::common::datum> get_k_center() {
     msgpack::rpc::future f = c_.call("get_k_center", name_);
     return f.get<std::vector<jubatus::client::common::datum> >();
   }
 
+  jubatus::client::common::future<std::vector<jubatus::client::common::datum> >
+      get_k_center_async() {
+    return jubatus::client::common::future<std::vector<jubatus::client::common::datum> >(
+        c_.call("get_k_center", name_));
+  }
+
   jubatus::client::common::datum get_nearest_center(
       const jubatus::client::common::datum& point) {
     msgpack::rpc::future f = c_.call("get_nearest_center", name_, point);
     return f.get<jubatus::client::common::datum>();
   }
 
+  jubatus::client::common::future<jubatus::client::common::datum>
+      get_nearest_center_async(const jubatus::client::common::datum& point) {
+    return jubatus::client::common::future<jubatus::client::common::datum>(
+        c_.call("get_nearest_center", name_, point));
+  }
+
   std::vector<weighted_datum> get_nearest_members(
       const jubatus::client::common::datum& point) {
     msgpack::rpc::future f = c_.call("get_nearest_members", name_, point);
     return f.get<std::vector<weighted_datum> >();
   }
 
+  jubatus::client::common::future<std::vector<weighted_datum> >
+      get_nearest_members_async(const jubatus::client::common::datum& point) {
+    return jubatus::client::common::future<std::vector<weighted_datum> >(
+        c_.call("get_nearest_members", name_, point));
+  }
+
   std::vector<weighted_index> get_nearest_members_light(
       const jubatus::client::common::datum& point) {
     msgpack::rpc::future f = c_.call("get_nearest_members_light", name_, point);
     return f.get<std::vector<weighted_index> >();
   }
 
+  jubatus::client::common::future<std::vector<weighted_index> >
+      get_nearest_members_light_async(
+      const jubatus::client::common::datum& point) {
+    return jubatus::client::common::future<std::vector<weighted_index> >(
+        c_.call("get_nearest_members_light", name_, point));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
 };
 
 }  // namespace client
@@ -21,6 +21,7 @@
 #include <map>
 #include <string>
 #include <jubatus/msgpack/rpc/client.h>
+#include <jubatus/client/common/future.hpp>
 
 namespace jubatus {
 namespace client {
@@ -0,0 +1,108 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_CLIENT_COMMON_FUTURE_HPP_
+#define JUBATUS_CLIENT_COMMON_FUTURE_HPP_
+
+#include <deque>
+#include <jubatus/msgpack/rpc/future.h>
+
+namespace jubatus {
+namespace client {
+namespace common {
+
+// future
+//   Typed result of a request sent by *_async methods of clients.
+//   Responses are received while the client waits on any of its futures,
+//   so callbacks attached to a future run in the thread calling get().
+template<typename T>
+class future {
+ public:
+  explicit future(const msgpack::rpc::future& f)
+      : f_(f) {
+  }
+
+  // waits for the response; throws the same errors as blocking methods
+  T get() {
+    return f_.get<T>();
+  }
+
+  void attach_callback(const msgpack::rpc::callback_t& callback) {
+    f_.attach_callback(callback);
+  }
+
+  msgpack::rpc::future& get_future() {
+    return f_;
+  }
+
+ private:
+  msgpack::rpc::future f_;
+};
+
+// pipeline
+//   Keeps at most max_in_flight requests in flight over one client, so
+//   that a single thread is not limited to one request per round trip.
+//
+//   pipeline<int32_t> p(64);
+//   int32_t done;
+//   for (...) {
+//     if (p.push(cli.train_async(data), done)) { ... }
+//   }
+//   while (!p.empty()) { done = p.pop(); ... }
+template<typename T>
+class pipeline {
+ public:
+  explicit pipeline(size_t max_in_flight)
+      : max_in_flight_(max_in_flight > 0 ? max_in_flight : 1) {
+  }
+
+  // when max_in_flight requests are already in flight, waits for the
+  // oldest one, stores its result to done and returns true
+  bool push(const future<T>& f, T& done) {
+    bool waited = false;
+    if (in_flight_.size() >= max_in_flight_) {
+      done = pop();
+      waited = true;
+    }
+    in_flight_.push_back(f);
+    return waited;
+  }
+
+  // waits for the oldest request in flight
+  T pop() {
+    future<T> f = in_flight_.front();
+    in_flight_.pop_front();
+    return f.get();
+  }
+
+  bool empty() const {
+    return in_flight_.empty();
+  }
+
+  size_t size() const {
+    return in_flight_.size();
+  }
+
+ private:
+  size_t max_in_flight_;
+  std::deque<future<T> > in_flight_;
+};
+
+}  // namespace common
+}  // namespace client
+}  // namespace jubatus
+
+#endif  // JUBATUS_CLIENT_COMMON_FUTURE_HPP_
@@ -0,0 +1,134 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_CLIENT_COMMON_MD5_HPP_
+#define JUBATUS_CLIENT_COMMON_MD5_HPP_
+
+#include <stdint.h>
+#include <string>
+
+namespace jubatus {
+namespace client {
+namespace common {
+namespace detail {
+
+// MD5 (RFC 1321) of the key as 32 lowercase hex digits, which is what
+// servers use to place nodes and keys on the CHT ring.
+// The client library does not link jubatus_core, so it has its own copy.
+
+inline uint32_t md5_rotl(uint32_t x, int c) {
+  return (x << c) | (x >> (32 - c));
+}
+
+inline void md5_block(uint32_t h[4], const unsigned char* p) {
+  static const uint32_t k[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
+    0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+    0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+    0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+    0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+    0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+    0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
+    0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+  };
+  static const int r[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+  };
+
+  uint32_t w[16];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = static_cast<uint32_t>(p[i * 4])
+        | (static_cast<uint32_t>(p[i * 4 + 1]) << 8)
+        | (static_cast<uint32_t>(p[i * 4 + 2]) << 16)
+        | (static_cast<uint32_t>(p[i * 4 + 3]) << 24);
+  }
+
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+  for (int i = 0; i < 64; ++i) {
+    uint32_t f;
+    int g;
+    if (i < 16) {
+      f = (b & c) | (~b & d);
+      g = i;
+    } else if (i < 32) {
+      f = (d & b) | (~d & c);
+      g = (5 * i + 1) % 16;
+    } else if (i < 48) {
+      f = b ^ c ^ d;
+      g = (3 * i + 5) % 16;
+    } else {
+      f = c ^ (b | ~d);
+      g = (7 * i) % 16;
+    }
+    const uint32_t t = d;
+    d = c;
+    c = b;
+    b = b + md5_rotl(a + f + k[i] + w[g], r[i]);
+    a = t;
+  }
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+}
+
+inline std::string md5_hex(const std::string& key) {
+  uint32_t h[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+  std::string msg(key);
+  const uint64_t bits = static_cast<uint64_t>(key.size()) * 8;
+  msg += static_cast<char>(0x80);
+  while (msg.size() % 64 != 56) {
+    msg += static_cast<char>(0);
+  }
+  for (int i = 0; i < 8; ++i) {
+    msg += static_cast<char>((bits >> (8 * i)) & 0xff);
+  }
+
+  for (size_t i = 0; i < msg.size(); i += 64) {
+    md5_block(h, reinterpret_cast<const unsigned char*>(msg.data() + i));
+  }
+
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(32);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      const uint32_t byte = (h[i] >> (8 * j)) & 0xff;
+      hex += digits[byte >> 4];
+      hex += digits[byte & 0xf];
+    }
+  }
+  return hex;
+}
+
+}  // namespace detail
+}  // namespace common
+}  // namespace client
+}  // namespace jubatus
+
+#endif  // JUBATUS_CLIENT_COMMON_MD5_HPP_
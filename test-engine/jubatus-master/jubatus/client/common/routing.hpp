@@ -0,0 +1,80 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_CLIENT_COMMON_ROUTING_HPP_
+#define JUBATUS_CLIENT_COMMON_ROUTING_HPP_
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <msgpack.hpp>
+#include <jubatus/client/common/md5.hpp>
+
+namespace jubatus {
+namespace client {
+namespace common {
+
+typedef std::vector<std::pair<std::string, std::pair<std::string, int> > >
+    routing_ring;
+
+// routing table served by jubaproxy's get_routing_table
+struct routing_table {
+  std::string version;
+  std::vector<std::pair<std::string, int> > members;
+  // CHT ring as (hash, node) sorted by hash
+  routing_ring ring;
+
+  MSGPACK_DEFINE(version, members, ring);
+};
+
+namespace detail {
+
+inline bool ring_hash_less(
+    const std::pair<std::string, std::pair<std::string, int> >& lhs,
+    const std::pair<std::string, std::pair<std::string, int> >& rhs) {
+  return lhs.first < rhs.first;
+}
+
+}  // namespace detail
+
+// returns at most n nodes owning the key on the ring, in the same way as
+// servers (common::cht::find) do
+inline std::vector<std::pair<std::string, int> > find_in_ring(
+    const routing_ring& ring,
+    const std::string& key,
+    size_t n) {
+  std::vector<std::pair<std::string, int> > out;
+  if (ring.empty()) {
+    return out;
+  }
+  const std::pair<std::string, std::pair<std::string, int> > hash(
+      detail::md5_hex(key), std::pair<std::string, int>());
+  size_t idx = (std::lower_bound(ring.begin(), ring.end(), hash,
+                                 detail::ring_hash_less) - ring.begin())
+      % ring.size();
+  for (size_t i = 0; i < n; ++i) {
+    out.push_back(ring[idx].second);
+    idx = (idx + 1) % ring.size();
+  }
+  return out;
+}
+
+}  // namespace common
+}  // namespace client
+}  // namespace jubatus
+
+#endif  // JUBATUS_CLIENT_COMMON_ROUTING_HPP_
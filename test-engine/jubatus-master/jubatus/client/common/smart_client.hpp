@@ -0,0 +1,207 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_CLIENT_COMMON_SMART_CLIENT_HPP_
+#define JUBATUS_CLIENT_COMMON_SMART_CLIENT_HPP_
+
+#include <stdint.h>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+#include <jubatus/msgpack/rpc/client.h>
+#include <jubatus/msgpack/rpc/session_pool.h>
+#include <jubatus/client/common/client.hpp>
+#include <jubatus/client/common/routing.hpp>
+
+namespace jubatus {
+namespace client {
+namespace common {
+
+// smart_client
+//   Client connected to a proxy, which sends requests to servers directly
+//   instead of having the proxy forward them.
+//   It fetches the routing table from the proxy and refetches it every
+//   refresh_interval_sec (only changed tables are transferred), and after
+//   a connection error.  CHT requests go to the servers owning the key,
+//   and random requests are distributed over the servers in round robin.
+//   Requests fall back to the proxy while no table is available.
+class smart_client : public client {
+ public:
+  smart_client(const std::string& host,
+               uint64_t port,
+               const std::string& name,
+               unsigned int timeout_sec,
+               unsigned int refresh_interval_sec = 1)
+      : client(host, port, name, timeout_sec),
+        timeout_sec_(timeout_sec),
+        refresh_interval_sec_(refresh_interval_sec),
+        last_refresh_(0),
+        next_(0) {
+  }
+
+  void refresh() {
+    msgpack::rpc::future f =
+        c_.call("get_routing_table", name_, table_.version);
+    routing_table t = f.get<routing_table>();
+    last_refresh_ = std::time(NULL);
+    if (t.version != table_.version) {
+      table_ = t;
+    }
+  }
+
+  const std::string& get_routing_version() const {
+    return table_.version;
+  }
+
+  // returns at most n nodes owning the key, as servers do
+  std::vector<std::pair<std::string, int> > find(
+      const std::string& key,
+      size_t n) {
+    refresh_if_needed();
+    return find_in_ring(table_.ring, key, n);
+  }
+
+  // sends to one of the servers
+  template<typename Res, typename Args>
+  Res call_random_apply(const std::string& method, const Args& args) {
+    refresh_if_needed();
+    if (table_.members.empty()) {
+      return c_.call_apply(method, args).template get<Res>();
+    }
+    const std::pair<std::string, int>& server =
+        table_.members[next_++ % table_.members.size()];
+    try {
+      return get_session(server).call_apply(method, args).template get<Res>();
+    } catch (const msgpack::rpc::connect_error&) {
+      last_refresh_ = 0;
+      throw;
+    } catch (const msgpack::rpc::timeout_error&) {
+      last_refresh_ = 0;
+      throw;
+    }
+  }
+
+  // sends to n servers owning the key and reduces their results
+  template<typename Res, typename Args, typename Reducer>
+  Res call_cht_apply(
+      const std::string& method,
+      const std::string& key,
+      size_t n,
+      const Args& args,
+      Reducer reduce) {
+    std::vector<std::pair<std::string, int> > nodes = find(key, n);
+    if (nodes.empty()) {
+      return c_.call_apply(method, args).template get<Res>();
+    }
+    std::vector<msgpack::rpc::future> futures;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      futures.push_back(get_session(nodes[i]).call_apply(method, args));
+    }
+    try {
+      Res result = futures[0].template get<Res>();
+      for (size_t i = 1; i < futures.size(); ++i) {
+        result = reduce(result, futures[i].template get<Res>());
+      }
+      return result;
+    } catch (const msgpack::rpc::connect_error&) {
+      last_refresh_ = 0;
+      throw;
+    } catch (const msgpack::rpc::timeout_error&) {
+      last_refresh_ = 0;
+      throw;
+    }
+  }
+
+  template<typename Res, typename A1>
+  Res call_random(const std::string& method, const A1& a1) {
+    return call_random_apply<Res>(method,
+        msgpack::type::tuple<const std::string&, const A1&>(name_, a1));
+  }
+
+  template<typename Res, typename A1, typename A2>
+  Res call_random(const std::string& method, const A1& a1, const A2& a2) {
+    return call_random_apply<Res>(method,
+        msgpack::type::tuple<const std::string&, const A1&, const A2&>(
+            name_, a1, a2));
+  }
+
+  // number of servers a CHT method goes to when the IDL says just #@cht
+  static const size_t DEFAULT_CHT_REPLICAS = 2;
+
+  // sends to the n servers owning the key and reduces their results with
+  // `reduce`; n and the reducer are to be those of the method in the IDL
+  // (#@cht(n), DEFAULT_CHT_REPLICAS for #@cht, and e.g. all_and or pass),
+  // as the proxy writes updates to the replicas as well
+  template<typename Res, typename Reducer, typename A1>
+  Res call_cht(const std::string& method, const std::string& key,
+               size_t n, Reducer reduce, const A1& a1) {
+    return call_cht_apply<Res>(method, key, n,
+        msgpack::type::tuple<const std::string&, const A1&>(name_, a1),
+        reduce);
+  }
+
+  template<typename Res, typename Reducer, typename A1, typename A2>
+  Res call_cht(const std::string& method, const std::string& key,
+               size_t n, Reducer reduce, const A1& a1, const A2& a2) {
+    return call_cht_apply<Res>(method, key, n,
+        msgpack::type::tuple<const std::string&, const A1&, const A2&>(
+            name_, a1, a2),
+        reduce);
+  }
+
+  // aggregators of the IDL (#@pass and #@all_and)
+  template<typename Res>
+  static Res pass(const Res& lhs, const Res&) {
+    return lhs;
+  }
+
+  static bool all_and(bool lhs, bool rhs) {
+    return lhs && rhs;
+  }
+
+ private:
+  void refresh_if_needed() {
+    if (std::time(NULL) - last_refresh_ >=
+        static_cast<std::time_t>(refresh_interval_sec_)) {
+      try {
+        refresh();
+      } catch (const msgpack::rpc::rpc_error&) {
+        // keep using the last table while the proxy is unavailable
+        last_refresh_ = std::time(NULL);
+      }
+    }
+  }
+
+  msgpack::rpc::session get_session(const std::pair<std::string, int>& node) {
+    msgpack::rpc::session s = pool_.get_session(node.first, node.second);
+    s.set_timeout(timeout_sec_);
+    return s;
+  }
+
+  unsigned int timeout_sec_;
+  unsigned int refresh_interval_sec_;
+  std::time_t last_refresh_;
+  size_t next_;
+  routing_table table_;
+  msgpack::rpc::session_pool pool_;
+};
+
+}  // namespace common
+}  // namespace client
+}  // namespace jubatus
+
+#endif  // JUBATUS_CLIENT_COMMON_SMART_CLIENT_HPP_
@@ -27,33 +27,69 @@ class graph : public jubatus::client::common::client {
     return f.get<std::string>();
   }
 
+  jubatus::client::common::future<std::string> create_node_async() {
+    return jubatus::client::common::future<std::string>(c_.call("create_node",
+        name_));
+  }
+
   bool remove_node(const std::string& node_id) {
     msgpack::rpc::future f = c_.call("remove_node", name_, node_id);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_node_async(
+      const std::string& node_id) {
+    return jubatus::client::common::future<bool>(c_.call("remove_node", name_,
+        node_id));
+  }
+
   bool update_node(const std::string& node_id, const std::map<std::string,
       std::string>& property) {
     msgpack::rpc::future f = c_.call("update_node", name_, node_id, property);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> update_node_async(
+      const std::string& node_id, const std::map<std::string,
+      std::string>& property) {
+    return jubatus::client::common::future<bool>(c_.call("update_node", name_,
+        node_id, property));
+  }
+
   uint64_t create_edge(const std::string& node_id, const edge& e) {
     msgpack::rpc::future f = c_.call("create_edge", name_, node_id, e);
     return f.get<uint64_t>();
   }
 
+  jubatus::client::common::future<uint64_t> create_edge_async(
+      const std::string& node_id, const edge& e) {
+    return jubatus::client::common::future<uint64_t>(c_.call("create_edge",
+        name_, node_id, e));
+  }
+
   bool update_edge(const std::string& node_id, uint64_t edge_id,
       const edge& e) {
     msgpack::rpc::future f = c_.call("update_edge", name_, node_id, edge_id, e);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> update_edge_async(
+      const std::string& node_id, uint64_t edge_id, const edge& e) {
+    return jubatus::client::common::future<bool>(c_.call("update_edge", name_,
+        node_id, edge_id, e));
+  }
+
   bool remove_edge(const std::string& node_id, uint64_t edge_id) {
     msgpack::rpc::future f = c_.call("remove_edge", name_, node_id, edge_id);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_edge_async(
+      const std::string& node_id, uint64_t edge_id) {
+    return jubatus::client::common::future<bool>(c_.call("remove_edge", name_,
+        node_id, edge_id));
+  }
+
   double get_centrality(const std::string& node_id, int32_t centrality_type,
       const preset_query& query) {
     msgpack::rpc::future f = c_.call("get_centrality", name_, node_id,
@@ -61,66 +97,153 @@ class graph : public jubatus::client::common::client {
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> get_centrality_async(
+      const std::string& node_id, int32_t centrality_type,
+      const preset_query& query) {
+    return jubatus::client::common::future<double>(c_.call("get_centrality",
+        name_, node_id, centrality_type, query));
+  }
+
   bool add_centrality_query(const preset_query& query) {
     msgpack::rpc::future f = c_.call("add_centrality_query", name_, query);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> add_centrality_query_async(
+      const preset_query& query) {
+    return jubatus::client::common::future<bool>(c_.call("add_centrality_query",
+        name_, query));
+  }
+
   bool add_shortest_path_query(const preset_query& query) {
     msgpack::rpc::future f = c_.call("add_shortest_path_query", name_, query);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> add_shortest_path_query_async(
+      const preset_query& query) {
+    return jubatus::client::common::future<bool>(c_.call(
+        "add_shortest_path_query", name_, query));
+  }
+
   bool remove_centrality_query(const preset_query& query) {
     msgpack::rpc::future f = c_.call("remove_centrality_query", name_, query);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_centrality_query_async(
+      const preset_query& query) {
+    return jubatus::client::common::future<bool>(c_.call(
+        "remove_centrality_query", name_, query));
+  }
+
   bool remove_shortest_path_query(const preset_query& query) {
     msgpack::rpc::future f = c_.call("remove_shortest_path_query", name_,
         query);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_shortest_path_query_async(
+      const preset_query& query) {
+    return jubatus::client::common::future<bool>(c_.call(
+        "remove_shortest_path_query", name_, query));
+  }
+
   std::vector<std::string> get_shortest_path(const shortest_path_query& query) {
     msgpack::rpc::future f = c_.call("get_shortest_path", name_, query);
     return f.get<std::vector<std::string> >();
   }
 
+  jubatus::client::common::future<std::vector<std::string> >
+      get_shortest_path_async(const shortest_path_query& query) {
+    return jubatus::client::common::future<std::vector<std::string> >(c_.call(
+        "get_shortest_path", name_, query));
+  }
+
   bool update_index() {
     msgpack::rpc::future f = c_.call("update_index", name_);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> update_index_async() {
+    return jubatus::client::common::future<bool>(c_.call("update_index",
+        name_));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
+
   node get_node(const std::string& node_id) {
     msgpack::rpc::future f = c_.call("get_node", name_, node_id);
     return f.get<node>();
   }
 
+  jubatus::client::common::future<node> get_node_async(
+      const std::string& node_id) {
+    return jubatus::client::common::future<node>(c_.call("get_node", name_,
+        node_id));
+  }
+
   edge get_edge(const std::string& node_id, uint64_t edge_id) {
     msgpack::rpc::future f = c_.call("get_edge", name_, node_id, edge_id);
     return f.get<edge>();
   }
 
+  jubatus::client::common::future<edge> get_edge_async(
+      const std::string& node_id, uint64_t edge_id) {
+    return jubatus::client::common::future<edge>(c_.call("get_edge", name_,
+        node_id, edge_id));
+  }
+
   bool create_node_here(const std::string& node_id) {
     msgpack::rpc::future f = c_.call("create_node_here", name_, node_id);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> create_node_here_async(
+      const std::string& node_id) {
+    return jubatus::client::common::future<bool>(c_.call("create_node_here",
+        name_, node_id));
+  }
+
   bool remove_global_node(const std::string& node_id) {
     msgpack::rpc::future f = c_.call("remove_global_node", name_, node_id);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> remove_global_node_async(
+      const std::string& node_id) {
+    return jubatus::client::common::future<bool>(c_.call("remove_global_node",
+        name_, node_id));
+  }
+
+  bool remove_node_here(const std::string& node_id) {
+    msgpack::rpc::future f = c_.call("remove_node_here", name_, node_id);
+    return f.get<bool>();
+  }
+
+  jubatus::client::common::future<bool> remove_node_here_async(
+      const std::string& node_id) {
+    return jubatus::client::common::future<bool>(c_.call("remove_node_here",
+        name_, node_id));
+  }
+
   bool create_edge_here(uint64_t edge_id, const edge& e) {
     msgpack::rpc::future f = c_.call("create_edge_here", name_, edge_id, e);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> create_edge_here_async(uint64_t edge_id,
+      const edge& e) {
+    return jubatus::client::common::future<bool>(c_.call("create_edge_here",
+        name_, edge_id, e));
+  }
 };
 
 }  // namespace client
@@ -27,17 +27,33 @@ class nearest_neighbor : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
+
   bool set_row(const std::string& id, const jubatus::client::common::datum& d) {
     msgpack::rpc::future f = c_.call("set_row", name_, id, d);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> set_row_async(const std::string& id,
+      const jubatus::client::common::datum& d) {
+    return jubatus::client::common::future<bool>(c_.call("set_row", name_, id,
+        d));
+  }
+
   std::vector<id_with_score> neighbor_row_from_id(const std::string& id,
       uint32_t size) {
     msgpack::rpc::future f = c_.call("neighbor_row_from_id", name_, id, size);
     return f.get<std::vector<id_with_score> >();
   }
 
+  jubatus::client::common::future<std::vector<id_with_score> >
+      neighbor_row_from_id_async(const std::string& id, uint32_t size) {
+    return jubatus::client::common::future<std::vector<id_with_score> >(c_.call(
+        "neighbor_row_from_id", name_, id, size));
+  }
+
   std::vector<id_with_score> neighbor_row_from_datum(
       const jubatus::client::common::datum& query, uint32_t size) {
     msgpack::rpc::future f = c_.call("neighbor_row_from_datum", name_, query,
@@ -45,12 +61,25 @@ class nearest_neighbor : public jubatus::client::common::client {
     return f.get<std::vector<id_with_score> >();
   }
 
+  jubatus::client::common::future<std::vector<id_with_score> >
+      neighbor_row_from_datum_async(const jubatus::client::common::datum& query,
+      uint32_t size) {
+    return jubatus::client::common::future<std::vector<id_with_score> >(c_.call(
+        "neighbor_row_from_datum", name_, query, size));
+  }
+
   std::vector<id_with_score> similar_row_from_id(const std::string& id,
       uint32_t ret_num) {
     msgpack::rpc::future f = c_.call("similar_row_from_id", name_, id, ret_num);
     return f.get<std::vector<id_with_score> >();
   }
 
+  jubatus::client::common::future<std::vector<id_with_score> >
+      similar_row_from_id_async(const std::string& id, uint32_t ret_num) {
+    return jubatus::client::common::future<std::vector<id_with_score> >(c_.call(
+        "similar_row_from_id", name_, id, ret_num));
+  }
+
   std::vector<id_with_score> similar_row_from_datum(
       const jubatus::client::common::datum& query, uint32_t ret_num) {
     msgpack::rpc::future f = c_.call("similar_row_from_datum", name_, query,
@@ -58,10 +87,23 @@ class nearest_neighbor : public jubatus::client::common::client {
     return f.get<std::vector<id_with_score> >();
   }
 
+  jubatus::client::common::future<std::vector<id_with_score> >
+      similar_row_from_datum_async(const jubatus::client::common::datum& query,
+      uint32_t ret_num) {
+    return jubatus::client::common::future<std::vector<id_with_score> >(c_.call(
+        "similar_row_from_datum", name_, query, ret_num));
+  }
+
   std::vector<std::string> get_all_rows() {
     msgpack::rpc::future f = c_.call("get_all_rows", name_);
     return f.get<std::vector<std::string> >();
   }
+
+  jubatus::client::common::future<std::vector<std::string> >
+      get_all_rows_async() {
+    return jubatus::client::common::future<std::vector<std::string> >(c_.call(
+        "get_all_rows", name_));
+  }
 };
 
 }  // namespace client
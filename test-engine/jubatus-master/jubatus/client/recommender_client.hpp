@@ -27,34 +27,67 @@ class recommender : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_row_async(const std::string& id) {
+    return jubatus::client::common::future<bool>(c_.call("clear_row", name_,
+        id));
+  }
+
   bool update_row(const std::string& id,
       const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("update_row", name_, id, row);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> update_row_async(const std::string& id,
+      const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<bool>(c_.call("update_row", name_,
+        id, row));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
+
   jubatus::client::common::datum complete_row_from_id(const std::string& id) {
     msgpack::rpc::future f = c_.call("complete_row_from_id", name_, id);
     return f.get<jubatus::client::common::datum>();
   }
 
+  jubatus::client::common::future<jubatus::client::common::datum>
+      complete_row_from_id_async(const std::string& id) {
+    return jubatus::client::common::future<jubatus::client::common::datum>(
+        c_.call("complete_row_from_id", name_, id));
+  }
+
   jubatus::client::common::datum complete_row_from_datum(
       const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("complete_row_from_datum", name_, row);
     return f.get<jubatus::client::common::datum>();
   }
 
+  jubatus::client::common::future<jubatus::client::common::datum>
+      complete_row_from_datum_async(const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<jubatus::client::common::datum>(
+        c_.call("complete_row_from_datum", name_, row));
+  }
+
   std::vector<id_with_score> similar_row_from_id(const std::string& id,
       uint32_t size) {
     msgpack::rpc::future f = c_.call("similar_row_from_id", name_, id, size);
     return f.get<std::vector<id_with_score> >();
   }
 
+  jubatus::client::common::future<std::vector<id_with_score> >
+      similar_row_from_id_async(const std::string& id, uint32_t size) {
+    return jubatus::client::common::future<std::vector<id_with_score> >(c_.call(
+        "similar_row_from_id", name_, id, size));
+  }
+
   std::vector<id_with_score> similar_row_from_datum(
       const jubatus::client::common::datum& row, uint32_t size) {
     msgpack::rpc::future f = c_.call("similar_row_from_datum", name_, row,
@@ -62,26 +95,58 @@ class recommender : public jubatus::client::common::client {
     return f.get<std::vector<id_with_score> >();
   }
 
+  jubatus::client::common::future<std::vector<id_with_score> >
+      similar_row_from_datum_async(const jubatus::client::common::datum& row,
+      uint32_t size) {
+    return jubatus::client::common::future<std::vector<id_with_score> >(c_.call(
+        "similar_row_from_datum", name_, row, size));
+  }
+
   jubatus::client::common::datum decode_row(const std::string& id) {
     msgpack::rpc::future f = c_.call("decode_row", name_, id);
     return f.get<jubatus::client::common::datum>();
   }
 
+  jubatus::client::common::future<jubatus::client::common::datum>
+      decode_row_async(const std::string& id) {
+    return jubatus::client::common::future<jubatus::client::common::datum>(
+        c_.call("decode_row", name_, id));
+  }
+
   std::vector<std::string> get_all_rows() {
     msgpack::rpc::future f = c_.call("get_all_rows", name_);
     return f.get<std::vector<std::string> >();
   }
 
+  jubatus::client::common::future<std::vector<std::string> >
+      get_all_rows_async() {
+    return jubatus::client::common::future<std::vector<std::string> >(c_.call(
+        "get_all_rows", name_));
+  }
+
   float calc_similarity(const jubatus::client::common::datum& lhs,
       const jubatus::client::common::datum& rhs) {
     msgpack::rpc::future f = c_.call("calc_similarity", name_, lhs, rhs);
     return f.get<float>();
   }
 
+  jubatus::client::common::future<float> calc_similarity_async(
+      const jubatus::client::common::datum& lhs,
+      const jubatus::client::common::datum& rhs) {
+    return jubatus::client::common::future<float>(c_.call("calc_similarity",
+        name_, lhs, rhs));
+  }
+
   float calc_l2norm(const jubatus::client::common::datum& row) {
     msgpack::rpc::future f = c_.call("calc_l2norm", name_, row);
     return f.get<float>();
   }
+
+  jubatus::client::common::future<float> calc_l2norm_async(
+      const jubatus::client::common::datum& row) {
+    return jubatus::client::common::future<float>(c_.call("calc_l2norm", name_,
+        row));
+  }
 };
 
 }  // namespace client
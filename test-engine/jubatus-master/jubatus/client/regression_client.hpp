@@ -27,16 +27,32 @@ class regression : public jubatus::client::common::client {
     return f.get<int32_t>();
   }
 
+  jubatus::client::common::future<int32_t> train_async(
+      const std::vector<scored_datum>& train_data) {
+    return jubatus::client::common::future<int32_t>(c_.call("train", name_,
+        train_data));
+  }
+
   std::vector<float> estimate(
       const std::vector<jubatus::client::common::datum>& estimate_data) {
     msgpack::rpc::future f = c_.call("estimate", name_, estimate_data);
     return f.get<std::vector<float> >();
   }
 
+  jubatus::client::common::future<std::vector<float> > estimate_async(
+      const std::vector<jubatus::client::common::datum>& estimate_data) {
+    return jubatus::client::common::future<std::vector<float> >(c_.call(
+        "estimate", name_, estimate_data));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
 };
 
 }  // namespace client
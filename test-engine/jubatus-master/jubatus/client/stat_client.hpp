@@ -27,40 +27,79 @@ class stat : public jubatus::client::common::client {
     return f.get<bool>();
   }
 
+  jubatus::client::common::future<bool> push_async(const std::string& key,
+      double value) {
+    return jubatus::client::common::future<bool>(c_.call("push", name_, key,
+        value));
+  }
+
   double sum(const std::string& key) {
     msgpack::rpc::future f = c_.call("sum", name_, key);
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> sum_async(const std::string& key) {
+    return jubatus::client::common::future<double>(c_.call("sum", name_, key));
+  }
+
   double stddev(const std::string& key) {
     msgpack::rpc::future f = c_.call("stddev", name_, key);
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> stddev_async(const std::string& key) {
+    return jubatus::client::common::future<double>(c_.call("stddev", name_,
+        key));
+  }
+
   double max(const std::string& key) {
     msgpack::rpc::future f = c_.call("max", name_, key);
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> max_async(const std::string& key) {
+    return jubatus::client::common::future<double>(c_.call("max", name_, key));
+  }
+
   double min(const std::string& key) {
     msgpack::rpc::future f = c_.call("min", name_, key);
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> min_async(const std::string& key) {
+    return jubatus::client::common::future<double>(c_.call("min", name_, key));
+  }
+
   double entropy(const std::string& key) {
     msgpack::rpc::future f = c_.call("entropy", name_, key);
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> entropy_async(
+      const std::string& key) {
+    return jubatus::client::common::future<double>(c_.call("entropy", name_,
+        key));
+  }
+
   double moment(const std::string& key, int32_t degree, double center) {
     msgpack::rpc::future f = c_.call("moment", name_, key, degree, center);
     return f.get<double>();
   }
 
+  jubatus::client::common::future<double> moment_async(const std::string& key,
+      int32_t degree, double center) {
+    return jubatus::client::common::future<double>(c_.call("moment", name_, key,
+        degree, center));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
 };
 
 }  // namespace client
@@ -27,15 +27,31 @@ class weight : public jubatus::client::common::client {
     return f.get<std::vector<feature> >();
   }
 
+  jubatus::client::common::future<std::vector<feature> > update_async(
+      const jubatus::client::common::datum& d) {
+    return jubatus::client::common::future<std::vector<feature> >(c_.call(
+        "update", name_, d));
+  }
+
   std::vector<feature> calc_weight(const jubatus::client::common::datum& d) {
     msgpack::rpc::future f = c_.call("calc_weight", name_, d);
     return f.get<std::vector<feature> >();
   }
 
+  jubatus::client::common::future<std::vector<feature> > calc_weight_async(
+      const jubatus::client::common::datum& d) {
+    return jubatus::client::common::future<std::vector<feature> >(c_.call(
+        "calc_weight", name_, d));
+  }
+
   bool clear() {
     msgpack::rpc::future f = c_.call("clear", name_);
     return f.get<bool>();
   }
+
+  jubatus::client::common::future<bool> clear_async() {
+    return jubatus::client::common::future<bool>(c_.call("clear", name_));
+  }
 };
 
 }  // namespace client
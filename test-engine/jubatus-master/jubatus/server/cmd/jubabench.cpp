@@ -0,0 +1,785 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+// jubabench
+//   Open-loop load generator for Jubatus servers.
+//
+//   Requests are issued on a fixed schedule (--rate requests/sec) shared by
+//   all worker threads. Latency is measured from the time each request was
+//   *scheduled* to be sent, not from the time it was actually sent, so that
+//   stalls of the server are not hidden by the client backing off
+//   (coordinated omission). The latency from the actual send time is also
+//   reported as "service time". With --rate 0, workers send back-to-back
+//   (closed loop) and both numbers are the same.
+//
+//   Both latencies cover successful requests only. Failed requests are
+//   counted and reported separately, together with the time they took from
+//   the actual send time ("failure latency").
+//
+//   The corpus is JSON lines; each line is one record:
+//     {"label": "spam", "score": 1.5, "id": "row1",
+//      "datum": {"title": "hello", "length": 5}}
+//   "label" is used by classifier train, "score" by regression train and
+//   "id" by methods which take a row ID (generated if missing). If "datum"
+//   is omitted, all other members of the record form the datum. String
+//   values become string_values and numbers become num_values.
+//
+//   Engines which do not take a datum map the record as follows:
+//     graph:   update_node sets the datum as the properties of node "id",
+//              which must exist; create_node ignores the record
+//     stat:    push adds "score" to key "label"; sum reads key "label"
+//     bandit:  register_reward gives "score" to arm "label" of player
+//              "id"; select_arm selects an arm for player "id"
+//     burst:   add_documents adds "label" as a document at position
+//              "score"; get_result reads keyword "label"
+//   Clustering push adds the datum as point "id".
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <jubatus/client/anomaly_client.hpp>
+#include <jubatus/client/bandit_client.hpp>
+#include <jubatus/client/burst_client.hpp>
+#include <jubatus/client/classifier_client.hpp>
+#include <jubatus/client/clustering_client.hpp>
+#include <jubatus/client/graph_client.hpp>
+#include <jubatus/client/nearest_neighbor_client.hpp>
+#include <jubatus/client/recommender_client.hpp>
+#include <jubatus/client/regression_client.hpp>
+#include <jubatus/client/stat_client.hpp>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/concurrent/thread.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "jubatus/util/system/time_util.h"
+#include "jubatus/util/text/json.h"
+
+#include "../third_party/cmdline/cmdline.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using jubatus::util::concurrent::mutex;
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
+using jubatus::util::system::time::get_clock_time;
+using jubatus::util::text::json::json;
+
+namespace {
+
+typedef jubatus::client::common::datum datum;
+
+struct record {
+  record()
+      : score(0) {
+  }
+
+  string id;
+  string label;
+  float score;
+  datum data;
+};
+
+double now() {
+  return static_cast<double>(get_clock_time());
+}
+
+void sleep_until(double t) {
+  const double wait = t - now();
+  if (wait > 0) {
+    ::usleep(static_cast<useconds_t>(wait * 1e6));
+  }
+}
+
+void add_to_datum(const string& key, const json& value, datum& d) {
+  using jubatus::util::text::json::json_cast;
+  switch (value.type()) {
+    case json::String:
+      d.add_string(key, json_cast<string>(value));
+      break;
+    case json::Integer:
+    case json::Float:
+      d.add_number(key, json_cast<double>(value));
+      break;
+    case json::Bool:
+      d.add_number(key, json_cast<bool>(value) ? 1.0 : 0.0);
+      break;
+    default:
+      break;  // null, arrays and nested objects are ignored
+  }
+}
+
+record parse_record(const string& line, size_t index) {
+  using jubatus::util::text::json::json_cast;
+  std::istringstream iss(line);
+  json js;
+  iss >> js;
+  if (js.type() != json::Object) {
+    throw std::runtime_error("record must be a JSON object");
+  }
+
+  record r;
+  bool has_datum = false;
+  for (json::const_iterator it = js.begin(); it != js.end(); ++it) {
+    if (it->first == "id") {
+      r.id = json_cast<string>(it->second);
+    } else if (it->first == "label") {
+      r.label = json_cast<string>(it->second);
+    } else if (it->first == "score") {
+      r.score = json_cast<double>(it->second);
+    } else if (it->first == "datum" && it->second.type() == json::Object) {
+      has_datum = true;
+      r.data = datum();
+      for (json::const_iterator jt = it->second.begin();
+           jt != it->second.end(); ++jt) {
+        add_to_datum(jt->first, jt->second, r.data);
+      }
+    } else if (!has_datum) {
+      add_to_datum(it->first, it->second, r.data);
+    }
+  }
+  if (r.id.empty()) {
+    r.id = "jubabench_" + lexical_cast<string>(index);
+  }
+  return r;
+}
+
+void read_corpus(const string& path, vector<record>& corpus) {
+  std::ifstream ifs(path.c_str());
+  if (!ifs) {
+    throw std::runtime_error("cannot open corpus file: " + path);
+  }
+  string line;
+  size_t lineno = 0;
+  while (std::getline(ifs, line)) {
+    ++lineno;
+    if (line.find_first_not_of(" \t\r") == string::npos) {
+      continue;
+    }
+    try {
+      corpus.push_back(parse_record(line, corpus.size()));
+    } catch (const std::exception& e) {
+      throw std::runtime_error(
+          path + ":" + lexical_cast<string>(lineno) + ": " + e.what());
+    }
+  }
+  if (corpus.empty()) {
+    throw std::runtime_error("corpus is empty: " + path);
+  }
+}
+
+// bench_target
+//   Issues one request (a batch of records) with the generated client.
+//   Each worker thread owns its own target (and connection).
+class bench_target {
+ public:
+  virtual ~bench_target() {
+  }
+  virtual void call(const vector<const record*>& batch) = 0;
+};
+
+class classifier_target : public bench_target {
+ public:
+  classifier_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), train_(method == "train") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    if (train_) {
+      vector<jubatus::classifier::labeled_datum> data;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        data.push_back(jubatus::classifier::labeled_datum(
+            batch[i]->label, batch[i]->data));
+      }
+      c_.train(data);
+    } else {
+      vector<datum> data;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        data.push_back(batch[i]->data);
+      }
+      c_.classify(data);
+    }
+  }
+
+ private:
+  jubatus::classifier::client::classifier c_;
+  const bool train_;
+};
+
+class regression_target : public bench_target {
+ public:
+  regression_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), train_(method == "train") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    if (train_) {
+      vector<jubatus::regression::scored_datum> data;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        data.push_back(jubatus::regression::scored_datum(
+            batch[i]->score, batch[i]->data));
+      }
+      c_.train(data);
+    } else {
+      vector<datum> data;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        data.push_back(batch[i]->data);
+      }
+      c_.estimate(data);
+    }
+  }
+
+ private:
+  jubatus::regression::client::regression c_;
+  const bool train_;
+};
+
+class burst_target : public bench_target {
+ public:
+  burst_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), add_(method == "add_documents") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    if (add_) {
+      vector<jubatus::burst::document> data;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        data.push_back(jubatus::burst::document(
+            batch[i]->score, batch[i]->label));
+      }
+      c_.add_documents(data);
+    } else {
+      for (size_t i = 0; i < batch.size(); ++i) {
+        c_.get_result(batch[i]->label);
+      }
+    }
+  }
+
+ private:
+  jubatus::burst::client::burst c_;
+  const bool add_;
+};
+
+class clustering_target : public bench_target {
+ public:
+  clustering_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), push_(method == "push") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    if (push_) {
+      vector<jubatus::clustering::indexed_point> data;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        data.push_back(jubatus::clustering::indexed_point(
+            batch[i]->id, batch[i]->data));
+      }
+      c_.push(data);
+    } else {
+      for (size_t i = 0; i < batch.size(); ++i) {
+        c_.get_nearest_center(batch[i]->data);
+      }
+    }
+  }
+
+ private:
+  jubatus::clustering::client::clustering c_;
+  const bool push_;
+};
+
+// targets below take a single row per RPC; a batch is sent one by one
+// and accounted as a single request
+
+class recommender_target : public bench_target {
+ public:
+  recommender_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method, uint32_t size)
+      : c_(host, port, name, timeout), update_(method == "update_row"),
+        size_(size) {
+  }
+
+  void call(const vector<const record*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (update_) {
+        c_.update_row(batch[i]->id, batch[i]->data);
+      } else {
+        c_.similar_row_from_datum(batch[i]->data, size_);
+      }
+    }
+  }
+
+ private:
+  jubatus::recommender::client::recommender c_;
+  const bool update_;
+  const uint32_t size_;
+};
+
+class anomaly_target : public bench_target {
+ public:
+  anomaly_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), add_(method == "add") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (add_) {
+        c_.add(batch[i]->data);
+      } else {
+        c_.calc_score(batch[i]->data);
+      }
+    }
+  }
+
+ private:
+  jubatus::anomaly::client::anomaly c_;
+  const bool add_;
+};
+
+class nearest_neighbor_target : public bench_target {
+ public:
+  nearest_neighbor_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method, uint32_t size)
+      : c_(host, port, name, timeout), set_(method == "set_row"),
+        size_(size) {
+  }
+
+  void call(const vector<const record*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (set_) {
+        c_.set_row(batch[i]->id, batch[i]->data);
+      } else {
+        c_.neighbor_row_from_datum(batch[i]->data, size_);
+      }
+    }
+  }
+
+ private:
+  jubatus::nearest_neighbor::client::nearest_neighbor c_;
+  const bool set_;
+  const uint32_t size_;
+};
+
+class graph_target : public bench_target {
+ public:
+  graph_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), create_(method == "create_node") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (create_) {
+        c_.create_node();
+      } else {
+        c_.update_node(batch[i]->id, to_property(batch[i]->data));
+      }
+    }
+  }
+
+ private:
+  static std::map<string, string> to_property(const datum& d) {
+    std::map<string, string> property;
+    for (size_t i = 0; i < d.string_values.size(); ++i) {
+      property[d.string_values[i].first] = d.string_values[i].second;
+    }
+    for (size_t i = 0; i < d.num_values.size(); ++i) {
+      property[d.num_values[i].first] =
+          lexical_cast<string>(d.num_values[i].second);
+    }
+    return property;
+  }
+
+  jubatus::graph::client::graph c_;
+  const bool create_;
+};
+
+class stat_target : public bench_target {
+ public:
+  stat_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), push_(method == "push") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (push_) {
+        c_.push(batch[i]->label, batch[i]->score);
+      } else {
+        c_.sum(batch[i]->label);
+      }
+    }
+  }
+
+ private:
+  jubatus::stat::client::stat c_;
+  const bool push_;
+};
+
+class bandit_target : public bench_target {
+ public:
+  bandit_target(
+      const string& host, int port, const string& name, int timeout,
+      const string& method)
+      : c_(host, port, name, timeout), reward_(method == "register_reward") {
+  }
+
+  void call(const vector<const record*>& batch) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (reward_) {
+        c_.register_reward(batch[i]->id, batch[i]->label, batch[i]->score);
+      } else {
+        c_.select_arm(batch[i]->id);
+      }
+    }
+  }
+
+ private:
+  jubatus::bandit::client::bandit c_;
+  const bool reward_;
+};
+
+struct bench_config {
+  string host;
+  int port;
+  string name;
+  int timeout;
+  string engine;
+  string method;
+  uint32_t size;
+  double rate;
+  size_t batch;
+  size_t requests;
+  double duration;
+};
+
+bool is_supported(const string& engine, const string& method) {
+  if (engine == "classifier") {
+    return method == "train" || method == "classify";
+  } else if (engine == "regression") {
+    return method == "train" || method == "estimate";
+  } else if (engine == "recommender") {
+    return method == "update_row" || method == "similar_row_from_datum";
+  } else if (engine == "anomaly") {
+    return method == "add" || method == "calc_score";
+  } else if (engine == "nearest_neighbor") {
+    return method == "set_row" || method == "neighbor_row_from_datum";
+  } else if (engine == "graph") {
+    return method == "create_node" || method == "update_node";
+  } else if (engine == "stat") {
+    return method == "push" || method == "sum";
+  } else if (engine == "bandit") {
+    return method == "register_reward" || method == "select_arm";
+  } else if (engine == "burst") {
+    return method == "add_documents" || method == "get_result";
+  } else if (engine == "clustering") {
+    return method == "push" || method == "get_nearest_center";
+  }
+  return false;
+}
+
+shared_ptr<bench_target> make_target(const bench_config& c) {
+  shared_ptr<bench_target> t;
+  if (c.engine == "classifier") {
+    t.reset(new classifier_target(
+        c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "regression") {
+    t.reset(new regression_target(
+        c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "recommender") {
+    t.reset(new recommender_target(
+        c.host, c.port, c.name, c.timeout, c.method, c.size));
+  } else if (c.engine == "anomaly") {
+    t.reset(new anomaly_target(
+        c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "nearest_neighbor") {
+    t.reset(new nearest_neighbor_target(
+        c.host, c.port, c.name, c.timeout, c.method, c.size));
+  } else if (c.engine == "graph") {
+    t.reset(new graph_target(c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "stat") {
+    t.reset(new stat_target(c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "bandit") {
+    t.reset(new bandit_target(c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "burst") {
+    t.reset(new burst_target(c.host, c.port, c.name, c.timeout, c.method));
+  } else if (c.engine == "clustering") {
+    t.reset(new clustering_target(
+        c.host, c.port, c.name, c.timeout, c.method));
+  }
+  return t;
+}
+
+// load_generator
+//   Hands out request slots on the open-loop schedule to worker threads
+//   and collects their latencies.
+class load_generator {
+ public:
+  load_generator(const bench_config& conf, const vector<record>& corpus)
+      : conf_(conf),
+        corpus_(corpus),
+        start_(0),
+        next_(0),
+        errors_(0) {
+  }
+
+  void run(size_t concurrency) {
+    vector<shared_ptr<bench_target> > targets;
+    for (size_t i = 0; i < concurrency; ++i) {
+      targets.push_back(make_target(conf_));
+    }
+
+    start_ = now();
+    vector<shared_ptr<jubatus::util::concurrent::thread> > threads;
+    for (size_t i = 0; i < concurrency; ++i) {
+      shared_ptr<jubatus::util::concurrent::thread> th(
+          new jubatus::util::concurrent::thread(jubatus::util::lang::bind(
+              &load_generator::worker, this, targets[i].get())));
+      th->start();
+      threads.push_back(th);
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i]->join();
+    }
+    end_ = now();
+  }
+
+  void report(std::ostream& os) const {
+    const double elapsed = end_ - start_;
+    const size_t completed = service_times_.size();
+    os << "engine:       " << conf_.engine << "." << conf_.method << endl;
+    os << "target rate:  ";
+    if (conf_.rate > 0) {
+      os << conf_.rate << " req/sec" << endl;
+    } else {
+      os << "unlimited (closed loop)" << endl;
+    }
+    os << "batch size:   " << conf_.batch << endl;
+    os << "elapsed:      " << elapsed << " sec" << endl;
+    os << "requests:     " << completed << " ok, " << errors_ << " error"
+       << endl;
+    if (completed + errors_ > 0) {
+      os << "error rate:   "
+         << 100.0 * errors_ / (completed + errors_) << " %" << endl;
+    }
+    if (elapsed > 0) {
+      os << "throughput:   " << completed / elapsed << " req/sec, "
+         << completed * conf_.batch / elapsed << " records/sec" << endl;
+    }
+    report_latency(os, "latency (corrected)", latencies_);
+    report_latency(os, "service time", service_times_);
+    report_latency(os, "failure latency", failure_latencies_);
+  }
+
+  size_t errors() const {
+    return errors_;
+  }
+
+ private:
+  // returns false when the run is over
+  bool next_slot(size_t& slot, double& scheduled) {
+    scoped_lock lk(m_);
+    if (conf_.requests > 0 && next_ >= conf_.requests) {
+      return false;
+    }
+    if (conf_.rate > 0) {
+      scheduled = start_ + next_ / conf_.rate;
+    } else {
+      scheduled = now();
+    }
+    if (conf_.duration > 0 && scheduled - start_ >= conf_.duration) {
+      return false;
+    }
+    slot = next_++;
+    return true;
+  }
+
+  void worker(bench_target* target) {
+    vector<double> latencies;
+    vector<double> service_times;
+    vector<double> failure_latencies;
+    size_t errors = 0;
+    vector<const record*> batch(conf_.batch);
+
+    size_t slot;
+    double scheduled;
+    while (next_slot(slot, scheduled)) {
+      for (size_t i = 0; i < conf_.batch; ++i) {
+        batch[i] = &corpus_[(slot * conf_.batch + i) % corpus_.size()];
+      }
+      sleep_until(scheduled);
+
+      const double sent = now();
+      try {
+        target->call(batch);
+      } catch (const std::exception& e) {
+        ++errors;
+        if (errors == 1) {
+          scoped_lock lk(m_);
+          cerr << "request failed: " << e.what() << endl;
+        }
+        failure_latencies.push_back(now() - sent);
+        continue;
+      }
+      const double done = now();
+      latencies.push_back(done - scheduled);
+      service_times.push_back(done - sent);
+    }
+
+    scoped_lock lk(m_);
+    latencies_.insert(latencies_.end(), latencies.begin(), latencies.end());
+    service_times_.insert(
+        service_times_.end(), service_times.begin(), service_times.end());
+    failure_latencies_.insert(failure_latencies_.end(),
+        failure_latencies.begin(), failure_latencies.end());
+    errors_ += errors;
+  }
+
+  static void report_latency(
+      std::ostream& os,
+      const string& title,
+      vector<double> values) {
+    if (values.empty()) {
+      return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+      sum += values[i];
+    }
+
+    const double ps[] = {50, 90, 99, 99.9};
+    os << title << " (msec):" << endl;
+    os << "  mean:   " << sum / values.size() * 1e3 << endl;
+    for (size_t i = 0; i < sizeof(ps) / sizeof(ps[0]); ++i) {
+      // nearest-rank percentile
+      size_t rank = static_cast<size_t>(ps[i] * values.size() / 100.0 + 0.5);
+      rank = std::min(std::max(rank, static_cast<size_t>(1)), values.size());
+      os << "  p" << ps[i] << ":" << string(ps[i] < 99.5 ? 4 : 2, ' ')
+         << values[rank - 1] * 1e3 << endl;
+    }
+    os << "  max:    " << values.back() * 1e3 << endl;
+  }
+
+  const bench_config& conf_;
+  const vector<record>& corpus_;
+  double start_;
+  double end_;
+
+  mutex m_;
+  size_t next_;
+  size_t errors_;
+  vector<double> latencies_;
+  vector<double> service_times_;
+  vector<double> failure_latencies_;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  cmdline::parser p;
+  p.add<string>("server", 's', "server address", false, "127.0.0.1");
+  p.add<int>("rpc-port", 'p', "server port", false, 9199);
+  p.add<string>("name", 'n', "cluster name", false, "");
+  p.add<int>("timeout", 'T', "RPC timeout in seconds", false, 10);
+  p.add<string>("engine", 'e', "engine type", true, "",
+      cmdline::oneof<string>("classifier", "regression", "recommender",
+          "anomaly", "nearest_neighbor", "graph", "stat", "bandit", "burst",
+          "clustering"));
+  p.add<string>("method", 'm', "method to call", true);
+  p.add<string>("input", 'i', "corpus file (JSON lines)", true);
+  p.add<double>("rate", 'r',
+      "target request rate per second (0: closed loop)", false, 100);
+  p.add<int>("concurrency", 'c', "number of concurrent connections",
+      false, 4, cmdline::range(1, 4096));
+  p.add<int>("batch", 'b', "records per request", false, 1,
+      cmdline::range(1, 1000000));
+  p.add<int>("requests", 'N', "number of requests (0: unlimited)", false, 0);
+  p.add<double>("duration", 'd', "duration in seconds (0: unlimited)",
+      false, 10);
+  p.add<int>("size", 'k', "number of results for similar/neighbor queries",
+      false, 10);
+  p.set_program_name("jubabench");
+  p.parse_check(argc, argv);
+
+  bench_config conf;
+  conf.host = p.get<string>("server");
+  conf.port = p.get<int>("rpc-port");
+  conf.name = p.get<string>("name");
+  conf.timeout = p.get<int>("timeout");
+  conf.engine = p.get<string>("engine");
+  conf.method = p.get<string>("method");
+  conf.size = p.get<int>("size");
+  conf.rate = p.get<double>("rate");
+  conf.batch = p.get<int>("batch");
+  conf.requests = std::max(p.get<int>("requests"), 0);
+  conf.duration = p.get<double>("duration");
+
+  if (!is_supported(conf.engine, conf.method)) {
+    cerr << "unsupported method for " << conf.engine << ": " << conf.method
+         << endl;
+    return -1;
+  }
+  if (conf.requests == 0 && conf.duration <= 0) {
+    cerr << "specify --requests or --duration" << endl;
+    return -1;
+  }
+  if (conf.rate < 0) {
+    cerr << "--rate must not be negative" << endl;
+    return -1;
+  }
+
+  vector<record> corpus;
+  try {
+    read_corpus(p.get<string>("input"), corpus);
+  } catch (const std::exception& e) {
+    cerr << e.what() << endl;
+    return -1;
+  }
+
+  load_generator gen(conf, corpus);
+  gen.run(p.get<int>("concurrency"));
+  gen.report(cout);
+
+  return gen.errors() == 0 ? 0 : 1;
+}
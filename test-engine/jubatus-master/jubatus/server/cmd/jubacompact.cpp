@@ -0,0 +1,53 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <iostream>
+#include <string>
+
+#include "jubatus/core/common/exception.hpp"
+#include "../framework/save_load.hpp"
+#include "../third_party/cmdline/cmdline.h"
+
+using std::string;
+
+// rewrites a delta model file saved with --save_delta_chain (and the chain of
+// model files it depends on) into a single model file
+int main(int argc, char* argv[])
+try {
+  cmdline::parser p;
+  p.add<string>("input", 'i', "model file to compact", true);
+  p.add<string>("output", 'o', "path to write the compacted model file", true);
+  p.add("compress", 'c',
+        "write the sectioned format (version 3), which servers older than "
+        "this one cannot load");
+  p.set_program_name("jubacompact");
+  p.parse_check(argc, argv);
+
+  const string input = p.get<string>("input");
+  const string output = p.get<string>("output");
+  if (input == output) {
+    std::cerr << "output must differ from input" << std::endl;
+    return -1;
+  }
+
+  jubatus::server::framework::compact_model_file(
+      input, output, p.exist("compress"));
+  return 0;
+} catch (const jubatus::core::common::exception::jubatus_exception& e) {
+  std::cerr << e.diagnostic_information(true) << std::endl;
+  return -1;
+}
@@ -18,8 +18,21 @@
 #include <log4cxx/patternlayout.h>
 #include <log4cxx/fileappender.h>
 
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
+#include "jubatus/util/concurrent/condition.h"
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/concurrent/thread.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/noncopyable.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "jubatus/util/system/time_util.h"
 #include "jubatus/util/text/json.h"
 
 #include "jubatus/core/common/exception.hpp"
@@ -28,6 +41,7 @@
 #include "jubatus/core/fv_converter/json_converter.hpp"
 #include "jubatus/core/fv_converter/converter_config.hpp"
 #include "jubatus/core/fv_converter/so_factory.hpp"
+#include "../common/unique_lock.hpp"
 #include "../third_party/cmdline/cmdline.h"
 
 
@@ -37,12 +51,19 @@ using std::cin;
 using std::cout;
 using std::endl;
 using std::ifstream;
+using std::istream;
+using std::ostream;
 using std::string;
+using std::vector;
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::concurrent::thread;
+using jubatus::util::lang::shared_ptr;
 using jubatus::util::text::json::json;
 using jubatus::core::fv_converter::converter_config;
 using jubatus::core::fv_converter::datum;
 using jubatus::core::fv_converter::datum_to_fv_converter;
 using jubatus::core::fv_converter::json_converter;
+using jubatus::server::common::unique_lock;
 
 struct server_config {
   jubatus::core::fv_converter::converter_config converter;
@@ -60,12 +81,12 @@ void show_invalid_type_error(
       << output_format << endl;
 }
 
-void output_json(const json& json) {
-  json.pretty(cout, false);
+void output_json(ostream& out, const json& json) {
+  json.pretty(out, false);
 }
 
-void output_datum(const datum& datum) {
-  jubatus::util::text::json::to_json(datum).pretty(cout, false);
+void output_datum(ostream& out, const datum& datum) {
+  jubatus::util::text::json::to_json(datum).pretty(out, false);
 }
 
 int read_config(const string& conf_file, converter_config& conf) {
@@ -96,9 +117,9 @@ void convert_datum(
   conv.convert(datum, fv);
 }
 
-void output_fv(const jubatus::core::common::sfv_t& fv) {
+void output_fv(ostream& out, const jubatus::core::common::sfv_t& fv) {
   for (size_t i = 0; i < fv.size(); ++i) {
-    cout << fv[i].first << ": " << fv[i].second << endl;
+    out << fv[i].first << ": " << fv[i].second << endl;
   }
 }
 
@@ -120,6 +141,279 @@ void read_datum(datum& datum) {
   }
 }
 
+// Number of records each conversion thread may have in flight; the input
+// is read ahead by at most this many records per thread.
+const size_t BATCH_RECORDS_PER_THREAD = 256;
+
+// batch_worker
+//   Converts one record into the same text single mode prints for it. Each
+//   worker owns its own converter (and plugin instances), built once before
+//   processing starts.
+class batch_worker {
+ public:
+  batch_worker(
+      const string& input_format,
+      const string& output_format,
+      const converter_config& conf)
+      : input_format_(input_format),
+        output_format_(output_format) {
+    if (output_format_ == "fv") {
+      initialize_converter(conf, conv_, &so_loader_);
+    }
+  }
+
+  string convert(const string& line) {
+    std::istringstream iss(line);
+    std::ostringstream oss;
+
+    json js;
+    datum d;
+    if (input_format_ == "json") {
+      iss >> js;
+      if (output_format_ == "json") {
+        output_json(oss, js);
+        return oss.str();
+      }
+      json_converter::convert(js, d);
+    } else {
+      iss >> jubatus::util::text::json::via_json(d);
+    }
+
+    if (output_format_ == "datum") {
+      output_datum(oss, d);
+      return oss.str();
+    }
+
+    jubatus::core::common::sfv_t fv;
+    conv_.convert(d, fv);
+    output_fv(oss, fv);
+    return oss.str();
+  }
+
+ private:
+  const string input_format_;
+  const string output_format_;
+  datum_to_fv_converter conv_;
+  jubatus::core::fv_converter::so_factory so_loader_;
+};
+
+// batch_pipeline
+//   Persistent threads converting records taken from a bounded queue.
+//   Records are numbered when pushed and results are taken in that order,
+//   so at most `capacity` records are held at a time.
+class batch_pipeline : jubatus::util::lang::noncopyable {
+ public:
+  batch_pipeline(
+      const vector<shared_ptr<batch_worker> >& workers,
+      size_t capacity)
+      : workers_(workers),
+        slots_(capacity),
+        pushed_(0),
+        popped_(0),
+        stopped_(false) {
+  }
+
+  ~batch_pipeline() {
+    stop();
+  }
+
+  void start() {
+    for (size_t t = 0; t < workers_.size(); ++t) {
+      shared_ptr<thread> th(new thread(jubatus::util::lang::bind(
+          &batch_pipeline::run, this, workers_[t].get())));
+      if (!th->start()) {
+        throw JUBATUS_EXCEPTION(
+            jubatus::core::common::exception::runtime_error(
+                "failed to start conversion thread"));
+      }
+      threads_.push_back(th);
+    }
+  }
+
+  bool full() const {
+    return pushed_ - popped_ == slots_.size();
+  }
+
+  bool empty() const {
+    return pushed_ == popped_;
+  }
+
+  // must not be called when full()
+  void push(const string& line) {
+    scoped_lock lk(m_);
+    record& r = slots_[pushed_ % slots_.size()];
+    r.input = line;
+    r.done = false;
+    queue_.push_back(pushed_++);
+    queued_.notify();
+  }
+
+  // waits for the oldest record; returns false if its conversion failed
+  bool pop(string& output, string& error) {
+    unique_lock lk(m_);
+    record& r = slots_[popped_++ % slots_.size()];
+    while (!r.done) {
+      converted_.wait(m_);
+    }
+    output.swap(r.output);
+    error.swap(r.error);
+    return error.empty();
+  }
+
+  // records still queued are dropped
+  void stop() {
+    {
+      scoped_lock lk(m_);
+      stopped_ = true;
+      queued_.notify_all();
+    }
+    for (size_t t = 0; t < threads_.size(); ++t) {
+      threads_[t]->join();
+    }
+    threads_.clear();
+  }
+
+ private:
+  struct record {
+    record() : done(false) {
+    }
+    string input;
+    string output;
+    string error;
+    bool done;
+  };
+
+  void run(batch_worker* worker) {
+    while (true) {
+      size_t seq;
+      string input;
+      {
+        unique_lock lk(m_);
+        while (queue_.empty() && !stopped_) {
+          queued_.wait(m_);
+        }
+        if (stopped_) {
+          return;
+        }
+        seq = queue_.front();
+        queue_.pop_front();
+        input.swap(slots_[seq % slots_.size()].input);
+      }
+
+      string output;
+      string error;
+      try {
+        output = worker->convert(input);
+      } catch (const jubatus::core::common::exception::jubatus_exception& e) {
+        error = e.what();
+      } catch (const std::exception& e) {
+        error = e.what();
+      }
+
+      scoped_lock lk(m_);
+      record& r = slots_[seq % slots_.size()];
+      r.output.swap(output);
+      r.error.swap(error);
+      r.done = true;
+      converted_.notify_all();
+    }
+  }
+
+  const vector<shared_ptr<batch_worker> > workers_;
+  vector<shared_ptr<thread> > threads_;
+
+  jubatus::util::concurrent::mutex m_;
+  jubatus::util::concurrent::condition queued_;
+  jubatus::util::concurrent::condition converted_;
+  std::deque<size_t> queue_;
+  vector<record> slots_;
+  // only touched by the thread calling push() and pop()
+  size_t pushed_;
+  size_t popped_;
+  bool stopped_;
+};
+
+// Converts JSON-lines input (one record per line) and writes each record as
+// single mode does, in the input order and separated by an empty line.
+// Stops at the first record that fails to convert and returns -1.
+int convert_batch(
+    istream& in,
+    const string& input_format,
+    const string& output_format,
+    const string& conf_file,
+    size_t thread_num) {
+  converter_config conf;
+  if (output_format == "fv") {
+    if (conf_file == "") {
+      cerr << "specify converter config with -c flag" << endl;
+      exit(-1);
+    }
+    if (read_config(conf_file, conf) != 0) {
+      exit(-1);
+    }
+  }
+
+  vector<shared_ptr<batch_worker> > workers;
+  for (size_t t = 0; t < thread_num; ++t) {
+    workers.push_back(shared_ptr<batch_worker>(
+        new batch_worker(input_format, output_format, conf)));
+  }
+
+  using jubatus::util::system::time::clock_time;
+  using jubatus::util::system::time::get_clock_time;
+  const clock_time start = get_clock_time();
+
+  batch_pipeline pipeline(workers, thread_num * BATCH_RECORDS_PER_THREAD);
+  pipeline.start();
+
+  // line numbers of the records in the pipeline
+  std::deque<size_t> linenos;
+  size_t lineno = 0;
+  size_t records = 0;
+  string line;
+  string output;
+  string error;
+  while (true) {
+    while (!pipeline.full() && std::getline(in, line)) {
+      ++lineno;
+      if (line.find_first_not_of(" \t\r") == string::npos) {
+        continue;  // skip blank lines
+      }
+      pipeline.push(line);
+      linenos.push_back(lineno);
+    }
+    if (pipeline.empty()) {
+      break;
+    }
+
+    if (!pipeline.pop(output, error)) {
+      cout.flush();
+      cerr << "line " << linenos.front() << ": " << error << endl;
+      return -1;
+    }
+    linenos.pop_front();
+    if (records > 0) {
+      cout << '\n';
+    }
+    cout << output;
+    if (!output.empty() && output[output.size() - 1] != '\n') {
+      cout << '\n';
+    }
+    ++records;
+  }
+  cout.flush();
+
+  const double elapsed = static_cast<double>(get_clock_time() - start);
+  cerr << "converted " << records << " records in " << elapsed
+       << " sec with " << thread_num << " thread(s)";
+  if (elapsed > 0) {
+    cerr << ": " << records / elapsed << " records/sec";
+  }
+  cerr << endl;
+
+  return 0;
+}
+
 void disable_log4cxx() {
     log4cxx::LayoutPtr layout(
         new log4cxx::PatternLayout(""));
@@ -136,6 +430,13 @@ try {
   p.add<string>("output-format", 'o', "output format (json/datum/fv)", false,
       "fv", cmdline::oneof<string>("json", "datum", "fv"));
   p.add<string>("conf", 'c', "converter config file", false);
+  p.add("batch", 'b',
+      "batch mode: convert JSON-lines input, one record per line; records "
+      "are written as in single mode, separated by an empty line");
+  p.add<string>("input-file", 'f',
+      "read input from the file instead of stdin (batch mode)", false, "");
+  p.add<int>("thread", 't', "number of conversion threads (batch mode)",
+      false, 1, cmdline::range(1, 1024));
   p.set_program_name("jubaconv");
   p.parse_check(argc, argv);
 
@@ -149,6 +450,26 @@ try {
 
   disable_log4cxx();
 
+  if (p.exist("batch")) {
+    if (input_format == "datum" && output_format == "json") {
+      show_invalid_type_error(input_format, output_format);
+      return -1;
+    }
+    const string input_file = p.get<string>("input-file");
+    if (input_file.empty()) {
+      return convert_batch(cin, input_format, output_format,
+          p.get<string>("conf"), p.get<int>("thread"));
+    } else {
+      ifstream ifs(input_file.c_str());
+      if (!ifs) {
+        cerr << "cannot open input file: " << input_file << endl;
+        return -1;
+      }
+      return convert_batch(ifs, input_format, output_format,
+          p.get<string>("conf"), p.get<int>("thread"));
+    }
+  }
+
   if (input_format == "json") {
     read_json(json);
     proc = true;
@@ -159,7 +480,7 @@ try {
       show_invalid_type_error(input_format, output_format);
       return -1;
     }
-    output_json(json);
+    output_json(cout, json);
     return 0;
   }
 
@@ -175,7 +496,7 @@ try {
       show_invalid_type_error(input_format, output_format);
       return -1;
     }
-    output_datum(datum);
+    output_datum(cout, datum);
     return 0;
   }
 
@@ -188,7 +509,7 @@ try {
       show_invalid_type_error(input_format, output_format);
       return -1;
     }
-    output_fv(fv);
+    output_fv(cout, fv);
     return 0;
   }
 
@@ -90,6 +90,19 @@ try {
   p.add<std::string>("listen_if", 'B',
       "[start] bind network interfance", false, "");
   p.add<int>("thread", 'C', "[start] concurrency = thread number", false, 2);
+  p.add<int>("update_threads", 'U',
+      "[start] dedicated threads for update methods", false, 0);
+  p.add<int>("analysis_threads", 'A',
+      "[start] dedicated threads for analysis methods", false, 0);
+  p.add<int>("update_max_inflight", 0,
+      "[start] max update requests in progress before rejecting", false, 0);
+  p.add<int>("analysis_max_inflight", 0,
+      "[start] max analysis requests in progress before rejecting", false, 0);
+  p.add<double>("request_deadline", 0,
+      "[start] drop requests queued longer than this (sec, needs -U or -A)",
+      false, 0);
+  p.add<int>("analysis_cache_size", 0,
+      "[start] analysis results to reuse until the model changes", false, 0);
   p.add<int>("timeout", 'T', "[start] time out (sec)", false, 10);
   p.add<std::string>("datadir", 'D',
       "[start] directory to load and save models", false, "/tmp");
@@ -97,15 +110,52 @@ try {
       "[start] directory to output logs (instead of stderr)", false, "");
   p.add<std::string>("log_config", 'G',
       "[start] log4cxx XML configuration file", false, "");
+  p.add("update_log", 0,
+      "[start] log update requests and recover them after a restart");
+  p.add<int>("checkpoint_interval", 0,
+      "[start] seconds between checkpoints of the update log", false, 600);
+  p.add<int>("save_delta_chain", 0,
+      "[start] deltas saved in a row before a whole model (0: no delta)",
+      false, 0);
+  p.add("background_load", 0,
+      "[start] load models in the background while serving the current one");
+  p.add("compress_model", 0,
+      "[start] save whole models in the sectioned format (version 3)");
   p.add<std::string>("mixer", 'X',
       "[start] mixer strategy", false, "linear_mixer");
   p.add<int>("interval_sec", 'S', "[start] mix interval by seconds", false, 16);
   p.add<int>("interval_count", 'I',
       "[start] mix interval by update count", false, 512);
+  p.add<int>("mix_target_staleness", 0,
+      "[start] updates left unmixed, to adapt mix interval (0: fixed)",
+      false, 0);
+  p.add<int>("mix_network_budget", 0,
+      "[start] MIX bytes per sec, to adapt mix interval (0: unlimited)",
+      false, 0);
+  p.add<int>("mix_min_interval", 0,
+      "[start] shortest adaptive mix interval by seconds", false, 1);
+  p.add<int>("mix_bandwidth_limit", 0,
+      "[start] MIX bytes per sec each server transfers (0: unlimited)",
+      false, 0);
+  p.add<int>("mix_port_offset", 0,
+      "[start] serve MIX at rpc-port + offset (0: use rpc-port)", false, 0);
+  p.add<std::string>("cpu_affinity", 0,
+      "[start] run servers only on these CPUs (default: jubavisor placement)",
+      false, "");
+  p.add<int>("numa_node", 0,
+      "[start] allocate server memory from this NUMA node (-1: any)",
+      false, -1);
   p.add<int>("zookeeper_timeout", 'Z',
       "[start] zookeeper time out (sec)", false, 10);
   p.add<int>("interconnect_timeout", 'R',
       "[start] interconnect time out between servers (sec)", false, 10);
+  p.add<std::string>("replica_write_quorum", 0,
+      "[start] acknowledge replicated writes when written to primary or all",
+      false, "primary");
+  p.add("partitioned", 0,
+      "[start] keep rows only on their CHT owners (model is not mixed)");
+  p.add("serving_only", 0,
+      "[start] receive mixed models but reject update requests");
 
   p.add("debug", 'd', "debug mode (obsolete)");
 
@@ -209,6 +259,13 @@ void send2supervisor(
 
     server_option.bind_if = argv.get<std::string>("listen_if");
     server_option.threadnum = argv.get<int>("thread");
+    server_option.update_threadnum = argv.get<int>("update_threads");
+    server_option.analysis_threadnum = argv.get<int>("analysis_threads");
+    server_option.update_max_inflight = argv.get<int>("update_max_inflight");
+    server_option.analysis_max_inflight =
+        argv.get<int>("analysis_max_inflight");
+    server_option.request_deadline = argv.get<double>("request_deadline");
+    server_option.analysis_cache_size = argv.get<int>("analysis_cache_size");
     server_option.timeout = argv.get<int>("timeout");
     server_option.program_name = type;
     server_option.z = zkhosts;
@@ -216,12 +273,29 @@ void send2supervisor(
     server_option.datadir = argv.get<std::string>("datadir");
     server_option.logdir = argv.get<std::string>("logdir");
     server_option.log_config = argv.get<std::string>("log_config");
+    server_option.update_log = argv.exist("update_log");
+    server_option.checkpoint_interval = argv.get<int>("checkpoint_interval");
+    server_option.save_delta_chain = argv.get<int>("save_delta_chain");
+    server_option.background_load = argv.exist("background_load");
+    server_option.compress_model = argv.exist("compress_model");
     server_option.mixer = argv.get<std::string>("mixer");
 
     server_option.interval_sec = argv.get<int>("interval_sec");
     server_option.interval_count = argv.get<int>("interval_count");
+    server_option.mix_target_staleness =
+        argv.get<int>("mix_target_staleness");
+    server_option.mix_network_budget = argv.get<int>("mix_network_budget");
+    server_option.mix_min_interval = argv.get<int>("mix_min_interval");
+    server_option.mix_bandwidth_limit = argv.get<int>("mix_bandwidth_limit");
+    server_option.mix_port_offset = argv.get<int>("mix_port_offset");
+    server_option.cpu_affinity = argv.get<std::string>("cpu_affinity");
+    server_option.numa_node = argv.get<int>("numa_node");
     server_option.zookeeper_timeout = argv.get<int>("zookeeper_timeout");
     server_option.interconnect_timeout = argv.get<int>("interconnect_timeout");
+    server_option.replica_write_quorum =
+        argv.get<std::string>("replica_write_quorum");
+    server_option.partitioned = argv.exist("partitioned");
+    server_option.serving_only = argv.exist("serving_only");
   }
 
   ls_->list(jubatus::server::common::JUBAVISOR_BASE_PATH, list);
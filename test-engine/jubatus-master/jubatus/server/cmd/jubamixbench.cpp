@@ -0,0 +1,260 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+// jubamixbench
+//   Measures how long the linear mixer takes to fold and apply a diff of a
+//   synthetic classifier model, and the peak RSS of doing so.
+//
+//   A PA classifier is trained on --features distinct numeric features, and
+//   its diff is packed once. Each round then does what a MIX master and
+//   its members do with the diffs of --peers servers:
+//     fold:      unpack each diff and mix it into one diff_object
+//     serialize: pack the mixed diff
+//     put_diff:  unpack the mixed diff and apply it to the model
+//   Diffs are unpacked in place, as the mixers do; with --copy, each diff
+//   is first copied into a byte_buffer, as put_diff used to receive it.
+//   Peak RSS is the high-water mark of the process, so compare the two
+//   modes in separate runs.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <msgpack.hpp>
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "jubatus/util/system/time_util.h"
+#include "jubatus/util/text/json.h"
+
+#include "jubatus/core/classifier/classifier_factory.hpp"
+#include "jubatus/core/common/byte_buffer.hpp"
+#include "jubatus/core/common/jsonconfig.hpp"
+#include "jubatus/core/driver/classifier.hpp"
+#include "jubatus/core/framework/mixable.hpp"
+#include "jubatus/core/framework/stream_writer.hpp"
+#include "jubatus/core/fv_converter/converter_config.hpp"
+#include "jubatus/core/fv_converter/datum.hpp"
+#include "jubatus/core/fv_converter/datum_to_fv_converter.hpp"
+#include "jubatus/core/storage/storage_factory.hpp"
+
+#include "../framework/mixer/mixer.hpp"
+#include "../third_party/cmdline/cmdline.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using jubatus::core::common::byte_buffer;
+using jubatus::core::framework::diff_object;
+using jubatus::core::framework::jubatus_packer;
+using jubatus::core::framework::linear_mixable;
+using jubatus::core::framework::packer;
+using jubatus::core::framework::stream_writer;
+using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
+using jubatus::util::system::time::get_clock_time;
+using jubatus::util::text::json::json;
+
+namespace {
+
+// features per training datum
+const size_t DATUM_FEATURES = 10000;
+
+double now() {
+  return static_cast<double>(get_clock_time());
+}
+
+long peak_rss_kb() {  // NOLINT
+  struct rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+shared_ptr<jubatus::core::driver::classifier> make_classifier() {
+  namespace jsonconfig = jubatus::core::common::jsonconfig;
+  const string converter =
+      "{\"num_rules\": [{\"key\": \"*\", \"type\": \"num\"}]}";
+  const jubatus::core::fv_converter::converter_config conf =
+      jsonconfig::config_cast_check<
+          jubatus::core::fv_converter::converter_config>(
+          jsonconfig::config(lexical_cast<json>(converter)));
+
+  return shared_ptr<jubatus::core::driver::classifier>(
+      new jubatus::core::driver::classifier(
+          jubatus::core::classifier::classifier_factory::create_classifier(
+              "PA", jsonconfig::config(),
+              jubatus::core::storage::storage_factory::create_storage(
+                  "local_mixture")),
+          jubatus::core::fv_converter::make_fv_converter(conf, NULL)));
+}
+
+void train(jubatus::core::driver::classifier& classifier, size_t features) {
+  for (size_t begin = 0; begin < features; begin += DATUM_FEATURES) {
+    jubatus::core::fv_converter::datum d;
+    const size_t end = std::min(begin + DATUM_FEATURES, features);
+    for (size_t i = begin; i < end; ++i) {
+      d.num_values_.push_back(
+          std::make_pair("f" + lexical_cast<string>(i), 1.0));
+    }
+    classifier.train((begin / DATUM_FEATURES) % 2 ? "pos" : "neg", d);
+  }
+}
+
+linear_mixable* get_linear_mixable(
+    jubatus::core::driver::classifier& classifier) {
+  linear_mixable* mixable =
+      dynamic_cast<linear_mixable*>(classifier.get_mixable());
+  if (!mixable) {
+    throw std::runtime_error("classifier is not linear mixable");
+  }
+  return mixable;
+}
+
+void pack_diff(const diff_object& diff, msgpack::sbuffer& sbuf) {
+  stream_writer<msgpack::sbuffer> st(sbuf);
+  jubatus_packer jp(st);
+  packer pk(jp);
+  diff->convert_binary(pk);
+}
+
+// unpacks a diff in the way the mixers receive it
+void unpack_received(
+    const char* data,
+    size_t size,
+    bool copy,
+    byte_buffer& copied,
+    msgpack::unpacked& msg) {
+  if (copy) {
+    copied = byte_buffer(data, size);
+    data = copied.ptr();
+  }
+  msgpack::object raw;
+  raw.type = msgpack::type::RAW;
+  raw.via.raw.ptr = data;
+  raw.via.raw.size = size;
+  jubatus::server::framework::mixer::unpack_diff(raw, msg);
+}
+
+struct phase_times {
+  phase_times()
+      : fold(0), serialize(0), put_diff(0) {
+  }
+
+  double fold;
+  double serialize;
+  double put_diff;
+};
+
+phase_times run_round(
+    linear_mixable& mixable,
+    const msgpack::sbuffer& peer_diff,
+    int peers,
+    bool copy) {
+  phase_times t;
+
+  double start = now();
+  diff_object diff;
+  for (int i = 0; i < peers; ++i) {
+    byte_buffer copied;
+    msgpack::unpacked msg;
+    unpack_received(peer_diff.data(), peer_diff.size(), copy, copied, msg);
+    if (!diff) {
+      diff = mixable.convert_diff_object(msg.get());
+    } else {
+      mixable.mix(msg.get(), diff);
+    }
+  }
+  t.fold = now() - start;
+
+  start = now();
+  msgpack::sbuffer mixed;
+  pack_diff(diff, mixed);
+  diff = diff_object();
+  t.serialize = now() - start;
+
+  start = now();
+  {
+    byte_buffer copied;
+    msgpack::unpacked msg;
+    unpack_received(mixed.data(), mixed.size(), copy, copied, msg);
+    mixable.put_diff(mixable.convert_diff_object(msg.get()));
+  }
+  t.put_diff = now() - start;
+
+  return t;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  cmdline::parser p;
+  p.add<int>("features", 'f', "number of features in the diff", false,
+      1000000, cmdline::range(1, 100000000));
+  p.add<int>("peers", 'n', "number of diffs folded per round", false, 4,
+      cmdline::range(1, 1024));
+  p.add<int>("rounds", 'r', "number of rounds", false, 3,
+      cmdline::range(1, 1000));
+  p.add("copy", 'C', "copy each diff into a byte_buffer before unpacking");
+  p.set_program_name("jubamixbench");
+  p.parse_check(argc, argv);
+
+  const int peers = p.get<int>("peers");
+  const int rounds = p.get<int>("rounds");
+  const bool copy = p.exist("copy");
+
+  try {
+    shared_ptr<jubatus::core::driver::classifier> classifier =
+        make_classifier();
+    double start = now();
+    train(*classifier, p.get<int>("features"));
+    cout << "train (sec):       " << now() - start << endl;
+
+    linear_mixable* mixable = get_linear_mixable(*classifier);
+    msgpack::sbuffer peer_diff;
+    {
+      stream_writer<msgpack::sbuffer> st(peer_diff);
+      jubatus_packer jp(st);
+      packer pk(jp);
+      mixable->get_diff(pk);
+    }
+    cout << "diff size (bytes): " << peer_diff.size() << endl;
+    cout << "peak RSS before mix (KB): " << peak_rss_kb() << endl;
+
+    phase_times total;
+    for (int i = 0; i < rounds; ++i) {
+      const phase_times t = run_round(*mixable, peer_diff, peers, copy);
+      total.fold += t.fold;
+      total.serialize += t.serialize;
+      total.put_diff += t.put_diff;
+    }
+
+    cout << "mode:              " << (copy ? "copy" : "in place") << endl;
+    cout << "per round (msec):" << endl;
+    cout << "  fold:      " << total.fold / rounds * 1e3 << endl;
+    cout << "  serialize: " << total.serialize / rounds * 1e3 << endl;
+    cout << "  put_diff:  " << total.put_diff / rounds * 1e3 << endl;
+    cout << "peak RSS (KB):     " << peak_rss_kb() << endl;
+  } catch (const std::exception& e) {
+    cerr << e.what() << endl;
+    return -1;
+  }
+  return 0;
+}
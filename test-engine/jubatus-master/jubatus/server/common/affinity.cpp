@@ -0,0 +1,213 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "affinity.hpp"
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "jubatus/util/lang/cast.h"
+#include "logger/logger.hpp"
+
+using std::string;
+using std::vector;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+namespace {
+
+#ifdef __linux__
+// from <linux/mempolicy.h>; libnuma is not required
+const int MPOL_PREFERRED_MODE = 1;
+#endif
+
+const char NODE_PATH[] = "/sys/devices/system/node/node";
+
+bool parse_cpu(const string& s, int& cpu) {
+  if (s.empty() || s.find_first_not_of("0123456789") != string::npos) {
+    return false;
+  }
+  cpu = std::atoi(s.c_str());
+  return true;
+}
+
+}  // namespace
+
+bool parse_cpu_list(const string& list, vector<int>& cpus) {
+  cpus.clear();
+  std::istringstream in(list);
+  string range;
+  while (std::getline(in, range, ',')) {
+    const size_t dash = range.find('-');
+    int first, last;
+    if (dash == string::npos) {
+      if (!parse_cpu(range, first)) {
+        return false;
+      }
+      last = first;
+    } else if (!parse_cpu(range.substr(0, dash), first)
+               || !parse_cpu(range.substr(dash + 1), last)
+               || last < first) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return !cpus.empty();
+}
+
+string format_cpu_list(const vector<int>& cpus) {
+  string list;
+  for (size_t i = 0; i < cpus.size(); ) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    if (!list.empty()) {
+      list += ',';
+    }
+    list += lexical_cast<string>(cpus[i]);
+    if (j > i) {
+      list += '-' + lexical_cast<string>(cpus[j]);
+    }
+    i = j + 1;
+  }
+  return list;
+}
+
+vector<int> partition_cpus(const vector<int>& cpus, size_t i, size_t n) {
+  if (cpus.empty() || n == 0) {
+    return vector<int>();
+  }
+  if (n > cpus.size()) {
+    return vector<int>(1, cpus[i % cpus.size()]);
+  }
+  return vector<int>(cpus.begin() + i * cpus.size() / n,
+                     cpus.begin() + (i + 1) * cpus.size() / n);
+}
+
+#ifdef __linux__
+
+bool get_allowed_cpus(vector<int>& cpus) {
+  cpus.clear();
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return false;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return true;
+}
+
+int get_numa_node_count() {
+  int n = 0;
+  while (std::ifstream(
+      (NODE_PATH + lexical_cast<string>(n) + "/cpulist").c_str())) {
+    ++n;
+  }
+  return n;
+}
+
+bool get_numa_node_cpus(int node, vector<int>& cpus) {
+  std::ifstream in(
+      (NODE_PATH + lexical_cast<string>(node) + "/cpulist").c_str());
+  string list;
+  return std::getline(in, list) && parse_cpu_list(list, cpus);
+}
+
+bool set_cpu_affinity(const vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    if (cpus[i] < 0 || cpus[i] >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpus[i], &set);
+  }
+  if (::sched_setaffinity(0, sizeof(set), &set) != 0) {
+    LOG(ERROR) << "sched_setaffinity failed: " << format_cpu_list(cpus);
+    return false;
+  }
+  return true;
+}
+
+bool set_numa_node(int node) {
+  if (node < 0) {
+    return false;
+  }
+  const size_t bits = sizeof(unsigned long) * 8;  // NOLINT
+  vector<unsigned long> mask(node / bits + 1, 0);  // NOLINT
+  mask[node / bits] |= 1UL << (node % bits);
+  if (::syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, &mask[0],
+                mask.size() * bits + 1) != 0) {
+    LOG(ERROR) << "set_mempolicy failed: node " << node;
+    return false;
+  }
+  return true;
+}
+
+#else
+
+bool get_allowed_cpus(vector<int>& cpus) {
+  cpus.clear();
+  return false;
+}
+
+int get_numa_node_count() {
+  return 0;
+}
+
+bool get_numa_node_cpus(int node, vector<int>& cpus) {
+  cpus.clear();
+  return false;
+}
+
+bool set_cpu_affinity(const vector<int>& cpus) {
+  LOG(ERROR) << "CPU affinity is not supported on this platform";
+  return false;
+}
+
+bool set_numa_node(int node) {
+  LOG(ERROR) << "NUMA memory policy is not supported on this platform";
+  return false;
+}
+
+#endif
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
@@ -0,0 +1,60 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_COMMON_AFFINITY_HPP_
+#define JUBATUS_SERVER_COMMON_AFFINITY_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+// "0-3,8" -> [0, 1, 2, 3, 8]; returns false on a syntax error
+bool parse_cpu_list(const std::string& list, std::vector<int>& cpus);
+
+// [0, 1, 2, 3, 8] -> "0-3,8"
+std::string format_cpu_list(const std::vector<int>& cpus);
+
+// CPUs of the i-th of n processes dividing `cpus` evenly; processes share
+// a CPU when there are fewer CPUs than processes
+std::vector<int> partition_cpus(
+    const std::vector<int>& cpus,
+    size_t i,
+    size_t n);
+
+// CPUs the calling process may run on
+bool get_allowed_cpus(std::vector<int>& cpus);
+
+// number of NUMA nodes (0 if unknown)
+int get_numa_node_count();
+bool get_numa_node_cpus(int node, std::vector<int>& cpus);
+
+// binds the calling thread, and threads it creates later, to `cpus`
+bool set_cpu_affinity(const std::vector<int>& cpus);
+
+// prefers memory of `node` for the calling thread and threads it creates
+// later
+bool set_numa_node(int node);
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_COMMON_AFFINITY_HPP_
@@ -0,0 +1,74 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "affinity.hpp"
+
+using std::string;
+using std::vector;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+TEST(affinity, parse_cpu_list) {
+  vector<int> cpus;
+  ASSERT_TRUE(parse_cpu_list("0-3,8,10-11", cpus));
+  ASSERT_EQ(7u, cpus.size());
+  EXPECT_EQ(0, cpus[0]);
+  EXPECT_EQ(3, cpus[3]);
+  EXPECT_EQ(8, cpus[4]);
+  EXPECT_EQ(11, cpus[6]);
+
+  EXPECT_FALSE(parse_cpu_list("", cpus));
+  EXPECT_FALSE(parse_cpu_list("a", cpus));
+  EXPECT_FALSE(parse_cpu_list("3-1", cpus));
+  EXPECT_FALSE(parse_cpu_list("1,-2", cpus));
+}
+
+TEST(affinity, format_cpu_list) {
+  vector<int> cpus;
+  ASSERT_TRUE(parse_cpu_list("8,0-3,10,11", cpus));
+  EXPECT_EQ("0-3,8,10-11", format_cpu_list(cpus));
+  EXPECT_EQ("", format_cpu_list(vector<int>()));
+}
+
+TEST(affinity, partition_cpus) {
+  vector<int> cpus;
+  ASSERT_TRUE(parse_cpu_list("0-7", cpus));
+  EXPECT_EQ("0-3", format_cpu_list(partition_cpus(cpus, 0, 2)));
+  EXPECT_EQ("4-7", format_cpu_list(partition_cpus(cpus, 1, 2)));
+  EXPECT_EQ("0-1", format_cpu_list(partition_cpus(cpus, 0, 3)));
+  EXPECT_EQ("5-7", format_cpu_list(partition_cpus(cpus, 2, 3)));
+
+  // more processes than CPUs
+  EXPECT_EQ("1", format_cpu_list(partition_cpus(cpus, 9, 10)));
+}
+
+TEST(affinity, allowed_cpus) {
+  vector<int> cpus;
+  if (get_allowed_cpus(cpus)) {
+    EXPECT_FALSE(cpus.empty());
+    EXPECT_TRUE(set_cpu_affinity(cpus));
+  }
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
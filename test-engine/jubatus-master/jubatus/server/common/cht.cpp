@@ -142,6 +142,32 @@ bool cht::find(
   return !hlist.size();
 }
 
+void cht::get_ring(
+    std::vector<std::pair<std::string, std::pair<std::string, int> > >& out) {
+  out.clear();
+  std::vector<std::string> hlist;
+  if (!get_hashlist_("", hlist)) {
+    throw JUBATUS_EXCEPTION(core::common::not_found(
+        "failed to fetch list of CHT entry"));
+  }
+  std::string path;
+  build_actor_path(path, type_, name_);
+  path += "/cht";
+
+  out.reserve(hlist.size());
+  std::string loc;
+  for (size_t i = 0; i < hlist.size(); ++i) {
+    std::string ip;
+    int port;
+    if (!lock_service_->read(path + "/" + hlist[i], loc)) {
+      throw JUBATUS_EXCEPTION(core::common::not_found(
+          "failed to read CHT entry: " + path));
+    }
+    revert(loc, ip, port);
+    out.push_back(make_pair(hlist[i], make_pair(ip, port)));
+  }
+}
+
 /**
  * Get list of CHT entries in my cluster.
  * Returns true when succeed to fetch one or more CHT entries.
@@ -78,6 +78,11 @@ class cht {
       std::vector<std::pair<std::string, int> >&,
       size_t);
 
+  // get_ring :: [(hash, node)] sorted by hash
+  // used to let clients find nodes by themselves
+  void get_ring(
+      std::vector<std::pair<std::string, std::pair<std::string, int> > >&);
+
  private:
   bool get_hashlist_(const std::string& key, std::vector<std::string>&);
 
@@ -14,16 +14,108 @@
 // License along with this library; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 #include <gtest/gtest.h>
+#include "jubatus/client/common/routing.hpp"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/util/lang/shared_ptr.h"
 #include "cht.hpp"
 
+using std::map;
+using std::pair;
 using std::string;
+using std::vector;
+using jubatus::util::lang::function;
+using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
 
 namespace jubatus {
 namespace server {
 namespace common {
 
+namespace {
+
+// keeps nodes in memory; enough for registering and finding CHT nodes
+class cht_zk_stub : public lock_service {
+ public:
+  void force_close() {
+  }
+  bool create(const string& path, const string& payload, bool ephemeral) {
+    if (nodes_.count(path) == 0) {
+      nodes_[path] = payload;
+    }
+    return true;
+  }
+  bool set(const string& path, const string& payload) {
+    nodes_[path] = payload;
+    return true;
+  }
+  bool remove(const string& path) {
+    nodes_.erase(path);
+    return true;
+  }
+  bool exists(const string& path) {
+    return nodes_.count(path) > 0;
+  }
+  bool bind_watcher(const string&, function<void(int, int, string)>&) {
+    return false;
+  }
+  bool bind_child_watcher(
+      const string&, const function<void(int, int, string)>&) {
+    return false;
+  }
+  bool bind_delete_watcher(const string&, function<void(string)>&) {
+    return false;
+  }
+  bool create_seq(const string&, string&) {
+    return false;
+  }
+  bool create_id(const string&, uint32_t, uint64_t&) {
+    return false;
+  }
+  bool list(const string& path, vector<string>& out) {
+    out.clear();
+    for (map<string, string>::const_iterator it = nodes_.begin();
+         it != nodes_.end(); ++it) {
+      if (it->first.compare(0, path.size() + 1, path + '/') == 0) {
+        out.push_back(it->first.substr(path.size() + 1));
+      }
+    }
+    return true;
+  }
+  bool read(const string& path, string& out) {
+    if (!exists(path)) {
+      return false;
+    }
+    out = nodes_[path];
+    return true;
+  }
+  void push_cleanup(const function<void()>&) {
+  }
+  void run_cleanup() {
+  }
+  const string& get_hosts() const {
+    return hosts_;
+  }
+  const string type() const {
+    return "stub";
+  }
+  const string get_connected_host_and_port() const {
+    return "";
+  }
+  void reopen_logfile() {
+  }
+
+ private:
+  map<string, string> nodes_;
+  string hosts_;
+};
+
+}  // namespace
+
 TEST(cht, make_hash) {
   string hash = make_hash("hage");
   string hash2 = make_hash("hage");
@@ -32,6 +124,45 @@ TEST(cht, make_hash) {
   ASSERT_NE(hash, hash3);
 }
 
+// smart clients place keys on the ring with their own MD5
+TEST(cht, client_md5_matches_make_hash) {
+  vector<string> keys;
+  keys.push_back("");
+  keys.push_back("a");
+  keys.push_back("127.0.0.1_9199_0");
+  keys.push_back("\xe5\xbe\xb3\xe5\xb7\x9d");
+  keys.push_back(string(55, 'x'));  // padding fits in the last block
+  keys.push_back(string(56, 'x'));  // padding needs another block
+  keys.push_back(string(1000, 'y'));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(make_hash(keys[i]),
+              jubatus::client::common::detail::md5_hex(keys[i]));
+  }
+}
+
+TEST(cht, client_find_matches_find) {
+  shared_ptr<lock_service> zk(new cht_zk_stub);
+  cht::setup_cht_dir(*zk, "test", "name");
+  cht ht(zk, "test", "name");
+  ht.register_node("192.168.0.1", 9199);
+  ht.register_node("192.168.0.2", 9199);
+  ht.register_node("192.168.0.3", 9200);
+
+  jubatus::client::common::routing_ring ring;
+  ht.get_ring(ring);
+  ASSERT_EQ(3u * NUM_VSERV, ring.size());
+
+  for (size_t i = 0; i < 1000; ++i) {
+    const string key = "row" + lexical_cast<string>(i);
+    for (size_t n = 1; n <= 3; ++n) {
+      vector<pair<string, int> > expected;
+      ht.find(key, expected, n);
+      EXPECT_EQ(expected,
+                jubatus::client::common::find_in_ring(ring, key, n));
+    }
+  }
+}
+
 }  // namespace common
 }  // namespace server
 }  // namespace jubatus
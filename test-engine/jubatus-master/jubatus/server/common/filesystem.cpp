@@ -18,6 +18,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <cstdlib>
 #include <cerrno>
@@ -71,6 +72,19 @@ string real_path(const string& relative_path) {
   return absolute_path;
 }
 
+bool sync_parent_dir(const string& path) {
+  const size_t found = path.rfind('/');
+  const string dir = found == string::npos ? string(".") :
+      found == 0 ? string("/") : path.substr(0, found);
+  const int fd = ::open(dir.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool synced = ::fsync(fd) == 0;
+  ::close(fd);
+  return synced;
+}
+
 }  // namespace common
 }  // namespace server
 }  // namespace jubatus
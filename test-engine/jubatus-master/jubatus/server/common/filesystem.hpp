@@ -26,6 +26,8 @@ namespace common {
 bool is_writable(const char* dir_path);
 std::string base_name(const std::string&);
 std::string real_path(const std::string&);
+// makes the directory entry of `path` durable (after creating or renaming)
+bool sync_parent_dir(const std::string& path);
 
 }  // namespace common
 }  // namespace server
@@ -0,0 +1,198 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "leader_election.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/function.h"
+#include "logger/logger.hpp"
+
+using std::string;
+using std::vector;
+using jubatus::util::concurrent::scoped_lock;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+// shared with watcher callbacks, which may run after the election is gone
+struct leader_election::watch_state {
+  watch_state()
+      : changed(false) {
+  }
+
+  jubatus::util::concurrent::mutex m;
+  // the predecessor has gone
+  bool changed;
+  // node of this member deleted after it became the leader
+  string lost;
+};
+
+namespace {
+
+void predecessor_deleted(
+    jubatus::util::lang::shared_ptr<leader_election::watch_state> state,
+    string path) {
+  scoped_lock lk(state->m);
+  state->changed = true;
+}
+
+void own_node_deleted(
+    jubatus::util::lang::shared_ptr<leader_election::watch_state> state,
+    string path) {
+  scoped_lock lk(state->m);
+  state->lost = path;
+}
+
+string take_lost(leader_election::watch_state& state) {
+  scoped_lock lk(state.m);
+  string lost;
+  lost.swap(state.lost);
+  return lost;
+}
+
+bool take_changed(leader_election::watch_state& state) {
+  scoped_lock lk(state.m);
+  const bool changed = state.changed;
+  state.changed = false;
+  return changed;
+}
+
+}  // namespace
+
+leader_election::leader_election(
+    lock_service& ls,
+    const string& path,
+    const string& data)
+    : ls_(ls),
+      path_(path),
+      data_(data),
+      is_leader_(false),
+      watch_(new watch_state) {
+}
+
+leader_election::~leader_election() {
+  resign();
+}
+
+bool leader_election::is_leader() {
+  scoped_lock lk(m_);
+  if (node_.empty()) {
+    if (!join()) {
+      return false;
+    }
+    update();
+  } else if (is_leader_ && take_lost(*watch_) == node_) {
+    // another member may be leading already
+    LOG(WARNING) << "election node lost, leaving leadership: " << node_;
+    ls_.remove(node_);
+    node_.clear();
+    is_leader_ = false;
+  } else if (take_changed(*watch_)) {
+    update();
+  }
+  return is_leader_;
+}
+
+bool leader_election::get_leader(string& data) {
+  vector<string> list;
+  if (!ls_.list(path_, list) || list.empty()) {
+    return false;
+  }
+  std::sort(list.begin(), list.end());
+  return ls_.read(path_ + '/' + list[0], data);
+}
+
+void leader_election::resign() {
+  scoped_lock lk(m_);
+  if (!node_.empty()) {
+    ls_.remove(node_);
+    LOG(INFO) << "left election: " << node_;
+    node_.clear();
+  }
+  is_leader_ = false;
+}
+
+bool leader_election::join() {
+  string node;
+  if (!ls_.create(path_) || !ls_.create_seq(path_ + "/n_", node)
+      || node.empty()) {
+    return false;
+  }
+  if (!ls_.set(node, data_)) {
+    ls_.remove(node);
+    return false;
+  }
+  node_ = node;
+  LOG(INFO) << "joined election: " << node_;
+  return true;
+}
+
+void leader_election::update() {
+  vector<string> list;
+  if (!ls_.list(path_, list)) {
+    // try again next time
+    scoped_lock lk(watch_->m);
+    watch_->changed = true;
+    return;
+  }
+  std::sort(list.begin(), list.end());
+
+  const string name = node_.substr(path_.size() + 1);
+  const vector<string>::const_iterator it =
+      std::lower_bound(list.begin(), list.end(), name);
+  if (it == list.end() || *it != name) {
+    LOG(WARNING) << "election node lost, joining again: " << node_;
+    node_.clear();
+    is_leader_ = false;
+    return;
+  }
+
+  if (it == list.begin()) {
+    if (!is_leader_) {
+      LOG(INFO) << "became leader: " << node_;
+      // watched instead of checked on every is_leader()
+      jubatus::util::lang::function<void(string)> f =
+          jubatus::util::lang::bind(&own_node_deleted, watch_,
+                                    jubatus::util::lang::_1);
+      if (!ls_.bind_delete_watcher(node_, f)) {
+        scoped_lock lk(watch_->m);
+        watch_->lost = node_;
+      }
+    }
+    is_leader_ = true;
+    return;
+  }
+
+  is_leader_ = false;
+  jubatus::util::lang::function<void(string)> f =
+      jubatus::util::lang::bind(&predecessor_deleted, watch_,
+                                jubatus::util::lang::_1);
+  if (!ls_.bind_delete_watcher(path_ + '/' + *(it - 1), f)) {
+    // the predecessor has already gone
+    scoped_lock lk(watch_->m);
+    watch_->changed = true;
+  }
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
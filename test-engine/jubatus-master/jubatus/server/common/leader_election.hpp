@@ -0,0 +1,74 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_COMMON_LEADER_ELECTION_HPP_
+#define JUBATUS_SERVER_COMMON_LEADER_ELECTION_HPP_
+
+#include <string>
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "lock_service.hpp"
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+// leader_election
+//   Elects one leader among the members under `path`.  Each member creates
+//   an ephemeral sequential node and watches only the node just before its
+//   own; the member with the smallest node is the leader.  The leadership
+//   is kept until the member resigns or its node is gone; the leader
+//   watches its own node, so is_leader() reads ZooKeeper only after a
+//   watched node has gone.
+class leader_election {
+ public:
+  // `data` is stored in the node of this member (e.g. its address)
+  leader_election(
+      lock_service& ls,
+      const std::string& path,
+      const std::string& data);
+  ~leader_election();
+
+  // joins the election on the first call
+  bool is_leader();
+
+  // data of the current leader
+  bool get_leader(std::string& data);
+
+  void resign();
+
+  struct watch_state;
+
+ private:
+  bool join();
+  void update();
+
+  lock_service& ls_;
+  const std::string path_;
+  const std::string data_;
+
+  jubatus::util::concurrent::mutex m_;
+  std::string node_;
+  bool is_leader_;
+  jubatus::util::lang::shared_ptr<watch_state> watch_;
+};
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_COMMON_LEADER_ELECTION_HPP_
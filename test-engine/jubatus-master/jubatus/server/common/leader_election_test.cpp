@@ -0,0 +1,242 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "jubatus/util/lang/cast.h"
+#include "leader_election.hpp"
+
+using std::map;
+using std::string;
+using std::vector;
+using jubatus::util::lang::function;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+namespace {
+
+// keeps nodes in memory and fires delete watchers on remove
+class election_zk_stub : public lock_service {
+ public:
+  election_zk_stub()
+      : writes_(0),
+        lists_(0),
+        exists_(0),
+        seq_(0) {
+  }
+
+  void force_close() {
+  }
+  bool create(const string& path, const string& payload, bool ephemeral) {
+    ++writes_;
+    if (nodes_.count(path) == 0) {
+      nodes_[path] = payload;
+    }
+    return true;
+  }
+  bool set(const string& path, const string& payload) {
+    ++writes_;
+    nodes_[path] = payload;
+    return true;
+  }
+  bool remove(const string& path) {
+    ++writes_;
+    nodes_.erase(path);
+    if (watchers_.count(path)) {
+      vector<function<void(string)> > fs;
+      fs.swap(watchers_[path]);
+      watchers_.erase(path);
+      for (size_t i = 0; i < fs.size(); ++i) {
+        fs[i](path);
+      }
+    }
+    return true;
+  }
+  bool exists(const string& path) {
+    ++exists_;
+    return nodes_.count(path) > 0;
+  }
+  bool bind_watcher(const string&, function<void(int, int, string)>&) {
+    return false;
+  }
+  bool bind_child_watcher(
+      const string&, const function<void(int, int, string)>&) {
+    return false;
+  }
+  bool bind_delete_watcher(const string& path, function<void(string)>& f) {
+    if (nodes_.count(path) == 0) {
+      return false;
+    }
+    watchers_[path].push_back(f);
+    return true;
+  }
+  bool create_seq(const string& path, string& seqfile) {
+    ++writes_;
+    const string n = lexical_cast<string>(seq_++);
+    seqfile = path + string(10 - n.size(), '0') + n;
+    nodes_[seqfile] = "";
+    return true;
+  }
+  bool create_id(const string&, uint32_t, uint64_t&) {
+    return false;
+  }
+  bool list(const string& path, vector<string>& out) {
+    ++lists_;
+    out.clear();
+    for (map<string, string>::const_iterator it = nodes_.begin();
+         it != nodes_.end(); ++it) {
+      if (it->first.compare(0, path.size() + 1, path + '/') == 0) {
+        out.push_back(it->first.substr(path.size() + 1));
+      }
+    }
+    return true;
+  }
+  bool read(const string& path, string& out) {
+    if (nodes_.count(path) == 0) {
+      return false;
+    }
+    out = nodes_[path];
+    return true;
+  }
+  void push_cleanup(const function<void()>&) {
+  }
+  void run_cleanup() {
+  }
+  const string& get_hosts() const {
+    return hosts_;
+  }
+  const string type() const {
+    return "stub";
+  }
+  const string get_connected_host_and_port() const {
+    return "";
+  }
+  void reopen_logfile() {
+  }
+
+  int writes_;
+  int lists_;
+  int exists_;
+
+ private:
+  int seq_;
+  map<string, string> nodes_;
+  map<string, vector<function<void(string)> > > watchers_;
+  string hosts_;
+};
+
+}  // namespace
+
+TEST(leader_election, first_member_leads) {
+  election_zk_stub zk;
+  leader_election a(zk, "/election", "a");
+  leader_election b(zk, "/election", "b");
+
+  EXPECT_TRUE(a.is_leader());
+  EXPECT_FALSE(b.is_leader());
+
+  string leader;
+  ASSERT_TRUE(b.get_leader(leader));
+  EXPECT_EQ("a", leader);
+}
+
+TEST(leader_election, no_writes_while_leading) {
+  election_zk_stub zk;
+  leader_election a(zk, "/election", "a");
+  leader_election b(zk, "/election", "b");
+  ASSERT_TRUE(a.is_leader());
+  ASSERT_FALSE(b.is_leader());
+
+  const int writes = zk.writes_;
+  zk.lists_ = 0;
+  zk.exists_ = 0;
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(a.is_leader());
+    EXPECT_FALSE(b.is_leader());
+  }
+  EXPECT_EQ(writes, zk.writes_);
+  EXPECT_EQ(0, zk.lists_);
+  EXPECT_EQ(0, zk.exists_);
+}
+
+TEST(leader_election, successor_takes_over) {
+  election_zk_stub zk;
+  leader_election a(zk, "/election", "a");
+  leader_election b(zk, "/election", "b");
+  leader_election c(zk, "/election", "c");
+  ASSERT_TRUE(a.is_leader());
+  ASSERT_FALSE(b.is_leader());
+  ASSERT_FALSE(c.is_leader());
+
+  // c watches b, which has not left yet
+  a.resign();
+  EXPECT_TRUE(b.is_leader());
+  EXPECT_FALSE(c.is_leader());
+
+  b.resign();
+  EXPECT_TRUE(c.is_leader());
+  string leader;
+  ASSERT_TRUE(a.get_leader(leader));
+  EXPECT_EQ("c", leader);
+}
+
+TEST(leader_election, leader_node_lost) {
+  election_zk_stub zk;
+  leader_election a(zk, "/election", "a");
+  leader_election b(zk, "/election", "b");
+  ASSERT_TRUE(a.is_leader());
+  ASSERT_FALSE(b.is_leader());
+
+  // the node of a is deleted as if its session expired
+  vector<string> nodes;
+  ASSERT_TRUE(zk.list("/election", nodes));
+  ASSERT_EQ(2u, nodes.size());
+  zk.remove("/election/" + nodes[0]);
+
+  EXPECT_FALSE(a.is_leader());
+  EXPECT_TRUE(b.is_leader());
+  // a joins again behind b
+  EXPECT_FALSE(a.is_leader());
+  string leader;
+  ASSERT_TRUE(a.get_leader(leader));
+  EXPECT_EQ("b", leader);
+}
+
+TEST(leader_election, middle_member_leaves) {
+  election_zk_stub zk;
+  leader_election a(zk, "/election", "a");
+  leader_election b(zk, "/election", "b");
+  leader_election c(zk, "/election", "c");
+  ASSERT_TRUE(a.is_leader());
+  ASSERT_FALSE(b.is_leader());
+  ASSERT_FALSE(c.is_leader());
+
+  // c now watches a
+  b.resign();
+  EXPECT_FALSE(c.is_leader());
+  a.resign();
+  EXPECT_TRUE(c.is_leader());
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
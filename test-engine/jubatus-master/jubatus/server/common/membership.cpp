@@ -77,9 +77,19 @@ void build_config_lock_path(
 
 // 127.0.0.1_9199 -> (127.0.0.1, 9199)
 bool revert(const string& name, string& ip, int& port) {
-  ip = name.substr(0, name.find("_"));
-  port = atoi(name.substr(name.find("_") + 1).c_str());
-  return true;
+  const string::size_type sep = name.find("_");
+  ip = name.substr(0, sep);
+  port = atoi(name.substr(sep + 1).c_str());
+  // e.g. the data of a node not written yet
+  return sep != string::npos && !ip.empty() && 0 < port && port <= 65535;
+}
+
+// node data: the MIX port if it differs from the RPC port
+static string mix_port_data(int port, int mix_port) {
+  if (mix_port <= 0 || mix_port == port) {
+    return "";
+  }
+  return lexical_cast<string>(mix_port);
 }
 
 // zk -> name -> ip -> port -> void
@@ -88,7 +98,8 @@ void register_actor(
     const string& type,
     const string& name,
     const string& ip,
-    int port) {
+    int port,
+    int mix_port) {
   bool success = true;
 
   string path;
@@ -101,7 +112,7 @@ void register_actor(
   {
     string path1;
     build_existence_path(path, ip, port, path1);
-    success = success && z.create(path1, "", true);
+    success = success && z.create(path1, mix_port_data(port, mix_port), true);
     if (success) {
       LOG(INFO) << "actor created: " << path1;
     } else {
@@ -167,6 +178,94 @@ void unregister_active(
   }
 }
 
+// serving-only replicas are listed apart from actives so that they only
+// receive analysis requests and are never asked for diffs
+void register_serving(
+    lock_service& z,
+    const string& type,
+    const string& name,
+    const string& ip,
+    int port,
+    int mix_port) {
+  bool success = true;
+
+  string path;
+  build_actor_path(path, type, name);
+  success = success && z.create(path);
+  success = success && z.create(path + "/master_lock", "");
+  path += "/servings";
+  success = success && z.create(path);
+
+  {
+    string path1;
+    build_existence_path(path, ip, port, path1);
+    success = success && z.create(path1, mix_port_data(port, mix_port), true);
+    if (success) {
+      LOG(INFO) << "serving created: " << path1;
+    } else {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("Failed to register_serving")
+          << core::common::exception::error_api_func("lock_service::create"));
+    }
+  }
+}
+
+void unregister_serving(
+    lock_service& z,
+    const std::string& type,
+    const std::string& name,
+    const std::string& ip,
+    int port) {
+  bool success = true;
+
+  string path;
+  build_actor_path(path, type, name);
+  path += "/servings";
+  {
+    string path1;
+    build_existence_path(path, ip, port, path1);
+    success = success && z.remove(path1);
+    if (success) {
+      LOG(INFO) << "serving removed: " << path1;
+    } else {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("Failed to unregister_serving")
+          << core::common::exception::error_api_func("lock_service::remove"));
+    }
+  }
+}
+
+void register_unix_socket(
+    lock_service& z,
+    const string& type,
+    const string& name,
+    const string& ip,
+    int port,
+    const string& socket_path) {
+  bool success = true;
+
+  string path;
+  build_actor_path(path, type, name);
+  success = success && z.create(path);
+  success = success && z.create(path + "/master_lock", "");
+  path += "/unix_sockets";
+  success = success && z.create(path);
+
+  {
+    string path1;
+    build_existence_path(path, ip, port, path1);
+    success = success && z.create(path1, socket_path, true);
+    if (success) {
+      LOG(INFO) << "unix socket registered: " << path1;
+    } else {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error(
+              "Failed to register_unix_socket")
+          << core::common::exception::error_api_func("lock_service::create"));
+    }
+  }
+}
+
 void watch_delete_actor(
     lock_service& z,
     const string& type,
@@ -254,6 +353,25 @@ static bool get_all_node(
   return true;
 }
 
+static bool get_all_mix_node(
+    lock_service& z,
+    const string& path,
+    std::vector<std::pair<string, int> >& ret) {
+  if (!get_all_node(z, path, ret)) {
+    return false;
+  }
+  for (size_t i = 0; i < ret.size(); ++i) {
+    string path1;
+    string data;
+    build_existence_path(path, ret[i].first, ret[i].second, path1);
+    // the node may have gone; keep its rpc_port then
+    if (z.read(path1, data) && !data.empty()) {
+      ret[i].second = atoi(data.c_str());
+    }
+  }
+  return true;
+}
+
 void shutdown_server() {
   ::kill(::getpid(), SIGTERM);
 }
@@ -284,6 +402,43 @@ bool get_all_actives(
   return get_all_node(z, path, ret);
 }
 
+// zk -> name -> list( (ip, rpc_port) )
+bool get_all_servings(
+    lock_service& z,
+    const string& type,
+    const string& name,
+    std::vector<std::pair<string, int> >& ret) {
+  ret.clear();
+  string path;
+  build_actor_path(path, type, name);
+  path += "/servings";
+  return get_all_node(z, path, ret);
+}
+
+bool get_all_mix_nodes(
+    lock_service& z,
+    const string& type,
+    const string& name,
+    std::vector<std::pair<string, int> >& ret) {
+  ret.clear();
+  string path;
+  build_actor_path(path, type, name);
+  path += "/nodes";
+  return get_all_mix_node(z, path, ret);
+}
+
+bool get_all_mix_servings(
+    lock_service& z,
+    const string& type,
+    const string& name,
+    std::vector<std::pair<string, int> >& ret) {
+  ret.clear();
+  string path;
+  build_actor_path(path, type, name);
+  path += "/servings";
+  return get_all_mix_node(z, path, ret);
+}
+
 void prepare_jubatus(lock_service& ls, const string& type, const string& name) {
   bool success = true;
   success = ls.create(JUBATUS_BASE_PATH) && success;
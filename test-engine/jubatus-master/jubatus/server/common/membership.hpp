@@ -60,16 +60,18 @@ void build_config_lock_path(
     const std::string&,
     const std::string&);
 
-// 127.0.0.1_9199 -> (127.0.0.1, 9199)
+// 127.0.0.1_9199 -> (127.0.0.1, 9199); false if `name` is not in the form
 bool revert(const std::string&, std::string&, int&);
 
 // zk -> name -> ip -> port -> void
+//   `mix_port` is published when MIX RPCs are served on another port
 void register_actor(
     lock_service&,
     const std::string& type,
     const std::string& name,
     const std::string& ip,
-    int port);
+    int port,
+    int mix_port = 0);
 
 void register_active(
     lock_service& z,
@@ -85,6 +87,32 @@ void unregister_active(
     const std::string& ip,
     int port);
 
+// registers a serving-only replica, which receives mixed models and
+// analysis requests but does not contribute diffs
+void register_serving(
+    lock_service& z,
+    const std::string& type,
+    const std::string& name,
+    const std::string& ip,
+    int port,
+    int mix_port = 0);
+
+void unregister_serving(
+    lock_service& z,
+    const std::string& type,
+    const std::string& name,
+    const std::string& ip,
+    int port);
+
+// publishes the UNIX domain socket `socket_path` that the server at
+// (ip, port) also listens on, for clients running on the same host
+void register_unix_socket(
+    lock_service& z,
+    const std::string& type,
+    const std::string& name,
+    const std::string& ip,
+    int port,
+    const std::string& socket_path);
 
 void watch_delete_actor(
     lock_service& z,
@@ -108,6 +136,26 @@ bool get_all_nodes(
     const std::string& name,
     std::vector<std::pair<std::string, int> >&);
 
+// zk -> name -> list( (ip, rpc_port) ) of serving-only replicas
+bool get_all_servings(
+    lock_service&,
+    const std::string& type,
+    const std::string& name,
+    std::vector<std::pair<std::string, int> >&);
+
+// zk -> name -> list( (ip, mix_port) ) of nodes / serving-only replicas
+//   where mix_port is the rpc_port unless the node published another one
+bool get_all_mix_nodes(
+    lock_service&,
+    const std::string& type,
+    const std::string& name,
+    std::vector<std::pair<std::string, int> >&);
+bool get_all_mix_servings(
+    lock_service&,
+    const std::string& type,
+    const std::string& name,
+    std::vector<std::pair<std::string, int> >&);
+
 void shutdown_server();
 
 void prepare_jubatus(
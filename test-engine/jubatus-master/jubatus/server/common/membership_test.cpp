@@ -55,6 +55,16 @@ TEST(util, revert) {
   EXPECT_EQ(9199, port);
 }
 
+TEST(util, revert_invalid) {
+  string ip;
+  int port;
+  EXPECT_FALSE(revert("", ip, port));
+  EXPECT_FALSE(revert("127.0.0.1", ip, port));
+  EXPECT_FALSE(revert("_9199", ip, port));
+  EXPECT_FALSE(revert("127.0.0.1_", ip, port));
+  EXPECT_FALSE(revert("127.0.0.1_99999", ip, port));
+}
+
 }  // namespace common
 }  // namespace server
 }  // namespace jubatus
@@ -27,6 +27,18 @@ namespace mprpc {
 
 DEFINE_ERROR_TAG(error_method, "Method", std::string)
 
+// error codes of rpc_server, in addition to msgpack-rpc's NO_METHOD_ERROR (1)
+// and ARGUMENT_ERROR (2)
+//   SERVER_BUSY_ERROR: rejected by admission control before execution, or
+//     because the server is stopping; the request can be retried on
+//     another server
+//   DEADLINE_EXCEEDED_ERROR: dropped because it waited in the queue longer
+//     than the request deadline
+//   READ_ONLY_ERROR: update request sent to a read-only (serving) server
+const unsigned int SERVER_BUSY_ERROR = 10;
+const unsigned int DEADLINE_EXCEEDED_ERROR = 11;
+const unsigned int READ_ONLY_ERROR = 12;
+
 class rpc_no_client
   : public core::common::exception::jubaexception<rpc_no_client> {
  public:
@@ -61,6 +73,24 @@ class rpc_method_not_found
     : public core::common::exception::jubaexception<rpc_method_not_found> {
 };
 
+// rpc_server error (retryable)
+class rpc_server_busy
+    : public core::common::exception::jubaexception<rpc_server_busy> {
+ public:
+  const char* what() const throw() {
+    return "server busy";
+  }
+};
+
+// rpc_server error
+class rpc_deadline_exceeded
+    : public core::common::exception::jubaexception<rpc_deadline_exceeded> {
+ public:
+  const char* what() const throw() {
+    return "deadline exceeded";
+  }
+};
+
 // rpc_server error
 class rpc_call_error
     : public core::common::exception::jubaexception<rpc_call_error> {
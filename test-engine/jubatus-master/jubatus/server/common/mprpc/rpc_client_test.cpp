@@ -53,6 +53,7 @@ JUBATUS_MPRPC_PROC(add_all, int, (int, int, int));
 JUBATUS_MPRPC_PROC(various, string, (int, float, double, strw));
 JUBATUS_MPRPC_PROC(sum, int, (std::vector<int>));
 JUBATUS_MPRPC_PROC(vec, std::vector<std::string>, (std::string, size_t));
+JUBATUS_MPRPC_PROC(nap, int, (int));  // NOLINT
 
 void wait_server(int port) {
   msgpack::rpc::client cli("localhost", port);
@@ -102,6 +103,13 @@ static int sum(std::vector<int> hoge) {
 static std::vector<std::string> vec(std::string s, size_t size) {
   return std::vector<std::string> (size, s);
 }
+static int nap_long(int i) {
+  usleep(500000);
+  return i;
+}
+static int nap_short(int i) {
+  return i;
+}
 static std::string concat(std::string l, std::string r) {
   return (l + r);
 }
@@ -122,7 +130,8 @@ JUBATUS_MPRPC_GEN(
     add_all,
     various,
     sum,
-    vec);
+    vec,
+    nap);
 
 typedef shared_ptr<test_mrpc_server> server_ptr;
 typedef std::vector<server_ptr> server_list;
@@ -140,6 +149,13 @@ static void server_thread(server_ptr srv, unsigned u) {
   srv->start(10, /*no_hang=*/ true);
 }
 
+static void nap_server_thread(server_ptr srv, unsigned u, bool slow) {
+  srv->set_nap(slow ? &nap_long : &nap_short);
+
+  srv->listen(u);
+  srv->start(10, /*no_hang=*/ true);
+}
+
 static const uint16_t PORT0 = JUBATUS_RPC_TEST_PORT_BASE;
 static const uint16_t PORT1 = JUBATUS_RPC_TEST_PORT_BASE + 1;
 static const uint16_t kPortStart = JUBATUS_RPC_TEST_PORT_BASE;
@@ -541,3 +557,28 @@ TEST(rpc_mclient, socket_disconnection) {
 
   ser->close();
 }
+
+TEST(rpc_mclient, elapsed_per_host) {
+  server_ptr slow(new test_mrpc_server(3.0));
+  server_ptr fast(new test_mrpc_server(3.0));
+  thread th0(jubatus::util::lang::bind(&nap_server_thread, slow, PORT0, true));
+  thread th1(jubatus::util::lang::bind(&nap_server_thread, fast, PORT1, false));
+  th0.start();
+  th1.start();
+  wait_server(PORT0);
+  wait_server(PORT1);
+
+  // the slow server is waited for first; the fast one must not be
+  // charged for that wait
+  std::vector<std::pair<std::string, uint16_t> > clients;
+  clients.push_back(std::make_pair(std::string("localhost"), PORT0));
+  clients.push_back(std::make_pair(std::string("localhost"), PORT1));
+  jubatus::server::common::mprpc::rpc_mclient cli(clients, 3.0);
+  jubatus::server::common::mprpc::rpc_result_object r = cli.call("nap", 1);
+  ASSERT_EQ(2u, r.elapsed.size());
+  EXPECT_LE(0.5, r.elapsed[0]);
+  EXPECT_GT(0.3, r.elapsed[1]);
+
+  slow->close();
+  fast->close();
+}
@@ -18,6 +18,7 @@
 #include <string>
 #include <utility>
 
+#include "jubatus/util/concurrent/lock.h"
 #include "jubatus/util/system/syscall.h"
 #include "../logger/logger.hpp"
 
@@ -46,6 +47,7 @@ rpc_result_object rpc_mclient::wait(const std::string& method) {
                     hosts_[i].second,
                     jubatus::core::common::exception::get_current_exception()));
     }
+    result.elapsed.push_back(elapsed_(i));
   }
 
   if (result.response.empty()) {
@@ -59,6 +61,29 @@ rpc_result_object rpc_mclient::wait(const std::string& method) {
   return result;
 }
 
+void rpc_mclient::completed(
+    jubatus::util::lang::shared_ptr<completion_times> times,
+    jubatus::util::system::time::clock_time call_time,
+    size_t i,
+    msgpack::rpc::future f) {
+  const double elapsed = static_cast<double>(
+      jubatus::util::system::time::get_clock_time() - call_time);
+  jubatus::util::concurrent::scoped_lock lk(times->m);
+  times->elapsed[i] = elapsed;
+}
+
+double rpc_mclient::elapsed_(size_t i) const {
+  {
+    jubatus::util::concurrent::scoped_lock lk(times_->m);
+    if (times_->elapsed[i] >= 0) {
+      return times_->elapsed[i];
+    }
+  }
+  // joined before the callback ran
+  return static_cast<double>(
+      jubatus::util::system::time::get_clock_time() - call_time_);
+}
+
 rpc_response_t rpc_mclient::wait_one(
     const std::string& method,
     msgpack::rpc::future& f) {
@@ -81,6 +106,12 @@ std::string create_error_string(const msgpack::object& error) {
           return "no method error";
         case msgpack::rpc::ARGUMENT_ERROR:
           return "argument error";
+        case SERVER_BUSY_ERROR:
+          return "server busy";
+        case DEADLINE_EXCEEDED_ERROR:
+          return "deadline exceeded";
+        case READ_ONLY_ERROR:
+          return "read-only server";
         default:
           {
             std::string msg = "unknown remote error (";
@@ -26,9 +26,11 @@
 #include <jubatus/msgpack/rpc/client.h>
 #include <jubatus/msgpack/rpc/session_pool.h>
 
+#include "jubatus/util/concurrent/mutex.h"
 #include "jubatus/util/lang/shared_ptr.h"
 #include "jubatus/util/lang/function.h"
 #include "jubatus/util/lang/noncopyable.h"
+#include "jubatus/util/system/time_util.h"
 
 #include "rpc_error.hpp"
 #include "rpc_result.hpp"
@@ -52,7 +54,18 @@
     /* juba's rpc_call_error with error code or error message.       */ \
                                                                         \
     msgpack::object err = e.error(); \
-    if (err.type == msgpack::type::POSITIVE_INTEGER) { \
+    if (err.type == msgpack::type::POSITIVE_INTEGER && \
+        err.via.u64 == jubatus::server::common::mprpc::SERVER_BUSY_ERROR) { \
+      throw JUBATUS_EXCEPTION( \
+          jubatus::server::common::mprpc::rpc_server_busy() \
+          << jubatus::server::common::mprpc::error_method(method)); \
+    } else if (err.type == msgpack::type::POSITIVE_INTEGER && \
+        err.via.u64 == \
+        jubatus::server::common::mprpc::DEADLINE_EXCEEDED_ERROR) { \
+      throw JUBATUS_EXCEPTION( \
+          jubatus::server::common::mprpc::rpc_deadline_exceeded() \
+          << jubatus::server::common::mprpc::error_method(method)); \
+    } else if (err.type == msgpack::type::POSITIVE_INTEGER) { \
       throw JUBATUS_EXCEPTION( \
           jubatus::server::common::mprpc::rpc_call_error() \
           << jubatus::server::common::mprpc::error_method(method) \
@@ -190,12 +203,32 @@ class rpc_mclient : jubatus::util::lang::noncopyable {
   rpc_result_object wait(const std::string& method);
   rpc_response_t wait_one(const std::string& method, msgpack::rpc::future& f);
 
+  // seconds from the call until each host completed, set by the callbacks
+  // of the futures (-1 until then); the callbacks may outlive this client
+  struct completion_times {
+    explicit completion_times(size_t n)
+        : elapsed(n, -1) {
+    }
+
+    jubatus::util::concurrent::mutex m;
+    std::vector<double> elapsed;
+  };
+
+  static void completed(
+      jubatus::util::lang::shared_ptr<completion_times> times,
+      jubatus::util::system::time::clock_time call_time,
+      size_t i,
+      msgpack::rpc::future f);
+  double elapsed_(size_t i) const;
+
   host_spec_list_t hosts_;
   int timeout_sec_;
 
   msgpack::rpc::session_pool* pool_;
   bool pool_allocated_;
   std::vector<msgpack::rpc::future> futures_;
+  jubatus::util::system::time::clock_time call_time_;
+  jubatus::util::lang::shared_ptr<completion_times> times_;
 };
 
 template<typename Res, typename A0>
@@ -250,11 +283,16 @@ template<typename Args>
 void rpc_mclient::call_(const std::string& m, const Args& args) {
   futures_.clear();
   futures_.reserve(hosts_.size());
+  call_time_ = jubatus::util::system::time::get_clock_time();
+  times_.reset(new completion_times(hosts_.size()));
   for (host_spec_list_t::iterator itr = hosts_.begin(), end = hosts_.end();
       itr != end; ++itr) {
     msgpack::rpc::session s = pool_->get_session(itr->first, itr->second);
     s.set_timeout(timeout_sec_);
     futures_.push_back(s.call_apply(m, args));
+    futures_.back().attach_callback(
+        mp::bind(&rpc_mclient::completed, times_, call_time_,
+                 futures_.size() - 1, mp::placeholders::_1));
   }
 }
 
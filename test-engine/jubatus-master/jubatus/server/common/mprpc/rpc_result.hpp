@@ -49,6 +49,10 @@ struct rpc_result_object {
 
   std::vector<rpc_response_t> response;
   std::vector<rpc_error> error;
+
+  // seconds from the request until the response or error of each host
+  // arrived, in the same order as `error`
+  std::vector<double> elapsed;
 };
 
 }  // namespace mprpc
@@ -15,15 +15,44 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "rpc_server.hpp"
+#include <unistd.h>
 #include <string>
+#include <jubatus/msgpack/rpc/transport/unix.h>
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/util/system/time_util.h"
 #include "jubatus/core/common/exception.hpp"
 #include "../logger/logger.hpp"
+#include "exception.hpp"
+
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
+using jubatus::util::system::time::get_clock_time;
 
 namespace jubatus {
 namespace server {
 namespace common {
 namespace mprpc {
 
+const size_t rpc_server::MAX_INFLIGHT_PER_WORKER;
+
+namespace {
+
+const char* method_type_name(method_type type) {
+  switch (type) {
+    case UPDATE_REQUEST:
+      return "update";
+    case ANALYSIS_REQUEST:
+      return "analysis";
+    default:
+      return "default";
+  }
+}
+
+}  // namespace
+
 // rpc_server
 //   Msgpack-RPC based server with 'hashed' dispatcher.
 //   rpc_server can add RPC method on-the-fly.
@@ -38,8 +67,85 @@ void rpc_server::dispatch(msgpack::rpc::request req) {
     return;
   }
 
+  const method_type type = fun->second.type;
+  if (read_only_ && type == UPDATE_REQUEST) {
+    req.error(READ_ONLY_ERROR, "read-only server: " + method);
+    return;
+  }
+  if (!admit(type)) {
+    req.error(SERVER_BUSY_ERROR, "server busy: " + method);
+    return;
+  }
+
+  pool_map::iterator pool = pools_.find(type);
+  if (pool != pools_.end()) {
+    // hand over to the worker pool and release this I/O thread
+    if (!pool->second->post(jubatus::util::lang::bind(
+            &rpc_server::invoke_queued, this, req, fun->second,
+            static_cast<double>(get_clock_time())))) {
+      req.error(SERVER_BUSY_ERROR, "server stopping: " + method);
+      release(type);
+    }
+    return;
+  }
+
+  invoke(req, fun->second);
+  release(type);
+}
+
+void rpc_server::invoke_queued(
+    msgpack::rpc::request req,
+    const method_entry& entry,
+    double queued_at) {
+  const method_type type = entry.type;
+  if (request_deadline_ > 0 &&
+      static_cast<double>(get_clock_time()) - queued_at > request_deadline_) {
+    {
+      scoped_lock lk(admission_m_);
+      ++admission_[type].expired;
+    }
+    std::string method;
+    req.method().convert(&method);
+    req.error(DEADLINE_EXCEEDED_ERROR, "deadline exceeded: " + method);
+  } else {
+    invoke(req, entry);
+  }
+  release(type);
+}
+
+bool rpc_server::admit(method_type type) {
+  if (type == DEFAULT_REQUEST) {
+    return true;  // internal and management methods are always accepted
+  }
+  scoped_lock lk(admission_m_);
+  admission_state& state = admission_[type];
+  const size_t limit = state.effective_limit();
+  if (limit > 0 && state.inflight >= limit) {
+    ++state.rejected;
+    return false;
+  }
+  ++state.inflight;
+  return true;
+}
+
+void rpc_server::release(method_type type) {
+  if (type == DEFAULT_REQUEST) {
+    return;
+  }
+  scoped_lock lk(admission_m_);
+  --admission_[type].inflight;
+}
+
+void rpc_server::invoke(msgpack::rpc::request req, const method_entry& entry) {
   try {
-    fun->second->invoke(req);
+    if (update_log_ && entry.logged && entry.type == UPDATE_REQUEST) {
+      invoke_logged(req, entry);
+    } else if (entry.barrier) {
+      entry.barrier(jubatus::util::lang::bind(
+          &invoker_base::invoke, entry.invoker.get(), req));
+    } else {
+      entry.invoker->invoke(req);
+    }
   } catch(const msgpack::type_error& e) {
     req.error(msgpack::rpc::ARGUMENT_ERROR, std::string(e.what()));
   } catch(const jubatus::core::common::exception::jubatus_exception& e) {
@@ -53,9 +159,132 @@ void rpc_server::dispatch(msgpack::rpc::request req) {
   }
 }
 
+void rpc_server::invoke_logged(
+    msgpack::rpc::request& req,
+    const method_entry& entry) {
+  // the record must reach the log before the model is updated, and no
+  // checkpoint may be taken in between
+  update_log::scoped_update update(*update_log_);
+
+  msgpack::sbuffer buf;
+  msgpack::packer<msgpack::sbuffer> packer(buf);
+  packer.pack_array(2);
+  packer.pack(req.method());
+  packer.pack(req.params());
+  update_log_->append(buf.data(), buf.size());
+
+  entry.invoker->invoke(req);
+}
+
 void rpc_server::add_inner(const std::string& name,
-    jubatus::util::lang::shared_ptr<invoker_base> invoker) {
-  funcs_[name] = invoker;
+    jubatus::util::lang::shared_ptr<invoker_base> invoker,
+    method_type type) {
+  method_entry& entry = funcs_[name];
+  entry.invoker = invoker;
+  entry.type = type;
+  entry.logged = true;
+}
+
+void rpc_server::set_update_log(update_log* log) {
+  update_log_ = log;
+}
+
+void rpc_server::set_unlogged(const std::string& name) {
+  func_map::iterator it = funcs_.find(name);
+  if (it != funcs_.end()) {
+    it->second.logged = false;
+  }
+}
+
+void rpc_server::set_barrier(
+    const std::string& name,
+    const barrier_type& barrier) {
+  func_map::iterator it = funcs_.find(name);
+  if (it != funcs_.end()) {
+    it->second.barrier = barrier;
+  }
+}
+
+void rpc_server::replay(
+    const std::string& name,
+    const msgpack::object& params) {
+  func_map::iterator it = funcs_.find(name);
+  if (it == funcs_.end()) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "unknown method in update log: " + name));
+  }
+  it->second.invoker->call(params);
+}
+
+void rpc_server::set_worker_pool(method_type type, int nthreads) {
+  if (type == DEFAULT_REQUEST || nthreads <= 0) {
+    pools_.erase(type);
+    scoped_lock lk(admission_m_);
+    admission_map::iterator it = admission_.find(type);
+    if (it != admission_.end()) {
+      it->second.pool_limit = 0;
+    }
+    return;
+  }
+  pools_[type] = shared_ptr<rpc_worker_pool>(new rpc_worker_pool(nthreads));
+
+  // requests of the type are bounded even without set_inflight_limit(), so
+  // that the queue of the pool cannot grow without limit
+  scoped_lock lk(admission_m_);
+  admission_[type].pool_limit =
+      MAX_INFLIGHT_PER_WORKER * static_cast<size_t>(nthreads);
+}
+
+void rpc_server::set_inflight_limit(method_type type, size_t limit) {
+  scoped_lock lk(admission_m_);
+  admission_[type].limit = limit;
+}
+
+void rpc_server::set_request_deadline(double sec) {
+  request_deadline_ = sec;
+}
+
+void rpc_server::set_read_only(bool read_only) {
+  read_only_ = read_only;
+}
+
+void rpc_server::get_status(status_t& status) const {
+  for (pool_map::const_iterator it = pools_.begin();
+       it != pools_.end(); ++it) {
+    const std::string prefix =
+        std::string("rpc_pool.") + method_type_name(it->first);
+    status[prefix + ".threads"] = lexical_cast<std::string>(it->second->size());
+    status[prefix + ".queue_depth"] =
+        lexical_cast<std::string>(it->second->queue_depth());
+    status[prefix + ".max_queue_depth"] =
+        lexical_cast<std::string>(it->second->max_queue_depth());
+    status[prefix + ".processed"] =
+        lexical_cast<std::string>(it->second->processed());
+  }
+
+  scoped_lock lk(admission_m_);
+  for (admission_map::const_iterator it = admission_.begin();
+       it != admission_.end(); ++it) {
+    const std::string prefix =
+        std::string("rpc_admission.") + method_type_name(it->first);
+    status[prefix + ".limit"] =
+        lexical_cast<std::string>(it->second.effective_limit());
+    status[prefix + ".inflight"] =
+        lexical_cast<std::string>(it->second.inflight);
+    status[prefix + ".rejected"] =
+        lexical_cast<std::string>(it->second.rejected);
+    status[prefix + ".expired"] =
+        lexical_cast<std::string>(it->second.expired);
+  }
+  status["rpc_admission.request_deadline"] =
+      lexical_cast<std::string>(request_deadline_);
+  status["rpc_admission.read_only"] = lexical_cast<std::string>(read_only_);
+}
+
+void rpc_server::stop_worker_pools() {
+  for (pool_map::iterator it = pools_.begin(); it != pools_.end(); ++it) {
+    it->second->stop();
+  }
 }
 
 void rpc_server::listen(uint16_t port) {
@@ -66,7 +295,17 @@ void rpc_server::listen(uint16_t port, const std::string& bind_address) {
   instance_.listen(bind_address, port);
 }
 
+void rpc_server::listen_unix(const std::string& path) {
+  // a socket left by a previous process would make the bind fail
+  ::unlink(path.c_str());
+  instance_.listen(msgpack::rpc::unix_listener(path));
+  unix_path_ = path;
+}
+
 void rpc_server::start(int nthreads, bool no_hang) {
+  for (pool_map::iterator it = pools_.begin(); it != pools_.end(); ++it) {
+    it->second->start();
+  }
   if (no_hang) {
     instance_.start(nthreads);
   } else {
@@ -76,6 +315,7 @@ void rpc_server::start(int nthreads, bool no_hang) {
 
 void rpc_server::join() {
   instance_.join();
+  stop_worker_pools();
 }
 
 void rpc_server::end() {
@@ -87,11 +327,16 @@ void rpc_server::stop() {
     instance_.end();
     instance_.join();
   }
+  stop_worker_pools();
 }
 
 void rpc_server::close() {
   stop();
   instance_.close();
+  if (!unix_path_.empty()) {
+    ::unlink(unix_path_.c_str());
+    unix_path_.clear();
+  }
 }
 
 }  // namespace mprpc
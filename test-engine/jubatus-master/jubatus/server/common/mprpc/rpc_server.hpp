@@ -17,11 +17,16 @@
 #ifndef JUBATUS_SERVER_COMMON_MPRPC_RPC_SERVER_HPP_
 #define JUBATUS_SERVER_COMMON_MPRPC_RPC_SERVER_HPP_
 
+#include <stdint.h>
 #include <map>
 #include <string>
 #include <jubatus/msgpack/rpc/server.h>
+#include "jubatus/util/concurrent/mutex.h"
 #include "jubatus/util/lang/shared_ptr.h"
 #include "jubatus/util/lang/function.h"
+#include "jubatus/core/common/exception.hpp"
+#include "../update_log.hpp"
+#include "rpc_worker_pool.hpp"
 
 namespace jubatus {
 namespace server {
@@ -38,6 +43,13 @@ class invoker_base {
   virtual ~invoker_base() {
   }
   virtual void invoke(request_type& req) = 0;
+
+  // calls the method with `params` and discards the result; used to replay
+  // logged requests
+  virtual void call(const msgpack::object& params) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "this method cannot be called without a request"));
+  }
 };
 
 // async var-arg method type
@@ -47,20 +59,40 @@ struct async_vmethod {
     type;
 };
 
+// method_type
+//   Class of an RPC method. Methods of a class which has its own worker
+//   pool (see rpc_server::set_worker_pool) run on that pool; others run on
+//   the msgpack-rpc threads directly.
+enum method_type {
+  DEFAULT_REQUEST,
+  UPDATE_REQUEST,
+  ANALYSIS_REQUEST
+};
+
 // rpc_server
 //   Msgpack-RPC based server with 'hashed' dispatcher.
 //   rpc_server can add RPC method on-the-fly.
 //
 class rpc_server : public msgpack::rpc::dispatcher {
  public:
+  typedef std::map<std::string, std::string> status_t;
+  typedef jubatus::util::lang::function<
+      void(const jubatus::util::lang::function<void()>&)> barrier_type;
+
   explicit rpc_server(msgpack::rpc::loop lo = msgpack::rpc::loop())
-      : instance_(lo) {
+      : instance_(lo),
+        request_deadline_(0),
+        read_only_(false),
+        update_log_(NULL) {
     instance_.serve(this);
   }
   explicit rpc_server(
       double server_timeout,
       msgpack::rpc::loop lo = msgpack::rpc::loop())
-      : instance_(lo) {
+      : instance_(lo),
+        request_deadline_(0),
+        read_only_(false),
+        update_log_(NULL) {
     instance_.set_server_timeout(server_timeout);
     instance_.serve(this);
   }
@@ -72,7 +104,8 @@ class rpc_server : public msgpack::rpc::dispatcher {
   // synchronous method registration
   template<typename T> void add(
       const std::string& name,
-      const jubatus::util::lang::function<T>& f);
+      const jubatus::util::lang::function<T>& f,
+      method_type type = DEFAULT_REQUEST);
 
   // *asynchronous* *var-arg* method registration
   //   where var-arg method means a method receive its arguments
@@ -82,8 +115,42 @@ class rpc_server : public msgpack::rpc::dispatcher {
       const std::string& name,
       const typename async_vmethod<Tuple>::type& f);
 
+  // run methods of `type` on a dedicated pool of `nthreads` threads;
+  // must be called before start()
+  void set_worker_pool(method_type type, int nthreads);
+
+  // reject requests of `type` with SERVER_BUSY_ERROR while `limit` requests
+  // of the type are queued or running (0: unlimited, or
+  // MAX_INFLIGHT_PER_WORKER per thread if the type has a worker pool, so
+  // that the queue of the pool is bounded)
+  void set_inflight_limit(method_type type, size_t limit);
+
+  static const size_t MAX_INFLIGHT_PER_WORKER = 1024;
+
+  // drop requests which waited in a worker pool queue longer than `sec`
+  // with DEADLINE_EXCEEDED_ERROR (0: disabled)
+  void set_request_deadline(double sec);
+
+  // reject update requests with READ_ONLY_ERROR
+  void set_read_only(bool read_only);
+
+  // append update requests to `log` before running them (NULL: disabled)
+  void set_update_log(update_log* log);
+  // do not log requests of update method `name`
+  void set_unlogged(const std::string& name);
+  // runs method `name` with `params` logged before; the result is discarded
+  void replay(const std::string& name, const msgpack::object& params);
+  // runs method `name` through `barrier`, which is given the invocation of
+  // the method (e.g. to take a checkpoint right after a load)
+  void set_barrier(const std::string& name, const barrier_type& barrier);
+
+  void get_status(status_t& status) const;
+
   void listen(uint16_t port);
   void listen(uint16_t port, const std::string& bind_address);
+  // also accepts requests on a UNIX domain socket at `path`, which is
+  // replaced if it exists and removed by close()
+  void listen_unix(const std::string& path);
   void start(int nthreads, bool no_hang = false);
   void join();
   void end();
@@ -93,14 +160,60 @@ class rpc_server : public msgpack::rpc::dispatcher {
   msgpack::rpc::server instance_;
 
  private:
-  typedef std::map<std::string, jubatus::util::lang::shared_ptr<invoker_base> >
-    func_map;
+  struct method_entry {
+    jubatus::util::lang::shared_ptr<invoker_base> invoker;
+    method_type type;
+    bool logged;
+    barrier_type barrier;
+  };
+  typedef std::map<std::string, method_entry> func_map;
+  typedef std::map<method_type,
+      jubatus::util::lang::shared_ptr<rpc_worker_pool> > pool_map;
+
+  struct admission_state {
+    admission_state()
+        : limit(0),
+          pool_limit(0),
+          inflight(0),
+          rejected(0),
+          expired(0) {
+    }
+    size_t effective_limit() const {
+      return limit > 0 ? limit : pool_limit;
+    }
+    size_t limit;
+    // default limit bounding the worker pool queue
+    size_t pool_limit;
+    size_t inflight;
+    uint64_t rejected;
+    uint64_t expired;
+  };
+  typedef std::map<method_type, admission_state> admission_map;
+
+  bool admit(method_type type);
+  void release(method_type type);
+  void invoke_queued(
+      msgpack::rpc::request req,
+      const method_entry& entry,
+      double queued_at);
 
   void add_inner(
       const std::string& name,
-      jubatus::util::lang::shared_ptr<invoker_base> invoker);
+      jubatus::util::lang::shared_ptr<invoker_base> invoker,
+      method_type type = DEFAULT_REQUEST);
+  void invoke(msgpack::rpc::request req, const method_entry& entry);
+  void invoke_logged(msgpack::rpc::request& req, const method_entry& entry);
+  void stop_worker_pools();
 
   func_map funcs_;
+  pool_map pools_;
+
+  mutable jubatus::util::concurrent::mutex admission_m_;
+  admission_map admission_;
+  double request_deadline_;
+  std::string unix_path_;
+  bool read_only_;
+  update_log* update_log_;
 };
 
 //
@@ -118,6 +231,9 @@ class invoker0 : public invoker_base {
     R retval = f_();
     req.result<R>(retval);
   }
+  virtual void call(const msgpack::object& params) {
+    (void)f_();
+  }
 
  private:
   func_type f_;
@@ -143,6 +259,11 @@ class invoker1 : public invoker_base {
     R retval = f_(params.template get<0>());
     req.result<R> (retval);
   }
+  virtual void call(const msgpack::object& obj) {
+    msgpack::type::tuple<A1> params;
+    obj.convert(&params);
+    (void)f_(params.template get<0>());
+  }
 
  private:
   func_type f_;
@@ -168,6 +289,11 @@ class invoker2 : public invoker_base {
     R retval = f_(params.template get<0>(), params.template get<1>());
     req.result<R>(retval);
   }
+  virtual void call(const msgpack::object& obj) {
+    msgpack::type::tuple<A1, A2> params;
+    obj.convert(&params);
+    (void)f_(params.template get<0>(), params.template get<1>());
+  }
 
  private:
   func_type f_;
@@ -197,6 +323,14 @@ class invoker3 : public invoker_base {
         params.template get<2>());
     req.result<R>(retval);
   }
+  virtual void call(const msgpack::object& obj) {
+    msgpack::type::tuple<A1, A2, A3> params;
+    obj.convert(&params);
+    (void)f_(
+        params.template get<0>(),
+        params.template get<1>(),
+        params.template get<2>());
+  }
 
  private:
   func_type f_;
@@ -227,6 +361,15 @@ class invoker4 : public invoker_base {
         params.template get<3>());
     req.result<R>(retval);
   }
+  virtual void call(const msgpack::object& obj) {
+    msgpack::type::tuple<A1, A2, A3, A4> params;
+    obj.convert(&params);
+    (void)f_(
+        params.template get<0>(),
+        params.template get<1>(),
+        params.template get<2>(),
+        params.template get<3>());
+  }
 
  private:
   func_type f_;
@@ -277,8 +420,9 @@ jubatus::util::lang::shared_ptr<invoker_base> make_async_vmethod_invoker(
 template<typename T>
 void rpc_server::add(
     const std::string& name,
-    const jubatus::util::lang::function<T>& f) {
-  add_inner(name, make_invoker(f));
+    const jubatus::util::lang::function<T>& f,
+    method_type type) {
+  add_inner(name, make_invoker(f), type);
 }
 
 template<typename Tuple>
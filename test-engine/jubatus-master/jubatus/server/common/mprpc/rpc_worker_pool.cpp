@@ -0,0 +1,124 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "rpc_worker_pool.hpp"
+
+#include <algorithm>
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/bind.h"
+#include "../logger/logger.hpp"
+#include "../unique_lock.hpp"
+
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::concurrent::thread;
+using jubatus::util::lang::shared_ptr;
+
+namespace jubatus {
+namespace server {
+namespace common {
+namespace mprpc {
+
+rpc_worker_pool::rpc_worker_pool(size_t nthreads)
+    : nthreads_(std::max(nthreads, static_cast<size_t>(1))),
+      max_queue_depth_(0),
+      processed_(0),
+      stopped_(false) {
+}
+
+rpc_worker_pool::~rpc_worker_pool() {
+  stop();
+}
+
+void rpc_worker_pool::start() {
+  for (size_t i = 0; i < nthreads_; ++i) {
+    shared_ptr<thread> t(new thread(
+        jubatus::util::lang::bind(&rpc_worker_pool::run, this)));
+    if (!t->start()) {
+      LOG(ERROR) << "failed to start RPC worker thread";
+      continue;
+    }
+    threads_.push_back(t);
+  }
+}
+
+bool rpc_worker_pool::post(const task_type& task) {
+  scoped_lock lk(m_);
+  if (stopped_) {
+    return false;
+  }
+  queue_.push_back(task);
+  max_queue_depth_ = std::max(max_queue_depth_, queue_.size());
+  c_.notify();
+  return true;
+}
+
+void rpc_worker_pool::stop() {
+  {
+    scoped_lock lk(m_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+    c_.notify_all();
+  }
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->join();
+  }
+  threads_.clear();
+}
+
+size_t rpc_worker_pool::queue_depth() const {
+  scoped_lock lk(m_);
+  return queue_.size();
+}
+
+size_t rpc_worker_pool::max_queue_depth() const {
+  scoped_lock lk(m_);
+  return max_queue_depth_;
+}
+
+uint64_t rpc_worker_pool::processed() const {
+  scoped_lock lk(m_);
+  return processed_;
+}
+
+void rpc_worker_pool::run() {
+  while (true) {
+    task_type task;
+    {
+      unique_lock lk(m_);
+      while (queue_.empty() && !stopped_) {
+        c_.wait(m_);
+      }
+      if (queue_.empty()) {
+        return;  // stopped and drained
+      }
+      task = queue_.front();
+      queue_.pop_front();
+    }
+
+    // tasks are responsible for handling their own errors
+    task();
+
+    scoped_lock lk(m_);
+    ++processed_;
+  }
+}
+
+}  // namespace mprpc
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
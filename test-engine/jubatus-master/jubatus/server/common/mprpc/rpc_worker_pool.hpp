@@ -0,0 +1,82 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_SERVER_COMMON_MPRPC_RPC_WORKER_POOL_HPP_
+#define JUBATUS_SERVER_COMMON_MPRPC_RPC_WORKER_POOL_HPP_
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include "jubatus/util/concurrent/condition.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/concurrent/thread.h"
+#include "jubatus/util/lang/function.h"
+#include "jubatus/util/lang/noncopyable.h"
+#include "jubatus/util/lang/shared_ptr.h"
+
+namespace jubatus {
+namespace server {
+namespace common {
+namespace mprpc {
+
+// rpc_worker_pool
+//   Fixed number of threads consuming a FIFO queue of tasks.
+//   rpc_server uses this to run a class of RPC methods apart from the
+//   msgpack-rpc I/O threads.
+class rpc_worker_pool : jubatus::util::lang::noncopyable {
+ public:
+  typedef jubatus::util::lang::function<void()> task_type;
+
+  explicit rpc_worker_pool(size_t nthreads);
+  ~rpc_worker_pool();
+
+  void start();
+
+  // returns false and discards the task if stop() has been called; the
+  // caller must then reply to the request the task would have served
+  bool post(const task_type& task);
+
+  // waits until queued tasks are processed and all threads exit
+  void stop();
+
+  size_t size() const {
+    return nthreads_;
+  }
+  size_t queue_depth() const;
+  size_t max_queue_depth() const;
+  uint64_t processed() const;
+
+ private:
+  void run();
+
+  const size_t nthreads_;
+  std::vector<jubatus::util::lang::shared_ptr<
+      jubatus::util::concurrent::thread> > threads_;
+
+  mutable jubatus::util::concurrent::mutex m_;
+  jubatus::util::concurrent::condition c_;
+  std::deque<task_type> queue_;
+  size_t max_queue_depth_;
+  uint64_t processed_;
+  bool stopped_;
+};
+
+}  // namespace mprpc
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_COMMON_MPRPC_RPC_WORKER_POOL_HPP_
@@ -0,0 +1,75 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <gtest/gtest.h>
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/bind.h"
+
+#include "rpc_worker_pool.hpp"
+
+using jubatus::util::concurrent::mutex;
+using jubatus::util::concurrent::scoped_lock;
+
+namespace jubatus {
+namespace server {
+namespace common {
+namespace mprpc {
+
+namespace {
+
+void count_up(mutex* m, int* counter) {
+  scoped_lock lk(*m);
+  ++*counter;
+}
+
+}  // namespace
+
+TEST(rpc_worker_pool, process_all_tasks) {
+  mutex m;
+  int counter = 0;
+
+  rpc_worker_pool pool(4);
+  EXPECT_EQ(4u, pool.size());
+  pool.start();
+  for (int i = 0; i < 1000; ++i) {
+    pool.post(jubatus::util::lang::bind(&count_up, &m, &counter));
+  }
+  pool.stop();
+
+  EXPECT_EQ(1000, counter);
+  EXPECT_EQ(1000u, pool.processed());
+  EXPECT_EQ(0u, pool.queue_depth());
+  EXPECT_LE(1u, pool.max_queue_depth());
+}
+
+TEST(rpc_worker_pool, post_after_stop) {
+  mutex m;
+  int counter = 0;
+
+  rpc_worker_pool pool(1);
+  pool.start();
+  pool.stop();
+  EXPECT_FALSE(pool.post(jubatus::util::lang::bind(&count_up, &m, &counter)));
+
+  EXPECT_EQ(0, counter);
+  EXPECT_EQ(0u, pool.queue_depth());
+}
+
+}  // namespace mprpc
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
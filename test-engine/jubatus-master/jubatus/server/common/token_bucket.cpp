@@ -0,0 +1,106 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "token_bucket.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/system/time_util.h"
+
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::system::time::clock_time;
+using jubatus::util::system::time::get_clock_time;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+namespace {
+
+double now_sec() {
+  const clock_time now = get_clock_time();
+  return now.sec + now.usec / 1000000.0;
+}
+
+// usleep takes less than a second on some platforms
+void sleep_sec(double sec) {
+  while (sec > 0) {
+    const double s = std::min(sec, 1.0);
+    ::usleep(static_cast<useconds_t>(s * 1000000));
+    sec -= s;
+  }
+}
+
+}  // namespace
+
+token_bucket::token_bucket(uint64_t rate, uint64_t burst)
+    : rate_(rate),
+      burst_(burst > 0 ? burst : rate),
+      tokens_(burst_),
+      last_(-1),
+      total_bytes_(0),
+      total_wait_(0) {
+}
+
+double token_bucket::consume(size_t bytes) {
+  if (!is_limited()) {
+    scoped_lock lk(m_);
+    total_bytes_ += bytes;
+    return 0;
+  }
+
+  const double wait = reserve(bytes, now_sec());
+  if (wait > 0) {
+    // sleep outside the lock; later senders queue behind our debt
+    sleep_sec(wait);
+  }
+  return wait;
+}
+
+double token_bucket::reserve(size_t bytes, double now) {
+  scoped_lock lk(m_);
+  total_bytes_ += bytes;
+  if (!is_limited()) {
+    return 0;
+  }
+
+  if (last_ >= 0 && now > last_) {
+    tokens_ = std::min(burst_, tokens_ + (now - last_) * rate_);
+  }
+  last_ = std::max(last_, now);
+
+  tokens_ -= bytes;
+  const double wait = tokens_ < 0 ? -tokens_ / rate_ : 0;
+  total_wait_ += wait;
+  return wait;
+}
+
+uint64_t token_bucket::total_bytes() const {
+  scoped_lock lk(m_);
+  return total_bytes_;
+}
+
+double token_bucket::total_wait() const {
+  scoped_lock lk(m_);
+  return total_wait_;
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
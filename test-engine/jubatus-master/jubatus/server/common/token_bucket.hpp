@@ -0,0 +1,75 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_COMMON_TOKEN_BUCKET_HPP_
+#define JUBATUS_SERVER_COMMON_TOKEN_BUCKET_HPP_
+
+#include <stdint.h>
+#include <cstddef>
+#include "jubatus/util/concurrent/mutex.h"
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+// token_bucket
+//   Limits the rate of bytes transferred for MIX and model transfers.
+//   Tokens (bytes) are added at `rate` bytes/sec and up to `burst` bytes are
+//   kept.  A sender that takes more tokens than available goes into debt
+//   and waits until the debt is paid, so concurrent senders are served in
+//   order and a transfer larger than the burst is still allowed.
+//   `rate` 0 means unlimited.  This class is thread safe.
+class token_bucket {
+ public:
+  // `burst` 0 means the bytes of one second
+  explicit token_bucket(uint64_t rate, uint64_t burst = 0);
+
+  bool is_limited() const {
+    return rate_ > 0;
+  }
+
+  uint64_t rate() const {
+    return rate_;
+  }
+
+  // takes `bytes` tokens, blocking until they are available;
+  // returns seconds waited
+  double consume(size_t bytes);
+
+  // takes `bytes` tokens at `now` (seconds) and returns seconds to wait
+  double reserve(size_t bytes, double now);
+
+  uint64_t total_bytes() const;
+  double total_wait() const;
+
+ private:
+  const uint64_t rate_;
+  const double burst_;
+
+  mutable jubatus::util::concurrent::mutex m_;
+  // negative when in debt
+  double tokens_;
+  double last_;
+  uint64_t total_bytes_;
+  double total_wait_;
+};
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_COMMON_TOKEN_BUCKET_HPP_
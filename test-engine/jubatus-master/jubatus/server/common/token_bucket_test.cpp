@@ -0,0 +1,74 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <gtest/gtest.h>
+#include "token_bucket.hpp"
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+TEST(token_bucket, unlimited) {
+  token_bucket b(0);
+  EXPECT_FALSE(b.is_limited());
+  EXPECT_EQ(0, b.reserve(1000000, 0));
+  EXPECT_EQ(0, b.consume(1000000));
+  EXPECT_EQ(2000000u, b.total_bytes());
+}
+
+TEST(token_bucket, burst) {
+  token_bucket b(1000, 2000);
+  EXPECT_TRUE(b.is_limited());
+  EXPECT_EQ(0, b.reserve(1500, 10));
+  EXPECT_EQ(0, b.reserve(500, 10));
+
+  // in debt of 500 bytes
+  EXPECT_DOUBLE_EQ(0.5, b.reserve(500, 10));
+  // the next sender waits for the previous debt as well
+  EXPECT_DOUBLE_EQ(1.0, b.reserve(500, 10));
+  EXPECT_DOUBLE_EQ(1.5, b.total_wait());
+}
+
+TEST(token_bucket, refill) {
+  token_bucket b(1000);
+  EXPECT_EQ(0, b.reserve(1000, 10));
+  // 0.5 sec gives 500 bytes
+  EXPECT_DOUBLE_EQ(0.5, b.reserve(1000, 10.5));
+
+  // tokens never exceed the burst (1000 bytes by default)
+  EXPECT_EQ(0, b.reserve(0, 100));
+  EXPECT_DOUBLE_EQ(1.0, b.reserve(2000, 100));
+}
+
+TEST(token_bucket, large_transfer) {
+  // a transfer larger than the burst is allowed after waiting
+  token_bucket b(1000, 100);
+  EXPECT_DOUBLE_EQ(9.9, b.reserve(10000, 0));
+}
+
+TEST(token_bucket, consume_over_a_second) {
+  token_bucket b(1000, 100);
+  const double wait = b.consume(1300);
+  EXPECT_NEAR(1.2, wait, 0.05);
+  EXPECT_NEAR(1.2, b.total_wait(), 0.05);
+  // the debt has been paid while sleeping
+  EXPECT_GT(0.1, b.consume(0));
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
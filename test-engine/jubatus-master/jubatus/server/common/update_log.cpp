@@ -0,0 +1,332 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "update_log.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/core/common/exception.hpp"
+#include "crc32.hpp"
+#include "filesystem.hpp"
+#include "logger/logger.hpp"
+
+using std::string;
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+namespace {
+
+const size_t HEADER_SIZE = 8;
+
+// a larger size means a corrupted header
+const uint32_t MAX_RECORD_SIZE = 1U << 30;
+
+void encode_u32(uint32_t v, char* p) {
+  for (int i = 0; i < 4; ++i) {
+    p[i] = static_cast<char>((v >> (8 * i)) & 0xff);
+  }
+}
+
+uint32_t decode_u32(const char* p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) {
+    v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+  }
+  return v;
+}
+
+// returns the number of records and sets the bytes they take to `valid`
+uint64_t read_records(
+    const string& path,
+    const update_log::record_handler& f,
+    uint64_t& valid) {
+  valid = 0;
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    if (errno == ENOENT) {
+      return 0;
+    }
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot open update log")
+        << core::common::exception::error_file_name(path)
+        << core::common::exception::error_errno(errno));
+  }
+
+  uint64_t count = 0;
+  std::vector<char> payload;
+  char header[HEADER_SIZE];
+  while (fread(header, 1, HEADER_SIZE, fp) == HEADER_SIZE) {
+    const uint32_t size = decode_u32(header);
+    if (size > MAX_RECORD_SIZE) {
+      break;
+    }
+    payload.resize(size);
+    if (size > 0 && fread(&payload[0], 1, size, fp) != size) {
+      break;
+    }
+    const char* data = size > 0 ? &payload[0] : NULL;
+    if (calc_crc32(data, size) != decode_u32(header + 4)) {
+      break;
+    }
+    if (f) {
+      f(data, size);
+    }
+    valid += HEADER_SIZE + size;
+    ++count;
+  }
+  fclose(fp);
+  return count;
+}
+
+void write_all(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("cannot write update log")
+          << core::common::exception::error_errno(errno));
+    }
+    data += n;
+    size -= n;
+  }
+}
+
+int sync_fd(int fd) {
+#ifdef __APPLE__
+  return ::fsync(fd);
+#else
+  return ::fdatasync(fd);
+#endif
+}
+
+int open_log(const string& path, int flags) {
+  const int fd = ::open(
+      path.c_str(), O_WRONLY | O_CREAT | O_APPEND | flags, 0644);
+  if (fd < 0) {
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot open update log")
+        << core::common::exception::error_file_name(path)
+        << core::common::exception::error_errno(errno));
+  }
+  return fd;
+}
+
+}  // namespace
+
+update_log::update_log(const string& path)
+    : path_(path),
+      fd_(-1),
+      size_(0),
+      written_(0),
+      synced_(0),
+      syncing_(false),
+      running_updates_(0),
+      checkpointing_(false),
+      syncs_(0),
+      checkpoints_(0) {
+  const uint64_t records = read_records(path_, record_handler(), size_);
+
+  fd_ = open_log(path_, 0);
+  if (!sync_parent_dir(path_)) {
+    LOG(WARNING) << "cannot sync the directory of update log " << path_;
+  }
+
+  struct stat st;
+  if (::fstat(fd_, &st) == 0 && static_cast<uint64_t>(st.st_size) > size_) {
+    LOG(WARNING) << "cutting off a torn record at the tail of update log "
+                 << path_ << " (" << (st.st_size - size_) << " bytes)";
+    if (::ftruncate(fd_, size_) != 0) {
+      const int err = errno;
+      ::close(fd_);
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("cannot truncate update log")
+          << core::common::exception::error_file_name(path_)
+          << core::common::exception::error_errno(err));
+    }
+  }
+  LOG(INFO) << "opened update log " << path_ << " with " << records
+            << " records";
+}
+
+update_log::~update_log() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+void update_log::append(const char* data, size_t size) {
+  char header[HEADER_SIZE];
+  encode_u32(size, header);
+  encode_u32(calc_crc32(data, size), header + 4);
+
+  uint64_t seq;
+  {
+    scoped_lock lk(m_);
+    try {
+      write_all(fd_, header, HEADER_SIZE);
+      write_all(fd_, data, size);
+    } catch (...) {
+      // do not leave a torn record followed by valid ones
+      if (::ftruncate(fd_, size_) != 0) {
+        LOG(ERROR) << "cannot truncate update log " << path_;
+      }
+      throw;
+    }
+    size_ += HEADER_SIZE + size;
+    seq = ++written_;
+  }
+  sync(seq);
+}
+
+void update_log::sync(uint64_t seq) {
+  scoped_lock lk(m_);
+  while (synced_ < seq) {
+    if (syncing_) {
+      // another appender is syncing; it may cover this record
+      c_.wait(m_);
+      continue;
+    }
+
+    syncing_ = true;
+    const uint64_t target = written_;
+    m_.unlock();
+    const int r = sync_fd(fd_);
+    const int err = errno;
+    m_.lock();
+    syncing_ = false;
+    c_.notify_all();
+    if (r != 0) {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("cannot sync update log")
+          << core::common::exception::error_file_name(path_)
+          << core::common::exception::error_errno(err));
+    }
+    synced_ = target;
+    ++syncs_;
+  }
+}
+
+void update_log::begin_update() {
+  scoped_lock lk(m_);
+  while (checkpointing_) {
+    c_.wait(m_);
+  }
+  ++running_updates_;
+}
+
+void update_log::end_update() {
+  scoped_lock lk(m_);
+  if (--running_updates_ == 0 && checkpointing_) {
+    c_.notify_all();
+  }
+}
+
+void update_log::begin_checkpoint() {
+  scoped_lock lk(m_);
+  while (checkpointing_) {
+    c_.wait(m_);
+  }
+  checkpointing_ = true;
+  while (running_updates_ > 0) {
+    c_.wait(m_);
+  }
+}
+
+void update_log::rotate(const string& path) {
+  const int fd = open_log(path, O_TRUNC);
+  if (!sync_parent_dir(path)) {
+    LOG(WARNING) << "cannot sync the directory of update log " << path;
+  }
+
+  scoped_lock lk(m_);
+  while (syncing_) {
+    c_.wait(m_);
+  }
+  if (synced_ < written_) {
+    // records appended outside of updates may not be synced yet
+    if (sync_fd(fd_) != 0) {
+      const int err = errno;
+      ::close(fd);
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("cannot sync update log")
+          << core::common::exception::error_file_name(path_)
+          << core::common::exception::error_errno(err));
+    }
+    synced_ = written_;
+    ++syncs_;
+  }
+  ::close(fd_);
+  fd_ = fd;
+  path_ = path;
+  size_ = 0;
+}
+
+void update_log::end_checkpoint() {
+  scoped_lock lk(m_);
+  checkpointing_ = false;
+  ++checkpoints_;
+  c_.notify_all();
+}
+
+string update_log::path() const {
+  scoped_lock lk(m_);
+  return path_;
+}
+
+uint64_t update_log::size() const {
+  scoped_lock lk(m_);
+  return size_;
+}
+
+uint64_t update_log::read(const string& path, const record_handler& f) {
+  uint64_t valid;
+  return read_records(path, f, valid);
+}
+
+void update_log::get_status(
+    const string& prefix,
+    std::map<string, string>& status) const {
+  scoped_lock lk(m_);
+  const string p = prefix + ".";
+  status[p + "path"] = path_;
+  status[p + "size"] = lexical_cast<string>(size_);
+  status[p + "appended"] = lexical_cast<string>(written_);
+  status[p + "syncs"] = lexical_cast<string>(syncs_);
+  status[p + "checkpoints"] = lexical_cast<string>(checkpoints_);
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
@@ -0,0 +1,122 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_COMMON_UPDATE_LOG_HPP_
+#define JUBATUS_SERVER_COMMON_UPDATE_LOG_HPP_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "jubatus/util/concurrent/condition.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/function.h"
+#include "jubatus/util/lang/noncopyable.h"
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+// update_log
+//   Append-only log of update requests, written before they are applied
+//   to the model so that they can be replayed after a crash.
+//
+//   A record is [size (4 bytes)][CRC32 of payload (4 bytes)][payload].
+//   Appends are group-committed: one appender syncs the records written
+//   by all appenders so far while others wait for it.
+//
+//   Updates (from append to applying to the model) and checkpoints exclude
+//   each other; a checkpoint waits for running updates, and new updates
+//   wait for the checkpoint, so the log rotated at a checkpoint has exactly
+//   the records applied after it.
+class update_log : jubatus::util::lang::noncopyable {
+ public:
+  typedef jubatus::util::lang::function<void(const char*, size_t)>
+      record_handler;
+
+  // opens `path` for appending; a torn record at the tail left by a crash
+  // is cut off
+  explicit update_log(const std::string& path);
+  ~update_log();
+
+  // blocks until the record is on the disk
+  void append(const char* data, size_t size);
+
+  void begin_update();
+  void end_update();
+
+  void begin_checkpoint();
+  // continues in a new empty log at `path`; records before it are left in
+  // the old file. Call between begin/end_checkpoint.
+  void rotate(const std::string& path);
+  void end_checkpoint();
+
+  // update_log::scoped_update
+  //   begin_update() and end_update() for a scope
+  class scoped_update : jubatus::util::lang::noncopyable {
+   public:
+    explicit scoped_update(update_log& log)
+        : log_(log) {
+      log_.begin_update();
+    }
+    ~scoped_update() {
+      log_.end_update();
+    }
+
+   private:
+    update_log& log_;
+  };
+
+  // calls `f` with each record of the log at `path` in order and returns
+  // the number of records; reading stops at a torn record
+  static uint64_t read(const std::string& path, const record_handler& f);
+
+  std::string path() const;
+  // bytes of the records in the current log file
+  uint64_t size() const;
+
+  void get_status(
+      const std::string& prefix,
+      std::map<std::string, std::string>& status) const;
+
+ private:
+  void sync(uint64_t seq);
+
+  std::string path_;
+  int fd_;
+  uint64_t size_;
+
+  // sequence numbers of the last record written and synced
+  uint64_t written_;
+  uint64_t synced_;
+  bool syncing_;
+
+  size_t running_updates_;
+  bool checkpointing_;
+
+  uint64_t syncs_;
+  uint64_t checkpoints_;
+
+  mutable jubatus::util::concurrent::mutex m_;
+  jubatus::util::concurrent::condition c_;
+};
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_COMMON_UPDATE_LOG_HPP_
@@ -0,0 +1,161 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "jubatus/util/lang/bind.h"
+#include "update_log.hpp"
+
+using std::string;
+using std::vector;
+
+namespace jubatus {
+namespace server {
+namespace common {
+
+namespace {
+
+void collect(vector<string>* records, const char* data, size_t size) {
+  records->push_back(string(data, size));
+}
+
+class update_log_test : public ::testing::Test {
+ protected:
+  update_log_test() {
+    char path[] = "/tmp/jubatus_update_log_test_XXXXXX";
+    const int fd = ::mkstemp(path);
+    ::close(fd);
+    path_ = path;
+  }
+
+  ~update_log_test() {
+    ::unlink(path_.c_str());
+  }
+
+  vector<string> read_all() const {
+    vector<string> records;
+    update_log::read(path_, jubatus::util::lang::bind(
+        &collect, &records, jubatus::util::lang::_1,
+        jubatus::util::lang::_2));
+    return records;
+  }
+
+  string path_;
+};
+
+}  // namespace
+
+TEST_F(update_log_test, append_and_read) {
+  {
+    update_log log(path_);
+    log.append("first", 5);
+    log.append("", 0);
+    log.append("third", 5);
+  }
+  vector<string> records = read_all();
+  ASSERT_EQ(3u, records.size());
+  EXPECT_EQ("first", records[0]);
+  EXPECT_EQ("", records[1]);
+  EXPECT_EQ("third", records[2]);
+
+  // appends after reopening
+  {
+    update_log log(path_);
+    log.append("fourth", 6);
+  }
+  EXPECT_EQ(4u, read_all().size());
+}
+
+TEST_F(update_log_test, torn_tail) {
+  {
+    update_log log(path_);
+    log.append("first", 5);
+    log.append("second", 6);
+  }
+  // crash in the middle of the second record
+  ASSERT_EQ(0, ::truncate(path_.c_str(), 8 + 5 + 8 + 3));
+  EXPECT_EQ(1u, read_all().size());
+
+  {
+    update_log log(path_);
+    log.append("third", 5);
+  }
+  vector<string> records = read_all();
+  ASSERT_EQ(2u, records.size());
+  EXPECT_EQ("third", records[1]);
+}
+
+TEST_F(update_log_test, corrupted_record) {
+  {
+    update_log log(path_);
+    log.append("first", 5);
+    log.append("second", 6);
+  }
+  FILE* fp = fopen(path_.c_str(), "r+b");
+  ASSERT_TRUE(fp != NULL);
+  fseek(fp, 8 + 2, SEEK_SET);
+  fputc('X', fp);
+  fclose(fp);
+
+  EXPECT_EQ(0u, read_all().size());
+}
+
+TEST_F(update_log_test, rotate) {
+  const string rotated = path_ + ".rotated";
+  update_log log(path_);
+  {
+    update_log::scoped_update u(log);
+    log.append("first", 5);
+  }
+
+  log.begin_checkpoint();
+  log.rotate(rotated);
+  log.end_checkpoint();
+  EXPECT_EQ(rotated, log.path());
+
+  {
+    update_log::scoped_update u(log);
+    log.append("second", 6);
+  }
+
+  vector<string> records = read_all();
+  ASSERT_EQ(1u, records.size());
+  EXPECT_EQ("first", records[0]);
+
+  records.clear();
+  update_log::read(rotated, jubatus::util::lang::bind(
+      &collect, &records, jubatus::util::lang::_1,
+      jubatus::util::lang::_2));
+  ::unlink(rotated.c_str());
+  ASSERT_EQ(1u, records.size());
+  EXPECT_EQ("second", records[0]);
+
+  std::map<string, string> status;
+  log.get_status("update_log", status);
+  EXPECT_EQ("2", status["update_log.appended"]);
+  EXPECT_EQ("1", status["update_log.checkpoints"]);
+}
+
+}  // namespace common
+}  // namespace server
+}  // namespace jubatus
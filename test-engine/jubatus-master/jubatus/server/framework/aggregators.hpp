@@ -17,7 +17,11 @@
 #ifndef JUBATUS_SERVER_FRAMEWORK_AGGREGATORS_HPP_
 #define JUBATUS_SERVER_FRAMEWORK_AGGREGATORS_HPP_
 
+#include <algorithm>
 #include <map>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace jubatus {
@@ -44,6 +48,111 @@ std::vector<T> concat(const std::vector<T>& lhs, const std::vector<T>& rhs) {
   return ret;
 }
 
+template<typename T>
+std::vector<T> concat_unique(
+    const std::vector<T>& lhs,
+    const std::vector<T>& rhs) {
+  std::vector<T> ret;
+  ret.reserve(lhs.size() + rhs.size());
+  std::set<T> seen;
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    if (seen.insert(lhs[i]).second) {
+      ret.push_back(lhs[i]);
+    }
+  }
+  for (size_t i = 0; i < rhs.size(); ++i) {
+    if (seen.insert(rhs[i]).second) {
+      ret.push_back(rhs[i]);
+    }
+  }
+  return ret;
+}
+
+namespace detail {
+
+// scored entries are either messages with id and score, or pairs of them
+template<typename T>
+const std::string& id_of(const T& v) {
+  return v.id;
+}
+
+template<typename T>
+float score_of(const T& v) {
+  return v.score;
+}
+
+inline const std::string& id_of(const std::pair<std::string, float>& v) {
+  return v.first;
+}
+
+inline float score_of(const std::pair<std::string, float>& v) {
+  return v.second;
+}
+
+template<typename T>
+bool higher_score(const T& lhs, const T& rhs) {
+  return score_of(lhs) > score_of(rhs);
+}
+
+template<typename T>
+bool lower_score(const T& lhs, const T& rhs) {
+  return score_of(lhs) < score_of(rhs);
+}
+
+// keeps the k best entries of both lists in a bounded heap whose top is the
+// worst one kept; entries whose ID is already kept (written to replicas)
+// are dropped
+template<typename T, typename Better>
+std::vector<T> merge_k(
+    const std::vector<T>& lhs,
+    const std::vector<T>& rhs,
+    size_t k,
+    Better better) {
+  std::vector<T> heap;
+  heap.reserve(std::min(k, lhs.size() + rhs.size()));
+  std::set<std::string> ids;
+  for (size_t i = 0; i < lhs.size() + rhs.size(); ++i) {
+    const T& v = i < lhs.size() ? lhs[i] : rhs[i - lhs.size()];
+    if (k == 0 || ids.count(id_of(v))) {
+      continue;
+    }
+    if (heap.size() < k) {
+      heap.push_back(v);
+      std::push_heap(heap.begin(), heap.end(), better);
+    } else if (better(v, heap.front())) {
+      ids.erase(id_of(heap.front()));
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = v;
+      std::push_heap(heap.begin(), heap.end(), better);
+    } else {
+      continue;
+    }
+    ids.insert(id_of(v));
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+  return heap;
+}
+
+}  // namespace detail
+
+// k entries with the highest scores (similarities), best first
+template<typename T>
+std::vector<T> top_k(
+    const std::vector<T>& lhs,
+    const std::vector<T>& rhs,
+    size_t k) {
+  return detail::merge_k(lhs, rhs, k, detail::higher_score<T>);
+}
+
+// k entries with the lowest scores (distances), best first
+template<typename T>
+std::vector<T> bottom_k(
+    const std::vector<T>& lhs,
+    const std::vector<T>& rhs,
+    size_t k) {
+  return detail::merge_k(lhs, rhs, k, detail::lower_score<T>);
+}
+
 template<typename T>
 T pass(T lhs, T rhs) {
   return lhs;  // TODO( ):
@@ -54,14 +163,116 @@ T add(T lhs, T rhs) {
   return lhs + rhs;
 }
 
-bool all_and(bool l, bool r) {
+inline bool all_and(bool l, bool r) {
   return l && r;
 }
 
-bool all_or(bool l, bool r) {
+inline bool all_or(bool l, bool r) {
   return l || r;
 }
 
+// In-place aggregators, with which the proxy folds each response into the
+// result as soon as it arrives; lhs is the result so far and rhs is the
+// response, which may be left in any state.
+namespace inplace {
+
+template<typename K, typename V>
+void merge(std::map<K, V>& lhs, std::map<K, V>& rhs) {
+  if (lhs.empty()) {
+    lhs.swap(rhs);
+    return;
+  }
+  for (typename std::map<K, V>::const_iterator it = rhs.begin();
+       it != rhs.end(); ++it) {
+    typename std::map<K, V>::iterator pos = lhs.lower_bound(it->first);
+    if (pos != lhs.end() && !lhs.key_comp()(it->first, pos->first)) {
+      pos->second = it->second;
+    } else {
+      lhs.insert(pos, *it);
+    }
+  }
+}
+
+template<typename T>
+void concat(std::vector<T>& lhs, std::vector<T>& rhs) {
+  if (lhs.empty()) {
+    lhs.swap(rhs);
+    return;
+  }
+  lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+}
+
+// IDs already in the result are remembered across calls, so each request
+// needs its own copy of this aggregator (the proxy copies it per request)
+template<typename T>
+class concat_unique {
+ public:
+  void operator()(std::vector<T>& lhs, std::vector<T>& rhs) {
+    if (seen_.empty()) {
+      // lhs is the first response; keep its (presized) buffer
+      std::vector<T> first(lhs);
+      lhs.clear();
+      append(lhs, first);
+    }
+    append(lhs, rhs);
+  }
+
+ private:
+  void append(std::vector<T>& lhs, const std::vector<T>& rhs) {
+    for (size_t i = 0; i < rhs.size(); ++i) {
+      if (seen_.insert(rhs[i]).second) {
+        lhs.push_back(rhs[i]);
+      }
+    }
+  }
+
+  std::set<T> seen_;
+};
+
+template<typename T>
+void top_k(std::vector<T>& lhs, std::vector<T>& rhs, size_t k) {
+  std::vector<T> ret =
+      detail::merge_k(lhs, rhs, k, detail::higher_score<T>);
+  lhs.swap(ret);
+}
+
+template<typename T>
+void bottom_k(std::vector<T>& lhs, std::vector<T>& rhs, size_t k) {
+  std::vector<T> ret =
+      detail::merge_k(lhs, rhs, k, detail::lower_score<T>);
+  lhs.swap(ret);
+}
+
+template<typename T>
+void pass(T& lhs, T& rhs) {
+}
+
+template<typename T>
+void add(T& lhs, T& rhs) {
+  lhs += rhs;
+}
+
+inline void all_and(bool& l, bool& r) {
+  l = l && r;
+}
+
+inline void all_or(bool& l, bool& r) {
+  l = l || r;
+}
+
+// reserves room for the responses of all hosts, assuming they are as
+// large as the first one
+template<typename T>
+void presize(T& result, size_t hosts) {
+}
+
+template<typename T>
+void presize(std::vector<T>& result, size_t hosts) {
+  result.reserve(result.size() * hosts);
+}
+
+}  // namespace inplace
+
 }  // namespace framework
 }  // namespace server
 }  // namespace jubatus
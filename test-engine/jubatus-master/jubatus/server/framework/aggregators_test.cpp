@@ -0,0 +1,203 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "aggregators.hpp"
+
+using std::make_pair;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+struct scored {
+  scored(const string& id, float score)
+      : id(id), score(score) {
+  }
+  string id;
+  float score;
+};
+
+}  // namespace
+
+TEST(top_k, merge) {
+  vector<pair<string, float> > lhs;
+  lhs.push_back(make_pair("a", 0.9f));
+  lhs.push_back(make_pair("b", 0.5f));
+  lhs.push_back(make_pair("c", 0.1f));
+  vector<pair<string, float> > rhs;
+  rhs.push_back(make_pair("d", 0.7f));
+  rhs.push_back(make_pair("e", 0.3f));
+
+  vector<pair<string, float> > r = top_k(lhs, rhs, 3);
+  ASSERT_EQ(3u, r.size());
+  EXPECT_EQ("a", r[0].first);
+  EXPECT_EQ("d", r[1].first);
+  EXPECT_EQ("b", r[2].first);
+}
+
+TEST(top_k, fewer_than_k) {
+  vector<pair<string, float> > lhs;
+  lhs.push_back(make_pair("a", 0.9f));
+  vector<pair<string, float> > rhs;
+  rhs.push_back(make_pair("b", 0.7f));
+
+  EXPECT_EQ(2u, top_k(lhs, rhs, 10).size());
+  EXPECT_EQ(0u, top_k(lhs, rhs, 0).size());
+}
+
+TEST(top_k, drop_replicas) {
+  vector<scored> lhs;
+  lhs.push_back(scored("a", 0.9f));
+  lhs.push_back(scored("b", 0.5f));
+  vector<scored> rhs;
+  rhs.push_back(scored("a", 0.9f));
+  rhs.push_back(scored("c", 0.4f));
+
+  vector<scored> r = top_k(lhs, rhs, 3);
+  ASSERT_EQ(3u, r.size());
+  EXPECT_EQ("a", r[0].id);
+  EXPECT_EQ("b", r[1].id);
+  EXPECT_EQ("c", r[2].id);
+}
+
+TEST(bottom_k, merge) {
+  vector<pair<string, float> > lhs;
+  lhs.push_back(make_pair("a", 0.1f));
+  lhs.push_back(make_pair("b", 2.0f));
+  vector<pair<string, float> > rhs;
+  rhs.push_back(make_pair("c", 0.5f));
+  rhs.push_back(make_pair("d", 1.0f));
+
+  vector<pair<string, float> > r = bottom_k(lhs, rhs, 2);
+  ASSERT_EQ(2u, r.size());
+  EXPECT_EQ("a", r[0].first);
+  EXPECT_EQ("c", r[1].first);
+}
+
+TEST(concat_unique, merge) {
+  vector<string> lhs;
+  lhs.push_back("a");
+  lhs.push_back("b");
+  vector<string> rhs;
+  rhs.push_back("b");
+  rhs.push_back("c");
+
+  vector<string> r = concat_unique(lhs, rhs);
+  ASSERT_EQ(3u, r.size());
+  EXPECT_EQ("a", r[0]);
+  EXPECT_EQ("b", r[1]);
+  EXPECT_EQ("c", r[2]);
+}
+
+TEST(inplace, concat) {
+  vector<string> lhs;
+  vector<string> rhs;
+  rhs.push_back("a");
+  inplace::concat(lhs, rhs);
+  ASSERT_EQ(1u, lhs.size());
+
+  inplace::presize(lhs, 3);
+  EXPECT_LE(3u, lhs.capacity());
+
+  rhs.clear();
+  rhs.push_back("b");
+  inplace::concat(lhs, rhs);
+  ASSERT_EQ(2u, lhs.size());
+  EXPECT_EQ("a", lhs[0]);
+  EXPECT_EQ("b", lhs[1]);
+}
+
+TEST(inplace, concat_unique) {
+  inplace::concat_unique<string> agg;
+  vector<string> lhs;
+  lhs.push_back("a");
+  lhs.push_back("b");
+  vector<string> rhs;
+  rhs.push_back("b");
+  rhs.push_back("c");
+  agg(lhs, rhs);
+
+  rhs.clear();
+  rhs.push_back("a");
+  rhs.push_back("d");
+  agg(lhs, rhs);
+
+  ASSERT_EQ(4u, lhs.size());
+  EXPECT_EQ("a", lhs[0]);
+  EXPECT_EQ("b", lhs[1]);
+  EXPECT_EQ("c", lhs[2]);
+  EXPECT_EQ("d", lhs[3]);
+}
+
+TEST(inplace, merge) {
+  std::map<string, int> lhs;
+  lhs["a"] = 1;
+  lhs["b"] = 2;
+  std::map<string, int> rhs;
+  rhs["b"] = 3;
+  rhs["c"] = 4;
+  inplace::merge(lhs, rhs);
+
+  ASSERT_EQ(3u, lhs.size());
+  EXPECT_EQ(1, lhs["a"]);
+  EXPECT_EQ(3, lhs["b"]);
+  EXPECT_EQ(4, lhs["c"]);
+}
+
+TEST(inplace, top_k) {
+  vector<pair<string, float> > lhs;
+  lhs.push_back(make_pair("a", 0.9f));
+  lhs.push_back(make_pair("b", 0.5f));
+  vector<pair<string, float> > rhs;
+  rhs.push_back(make_pair("c", 0.7f));
+  rhs.push_back(make_pair("a", 0.9f));
+  inplace::top_k(lhs, rhs, 2);
+
+  ASSERT_EQ(2u, lhs.size());
+  EXPECT_EQ("a", lhs[0].first);
+  EXPECT_EQ("c", lhs[1].first);
+}
+
+TEST(inplace, scalar) {
+  bool b = true;
+  bool f = false;
+  inplace::all_and(b, f);
+  EXPECT_FALSE(b);
+  inplace::all_or(b, f);
+  EXPECT_FALSE(b);
+
+  int i = 1;
+  int j = 2;
+  inplace::add(i, j);
+  EXPECT_EQ(3, i);
+  inplace::pass(i, j);
+  EXPECT_EQ(3, i);
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
@@ -0,0 +1,199 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/concurrent/thread.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "jubatus/core/driver/driver.hpp"
+#include "save_load.hpp"
+#include "server_base.hpp"
+#include "server_util.hpp"
+
+using std::vector;
+using jubatus::util::concurrent::thread;
+using jubatus::util::lang::shared_ptr;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace {
+
+const int ALIVE = 0x600d;
+
+// classify() tells whether it has run on a released driver
+class counter_driver : public core::driver::driver_base {
+ public:
+  counter_driver()
+      : value(0),
+        alive_(ALIVE) {
+  }
+
+  ~counter_driver() {
+    alive_ = 0;
+  }
+
+  int classify() const {
+    ::usleep(100);
+    return alive_ == ALIVE ? value : -1;
+  }
+
+  void pack(core::framework::packer& packer) const {
+    packer.pack(value);
+  }
+
+  void unpack(msgpack::object o) {
+    o.convert(&value);
+  }
+
+  void clear() {
+    value = 0;
+  }
+
+  int value;
+
+ private:
+  volatile int alive_;
+};
+
+server_argv make_argv() {
+  server_argv a;
+  a.type = "background_load_test";
+  return a;
+}
+
+class counter_server : public server_base {
+ public:
+  counter_server()
+      : server_base(make_argv()),
+        driver_(new counter_driver) {
+  }
+
+  mixer::mixer* get_mixer() const {
+    return NULL;
+  }
+
+  core::driver::driver_base* get_driver() const {
+    return driver_.get();
+  }
+
+  void get_status(status_t& status) const {
+  }
+
+  void set_config(const std::string& config) {
+  }
+
+  std::string get_config() const {
+    return "{}";
+  }
+
+  uint64_t user_data_version() const {
+    return 1;
+  }
+
+  core::driver::driver_base* prepare_driver(const std::string& config) {
+    next_driver_.reset(new counter_driver);
+    return next_driver_.get();
+  }
+
+  void commit_driver() {
+    driver_.swap(next_driver_);
+  }
+
+  void discard_driver() {
+    next_driver_.reset();
+  }
+
+  void set_value(int value) {
+    driver_->value = value;
+  }
+
+  // locked as NOLOCK_ does for nolock methods
+  int classify() {
+    jubatus::util::concurrent::scoped_rlock lk(driver_mutex());
+    return driver_->classify();
+  }
+
+ private:
+  shared_ptr<counter_driver> driver_;
+  shared_ptr<counter_driver> next_driver_;
+};
+
+void classify_loop(counter_server* server, volatile bool* stop, int* errors) {
+  while (!*stop) {
+    if (server->classify() < 0) {
+      ++*errors;
+    }
+  }
+}
+
+void ignore_progress(const std::string&) {
+}
+
+TEST(load_server_detached, classify_while_loading) {
+  counter_server server;
+  server.set_value(42);
+
+  char path[] = "/tmp/background_load_test_XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_NE(-1, fd);
+  FILE* fp = ::fdopen(fd, "wb");
+  ASSERT_TRUE(fp != NULL);
+  save_server(fp, server, "test");
+  ASSERT_EQ(0, ::fclose(fp));
+
+  const size_t num_threads = 4;
+  volatile bool stop = false;
+  vector<int> errors(num_threads, 0);
+  vector<shared_ptr<thread> > threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    shared_ptr<thread> t(new thread(jubatus::util::lang::bind(
+        &classify_loop, &server, &stop, &errors[i])));
+    ASSERT_TRUE(t->start());
+    threads.push_back(t);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    std::ifstream ifs(path, std::ios::binary);
+    load_server_detached(ifs, server, "test", path, &ignore_progress);
+  }
+
+  stop = true;
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i]->join();
+  }
+  ::unlink(path);
+
+  // no classify ran on a driver swapped out and released by the load
+  for (size_t i = 0; i < num_threads; ++i) {
+    EXPECT_EQ(0, errors[i]);
+  }
+  EXPECT_EQ(42, server.classify());
+}
+
+}  // namespace
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
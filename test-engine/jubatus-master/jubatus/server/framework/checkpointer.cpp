@@ -0,0 +1,420 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "checkpointer.hpp"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/util/system/time_util.h"
+#include "jubatus/core/common/exception.hpp"
+#include "../common/filesystem.hpp"
+#include "../common/logger/logger.hpp"
+#include "save_load.hpp"
+
+using std::string;
+using std::vector;
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::concurrent::scoped_rlock;
+using jubatus::util::lang::lexical_cast;
+using jubatus::util::system::time::clock_time;
+using jubatus::util::system::time::get_clock_time;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+const char CHECKPOINT_TAG[] = "checkpoint_";
+const char CHECKPOINT_SUFFIX[] = ".jubatus";
+const char LOG_TAG[] = "update_";
+const char LOG_SUFFIX[] = ".log";
+
+// log progress of replaying every this many records
+const uint64_t REPLAY_PROGRESS_INTERVAL = 100000;
+
+// parses "<tag><generation><suffix>"
+bool parse_generation(
+    const string& name,
+    const string& tag,
+    const string& suffix,
+    uint64_t& generation) {
+  if (name.size() <= tag.size() + suffix.size() ||
+      name.compare(0, tag.size(), tag) != 0 ||
+      name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+    return false;
+  }
+  const string digits =
+      name.substr(tag.size(), name.size() - tag.size() - suffix.size());
+  if (digits.find_first_not_of("0123456789") != string::npos) {
+    return false;
+  }
+  generation = strtoull(digits.c_str(), NULL, 10);
+  return true;
+}
+
+// lists generations of checkpoints and update logs in `dir` whose names
+// start with `prefix`
+void list_generations(
+    const string& dir,
+    const string& prefix,
+    vector<uint64_t>& checkpoints,
+    vector<uint64_t>& logs) {
+  DIR* d = opendir(dir.c_str());
+  if (!d) {
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot open datadir")
+        << core::common::exception::error_file_name(dir)
+        << core::common::exception::error_errno(errno));
+  }
+  for (struct dirent* entry = readdir(d); entry; entry = readdir(d)) {
+    const string name(entry->d_name);
+    if (name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    const string rest = name.substr(prefix.size());
+    uint64_t generation;
+    if (parse_generation(rest, CHECKPOINT_TAG, CHECKPOINT_SUFFIX,
+                         generation)) {
+      checkpoints.push_back(generation);
+    } else if (parse_generation(rest, LOG_TAG, LOG_SUFFIX, generation)) {
+      logs.push_back(generation);
+    }
+  }
+  closedir(d);
+  std::sort(checkpoints.begin(), checkpoints.end());
+  std::sort(logs.begin(), logs.end());
+}
+
+void remove_file(const string& path) {
+  if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+    LOG(WARNING) << "cannot remove " << path;
+  }
+}
+
+}  // namespace
+
+checkpointer::checkpointer(server_base& server, common::mprpc::rpc_server& rpc)
+    : server_(server),
+      rpc_(rpc),
+      generation_(0),
+      replayed_(0),
+      replay_errors_(0),
+      recovery_sec_(0),
+      last_checkpoint_sec_(0),
+      last_checkpoint_time_(0),
+      is_running_(false),
+      t_(jubatus::util::lang::bind(&checkpointer::checkpoint_loop, this)) {
+}
+
+checkpointer::~checkpointer() {
+  if (is_running_) {
+    {
+      scoped_lock lk(m_);
+      is_running_ = false;
+      c_.notify();
+    }
+    t_.join();
+  }
+  rpc_.set_update_log(NULL);
+  server_.set_update_log(NULL);
+}
+
+void checkpointer::recover() {
+  const clock_time start = get_clock_time();
+  const server_argv& a = server_.argv();
+
+  vector<uint64_t> checkpoints;
+  vector<uint64_t> logs;
+  list_generations(a.datadir, base_prefix(), checkpoints, logs);
+
+  uint64_t generation = 0;
+  if (!checkpoints.empty()) {
+    generation = checkpoints.back();
+    LOG(INFO) << "recovering from checkpoint " << generation;
+    // config must be the same as the one the checkpoint was taken with
+    server_.load(checkpoint_id(generation));
+  }
+
+  // logs before the checkpoint are left by a crash while removing them
+  for (size_t i = 0; i < logs.size(); ++i) {
+    if (logs[i] < generation) {
+      continue;
+    }
+    const string path = log_path(logs[i]);
+    LOG(INFO) << "replaying update log " << path;
+    const uint64_t records = common::update_log::read(path,
+        jubatus::util::lang::bind(&checkpointer::replay_record, this,
+                                  jubatus::util::lang::_1,
+                                  jubatus::util::lang::_2));
+    LOG(INFO) << "replayed " << records << " records of " << path;
+    generation = std::max(generation, logs[i]);
+  }
+
+  // keep appending to the newest log
+  log_.reset(new common::update_log(log_path(generation)));
+  rpc_.set_update_log(log_.get());
+  server_.set_update_log(log_.get());
+  const vector<string> unlogged = server_.unlogged_update_methods();
+  for (size_t i = 0; i < unlogged.size(); ++i) {
+    rpc_.set_unlogged(unlogged[i]);
+  }
+  remove_files_before(checkpoints.empty() ? 0 : checkpoints.back());
+
+  scoped_lock lk(m_);
+  generation_ = generation;
+  recovery_sec_ = static_cast<double>(get_clock_time() - start);
+  LOG(INFO) << "recovered " << replayed_ << " updates ("
+            << replay_errors_ << " failed) in " << recovery_sec_ << " sec";
+}
+
+void checkpointer::start() {
+  scoped_lock lk(m_);
+  if (!is_running_ && server_.argv().checkpoint_interval > 0) {
+    is_running_ = true;
+    t_.start();
+  }
+}
+
+void checkpointer::stop() {
+  bool running;
+  {
+    scoped_lock lk(m_);
+    running = is_running_;
+    is_running_ = false;
+    c_.notify();
+  }
+  if (running) {
+    t_.join();
+  }
+  checkpoint();
+}
+
+void checkpointer::checkpoint() {
+  scoped_lock checkpoint_lk(checkpoint_m_);
+  if (!log_ || log_->size() == 0) {
+    return;  // no updates since the last checkpoint
+  }
+  take_checkpoint(jubatus::util::lang::function<void()>());
+}
+
+void checkpointer::checkpoint_after(
+    const jubatus::util::lang::function<void()>& f) {
+  scoped_lock checkpoint_lk(checkpoint_m_);
+  take_checkpoint(f);
+}
+
+void checkpointer::take_checkpoint(
+    const jubatus::util::lang::function<void()>& before) {
+  // the log must not have the updates in the checkpoint, nor lack the
+  // updates after it
+  log_->begin_checkpoint();
+  if (before) {
+    try {
+      before();
+    } catch (...) {
+      log_->end_checkpoint();
+      throw;
+    }
+  }
+
+  const clock_time start = get_clock_time();
+  uint64_t generation;
+  {
+    scoped_lock lk(m_);
+    generation = generation_ + 1;
+  }
+
+  try {
+    log_->rotate(log_path(generation));
+    {
+      scoped_lock lk(m_);
+      generation_ = generation;
+    }
+    scoped_rlock model_lk(server_.rw_mutex());
+    save_checkpoint(generation);
+  } catch (...) {
+    log_->end_checkpoint();
+    throw;
+  }
+  log_->end_checkpoint();
+
+  // older logs are kept until their checkpoint has been replaced
+  remove_files_before(generation);
+
+  scoped_lock lk(m_);
+  const clock_time now = get_clock_time();
+  last_checkpoint_sec_ = static_cast<double>(now - start);
+  last_checkpoint_time_ = now.sec;
+  LOG(INFO) << "took checkpoint " << generation << " in "
+            << last_checkpoint_sec_ << " sec";
+}
+
+void checkpointer::get_status(server_base::status_t& status) const {
+  if (log_) {
+    log_->get_status("update_log", status);
+  }
+  scoped_lock lk(m_);
+  status["update_log.generation"] = lexical_cast<string>(generation_);
+  status["update_log.replayed"] = lexical_cast<string>(replayed_);
+  status["update_log.replay_errors"] = lexical_cast<string>(replay_errors_);
+  status["update_log.recovery_sec"] = lexical_cast<string>(recovery_sec_);
+  status["update_log.last_checkpoint"] =
+      lexical_cast<string>(last_checkpoint_time_);
+  status["update_log.last_checkpoint_sec"] =
+      lexical_cast<string>(last_checkpoint_sec_);
+  status["update_log.checkpoint_interval"] =
+      lexical_cast<string>(server_.argv().checkpoint_interval);
+}
+
+void checkpointer::checkpoint_loop() {
+  const double interval = server_.argv().checkpoint_interval;
+  while (true) {
+    {
+      scoped_lock lk(m_);
+      if (!is_running_) {
+        return;
+      }
+      c_.wait(m_, interval);
+      if (!is_running_) {
+        return;
+      }
+    }
+
+    try {
+      checkpoint();
+    } catch (const core::common::exception::jubatus_exception& e) {
+      LOG(ERROR) << "failed to take checkpoint: "
+                 << e.diagnostic_information(true);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "failed to take checkpoint: " << e.what();
+    }
+  }
+}
+
+void checkpointer::replay_record(const char* data, size_t size) {
+  try {
+    msgpack::unpacked unpacked;
+    msgpack::unpack(&unpacked, data, size);
+    msgpack::type::tuple<string, msgpack::object> record;
+    unpacked.get().convert(&record);
+    rpc_.replay(record.get<0>(), record.get<1>());
+  } catch (const std::exception& e) {
+    // the update failed when it was requested, too
+    ++replay_errors_;
+    DLOG(INFO) << "replayed update failed: " << e.what();
+  }
+  if (++replayed_ % REPLAY_PROGRESS_INTERVAL == 0) {
+    LOG(INFO) << "replayed " << replayed_ << " updates";
+  }
+}
+
+void checkpointer::save_checkpoint(uint64_t generation) const {
+  const string id = checkpoint_id(generation);
+  const string path = path_prefix() + id + CHECKPOINT_SUFFIX;
+  const string tmp_path = path + ".tmp";
+
+  FILE* fp = fopen(tmp_path.c_str(), "wb");
+  if (!fp) {
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot open checkpoint file")
+        << core::common::exception::error_file_name(tmp_path)
+        << core::common::exception::error_errno(errno));
+  }
+  try {
+    framework::save_server(fp, server_, id);
+  } catch (...) {
+    fclose(fp);
+    remove_file(tmp_path);
+    throw;
+  }
+  // the checkpoint replaces the logs; it must be on the disk before that
+  int err = 0;
+  if (fflush(fp) != 0 || ::fsync(fileno(fp)) != 0) {
+    err = errno;
+  }
+  if (fclose(fp) != 0 && err == 0) {
+    err = errno;
+  }
+  if (err == 0 && ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    err = errno;
+  }
+  if (err != 0) {
+    remove_file(tmp_path);
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot write checkpoint file")
+        << core::common::exception::error_file_name(path)
+        << core::common::exception::error_errno(err));
+  }
+  if (!common::sync_parent_dir(path)) {
+    LOG(WARNING) << "cannot sync the directory of checkpoint " << path;
+  }
+}
+
+void checkpointer::remove_files_before(uint64_t generation) const {
+  vector<uint64_t> checkpoints;
+  vector<uint64_t> logs;
+  list_generations(server_.argv().datadir, base_prefix(), checkpoints, logs);
+  for (size_t i = 0; i < checkpoints.size(); ++i) {
+    if (checkpoints[i] < generation) {
+      remove_file(path_prefix() + checkpoint_id(checkpoints[i]) +
+                  CHECKPOINT_SUFFIX);
+    }
+  }
+  for (size_t i = 0; i < logs.size(); ++i) {
+    if (logs[i] < generation) {
+      remove_file(log_path(logs[i]));
+    }
+  }
+}
+
+// <eth>_<port>_<type>_, the same as model files saved by `save`
+string checkpointer::base_prefix() const {
+  const server_argv& a = server_.argv();
+  std::ostringstream prefix;
+  prefix << a.eth << '_' << a.port << '_' << a.type << '_';
+  return prefix.str();
+}
+
+string checkpointer::path_prefix() const {
+  return server_.argv().datadir + '/' + base_prefix();
+}
+
+string checkpointer::checkpoint_id(uint64_t generation) const {
+  return CHECKPOINT_TAG + lexical_cast<string>(generation);
+}
+
+string checkpointer::log_path(uint64_t generation) const {
+  return path_prefix() + LOG_TAG + lexical_cast<string>(generation) +
+      LOG_SUFFIX;
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
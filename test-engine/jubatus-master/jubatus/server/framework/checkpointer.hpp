@@ -0,0 +1,116 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_CHECKPOINTER_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_CHECKPOINTER_HPP_
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include "jubatus/util/concurrent/condition.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/concurrent/thread.h"
+#include "jubatus/util/lang/function.h"
+#include "jubatus/util/lang/noncopyable.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "../common/mprpc/rpc_server.hpp"
+#include "../common/update_log.hpp"
+#include "server_base.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+// checkpointer
+//   Keeps the model recoverable from a crash with the update log and
+//   checkpoints in datadir.
+//
+//   A checkpoint N is a model file saved in the same format as `save`, and
+//   update log N has the updates applied after checkpoint N. Taking a
+//   checkpoint first continues the log in log N+1, then saves checkpoint
+//   N+1 and removes older files, so the files left by a crash at any point
+//   are always the newest checkpoint and the logs following it.
+//
+//   Updates forwarded to other servers (unlogged_update_methods) are logged
+//   by the part applied on this server (local_update). In distributed mode
+//   the recovered model is only a starting point: a server of linear_mixer
+//   starts obsolete and gets the model from another server right after it
+//   starts, which replaces the recovered one unless no other server is up.
+class checkpointer : jubatus::util::lang::noncopyable {
+ public:
+  checkpointer(server_base& server, common::mprpc::rpc_server& rpc);
+  ~checkpointer();
+
+  // loads the newest checkpoint, replays the update logs following it,
+  // and starts logging update requests to `rpc` and `server`; call before
+  // `rpc` starts
+  void recover();
+
+  // takes a checkpoint every checkpoint_interval seconds
+  void start();
+  // stops the thread and takes the last checkpoint; call after `rpc` stops
+  void stop();
+
+  void checkpoint();
+  // runs `f` (e.g. a load, which replaces the model) while no update runs
+  // and takes a checkpoint before updates resume, so that updates after
+  // `f` are never replayed onto the model before it
+  void checkpoint_after(const jubatus::util::lang::function<void()>& f);
+
+  void get_status(server_base::status_t& status) const;
+
+ private:
+  void checkpoint_loop();
+  // call with checkpoint_m_ held
+  void take_checkpoint(const jubatus::util::lang::function<void()>& before);
+  void replay_record(const char* data, size_t size);
+  void save_checkpoint(uint64_t generation) const;
+  void remove_files_before(uint64_t generation) const;
+
+  std::string base_prefix() const;
+  std::string path_prefix() const;
+  std::string checkpoint_id(uint64_t generation) const;
+  std::string log_path(uint64_t generation) const;
+
+  server_base& server_;
+  common::mprpc::rpc_server& rpc_;
+  jubatus::util::lang::shared_ptr<common::update_log> log_;
+
+  // generation of the running update log
+  uint64_t generation_;
+  uint64_t replayed_;
+  uint64_t replay_errors_;
+  double recovery_sec_;
+  double last_checkpoint_sec_;
+  uint64_t last_checkpoint_time_;
+
+  bool is_running_;
+  jubatus::util::concurrent::thread t_;
+
+  // protects the members above except `log_`; taken after checkpoint_m_
+  mutable jubatus::util::concurrent::mutex m_;
+  jubatus::util::concurrent::condition c_;
+
+  // serializes checkpoints
+  jubatus::util::concurrent::mutex checkpoint_m_;
+};
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_CHECKPOINTER_HPP_
@@ -0,0 +1,157 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "datum_cache.hpp"
+
+#include <string.h>
+#include <string>
+
+#include <msgpack.hpp>
+#include "jubatus/util/lang/cast.h"
+
+using std::string;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+inline uint64_t rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+inline uint64_t load64(const char* p) {
+  uint64_t k;
+  memcpy(&k, p, sizeof(k));
+  return k;
+}
+
+}  // namespace
+
+datum_key hash128(const char* data, size_t size, uint64_t seed) {
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  const size_t nblocks = size / 16;
+
+  uint64_t h1 = seed;
+  uint64_t h2 = seed;
+
+  for (size_t i = 0; i < nblocks; ++i) {
+    uint64_t k1 = load64(data + i * 16);
+    uint64_t k2 = load64(data + i * 16 + 8);
+
+    k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const unsigned char* tail =
+      reinterpret_cast<const unsigned char*>(data + nblocks * 16);
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  // every case falls through
+  switch (size & 15) {
+    case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48;
+    case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40;
+    case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32;
+    case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24;
+    case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16;
+    case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8;
+    case 9: k2 ^= static_cast<uint64_t>(tail[8]);
+      k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    case 8: k1 ^= static_cast<uint64_t>(tail[7]) << 56;
+    case 7: k1 ^= static_cast<uint64_t>(tail[6]) << 48;
+    case 6: k1 ^= static_cast<uint64_t>(tail[5]) << 40;
+    case 5: k1 ^= static_cast<uint64_t>(tail[4]) << 32;
+    case 4: k1 ^= static_cast<uint64_t>(tail[3]) << 24;
+    case 3: k1 ^= static_cast<uint64_t>(tail[2]) << 16;
+    case 2: k1 ^= static_cast<uint64_t>(tail[1]) << 8;
+    case 1: k1 ^= static_cast<uint64_t>(tail[0]);
+      k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+  }
+
+  h1 ^= size;
+  h2 ^= size;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+  h1 += h2;
+  h2 += h1;
+
+  datum_key key;
+  key.hi = h1;
+  key.lo = h2;
+  return key;
+}
+
+datum_key make_datum_key(const core::fv_converter::datum& d, uint64_t salt) {
+  msgpack::sbuffer buf;
+  msgpack::pack(buf, d);
+  return hash128(buf.data(), buf.size(), salt);
+}
+
+datum_cache_base::datum_cache_base(size_t capacity)
+    : capacity_(capacity),
+      generation_(1),
+      hits_(0),
+      misses_(0),
+      evictions_(0),
+      invalidations_(0) {
+}
+
+void datum_cache_base::invalidate() {
+  jubatus::util::concurrent::scoped_lock lk(m_);
+  ++generation_;
+  ++invalidations_;
+}
+
+void datum_cache_base::get_status(
+    const string& prefix,
+    server_base::status_t& status) const {
+  jubatus::util::concurrent::scoped_lock lk(m_);
+  const string p = prefix + ".";
+  status[p + "capacity"] = lexical_cast<string>(capacity_);
+  if (!enabled()) {
+    return;
+  }
+  const uint64_t lookups = hits_ + misses_;
+  status[p + "size"] = lexical_cast<string>(size());
+  status[p + "hits"] = lexical_cast<string>(hits_);
+  status[p + "misses"] = lexical_cast<string>(misses_);
+  status[p + "hit_rate"] = lexical_cast<string>(
+      lookups == 0 ? 0.0 : static_cast<double>(hits_) / lookups);
+  status[p + "evictions"] = lexical_cast<string>(evictions_);
+  status[p + "invalidations"] = lexical_cast<string>(invalidations_);
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
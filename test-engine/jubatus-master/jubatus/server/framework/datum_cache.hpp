@@ -0,0 +1,202 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_DATUM_CACHE_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_DATUM_CACHE_HPP_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/noncopyable.h"
+#include "jubatus/core/fv_converter/datum.hpp"
+#include "server_base.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+// 128-bit hash of a serialized datum
+struct datum_key {
+  uint64_t hi;
+  uint64_t lo;
+
+  bool operator<(const datum_key& k) const {
+    return hi < k.hi || (hi == k.hi && lo < k.lo);
+  }
+  bool operator==(const datum_key& k) const {
+    return hi == k.hi && lo == k.lo;
+  }
+};
+
+// `salt` tells apart requests on the same datum with different arguments
+datum_key make_datum_key(
+    const core::fv_converter::datum& d,
+    uint64_t salt = 0);
+
+// 128-bit MurmurHash3 (x64)
+datum_key hash128(const char* data, size_t size, uint64_t seed);
+
+// datum_cache_base
+//   Invalidation and statistics shared by datum_cache<V>.
+//
+//   Invalidation only advances the generation; entries of older
+//   generations are treated as empty and reused by later insertions.
+class datum_cache_base : jubatus::util::lang::noncopyable {
+ public:
+  explicit datum_cache_base(size_t capacity);
+  virtual ~datum_cache_base() {}
+
+  bool enabled() const {
+    return capacity_ > 0;
+  }
+
+  // drops all entries; call after the model has been modified
+  void invalidate();
+
+  void get_status(
+      const std::string& prefix,
+      server_base::status_t& status) const;
+
+ protected:
+  virtual size_t size() const = 0;
+
+  const size_t capacity_;
+  uint64_t generation_;
+
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+  uint64_t invalidations_;
+
+  mutable jubatus::util::concurrent::mutex m_;
+};
+
+// datum_cache
+//   Bounded cache of analysis results keyed by datum, evicted by CLOCK.
+//
+//   A result must not be stored if the model was modified while it was
+//   computed, so put() takes the generation returned by a missed get()
+//   and drops the result if the cache was invalidated in between:
+//
+//     uint64_t generation;
+//     if (!cache.get(key, result, generation)) {
+//       result = compute();
+//       cache.put(key, result, generation);
+//     }
+template <typename V>
+class datum_cache : public datum_cache_base {
+ public:
+  explicit datum_cache(size_t capacity)
+      : datum_cache_base(capacity),
+        hand_(0) {
+  }
+
+  bool get(const datum_key& key, V& value, uint64_t& generation) {
+    jubatus::util::concurrent::scoped_lock lk(m_);
+    generation = generation_;
+    typename index_t::const_iterator it = index_.find(key);
+    if (it != index_.end() && entries_[it->second].generation == generation_) {
+      entry& e = entries_[it->second];
+      e.referenced = true;
+      value = e.value;
+      ++hits_;
+      return true;
+    }
+    ++misses_;
+    return false;
+  }
+
+  void put(const datum_key& key, const V& value, uint64_t generation) {
+    jubatus::util::concurrent::scoped_lock lk(m_);
+    if (!enabled() || generation != generation_) {
+      return;
+    }
+
+    size_t slot;
+    typename index_t::const_iterator it = index_.find(key);
+    if (it != index_.end()) {
+      slot = it->second;
+    } else {
+      if (entries_.size() < capacity_) {
+        slot = entries_.size();
+        entries_.push_back(entry());
+      } else {
+        slot = evict();
+        index_.erase(entries_[slot].key);
+      }
+      index_.insert(std::make_pair(key, slot));
+    }
+
+    entry& e = entries_[slot];
+    e.key = key;
+    e.value = value;
+    e.generation = generation;
+    e.referenced = false;
+  }
+
+ private:
+  struct entry {
+    entry()
+        : generation(0),
+          referenced(false) {
+    }
+
+    datum_key key;
+    V value;
+    uint64_t generation;
+    bool referenced;
+  };
+
+  typedef std::map<datum_key, size_t> index_t;
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  // takes an invalidated entry at once; referenced entries get a second
+  // chance, so this returns within two turns of the hand
+  size_t evict() {
+    for (;;) {
+      const size_t slot = hand_;
+      hand_ = (hand_ + 1) % entries_.size();
+      entry& e = entries_[slot];
+      if (e.generation != generation_) {
+        return slot;
+      }
+      if (!e.referenced) {
+        ++evictions_;
+        return slot;
+      }
+      e.referenced = false;
+    }
+  }
+
+  std::vector<entry> entries_;
+  index_t index_;
+  size_t hand_;
+};
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_DATUM_CACHE_HPP_
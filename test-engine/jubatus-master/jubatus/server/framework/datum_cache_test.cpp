@@ -0,0 +1,123 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <string>
+#include <gtest/gtest.h>
+#include "datum_cache.hpp"
+
+using std::string;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+datum_key make_key(const string& s) {
+  return hash128(s.data(), s.size(), 0);
+}
+
+}  // namespace
+
+TEST(datum_cache, hash128) {
+  const datum_key a = make_key("hello");
+  EXPECT_TRUE(a == make_key("hello"));
+  EXPECT_FALSE(a == make_key("hellp"));
+  EXPECT_FALSE(a == hash128("hello", 5, 1));
+
+  // blocks and tails of every length
+  const string s(40, 'x');
+  for (size_t n = 0; n < s.size(); ++n) {
+    EXPECT_FALSE(hash128(s.data(), n, 0) == hash128(s.data(), n + 1, 0));
+  }
+}
+
+TEST(datum_cache, get_put) {
+  datum_cache<int> cache(4);
+  ASSERT_TRUE(cache.enabled());
+
+  int value = 0;
+  uint64_t generation;
+  EXPECT_FALSE(cache.get(make_key("a"), value, generation));
+  cache.put(make_key("a"), 1, generation);
+  EXPECT_TRUE(cache.get(make_key("a"), value, generation));
+  EXPECT_EQ(1, value);
+
+  server_base::status_t status;
+  cache.get_status("cache", status);
+  EXPECT_EQ("1", status["cache.hits"]);
+  EXPECT_EQ("1", status["cache.misses"]);
+  EXPECT_EQ("0.5", status["cache.hit_rate"]);
+}
+
+TEST(datum_cache, invalidate) {
+  datum_cache<int> cache(4);
+  int value;
+  uint64_t generation;
+  EXPECT_FALSE(cache.get(make_key("a"), value, generation));
+  cache.put(make_key("a"), 1, generation);
+
+  cache.invalidate();
+  EXPECT_FALSE(cache.get(make_key("a"), value, generation));
+
+  // computed across an invalidation: dropped
+  uint64_t before;
+  EXPECT_FALSE(cache.get(make_key("b"), value, before));
+  cache.invalidate();
+  cache.put(make_key("b"), 2, before);
+  EXPECT_FALSE(cache.get(make_key("b"), value, generation));
+}
+
+TEST(datum_cache, clock_eviction) {
+  datum_cache<int> cache(2);
+  int value;
+  uint64_t generation;
+  cache.get(make_key("a"), value, generation);
+  cache.put(make_key("a"), 1, generation);
+  cache.get(make_key("b"), value, generation);
+  cache.put(make_key("b"), 2, generation);
+
+  // "a" is referenced and survives; "b" is evicted
+  EXPECT_TRUE(cache.get(make_key("a"), value, generation));
+  cache.get(make_key("c"), value, generation);
+  cache.put(make_key("c"), 3, generation);
+
+  EXPECT_TRUE(cache.get(make_key("a"), value, generation));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(cache.get(make_key("b"), value, generation));
+  EXPECT_TRUE(cache.get(make_key("c"), value, generation));
+  EXPECT_EQ(3, value);
+
+  server_base::status_t status;
+  cache.get_status("cache", status);
+  EXPECT_EQ("2", status["cache.size"]);
+  EXPECT_EQ("1", status["cache.evictions"]);
+}
+
+TEST(datum_cache, disabled) {
+  datum_cache<int> cache(0);
+  EXPECT_FALSE(cache.enabled());
+  int value;
+  uint64_t generation;
+  cache.get(make_key("a"), value, generation);
+  cache.put(make_key("a"), 1, generation);
+  EXPECT_FALSE(cache.get(make_key("a"), value, generation));
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
@@ -0,0 +1,76 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_LOCAL_UPDATE_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_LOCAL_UPDATE_HPP_
+
+#include <string>
+#include <msgpack.hpp>
+#include "jubatus/util/lang/noncopyable.h"
+
+#include "../common/update_log.hpp"
+#include "server_base.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+// local_update
+//   Writes the part of an unlogged update (see unlogged_update_methods)
+//   applied on this server to the update log, as a call of `method` with
+//   `params` which replays it without forwarding. Construct it before the
+//   write lock is taken and keep it until the model is updated; checkpoints
+//   wait for it as for logged requests.
+class local_update : jubatus::util::lang::noncopyable {
+ public:
+  template <class Params>
+  local_update(
+      server_base& server,
+      const std::string& method,
+      const Params& params)
+      : log_(server.update_log()) {
+    if (!log_) {
+      return;
+    }
+    log_->begin_update();
+    try {
+      msgpack::sbuffer buf;
+      msgpack::packer<msgpack::sbuffer> packer(buf);
+      packer.pack_array(2);
+      packer.pack(method);
+      packer.pack(params);
+      log_->append(buf.data(), buf.size());
+    } catch (...) {
+      log_->end_update();
+      throw;
+    }
+  }
+
+  ~local_update() {
+    if (log_) {
+      log_->end_update();
+    }
+  }
+
+ private:
+  common::update_log* log_;
+};
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_LOCAL_UPDATE_HPP_
@@ -16,6 +16,7 @@
 
 #include "linear_mixer.hpp"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <sstream>
@@ -33,8 +34,10 @@
 #include "jubatus/core/common/exception.hpp"
 #include "jubatus/core/framework/mixable.hpp"
 #include "jubatus/core/framework/stream_writer.hpp"
+#include "../../common/leader_election.hpp"
 #include "../../common/membership.hpp"
 #include "../../common/mprpc/rpc_mclient.hpp"
+#include "../../common/token_bucket.hpp"
 #include "../../common/unique_lock.hpp"
 #include "../../common/logger/logger.hpp"
 
@@ -62,6 +65,17 @@ namespace framework {
 namespace mixer {
 namespace {
 
+// largest part of the model sent by one get_model_chunk
+const size_t MODEL_CHUNK_SIZE = 1024 * 1024;
+
+// how long the model snapshot of a transfer is kept without get_model_chunk;
+// pullers wait for the bandwidth limit between chunks
+const double MODEL_SNAPSHOT_EXPIRY_SEC = 600;
+
+// (follower) how long a request_mix is outstanding when rounds are not
+// time-based
+const double MIX_REQUEST_EXPIRY_SEC = 60;
+
 class linear_communication_impl : public linear_communication {
  public:
   linear_communication_impl(
@@ -69,10 +83,14 @@ class linear_communication_impl : public linear_communication {
       const string& type,
       const string& name,
       int timeout_sec,
-      const pair<string, int>& my_id);
+      const pair<string, int>& my_id,
+      bool serving_only,
+      int mix_port,
+      uint64_t bandwidth_limit);
 
   size_t update_members();
-  jubatus::util::lang::shared_ptr<common::try_lockable> create_lock();
+  bool is_master();
+  bool call_master(const string& method) const;
   void get_diff(common::mprpc::rpc_result_object& a) const;
   void put_diff(
       const byte_buffer& a,
@@ -81,17 +99,43 @@ class linear_communication_impl : public linear_communication {
 
   bool register_active_list() const {
     common::unique_lock lk(m_);
-    register_active(*zk_.get(), type_, name_, my_id_.first, my_id_.second);
+    if (serving_only_) {
+      register_serving(*zk_.get(), type_, name_, my_id_.first, my_id_.second,
+                       my_mix_id_.second);
+    } else {
+      register_active(*zk_.get(), type_, name_, my_id_.first, my_id_.second);
+    }
     return true;
   }
 
   bool unregister_active_list() const {
     common::unique_lock lk(m_);
-    unregister_active(*zk_.get(), type_, name_, my_id_.first, my_id_.second);
+    if (serving_only_) {
+      unregister_serving(
+          *zk_.get(), type_, name_, my_id_.first, my_id_.second);
+    } else {
+      unregister_active(*zk_.get(), type_, name_, my_id_.first, my_id_.second);
+    }
     return true;
   }
 
+  void throttle(size_t bytes) const {
+    bandwidth_.consume(bytes);
+  }
+
+  void get_status(const string& prefix, server_base::status_t& status) const {
+    status[prefix + ".bandwidth_limit"] =
+        jubatus::util::lang::lexical_cast<string>(bandwidth_.rate());
+    status[prefix + ".transferred_bytes"] =
+        jubatus::util::lang::lexical_cast<string>(bandwidth_.total_bytes());
+    status[prefix + ".throttled_sec"] =
+        jubatus::util::lang::lexical_cast<string>(bandwidth_.total_wait());
+  }
+
  private:
+  std::pair<uint64_t, byte_buffer> pull_model(
+      msgpack::rpc::client& cli) const;
+
   jubatus::util::lang::shared_ptr<server::common::lock_service> zk_;
 
   // This mutex is used to protect zk operation and `servers_`.
@@ -101,7 +145,15 @@ class linear_communication_impl : public linear_communication {
   const string name_;
   const int timeout_sec_;
   const pair<string, int> my_id_;
+  // where this server serves MIX RPCs; peers are listed by MIX endpoints
+  const pair<string, int> my_mix_id_;
+  const bool serving_only_;
+  mutable common::token_bucket bandwidth_;
   vector<pair<string, int> > servers_;
+  // serving-only replicas; they receive put_diff but are not asked get_diff
+  vector<pair<string, int> > servings_;
+  // nodes hold the MIX endpoints of the candidates
+  jubatus::util::lang::shared_ptr<common::leader_election> election_;
 };
 
 linear_communication_impl::linear_communication_impl(
@@ -109,26 +161,61 @@ linear_communication_impl::linear_communication_impl(
     const string& type,
     const string& name,
     int timeout_sec,
-    const pair<string, int>& my_id)
+    const pair<string, int>& my_id,
+    bool serving_only,
+    int mix_port,
+    uint64_t bandwidth_limit)
     : zk_(zk),
       type_(type),
       name_(name),
       timeout_sec_(timeout_sec),
-      my_id_(my_id) {
-}
-
-jubatus::util::lang::shared_ptr<common::try_lockable>
-linear_communication_impl::create_lock() {
+      my_id_(my_id),
+      my_mix_id_(my_id.first, mix_port > 0 ? mix_port : my_id.second),
+      serving_only_(serving_only),
+      bandwidth_(bandwidth_limit) {
   string path;
-  common::unique_lock lk(m_);
   common::build_actor_path(path, type_, name_);
-  return jubatus::util::lang::shared_ptr<common::try_lockable>(
-      new common::lock_service_mutex(*zk_, path + "/master_lock"));
+  election_.reset(new common::leader_election(
+      *zk_, path + "/master_election",
+      common::build_loc_str(my_mix_id_.first, my_mix_id_.second)));
+}
+
+bool linear_communication_impl::is_master() {
+  // serving replicas never become master
+  return !serving_only_ && election_->is_leader();
+}
+
+bool linear_communication_impl::call_master(const string& method) const {
+  string master;
+  if (!election_->get_leader(master)) {
+    LOG(WARNING) << "no mix master found to call " << method;
+    return false;
+  }
+  string ip;
+  int port;
+  if (!common::revert(master, ip, port)) {
+    // the master has joined the election but not written its address yet;
+    // skip this round
+    LOG(WARNING) << "invalid address of mix master to call " << method
+                 << ": \"" << master << "\"";
+    return false;
+  }
+
+  try {
+    msgpack::rpc::client cli(ip, port);
+    cli.set_timeout(timeout_sec_);
+    return cli.call(method).get<bool>();
+  } catch (const std::exception& e) {
+    LOG(WARNING) << method << " failed at mix master " << ip << ":" << port
+                 << ": " << e.what();
+    return false;
+  }
 }
 
 size_t linear_communication_impl::update_members() {
   common::unique_lock lk(m_);
-  common::get_all_nodes(*zk_, type_, name_, servers_);
+  common::get_all_mix_nodes(*zk_, type_, name_, servers_);
+  common::get_all_mix_servings(*zk_, type_, name_, servings_);
 #ifndef NDEBUG
   string members = "";
   for (size_t i = 0; i < servers_.size(); ++i) {
@@ -145,7 +232,8 @@ std::pair<uint64_t, byte_buffer> linear_communication_impl::get_model() {
     common::unique_lock lk(m_);
 
     // use time as pseudo random number(it should enough)
-    if (servers_.empty() || servers_.size() == 1) {
+    // (serving replicas are not in servers_, so a single node is another one)
+    if (servers_.empty() || (servers_.size() == 1 && !serving_only_)) {
       return make_pair(0, byte_buffer());
     }
 
@@ -153,18 +241,16 @@ std::pair<uint64_t, byte_buffer> linear_communication_impl::get_model() {
     const size_t target = now.usec % servers_.size();
     const string server_ip = servers_[target].first;
     const int server_port = servers_[target].second;
-    if (server_ip == my_id_.first && server_port == my_id_.second) {
+    if (server_ip == my_mix_id_.first && server_port == my_mix_id_.second) {
       // avoid get model from itself
       continue;
     }
 
     msgpack::rpc::client cli(server_ip, server_port);
     cli.set_timeout(timeout_sec_);
-    msgpack::rpc::future result(cli.call("get_model", 0));
 
     try {
-      const std::pair<uint64_t, byte_buffer> got_model_data(
-          result.get<std::pair<uint64_t, byte_buffer> >());
+      const std::pair<uint64_t, byte_buffer> got_model_data(pull_model(cli));
       LOG(INFO) << "got model(serialized data) "
                 << got_model_data.second.size()
                 << " from server[" << server_ip << ":" << server_port << "] ";
@@ -177,6 +263,44 @@ std::pair<uint64_t, byte_buffer> linear_communication_impl::get_model() {
   }
 }
 
+// fetches the model chunk by chunk so that a large model does not occupy
+// the sender for a long single RPC; servers without get_model_chunk send
+// the whole model by get_model
+std::pair<uint64_t, byte_buffer> linear_communication_impl::pull_model(
+    msgpack::rpc::client& cli) const {
+  model_chunk chunk;
+  try {
+    chunk = cli.call("get_model_chunk", 0, 0).get<model_chunk>();
+  } catch (const msgpack::rpc::no_method_error&) {
+    const std::pair<uint64_t, byte_buffer> model =
+        cli.call("get_model", 0).get<std::pair<uint64_t, byte_buffer> >();
+    throttle(model.second.size());
+    return model;
+  }
+
+  vector<char> model;
+  model.reserve(chunk.total_size);
+  while (true) {
+    model.insert(model.end(),
+                 chunk.data.ptr(), chunk.data.ptr() + chunk.data.size());
+    if (model.size() >= chunk.total_size || chunk.data.size() == 0) {
+      break;
+    }
+    // the sender replies at once; wait here before asking the next chunk
+    throttle(chunk.data.size());
+    const uint64_t snapshot = chunk.snapshot;
+    chunk = cli.call("get_model_chunk", snapshot,
+                     static_cast<uint64_t>(model.size())).get<model_chunk>();
+  }
+  if (model.size() != chunk.total_size) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "get_model_chunk returned a truncated model"));
+  }
+  return make_pair(chunk.protocol_version,
+                   model.empty() ? byte_buffer() :
+                   byte_buffer(&model[0], model.size()));
+}
+
 void linear_communication_impl::get_diff(
     common::mprpc::rpc_result_object& result) const {
   // TODO(beam2d): to be replaced to new client with socket connection pooling
@@ -190,22 +314,65 @@ void linear_communication_impl::get_diff(
   }
 #endif
   result = client.call("get_diff", 0);
+  lk.unlock();
+
+  // the senders reply at once; pace the next transfers instead, so that
+  // waiting never counts against their timeout
+  size_t bytes = 0;
+  for (size_t i = 0; i < result.response.size(); ++i) {
+    if (!result.response[i].has_error() &&
+        result.response[i]().type == msgpack::type::RAW) {
+      bytes += result.response[i]().via.raw.size;
+    }
+  }
+  throttle(bytes);
 }
 
 void linear_communication_impl::put_diff(
     const byte_buffer& mixed,
     common::mprpc::rpc_result_object& result) const {
   common::unique_lock lk(m_);
+  vector<pair<string, int> > targets(servers_);
+  targets.insert(targets.end(), servings_.begin(), servings_.end());
   // TODO(beam2d): to be replaced to new client with socket connection pooling
-  server::common::mprpc::rpc_mclient client(servers_, timeout_sec_);
+  server::common::mprpc::rpc_mclient client(targets, timeout_sec_);
 #ifndef NDEBUG
-  for (size_t i = 0; i < servers_.size(); i++) {
-    DLOG(INFO) << "put diff to " << servers_[i].first << ":"
-               << servers_[i].second;
+  for (size_t i = 0; i < targets.size(); i++) {
+    DLOG(INFO) << "put diff to " << targets[i].first << ":"
+               << targets[i].second;
   }
 #endif
   lk.unlock();  // unlock for re-entrant lock acquisition over RPC
-  result = client.call("put_diff", mixed);
+  if (!bandwidth_.is_limited()) {
+    result = client.call("put_diff", mixed);
+    return;
+  }
+
+  // send to one server at a time as tokens become available
+  result = common::mprpc::rpc_result_object();
+  for (size_t i = 0; i < targets.size(); ++i) {
+    throttle(mixed.size());
+    const clock_time start = get_clock_time();
+    try {
+      common::mprpc::rpc_mclient one(
+          vector<pair<string, int> >(1, targets[i]), timeout_sec_);
+      common::mprpc::rpc_result_object r = one.call("put_diff", mixed);
+      result.response.insert(
+          result.response.end(), r.response.begin(), r.response.end());
+      result.error.insert(result.error.end(), r.error.begin(), r.error.end());
+    } catch (...) {
+      result.error.push_back(common::mprpc::rpc_error(
+          targets[i].first, targets[i].second,
+          jubatus::core::common::exception::get_current_exception()));
+    }
+    result.elapsed.push_back(
+        static_cast<double>(get_clock_time() - start));
+  }
+  if (result.response.empty()) {
+    throw JUBATUS_EXCEPTION(common::mprpc::rpc_no_result()
+        << common::mprpc::error_multi_rpc(result.error)
+        << common::mprpc::error_method("put_diff"));
+  }
 }
 
 string server_list(const vector<pair<string, uint16_t> >& servers) {
@@ -219,6 +386,22 @@ string server_list(const vector<pair<string, uint16_t> >& servers) {
   return out.str();
 }
 
+string peer_name(const common::mprpc::rpc_error& peer) {
+  return peer.host() + "_"
+      + jubatus::util::lang::lexical_cast<string>(peer.port());
+}
+
+void record_peers(
+    const common::mprpc::rpc_result_object& result,
+    const string& phase,
+    mix_round& round) {
+  for (size_t i = 0; i < result.elapsed.size() && i < result.error.size();
+       ++i) {
+    round.add_peer_latency(peer_name(result.error[i]), phase,
+                           result.elapsed[i]);
+  }
+}
+
 string version_list(const std::vector<version>& versions)  {
   stringstream ss;
   ss << "[";
@@ -240,9 +423,14 @@ linear_communication::create(
     const string& type,
     const string& name,
     int timeout_sec,
-    const pair<string, int>& my_id) {
+    const pair<string, int>& my_id,
+    bool serving_only,
+    int mix_port,
+    uint64_t bandwidth_limit) {
   return jubatus::util::lang::shared_ptr<linear_communication_impl>(
-      new linear_communication_impl(zk, type, name, timeout_sec, my_id));
+      new linear_communication_impl(
+          zk, type, name, timeout_sec, my_id, serving_only,
+          mix_port, bandwidth_limit));
 }
 
 linear_mixer::linear_mixer(
@@ -250,17 +438,22 @@ linear_mixer::linear_mixer(
     jubatus::util::concurrent::rw_mutex& mutex,
     unsigned int count_threshold,
     unsigned int tick_threshold,
-    uint64_t protocol_version)
+    uint64_t protocol_version,
+    bool serving_only)
     : communication_(communication),
-      count_threshold_(count_threshold),
-      tick_threshold_(tick_threshold),
+      scheduler_(count_threshold, tick_threshold),
       protocol_version_(protocol_version),
+      serving_only_(serving_only),
       counter_(0),
       ticktime_(get_clock_time()),
       is_running_(false),
       is_obsolete_(true),
+      mix_requested_(false),
+      mix_request_sent_(false),
+      mix_request_time_(get_clock_time()),
       t_(jubatus::util::lang::bind(&linear_mixer::stabilizer_loop, this)),
-      model_mutex_(mutex) {
+      model_mutex_(mutex),
+      snapshot_id_(0) {
 }
 
 linear_mixer::~linear_mixer() {
@@ -273,7 +466,7 @@ void linear_mixer::register_api(rpc_server_t& server) {
       jubatus::util::lang::bind(
           &linear_mixer::get_diff, this, jubatus::util::lang::_1));
 
-  server.add<int(byte_buffer)>(
+  server.add<int(msgpack::object)>(
       "put_diff",
       jubatus::util::lang::bind(&linear_mixer::put_diff,
                                 this,
@@ -283,16 +476,31 @@ void linear_mixer::register_api(rpc_server_t& server) {
       jubatus::util::lang::bind(&linear_mixer::get_model,
                                 this,
                                 jubatus::util::lang::_1));
+  server.add<model_chunk(uint64_t, uint64_t)>(  // NOLINT
+      "get_model_chunk",
+      jubatus::util::lang::bind(&linear_mixer::get_model_chunk,
+                                this,
+                                jubatus::util::lang::_1,
+                                jubatus::util::lang::_2));
   server.add<bool(void)>(  // NOLINT
       "do_mix",
       jubatus::util::lang::bind(&linear_mixer::do_mix,
                                 this));
+  server.add<bool(void)>(  // NOLINT
+      "request_mix",
+      jubatus::util::lang::bind(&linear_mixer::request_mix,
+                                this));
 }
 
 void linear_mixer::set_driver(core::driver::driver_base* driver) {
   driver_ = driver;
 }
 
+void linear_mixer::set_scheduler(const mix_scheduler& scheduler) {
+  scoped_lock lk(m_);
+  scheduler_ = scheduler;
+}
+
 void linear_mixer::start() {
   scoped_lock lk(m_);
   if (!is_running_) {
@@ -311,21 +519,25 @@ void linear_mixer::stop() {
 }
 
 bool linear_mixer::do_mix() {
+  if (serving_only_) {
+    LOG(WARNING) << "serving only server does not start mix";
+    return false;
+  }
   {
     common::unique_lock lk(m_);
+    const clock_time now = get_clock_time();
+    scheduler_.observe(counter_, static_cast<double>(now - ticktime_));
     counter_ = 0;
-    ticktime_ = get_clock_time();
+    ticktime_ = now;
   }
   try {
-    LOG(INFO) << "forced to mix by user RPC";
-    jubatus::util::lang::shared_ptr<common::try_lockable> zklock =
-        communication_->create_lock();
-    while (true) {
-      if (zklock->try_lock()) {
-        mix();
-        return true;
-      }
+    if (!communication_->is_master()) {
+      LOG(INFO) << "forced to mix by user RPC, asking the mix master";
+      return communication_->call_master("do_mix");
     }
+    LOG(INFO) << "forced to mix by user RPC";
+    mix();
+    return true;
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(ERROR) << "exception in manual mix: "
                << e.diagnostic_information(true);
@@ -337,11 +549,18 @@ bool linear_mixer::do_mix() {
   return false;
 }
 
+bool linear_mixer::request_mix() {
+  scoped_lock lk(m_);
+  mix_requested_ = true;
+  c_.notify();
+  return true;
+}
+
 void linear_mixer::updated() {
   scoped_lock lk(m_);
   ++counter_;
-  if (counter_ >= count_threshold_
-      || get_clock_time() - ticktime_ > tick_threshold_) {
+  if (scheduler_.should_mix(
+          counter_, static_cast<double>(get_clock_time() - ticktime_))) {
     c_.notify();  // TODO(beam2d): need sync here?
   }
 }
@@ -357,12 +576,15 @@ void linear_mixer::get_status(server_base::status_t& status) const {
       jubatus::util::lang::lexical_cast<string>(is_obsolete_);
   status["linear_mixer.is_running"] =
       jubatus::util::lang::lexical_cast<string>(is_running_);
+  status["linear_mixer.serving_only"] =
+      jubatus::util::lang::lexical_cast<string>(serving_only_);
+  scheduler_.get_status("linear_mixer", status);
+  stats_.get_status("linear_mixer", status);
+  communication_->get_status("linear_mixer", status);
 }
 
 void linear_mixer::stabilizer_loop() {
   while (true) {
-    jubatus::util::lang::shared_ptr<common::try_lockable> zklock =
-        communication_->create_lock();
     try {
       common::unique_lock lk(m_);
       if (!is_running_) {
@@ -377,50 +599,75 @@ void linear_mixer::stabilizer_loop() {
         return;
       }
 
-      const clock_time new_ticktime = get_clock_time();
-      if (((0 < count_threshold_ && counter_ >= count_threshold_)
-          || (0 < tick_threshold_
-              && new_ticktime - ticktime_ > tick_threshold_))
-          && (0 < counter_)) {
-        lk.unlock();  // Release the lock during trying to get zk lock.
-        if (zklock->try_lock()) {
-          LOG(INFO) << "got ZooKeeper lock, starting mix";
+      if (is_obsolete_) {
+        lk.unlock();
 
-          lk.lock();
-          counter_ = 0;
-          ticktime_ = new_ticktime;
-          lk.unlock();
+        LOG(INFO) << "start to get model from other server";
+        update_model();
 
-          mix();
+        const bool master = communication_->is_master();
+        lk.lock();
+        if (!is_running_) {
+          return;
+        }
+        if (!master) {
+          // the pulled model is the latest one unless a round was running;
+          // then the next put_diff finds versions mismatched and we pull
+          // the model again
+          if (is_obsolete_) {
+            is_obsolete_ = false;
+            lk.unlock();
+            communication_->register_active_list();
+          }
+          continue;
+        }
+        lk.unlock();
 
-          // print versions of mixables
-          LOG(INFO) << ".... mix done. versions"
-                    << version_list(driver_->get_versions());
+        mix();
+        continue;
+      }
 
-          lk.lock();
-        }
+      const clock_time new_ticktime = get_clock_time();
+      const double elapsed = static_cast<double>(new_ticktime - ticktime_);
+      if (serving_only_ ||
+          !(mix_requested_ ||
+            (scheduler_.should_mix(counter_, elapsed) && (0 < counter_)))) {
+        continue;
       }
 
-      if (is_obsolete_) {
-        lk.unlock();  // Release the lock during trying to get zk lock.
-        if (zklock->try_lock()) {
-          lk.lock();
-          if (is_obsolete_) {
-            lk.unlock();
+      lk.unlock();  // Release the lock while checking the mastership.
+      if (communication_->is_master()) {
+        LOG(INFO) << "starting mix as mix master";
 
-            LOG(INFO) << "start to get model from other server";
-            update_model();
+        lk.lock();
+        scheduler_.observe(counter_, elapsed);
+        counter_ = 0;
+        ticktime_ = new_ticktime;
+        mix_requested_ = false;
+        lk.unlock();
 
-            lk.lock();
-            if (!is_running_) {
-              return;
-            }
-            lk.unlock();
+        mix();
 
-            mix();
-          }
-        } else {
-          LOG(INFO) << "failed to get ZooKeeper lock, waiting";
+        // print versions of mixables
+        LOG(INFO) << ".... mix done. versions"
+                  << version_list(driver_->get_versions());
+      } else {
+        lk.lock();
+        // once per round; put_diff from the master clears the flag, and it
+        // expires after the mix interval in case the round never reaches us
+        const double expiry = scheduler_.interval() > 0 ?
+            scheduler_.interval() : MIX_REQUEST_EXPIRY_SEC;
+        if (mix_request_sent_ &&
+            static_cast<double>(new_ticktime - mix_request_time_) < expiry) {
+          continue;
+        }
+        mix_request_sent_ = true;
+        mix_request_time_ = new_ticktime;
+        lk.unlock();
+
+        if (!communication_->call_master("request_mix")) {
+          lk.lock();
+          mix_request_sent_ = false;
         }
       }
     } catch (const jubatus::core::common::exception::jubatus_exception& e) {
@@ -435,12 +682,15 @@ void linear_mixer::stabilizer_loop() {
 }
 
 void linear_mixer::mix() {
-  // this method is thread safe
+  // this method is thread safe; rounds do not overlap, or they would
+  // collect the same diffs and put them twice
+  scoped_lock lk_mix(mix_m_);
   using jubatus::util::system::time::clock_time;
   using jubatus::util::system::time::get_clock_time;
 
   const clock_time start = get_clock_time();
   size_t s = 0;
+  mix_round round;
 
   const size_t servers_size = communication_->update_members();
   if (servers_size == 0) {
@@ -462,9 +712,14 @@ void linear_mixer::mix() {
       core::framework::diff_object diff;
       {
         // get_diff() and mix() each diffs
+        clock_time phase_start = get_clock_time();
         communication_->get_diff(diff_result);
+        round.add_phase("get_diff",
+            static_cast<double>(get_clock_time() - phase_start));
+        record_peers(diff_result, "get_diff", round);
 
         // convert from rpc_result_object to diff_object
+        phase_start = get_clock_time();
         typedef pair<string, uint16_t> server;
         vector<server> successes;
         for (size_t i = 0; i < diff_result.response.size(); ++i) {
@@ -475,6 +730,7 @@ void linear_mixer::mix() {
                          << diff_result.error[i].host() << ":"
                          << diff_result.error[i].port()
                          << " : " << error_text;
+            round.add_failed_peer(peer_name(diff_result.error[i]));
             continue;
           }
 
@@ -482,9 +738,11 @@ void linear_mixer::mix() {
           if (res.type != msgpack::type::RAW) {
             continue;
           }
+          round.add_bytes_in(res.via.raw.size);
 
+          // refers to diff_result, which outlives the fold
           msgpack::unpacked msg;
-          msgpack::unpack(&msg, res.via.raw.ptr, res.via.raw.size);
+          unpack_diff(res, msg);
           msgpack::object o = msg.get();
 
           diffs++;
@@ -497,9 +755,12 @@ void linear_mixer::mix() {
           successes.push_back(make_pair(
                 diff_result.error[i].host(), diff_result.error[i].port()));
         }
+        round.add_phase("fold",
+            static_cast<double>(get_clock_time() - phase_start));
 
         if (!diff) {  // all get_diffs fail
           LOG(WARNING) << "mix fails (all get_diffs fail)";
+          stats_.add_round(round);
           return;
         }
 
@@ -510,6 +771,7 @@ void linear_mixer::mix() {
 
       { // put mixed data
         // convert diff_object to binary
+        clock_time phase_start = get_clock_time();
         msgpack::sbuffer sbuf;
         stream_writer<msgpack::sbuffer> st(sbuf);
         core::framework::jubatus_packer jp(st);
@@ -517,10 +779,16 @@ void linear_mixer::mix() {
         diff->convert_binary(pk);
 
         byte_buffer mixed(sbuf.data(), sbuf.size());
+        round.add_phase("serialize",
+            static_cast<double>(get_clock_time() - phase_start));
 
         // do put_diff
+        phase_start = get_clock_time();
         common::mprpc::rpc_result_object result;
         communication_->put_diff(mixed, result);
+        round.add_phase("put_diff",
+            static_cast<double>(get_clock_time() - phase_start));
+        record_peers(result, "put_diff", round);
 
         {  // log output
           s += sbuf.size();
@@ -535,10 +803,12 @@ void linear_mixer::mix() {
                            << result.error[i].host() << ":"
                            << result.error[i].port()
                            << " : " << error_text;
+              round.add_failed_peer(peer_name(result.error[i]));
               continue;
             }
             successes.push_back(
               make_pair(result.error[i].host(), result.error[i].port()));
+            round.add_bytes_out(sbuf.size());
           }
           LOG(INFO) << "success to put_diff to ["
                     << server_list(successes) << "]";
@@ -552,6 +822,12 @@ void linear_mixer::mix() {
 
   {
     const clock_time finish = get_clock_time();
+    round.add_phase("total", static_cast<double>(finish - start));
+    stats_.add_round(round);
+    {
+      scoped_lock lk(m_);
+      scheduler_.mixed(static_cast<double>(finish - start), round.bytes());
+    }
     LOG(INFO) << "mixed with " << servers_size << " servers in "
               << static_cast<double>(finish - start) << " secs, " << s
               << " bytes (serialized data) has been put.";
@@ -560,25 +836,85 @@ void linear_mixer::mix() {
 
 
 byte_buffer linear_mixer::get_diff(int a) {
-  scoped_rlock lk_read(model_mutex_);
-  scoped_lock lk(m_);  // Prevent `stabilizer_loop` to awake from `wait`.
+  msgpack::sbuffer sbuf;
+  {
+    scoped_rlock lk_read(model_mutex_);
+    scoped_lock lk(m_);  // Prevent `stabilizer_loop` to awake from `wait`.
+
+    core::framework::linear_mixable* mixable =
+      dynamic_cast<core::framework::linear_mixable*>(driver_->get_mixable());
+    if (!mixable) {
+      // nothing to mix
+      throw JUBATUS_EXCEPTION(core::common::config_not_set());
+    }
 
-  core::framework::linear_mixable* mixable =
-    dynamic_cast<core::framework::linear_mixable*>(driver_->get_mixable());
-  if (!mixable) {
-    throw JUBATUS_EXCEPTION(core::common::config_not_set());  // nothing to mix
+    stream_writer<msgpack::sbuffer> st(sbuf);
+    core::framework::jubatus_packer jp(st);
+    packer pk(jp);
+    mixable->get_diff(pk);
   }
-
-  msgpack::sbuffer sbuf;
-  stream_writer<msgpack::sbuffer> st(sbuf);
-  core::framework::jubatus_packer jp(st);
-  packer pk(jp);
-  mixable->get_diff(pk);
+  // the master waits for the bandwidth after receiving it
   byte_buffer bytes(sbuf.data(), sbuf.size());
   return bytes;
 }
 
 std::pair<uint64_t, byte_buffer> linear_mixer::get_model(int a) const {
+  return std::make_pair(protocol_version_, pack_model());
+}
+
+model_chunk linear_mixer::get_model_chunk(uint64_t snapshot, uint64_t offset) {
+  if (snapshot == 0) {
+    // a new transfer: serialize the model once and send it by parts
+    const byte_buffer packed = pack_model();
+    scoped_lock lk(snapshot_m_);
+    snapshot = ++snapshot_id_;
+    snapshots_.insert(make_pair(
+        snapshot, model_snapshot(packed, get_clock_time())));
+  }
+
+  scoped_lock lk(snapshot_m_);
+  const clock_time now = get_clock_time();
+  // drop the snapshots of transfers given up by their pullers
+  for (map<uint64_t, model_snapshot>::iterator it = snapshots_.begin();
+       it != snapshots_.end(); ) {
+    if (static_cast<double>(now - it->second.last_access) >
+        MODEL_SNAPSHOT_EXPIRY_SEC) {
+      snapshots_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  map<uint64_t, model_snapshot>::iterator it = snapshots_.find(snapshot);
+  if (it == snapshots_.end()) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "model snapshot expired: " +
+        jubatus::util::lang::lexical_cast<string>(snapshot)));
+  }
+  const byte_buffer& data = it->second.data;
+  if (offset > data.size()) {
+    throw msgpack::rpc::argument_error();
+  }
+
+  const size_t size = std::min(
+      MODEL_CHUNK_SIZE, static_cast<size_t>(data.size() - offset));
+  model_chunk chunk;
+  chunk.protocol_version = protocol_version_;
+  chunk.snapshot = snapshot;
+  chunk.total_size = data.size();
+  if (size > 0) {
+    chunk.data = byte_buffer(data.ptr() + offset, size);
+  }
+  if (offset + size == data.size()) {
+    // the last chunk; release the snapshot
+    snapshots_.erase(it);
+  } else {
+    it->second.last_access = now;
+  }
+  return chunk;
+}
+
+byte_buffer linear_mixer::pack_model() const {
   scoped_rlock lk_read(model_mutex_);
   scoped_lock lk(m_);  // Prevent `stabilizer_loop` to awake from `wait`.
 
@@ -591,8 +927,7 @@ std::pair<uint64_t, byte_buffer> linear_mixer::get_model(int a) const {
   LOG(INFO) << "sending learning-model. size = "
             << jubatus::util::lang::lexical_cast<string>(packed.size());
 
-  return std::make_pair(
-      protocol_version_, byte_buffer(packed.data(), packed.size()));
+  return byte_buffer(packed.data(), packed.size());
 }
 
 void linear_mixer::update_model() {
@@ -627,29 +962,37 @@ void linear_mixer::update_model() {
   msgpack::unpack(&unpacked, model_serialized.ptr(), model_serialized.size());
   {
     scoped_wlock lk_write(model_mutex_);
+    const clock_time locked = get_clock_time();
     driver_->unpack(unpacked.get());
+    event_model_mixed();
+    stats_.add_event("update_model_lock_hold",
+        static_cast<double>(get_clock_time() - locked));
   }
 }
 
-int linear_mixer::put_diff(const byte_buffer& diff) {
+int linear_mixer::put_diff(const msgpack::object& diff) {
+  // the diff is read in place from the request instead of being copied
+  // into a byte_buffer
+  msgpack::unpacked msg;
+  unpack_diff(diff, msg);
+
   scoped_wlock lk_write(model_mutex_);
+  const clock_time locked = get_clock_time();
 
   // Prevent `stabilizer_loop` to awake from `wait` and protect
   // status values.
   scoped_lock lk(m_);
 
-  msgpack::unpacked msg;
-  msgpack::unpack(&msg, diff.ptr(), diff.size());
-
   core::framework::linear_mixable* mixable =
     dynamic_cast<core::framework::linear_mixable*>(driver_->get_mixable());
   if (!mixable) {
     throw JUBATUS_EXCEPTION(core::common::config_not_set());  // nothing to mix
   }
 
-  const size_t total_size = diff.size();
+  const size_t total_size = diff.via.raw.size;
   const bool not_obsolete =
       mixable->put_diff(mixable->convert_diff_object(msg.get()));
+  event_model_mixed();
 
   // print versions of mixables
   const string versions = version_list(driver_->get_versions());
@@ -679,9 +1022,14 @@ int linear_mixer::put_diff(const byte_buffer& diff) {
     }
   }
   is_obsolete_ = !not_obsolete;
+  mix_request_sent_ = false;
 
+  const clock_time now = get_clock_time();
+  scheduler_.observe(counter_, static_cast<double>(now - ticktime_));
   counter_ = 0;
-  ticktime_ = get_clock_time();
+  ticktime_ = now;
+  stats_.add_event("put_diff_lock_hold",
+      static_cast<double>(ticktime_ - locked));
   return 0;
 }
 
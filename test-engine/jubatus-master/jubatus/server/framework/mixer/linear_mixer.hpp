@@ -17,9 +17,11 @@
 #ifndef JUBATUS_SERVER_FRAMEWORK_MIXER_LINEAR_MIXER_HPP_
 #define JUBATUS_SERVER_FRAMEWORK_MIXER_LINEAR_MIXER_HPP_
 
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
+#include <msgpack.hpp>
 #include "jubatus/util/concurrent/condition.h"
 #include "jubatus/util/concurrent/mutex.h"
 #include "jubatus/util/concurrent/thread.h"
@@ -28,6 +30,8 @@
 #include "jubatus/core/common/byte_buffer.hpp"
 #include "../../common/lock_service.hpp"
 #include "../../common/mprpc/rpc_mclient.hpp"
+#include "mix_scheduler.hpp"
+#include "mix_statistics.hpp"
 #include "mixer.hpp"
 
 namespace jubatus {
@@ -35,6 +39,23 @@ namespace server {
 namespace framework {
 namespace mixer {
 
+// a part of the serialized model sent by get_model_chunk
+struct model_chunk {
+  model_chunk()
+      : protocol_version(0),
+        snapshot(0),
+        total_size(0) {
+  }
+
+  uint64_t protocol_version;
+  // identifies the serialized model the chunk is cut from
+  uint64_t snapshot;
+  uint64_t total_size;
+  core::common::byte_buffer data;
+
+  MSGPACK_DEFINE(protocol_version, snapshot, total_size, data);
+};
+
 class linear_communication {
  public:
   virtual ~linear_communication() {
@@ -45,7 +66,10 @@ class linear_communication {
       const std::string& type,
       const std::string& name,
       int timeout_sec,
-      const std::pair<std::string, int>& my_id);
+      const std::pair<std::string, int>& my_id,
+      bool serving_only = false,
+      int mix_port = 0,
+      uint64_t bandwidth_limit = 0);
 
   // Call update_members once before using get_diff and put_diff
   virtual size_t update_members() = 0;
@@ -53,10 +77,12 @@ class linear_communication {
   // Get random one model from another server
   virtual std::pair<uint64_t, core::common::byte_buffer> get_model() = 0;
 
-  // We use shared_ptr instead of auto_ptr/unique_ptr
-  // because in C++03 specification limits.
-  virtual jubatus::util::lang::shared_ptr<common::try_lockable> create_lock()
-      = 0;
+  // Whether this server is the mix master; the mastership is kept across
+  // rounds, and checking it makes no ZooKeeper writes
+  virtual bool is_master() = 0;
+
+  // Calls `method` returning bool on the mix master
+  virtual bool call_master(const std::string& method) const = 0;
 
   // it can throw common::mprpc exception
   virtual void get_diff(common::mprpc::rpc_result_object& result) const = 0;
@@ -67,6 +93,16 @@ class linear_communication {
 
   virtual bool register_active_list() const = 0;
   virtual bool unregister_active_list() const = 0;
+
+  // blocks until `bytes` may be transferred within the MIX bandwidth
+  // limit; called by the side which starts a transfer, never in a reply
+  virtual void throttle(size_t bytes) const {
+  }
+
+  virtual void get_status(
+      const std::string& prefix,
+      server_base::status_t& status) const {
+  }
 };
 
 class linear_mixer : public mixer {
@@ -76,11 +112,13 @@ class linear_mixer : public mixer {
       jubatus::util::concurrent::rw_mutex& mutex,
       unsigned int count_threshold,
       unsigned int tick_threshold,
-      uint64_t protocol_version);
+      uint64_t protocol_version,
+      bool serving_only = false);
   ~linear_mixer();
 
   void register_api(rpc_server_t& server);
   void set_driver(core::driver::driver_base*);
+  void set_scheduler(const mix_scheduler& scheduler);
 
   void start();
   void stop();
@@ -103,13 +141,17 @@ class linear_mixer : public mixer {
   void clear();
 
   core::common::byte_buffer get_diff(int a);
-  int put_diff(const core::common::byte_buffer&);
+  bool request_mix();
+  int put_diff(const msgpack::object& diff);
   std::pair<uint64_t, core::common::byte_buffer> get_model(int d) const;
+  model_chunk get_model_chunk(uint64_t snapshot, uint64_t offset);
+  core::common::byte_buffer pack_model() const;
 
   jubatus::util::lang::shared_ptr<linear_communication> communication_;
-  unsigned int count_threshold_;
-  unsigned int tick_threshold_;
+  mix_scheduler scheduler_;
   uint64_t protocol_version_;
+  // receives put_diff and pulls the model, but never becomes mix master
+  const bool serving_only_;
 
   unsigned int counter_;
   jubatus::util::system::time::clock_time ticktime_;
@@ -119,11 +161,24 @@ class linear_mixer : public mixer {
   // true means the model is delayed from cluster
   bool is_obsolete_;
 
+  // (master) a follower asked for a round
+  bool mix_requested_;
+  // (follower) asked the master for a round, not yet mixed; asked again
+  // once the request has expired, in case the master died or our
+  // put_diff of that round failed
+  bool mix_request_sent_;
+  jubatus::util::system::time::clock_time mix_request_time_;
+
   jubatus::util::concurrent::thread t_;
 
+  // Held while a round runs, so that rounds started by `stabilizer_loop`
+  // and by do_mix RPCs run one at a time; taken before `model_mutex_`.
+  jubatus::util::concurrent::mutex mix_m_;
+
   // This mutex is used to protect status values (`counter_`, `ticktime_`,
-  // `is_running_`, `is_obsolete_`) and to prevent `stabilizer_loop` while
-  // MIX-RPC is being called.
+  // `is_running_`, `is_obsolete_`, `mix_requested_`, `mix_request_sent_`,
+  // `mix_request_time_`, `scheduler_`) and to prevent
+  // `stabilizer_loop` while MIX-RPC is being called.
   mutable jubatus::util::concurrent::mutex m_;
 
   // This mutex is used to protect model.
@@ -134,6 +189,27 @@ class linear_mixer : public mixer {
   jubatus::util::concurrent::condition c_;
 
   core::driver::driver_base* driver_;
+
+  // phase-level timings and byte counts of recent MIX rounds
+  mix_statistics stats_;
+
+  // serialized model being sent by get_model_chunk to one puller
+  struct model_snapshot {
+    model_snapshot(
+        const core::common::byte_buffer& d,
+        const jubatus::util::system::time::clock_time& t)
+        : data(d),
+          last_access(t) {
+    }
+
+    core::common::byte_buffer data;
+    jubatus::util::system::time::clock_time last_access;
+  };
+
+  jubatus::util::concurrent::mutex snapshot_m_;
+  uint64_t snapshot_id_;
+  // by transfer (snapshot id); removed after the last chunk or when idle
+  std::map<uint64_t, model_snapshot> snapshots_;
 };
 
 }  // namespace mixer
@@ -64,10 +64,19 @@ common::mprpc::rpc_response_t make_response(const string& s) {
 
 class linear_communication_stub : public linear_communication {
  public:
+  linear_communication_stub()
+      : is_master_(true) {
+  }
+
   size_t update_members() { return 4; }
 
-  jubatus::util::lang::shared_ptr<common::try_lockable> create_lock() {
-    return jubatus::util::lang::shared_ptr<common::try_lockable>();
+  bool is_master() {
+    return is_master_;
+  }
+
+  bool call_master(const string& method) const {
+    master_calls_.push_back(method);
+    return true;
   }
 
   void get_diff(common::mprpc::rpc_result_object& result) const {
@@ -107,6 +116,9 @@ class linear_communication_stub : public linear_communication {
     return true;
   }
 
+  bool is_master_;
+  mutable vector<string> master_calls_;
+
  private:
   mutable vector<string> mixed_;
 };
@@ -168,6 +180,33 @@ TEST(linear_mixer, mix_order) {
   EXPECT_EQ("(4+(3+(2+1)))", mixed[0]);
 }
 
+TEST(linear_mixer, serving_only_does_not_mix) {
+  shared_ptr<linear_communication_stub> com(new linear_communication_stub);
+  jubatus::util::concurrent::rw_mutex mutex;
+  linear_mixer m(com, mutex, 1, 1, 1, true);
+
+  my_string_driver s;
+  m.set_driver(&s);
+
+  EXPECT_FALSE(m.do_mix());
+  EXPECT_TRUE(com->get_mixed().empty());
+}
+
+TEST(linear_mixer, follower_forwards_do_mix) {
+  shared_ptr<linear_communication_stub> com(new linear_communication_stub);
+  com->is_master_ = false;
+  jubatus::util::concurrent::rw_mutex mutex;
+  linear_mixer m(com, mutex, 1, 1, 1);
+
+  my_string_driver s;
+  m.set_driver(&s);
+
+  EXPECT_TRUE(m.do_mix());
+  EXPECT_TRUE(com->get_mixed().empty());
+  ASSERT_EQ(1u, com->master_calls_.size());
+  EXPECT_EQ("do_mix", com->master_calls_[0]);
+}
+
 TEST(linear_mixer, destruct_running_mixer) {
   shared_ptr<linear_communication_stub> com(new linear_communication_stub);
   jubatus::util::concurrent::rw_mutex mutex;
@@ -0,0 +1,139 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "mix_scheduler.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "jubatus/util/lang/cast.h"
+
+using std::string;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace mixer {
+
+namespace {
+
+// weight of the latest sample in the update rate
+const double RATE_WEIGHT = 0.5;
+
+// a round may take at most 1 / DURATION_FACTOR of the time
+const double DURATION_FACTOR = 2.0;
+
+}  // namespace
+
+mix_scheduler::mix_scheduler(
+    unsigned int count_threshold,
+    unsigned int tick_threshold,
+    unsigned int target_staleness,
+    unsigned int network_budget,
+    unsigned int min_interval)
+    : count_threshold_(count_threshold),
+      tick_threshold_(tick_threshold),
+      target_staleness_(target_staleness),
+      network_budget_(network_budget),
+      min_interval_(min_interval),
+      update_rate_(0),
+      last_duration_(0),
+      last_bytes_(0),
+      floor_(0),
+      interval_(tick_threshold) {
+  if (is_adaptive()) {
+    update_interval();
+  }
+}
+
+bool mix_scheduler::should_mix(unsigned int counter, double elapsed) const {
+  if (!is_adaptive()) {
+    return (0 < count_threshold_ && counter >= count_threshold_)
+        || (0 < tick_threshold_ && elapsed > tick_threshold_);
+  }
+
+  if (elapsed < floor_) {
+    return false;
+  }
+  return (0 < target_staleness_ && counter >= target_staleness_)
+      || (0 < interval_ && elapsed >= interval_);
+}
+
+void mix_scheduler::observe(unsigned int updates, double elapsed) {
+  if (elapsed <= 0) {
+    return;
+  }
+  const double rate = updates / elapsed;
+  if (update_rate_ == 0) {
+    update_rate_ = rate;
+  } else {
+    update_rate_ = RATE_WEIGHT * rate + (1 - RATE_WEIGHT) * update_rate_;
+  }
+  if (is_adaptive()) {
+    update_interval();
+  }
+}
+
+void mix_scheduler::mixed(double duration, uint64_t bytes) {
+  last_duration_ = duration;
+  last_bytes_ = bytes;
+  if (is_adaptive()) {
+    update_interval();
+  }
+}
+
+void mix_scheduler::update_interval() {
+  floor_ = std::max(min_interval_, DURATION_FACTOR * last_duration_);
+  if (0 < network_budget_) {
+    floor_ = std::max(floor_,
+        static_cast<double>(last_bytes_) / network_budget_);
+  }
+
+  double interval = floor_;
+  if (0 < target_staleness_) {
+    // time to make target_staleness updates; with no updates observed,
+    // rounds are started by tick_threshold only
+    interval = 0 < update_rate_ ?
+        target_staleness_ / update_rate_ : tick_threshold_;
+  }
+  if (0 < tick_threshold_ && interval > tick_threshold_) {
+    interval = tick_threshold_;
+  }
+  // the network budget wins over tick_threshold
+  interval_ = 0 < interval ? std::max(interval, floor_) : 0;
+}
+
+void mix_scheduler::get_status(
+    const string& prefix,
+    server_base::status_t& status) const {
+  const string p = prefix + ".scheduler.";
+  status[p + "adaptive"] = lexical_cast<string>(is_adaptive());
+  status[p + "interval"] = lexical_cast<string>(interval_);
+  status[p + "update_rate"] = lexical_cast<string>(update_rate_);
+  if (is_adaptive()) {
+    status[p + "min_interval"] = lexical_cast<string>(floor_);
+    status[p + "target_staleness"] = lexical_cast<string>(target_staleness_);
+    status[p + "network_budget"] = lexical_cast<string>(network_budget_);
+    status[p + "last_duration"] = lexical_cast<string>(last_duration_);
+    status[p + "last_bytes"] = lexical_cast<string>(last_bytes_);
+  }
+}
+
+}  // namespace mixer
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
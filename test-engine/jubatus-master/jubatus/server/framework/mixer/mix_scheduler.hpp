@@ -0,0 +1,102 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_MIXER_MIX_SCHEDULER_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_MIXER_MIX_SCHEDULER_HPP_
+
+#include <stdint.h>
+#include <string>
+#include "../server_base.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace mixer {
+
+// mix_scheduler
+//   Decides when the mixer thread starts a MIX round.
+//
+//   Unless adaptive, a round starts when count_threshold updates have been
+//   made or tick_threshold seconds have passed since the last round.
+//
+//   When target_staleness (updates) or network_budget (bytes/sec) is
+//   given, the interval follows the observed update rate so that about
+//   target_staleness updates are left unmixed, and a round also starts as
+//   soon as that many updates are made.  The interval never gets shorter
+//   than min_interval, twice the duration of the last round, or the time
+//   to transfer the last round's bytes within network_budget; it never gets
+//   longer than tick_threshold.
+//
+//   This class is not thread safe; mixers call it under their own lock.
+class mix_scheduler {
+ public:
+  mix_scheduler(
+      unsigned int count_threshold,
+      unsigned int tick_threshold,
+      unsigned int target_staleness = 0,
+      unsigned int network_budget = 0,
+      unsigned int min_interval = 1);
+
+  bool is_adaptive() const {
+    return target_staleness_ > 0 || network_budget_ > 0;
+  }
+
+  // whether to start a round, where `counter` updates have been made in
+  // `elapsed` seconds since the last round
+  bool should_mix(unsigned int counter, double elapsed) const;
+
+  // `updates` updates were made in `elapsed` seconds until the model was
+  // mixed (by this server or by others)
+  void observe(unsigned int updates, double elapsed);
+
+  // a round started by this server finished in `duration` seconds,
+  // transferring `bytes` bytes
+  void mixed(double duration, uint64_t bytes);
+
+  // current interval in seconds (0: no time-based rounds)
+  double interval() const {
+    return interval_;
+  }
+
+  void get_status(
+      const std::string& prefix,
+      server_base::status_t& status) const;
+
+ private:
+  void update_interval();
+
+  unsigned int count_threshold_;
+  unsigned int tick_threshold_;
+  unsigned int target_staleness_;
+  unsigned int network_budget_;
+  double min_interval_;
+
+  // updates per second, exponentially weighted
+  double update_rate_;
+  double last_duration_;
+  uint64_t last_bytes_;
+
+  // lower bound of the interval imposed by the last round
+  double floor_;
+  double interval_;
+};
+
+}  // namespace mixer
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_MIXER_MIX_SCHEDULER_HPP_
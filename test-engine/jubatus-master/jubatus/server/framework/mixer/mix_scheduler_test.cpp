@@ -0,0 +1,89 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <gtest/gtest.h>
+#include "mix_scheduler.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace mixer {
+
+TEST(mix_scheduler, fixed) {
+  mix_scheduler s(512, 16);
+  EXPECT_FALSE(s.is_adaptive());
+  EXPECT_FALSE(s.should_mix(10, 1));
+  EXPECT_TRUE(s.should_mix(512, 1));
+  EXPECT_TRUE(s.should_mix(1, 17));
+
+  // observed rates do not change fixed thresholds
+  s.observe(10000, 1);
+  EXPECT_FALSE(s.should_mix(10, 1));
+  EXPECT_EQ(16, s.interval());
+}
+
+TEST(mix_scheduler, follows_update_rate) {
+  mix_scheduler s(512, 60, 1000, 0, 1);
+  EXPECT_TRUE(s.is_adaptive());
+  // no update observed yet
+  EXPECT_EQ(60, s.interval());
+
+  // 100 updates/sec: 1000 updates are made in 10 secs
+  s.observe(1000, 10);
+  EXPECT_DOUBLE_EQ(10, s.interval());
+  EXPECT_FALSE(s.should_mix(500, 5));
+  EXPECT_TRUE(s.should_mix(500, 10));
+  // a burst reaches the target before the interval
+  EXPECT_TRUE(s.should_mix(1000, 2));
+
+  // quiet: bounded by tick_threshold
+  s.observe(1, 100);
+  s.observe(1, 100);
+  s.observe(1, 100);
+  EXPECT_EQ(60, s.interval());
+}
+
+TEST(mix_scheduler, lower_bounds) {
+  mix_scheduler s(512, 60, 1000, 1000, 1);
+
+  // 10000 updates/sec would mix every 0.1 sec
+  s.observe(10000, 1);
+  EXPECT_EQ(1, s.interval());
+
+  // a round of 3 secs allows mixing every 6 secs
+  s.mixed(3, 0);
+  EXPECT_EQ(6, s.interval());
+  EXPECT_FALSE(s.should_mix(100000, 5));
+  EXPECT_TRUE(s.should_mix(1, 6));
+
+  // 100KB at 1KB/sec: even longer than tick_threshold
+  s.mixed(0, 100000);
+  EXPECT_EQ(100, s.interval());
+}
+
+TEST(mix_scheduler, status) {
+  mix_scheduler s(512, 16, 100, 0, 1);
+  server_base::status_t status;
+  s.get_status("test_mixer", status);
+  EXPECT_EQ("1", status["test_mixer.scheduler.adaptive"]);
+  EXPECT_EQ("16", status["test_mixer.scheduler.interval"]);
+  EXPECT_EQ("100", status["test_mixer.scheduler.target_staleness"]);
+}
+
+}  // namespace mixer
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
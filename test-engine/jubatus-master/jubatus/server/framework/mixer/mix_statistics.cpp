@@ -0,0 +1,173 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2013 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "mix_statistics.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/cast.h"
+
+using std::deque;
+using std::map;
+using std::make_pair;
+using std::pair;
+using std::string;
+using std::vector;
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace mixer {
+
+namespace {
+
+// nearest-rank percentile of sorted values
+double percentile(const vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = static_cast<size_t>(p * sorted.size() / 100.0 + 0.5);
+  if (rank == 0) {
+    rank = 1;
+  }
+  if (rank > sorted.size()) {
+    rank = sorted.size();
+  }
+  return sorted[rank - 1];
+}
+
+void put_percentiles(
+    const string& key,
+    const deque<double>& window,
+    server_base::status_t& status) {
+  vector<double> sorted(window.begin(), window.end());
+  std::sort(sorted.begin(), sorted.end());
+  status[key + ".p50"] = lexical_cast<string>(percentile(sorted, 50));
+  status[key + ".p90"] = lexical_cast<string>(percentile(sorted, 90));
+  status[key + ".p99"] = lexical_cast<string>(percentile(sorted, 99));
+  status[key + ".max"] =
+      lexical_cast<string>(sorted.empty() ? 0 : sorted.back());
+}
+
+}  // namespace
+
+const size_t mix_statistics::DEFAULT_WINDOW_SIZE;
+
+void mix_round::add_phase(const string& phase, double sec) {
+  phases_[phase] += sec;
+}
+
+void mix_round::add_peer_latency(
+    const string& peer,
+    const string& phase,
+    double sec) {
+  peer_latencies_[make_pair(peer, phase)] = sec;
+}
+
+void mix_round::add_failed_peer(const string& peer) {
+  failed_peers_.push_back(peer);
+}
+
+mix_statistics::mix_statistics(size_t window_size)
+    : window_size_(std::max(window_size, static_cast<size_t>(1))),
+      total_rounds_(0),
+      total_failed_peers_(0) {
+}
+
+void mix_statistics::push(window_t& w, double value) {
+  w.push_back(value);
+  while (w.size() > window_size_) {
+    w.pop_front();
+  }
+}
+
+void mix_statistics::add_round(const mix_round& round) {
+  scoped_lock lk(m_);
+
+  for (map<string, double>::const_iterator it = round.phases_.begin();
+       it != round.phases_.end(); ++it) {
+    push(phases_[it->first], it->second);
+  }
+  for (map<pair<string, string>, double>::const_iterator
+       it = round.peer_latencies_.begin();
+       it != round.peer_latencies_.end(); ++it) {
+    push(peers_[it->first.first][it->first.second], it->second);
+  }
+  push(bytes_in_, static_cast<double>(round.bytes_in_));
+  push(bytes_out_, static_cast<double>(round.bytes_out_));
+  push(failed_peers_, static_cast<double>(round.failed_peers_.size()));
+
+  string failed;
+  for (size_t i = 0; i < round.failed_peers_.size(); ++i) {
+    if (i > 0) {
+      failed += ",";
+    }
+    failed += round.failed_peers_[i];
+  }
+  last_failed_peers_ = failed;
+
+  ++total_rounds_;
+  total_failed_peers_ += round.failed_peers_.size();
+}
+
+void mix_statistics::add_event(const string& phase, double sec) {
+  scoped_lock lk(m_);
+  push(phases_[phase], sec);
+}
+
+void mix_statistics::get_status(
+    const string& prefix,
+    server_base::status_t& status) const {
+  scoped_lock lk(m_);
+  const string p = prefix + ".stats";
+
+  status[p + ".window"] = lexical_cast<string>(window_size_);
+  status[p + ".rounds"] = lexical_cast<string>(total_rounds_);
+  status[p + ".failed_peers"] = lexical_cast<string>(total_failed_peers_);
+  status[p + ".last_failed_peers"] = last_failed_peers_;
+
+  for (map<string, window_t>::const_iterator it = phases_.begin();
+       it != phases_.end(); ++it) {
+    put_percentiles(p + "." + it->first + "_sec", it->second, status);
+  }
+  for (map<string, map<string, window_t> >::const_iterator
+       it = peers_.begin(); it != peers_.end(); ++it) {
+    for (map<string, window_t>::const_iterator jt = it->second.begin();
+         jt != it->second.end(); ++jt) {
+      put_percentiles(
+          p + ".peer." + it->first + "." + jt->first + "_sec",
+          jt->second, status);
+    }
+  }
+  if (total_rounds_ > 0) {
+    put_percentiles(p + ".bytes_in", bytes_in_, status);
+    put_percentiles(p + ".bytes_out", bytes_out_, status);
+    put_percentiles(p + ".failed_peers_per_round", failed_peers_, status);
+  }
+}
+
+}  // namespace mixer
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
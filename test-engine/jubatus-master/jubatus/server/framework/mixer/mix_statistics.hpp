@@ -0,0 +1,120 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2013 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_MIXER_MIX_STATISTICS_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_MIXER_MIX_STATISTICS_HPP_
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/noncopyable.h"
+#include "../server_base.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace mixer {
+
+// mix_round
+//   Measurements of one MIX round collected by the mixer thread.
+//   Phase names are free-form (e.g. "get_diff", "fold", "put_diff");
+//   durations are in seconds.
+class mix_round {
+ public:
+  mix_round()
+      : bytes_in_(0),
+        bytes_out_(0) {
+  }
+
+  void add_phase(const std::string& phase, double sec);
+  void add_peer_latency(
+      const std::string& peer,
+      const std::string& phase,
+      double sec);
+  void add_failed_peer(const std::string& peer);
+
+  void add_bytes_in(uint64_t bytes) {
+    bytes_in_ += bytes;
+  }
+  void add_bytes_out(uint64_t bytes) {
+    bytes_out_ += bytes;
+  }
+
+  uint64_t bytes() const {
+    return bytes_in_ + bytes_out_;
+  }
+
+ private:
+  friend class mix_statistics;
+
+  std::map<std::string, double> phases_;
+  // (peer, phase) -> latency
+  std::map<std::pair<std::string, std::string>, double> peer_latencies_;
+  std::vector<std::string> failed_peers_;
+  uint64_t bytes_in_;
+  uint64_t bytes_out_;
+};
+
+// mix_statistics
+//   Keeps a rolling window of the last N mix rounds and reports
+//   percentiles of each measurement through get_status.
+//   This class is thread safe.
+class mix_statistics : jubatus::util::lang::noncopyable {
+ public:
+  static const size_t DEFAULT_WINDOW_SIZE = 64;
+
+  explicit mix_statistics(size_t window_size = DEFAULT_WINDOW_SIZE);
+
+  // record a whole round (called by the mix master / initiator)
+  void add_round(const mix_round& round);
+
+  // record a single event which is not bound to a round owned by this
+  // node, e.g., the model lock hold time of put_diff called by the master
+  void add_event(const std::string& phase, double sec);
+
+  void get_status(
+      const std::string& prefix,
+      server_base::status_t& status) const;
+
+ private:
+  typedef std::deque<double> window_t;
+
+  void push(window_t& w, double value);
+
+  const size_t window_size_;
+  uint64_t total_rounds_;
+  uint64_t total_failed_peers_;
+  std::string last_failed_peers_;
+
+  std::map<std::string, window_t> phases_;
+  std::map<std::string, std::map<std::string, window_t> > peers_;
+  window_t bytes_in_;
+  window_t bytes_out_;
+  window_t failed_peers_;
+
+  mutable jubatus::util::concurrent::mutex m_;
+};
+
+}  // namespace mixer
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_MIXER_MIX_STATISTICS_HPP_
@@ -0,0 +1,94 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2013 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <string>
+#include <gtest/gtest.h>
+#include "mix_statistics.hpp"
+
+using std::string;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace mixer {
+
+TEST(mix_statistics, empty) {
+  mix_statistics stats(8);
+  server_base::status_t status;
+  stats.get_status("test_mixer", status);
+
+  EXPECT_EQ("8", status["test_mixer.stats.window"]);
+  EXPECT_EQ("0", status["test_mixer.stats.rounds"]);
+  EXPECT_EQ(0u, status.count("test_mixer.stats.bytes_in.p50"));
+}
+
+TEST(mix_statistics, percentiles) {
+  mix_statistics stats(100);
+  for (int i = 1; i <= 100; ++i) {
+    mix_round round;
+    round.add_phase("get_diff", i);
+    round.add_bytes_in(i * 10);
+    round.add_peer_latency("127.0.0.1_9199", "get_diff", i);
+    stats.add_round(round);
+  }
+
+  server_base::status_t status;
+  stats.get_status("test_mixer", status);
+  EXPECT_EQ("100", status["test_mixer.stats.rounds"]);
+  EXPECT_EQ("50", status["test_mixer.stats.get_diff_sec.p50"]);
+  EXPECT_EQ("90", status["test_mixer.stats.get_diff_sec.p90"]);
+  EXPECT_EQ("99", status["test_mixer.stats.get_diff_sec.p99"]);
+  EXPECT_EQ("100", status["test_mixer.stats.get_diff_sec.max"]);
+  EXPECT_EQ("500", status["test_mixer.stats.bytes_in.p50"]);
+  EXPECT_EQ("100",
+      status["test_mixer.stats.peer.127.0.0.1_9199.get_diff_sec.max"]);
+}
+
+TEST(mix_statistics, rolling_window) {
+  mix_statistics stats(2);
+  for (int i = 1; i <= 10; ++i) {
+    mix_round round;
+    round.add_phase("fold", i);
+    stats.add_round(round);
+  }
+
+  server_base::status_t status;
+  stats.get_status("test_mixer", status);
+  EXPECT_EQ("10", status["test_mixer.stats.rounds"]);
+  EXPECT_EQ("9", status["test_mixer.stats.fold_sec.p50"]);
+  EXPECT_EQ("10", status["test_mixer.stats.fold_sec.max"]);
+}
+
+TEST(mix_statistics, failed_peers) {
+  mix_statistics stats;
+  mix_round round;
+  round.add_failed_peer("10.0.0.1_9199");
+  round.add_failed_peer("10.0.0.2_9199");
+  stats.add_round(round);
+  stats.add_event("put_diff_lock_hold", 0.5);
+
+  server_base::status_t status;
+  stats.get_status("test_mixer", status);
+  EXPECT_EQ("2", status["test_mixer.stats.failed_peers"]);
+  EXPECT_EQ("10.0.0.1_9199,10.0.0.2_9199",
+            status["test_mixer.stats.last_failed_peers"]);
+  EXPECT_EQ("0.5", status["test_mixer.stats.put_diff_lock_hold_sec.max"]);
+}
+
+}  // namespace mixer
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
@@ -19,6 +19,8 @@
 
 #include <string>
 
+#include <msgpack.hpp>
+#include "jubatus/util/lang/function.h"
 #include "jubatus/util/lang/noncopyable.h"
 #include "jubatus/util/lang/shared_ptr.h"
 #include "jubatus/core/driver/driver.hpp"
@@ -48,8 +50,34 @@ class mixer : util::lang::noncopyable {
   virtual void get_status(server_base::status_t& status) const = 0;
 
   virtual std::string type() const = 0;
+
+  // called whenever MIX has modified the model, under the model lock
+  void set_mixed_callback(const jubatus::util::lang::function<void()>& f) {
+    mixed_callback_ = f;
+  }
+
+ protected:
+  void event_model_mixed() const {
+    if (mixed_callback_) {
+      mixed_callback_();
+    }
+  }
+
+ private:
+  jubatus::util::lang::function<void()> mixed_callback_;
 };
 
+// Unpacks a diff (or a pull argument) received as a msgpack raw.
+// Strings in the result refer to the raw instead of being copied, so the
+// buffer holding the raw (the RPC request or response) must be kept alive
+// while the result is used; only containers are allocated in its zone.
+inline void unpack_diff(const msgpack::object& raw, msgpack::unpacked& msg) {
+  if (raw.type != msgpack::type::RAW) {
+    throw msgpack::rpc::argument_error();
+  }
+  msgpack::unpack(&msg, raw.via.raw.ptr, raw.via.raw.size);
+}
+
 class unsupported_mixables : public core::common::exception::runtime_error {
  public:
   explicit unsupported_mixables(const std::string& type)
@@ -26,9 +26,9 @@
 #include "random_mixer.hpp"
 #include "broadcast_mixer.hpp"
 #include "skip_mixer.hpp"
-#else
-#include "dummy_mixer.hpp"
 #endif
+#include "dummy_mixer.hpp"
+#include "../../common/logger/logger.hpp"
 
 using std::make_pair;
 using std::string;
@@ -44,49 +44,77 @@ mixer* create_mixer(
     jubatus::util::concurrent::rw_mutex& model_mutex,
     uint64_t protocol_version) {
 #ifdef HAVE_ZOOKEEPER_H
+  if (a.partitioned) {
+    // each server keeps only the rows written to it; nothing to mix
+    LOG(INFO) << "partitioned mode: " << a.mixer << " is not used";
+    return new dummy_mixer;
+  }
+
+  const mix_scheduler scheduler(
+      a.interval_count,
+      a.interval_sec,
+      a.mix_target_staleness,
+      a.mix_network_budget,
+      a.mix_min_interval);
+
   const string& use_mixer = a.mixer;
   if (use_mixer == "linear_mixer") {
-    return new linear_mixer(
+    linear_mixer* m = new linear_mixer(
         linear_communication::create(
             zk,
             a.type,
             a.name,
             a.interconnect_timeout,
-            make_pair(a.eth, a.port)),
+            make_pair(a.eth, a.port),
+            a.serving_only,
+            a.mix_port(),
+            a.mix_bandwidth_limit),
         model_mutex,
         a.interval_count,
         a.interval_sec,
-        protocol_version);
+        protocol_version,
+        a.serving_only);
+    m->set_scheduler(scheduler);
+    return m;
   } else if (use_mixer == "random_mixer") {
-    return new random_mixer(
+    push_mixer* m = new random_mixer(
         push_communication::create(
             zk,
             a.type,
             a.name,
             a.interconnect_timeout,
-            make_pair(a.eth, a.port)),
+            make_pair(a.eth, a.port),
+            a.mix_bandwidth_limit),
         model_mutex,
-        a.interval_count, a.interval_sec, make_pair(a.eth, a.port));
+        a.interval_count, a.interval_sec, make_pair(a.eth, a.mix_port()));
+    m->set_scheduler(scheduler);
+    return m;
   } else if (use_mixer == "broadcast_mixer") {
-    return new broadcast_mixer(
+    push_mixer* m = new broadcast_mixer(
         push_communication::create(
             zk,
             a.type,
             a.name,
             a.interconnect_timeout,
-            make_pair(a.eth, a.port)),
+            make_pair(a.eth, a.port),
+            a.mix_bandwidth_limit),
         model_mutex,
-        a.interval_count, a.interval_sec, make_pair(a.eth, a.port));
+        a.interval_count, a.interval_sec, make_pair(a.eth, a.mix_port()));
+    m->set_scheduler(scheduler);
+    return m;
   } else if (use_mixer == "skip_mixer") {
-    return new skip_mixer(
+    push_mixer* m = new skip_mixer(
         push_communication::create(
             zk,
             a.type,
             a.name,
             a.interconnect_timeout,
-            make_pair(a.eth, a.port)),
+            make_pair(a.eth, a.port),
+            a.mix_bandwidth_limit),
         model_mutex,
-        a.interval_count, a.interval_sec, make_pair(a.eth, a.port));
+        a.interval_count, a.interval_sec, make_pair(a.eth, a.mix_port()));
+    m->set_scheduler(scheduler);
+    return m;
   } else {
     throw JUBATUS_EXCEPTION(jubatus::core::common::exception::runtime_error(
           "unsupported mix type (" + use_mixer + ")"));
@@ -16,6 +16,7 @@
 
 #include "push_mixer.hpp"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,10 +24,12 @@
 #include "jubatus/util/concurrent/rwmutex.h"
 #include "jubatus/util/lang/bind.h"
 #include "jubatus/util/system/time_util.h"
+#include "jubatus/core/common/exception.hpp"
 #include "jubatus/core/framework/stream_writer.hpp"
 #include "jubatus/core/framework/mixable.hpp"
 #include "../../common/membership.hpp"
 #include "../../common/mprpc/rpc_mclient.hpp"
+#include "../../common/token_bucket.hpp"
 #include "../../common/unique_lock.hpp"
 
 using std::pair;
@@ -49,6 +52,8 @@ namespace server {
 namespace framework {
 namespace mixer {
 
+const size_t push_mixer::MAX_CONCURRENT_EXCHANGES;
+
 namespace {
 
 class push_communication_impl : public push_communication {
@@ -58,7 +63,8 @@ class push_communication_impl : public push_communication {
       const string& type,
       const string& name,
       int timeout_sec,
-      const pair<string, int>& my_id);
+      const pair<string, int>& my_id,
+      uint64_t bandwidth_limit);
 
   size_t update_members();
   size_t size() const;
@@ -86,6 +92,19 @@ class push_communication_impl : public push_communication {
     return true;
   }
 
+  void throttle(size_t bytes) const {
+    bandwidth_.consume(bytes);
+  }
+
+  void get_status(const string& prefix, server_base::status_t& status) const {
+    status[prefix + ".bandwidth_limit"] =
+        jubatus::util::lang::lexical_cast<string>(bandwidth_.rate());
+    status[prefix + ".transferred_bytes"] =
+        jubatus::util::lang::lexical_cast<string>(bandwidth_.total_bytes());
+    status[prefix + ".throttled_sec"] =
+        jubatus::util::lang::lexical_cast<string>(bandwidth_.total_wait());
+  }
+
  private:
   vector<pair<string, int> > servers_;
   jubatus::util::lang::shared_ptr<common::lock_service> zk_;
@@ -97,6 +116,7 @@ class push_communication_impl : public push_communication {
   const string name_;
   const int timeout_sec_;
   const pair<string, int> my_id_;
+  mutable common::token_bucket bandwidth_;
 };
 
 push_communication_impl::push_communication_impl(
@@ -104,17 +124,19 @@ push_communication_impl::push_communication_impl(
     const string& type,
     const string& name,
     int timeout_sec,
-    const pair<string, int>& my_id)
+    const pair<string, int>& my_id,
+    uint64_t bandwidth_limit)
     : zk_(zk),
       type_(type),
       name_(name),
       timeout_sec_(timeout_sec),
-      my_id_(my_id) {
+      my_id_(my_id),
+      bandwidth_(bandwidth_limit) {
 }
 
 size_t push_communication_impl::update_members() {
   common::unique_lock lk(m_);
-  common::get_all_nodes(*zk_, type_, name_, servers_);
+  common::get_all_mix_nodes(*zk_, type_, name_, servers_);
   return servers_.size();
 }
 
@@ -148,6 +170,13 @@ void push_communication_impl::pull(
   // TODO(beam2d): to be replaced to new client with socket connection pooling
   common::mprpc::rpc_mclient client(servers, timeout_sec_);
   result = client.call("pull", arg);
+
+  // the sender replies at once; pace the next transfers instead, so that
+  // waiting never counts against its timeout
+  if (!result.response.empty() && !result.response.front().has_error() &&
+      result.response.front()().type == msgpack::type::RAW) {
+    throttle(result.response.front()().via.raw.size);
+  }
 }
 
 void push_communication_impl::get_pull_argument(
@@ -168,11 +197,21 @@ void push_communication_impl::push(
   vector<pair<string, int> > servers;
   servers.push_back(server);
 
+  throttle(diff.size());
   // TODO(beam2d): to be replaced to new client with socket connection pooling
   common::mprpc::rpc_mclient client(servers, timeout_sec_);
   result = client.call("push", diff);
 }
 
+string peer_name(const pair<string, int>& peer) {
+  return peer.first + "_"
+      + jubatus::util::lang::lexical_cast<string>(peer.second);
+}
+
+double elapsed_since(const clock_time& start) {
+  return static_cast<double>(get_clock_time() - start);
+}
+
 bool handle_communication_error(
     const std::string& function,
     common::mprpc::rpc_result_object& result) {
@@ -198,9 +237,11 @@ jubatus::util::lang::shared_ptr<push_communication> push_communication::create(
     const string& type,
     const string& name,
     int timeout_sec,
-    const pair<string, int>& my_id) {
+    const pair<string, int>& my_id,
+    uint64_t bandwidth_limit) {
   return jubatus::util::lang::shared_ptr<push_communication_impl>(
-      new push_communication_impl(zk, type, name, timeout_sec, my_id));
+      new push_communication_impl(
+          zk, type, name, timeout_sec, my_id, bandwidth_limit));
 }
 
 push_mixer::push_mixer(
@@ -210,8 +251,7 @@ push_mixer::push_mixer(
     unsigned int tick_threshold,
     const std::pair<std::string, int>& my_id)
     : communication_(communication),
-      count_threshold_(count_threshold),
-      tick_threshold_(tick_threshold),
+      scheduler_(count_threshold, tick_threshold),
       my_id_(my_id),
       counter_(0),
       mix_count_(0),
@@ -219,7 +259,9 @@ push_mixer::push_mixer(
       is_running_(false),
       is_obsolete_(true),
       t_(jubatus::util::lang::bind(&push_mixer::mixer_loop, this)),
-      model_mutex_(mutex) {
+      model_mutex_(mutex),
+      pushed_diffs_(0),
+      failed_pushes_(0) {
 }
 
 push_mixer::~push_mixer() {
@@ -242,6 +284,11 @@ void push_mixer::set_driver(core::driver::driver_base* driver) {
   driver_ = driver;
 }
 
+void push_mixer::set_scheduler(const mix_scheduler& scheduler) {
+  scoped_lock lk(m_);
+  scheduler_ = scheduler;
+}
+
 void push_mixer::start() {
   scoped_lock lk(m_);
   if (!is_running_) {
@@ -264,8 +311,10 @@ void push_mixer::stop() {
 bool push_mixer::do_mix() {
   {
     common::unique_lock lk(m_);
+    const clock_time now = get_clock_time();
+    scheduler_.observe(counter_, static_cast<double>(now - ticktime_));
     counter_ = 0;
-    ticktime_ = get_clock_time();
+    ticktime_ = now;
     lk.unlock();
   }
   try {
@@ -286,8 +335,8 @@ bool push_mixer::do_mix() {
 void push_mixer::updated() {
   scoped_lock lk(m_);
   ++counter_;
-  if (counter_ >= count_threshold_
-      || get_clock_time() - ticktime_ > tick_threshold_) {
+  if (scheduler_.should_mix(
+          counter_, static_cast<double>(get_clock_time() - ticktime_))) {
     c_.notify();  // FIXME: need sync here?
   }
 }
@@ -298,6 +347,13 @@ void push_mixer::get_status(server_base::status_t& status) const {
     jubatus::util::lang::lexical_cast<string>(counter_);
   status["push_mixer.ticktime"] =
     jubatus::util::lang::lexical_cast<string>(ticktime_.sec);  // since last mix
+  status["push_mixer.pushed_diffs"] =
+    jubatus::util::lang::lexical_cast<string>(pushed_diffs_);
+  status["push_mixer.failed_pushes"] =
+    jubatus::util::lang::lexical_cast<string>(failed_pushes_);
+  scheduler_.get_status("push_mixer", status);
+  stats_.get_status("push_mixer", status);
+  communication_->get_status("push_mixer", status);
 }
 
 void push_mixer::mixer_loop() {
@@ -317,12 +373,12 @@ void push_mixer::mixer_loop() {
       }
 
       clock_time new_ticktime = get_clock_time();
-      if ((0 < count_threshold_ &&  counter_ >= count_threshold_)
-          || (0 < tick_threshold_ && new_ticktime - ticktime_ > tick_threshold_)
-          ) {
-        DLOG(INFO) << "starting mix because of "
-                   << (count_threshold_ <= counter_ ? "counter" : "tick_time")
-                   << " threshold";
+      const double elapsed = static_cast<double>(new_ticktime - ticktime_);
+      if (scheduler_.should_mix(counter_, elapsed)) {
+        DLOG(INFO) << "starting mix after " << counter_ << " updates in "
+                   << elapsed << " secs (interval "
+                   << scheduler_.interval() << " secs)";
+        scheduler_.observe(counter_, elapsed);
         counter_ = 0;
         ticktime_ = new_ticktime;
 
@@ -342,6 +398,7 @@ void push_mixer::mixer_loop() {
 void push_mixer::mix() {
   clock_time start = get_clock_time();
   size_t s_pull = 0, s_push = 0;
+  mix_round round;
 
   size_t servers_size = communication_->update_members();
   if (servers_size == 0 ||
@@ -362,47 +419,90 @@ void push_mixer::mix() {
       // call virtual function to select push candidate
       vector<const pair<string, int>*> candidates =
           filter_candidates(communication_->servers_list());
+      if (candidates.size() == 0U) {
+        LOG(WARNING) << "no mix peer selected in mix strategy";
+      }
 
-      for (size_t i = 0; i < candidates.size(); ++i) {
-        const pair<string, int>& she = *candidates[i];
-
-        // pull from her
-        byte_buffer my_args = get_pull_argument(0);
-
-        common::mprpc::rpc_result_object pull_result;
-        communication_->pull(she, my_args, pull_result);
-        if (handle_communication_error("pull", pull_result)) {
-          continue;
+      // exchange with a batch of peers at once, and apply their diffs
+      // before the next batch; the first peer of each batch is handled in
+      // this thread and the others in the pool
+      const size_t width = std::max<size_t>(1, max_concurrent_exchanges());
+      shared_ptr<common::mprpc::rpc_worker_pool> pool;
+      if (width > 1) {
+        scoped_lock lk(m_);
+        if (!exchange_pool_) {
+          exchange_pool_.reset(new common::mprpc::rpc_worker_pool(width - 1));
+          exchange_pool_->start();
         }
-        msgpack::object her_diff = pull_result.response.front()();
-
-        // pull from me
-        common::mprpc::rpc_result_object args_result;
-        communication_->get_pull_argument(she, args_result);
-        if (handle_communication_error("get_pull_argument", args_result)) {
-          continue;
+        pool = exchange_pool_;
+      }
+      for (size_t begin = 0; begin < candidates.size(); begin += width) {
+        const size_t end = std::min(begin + width, candidates.size());
+
+        // the argument to pull from me is the same for the whole batch
+        clock_time phase_start = get_clock_time();
+        const byte_buffer my_args = get_pull_argument(0);
+        round.add_phase("get_pull_argument", elapsed_since(phase_start));
+
+        phase_start = get_clock_time();
+        vector<exchange_result> results(end - begin);
+        exchange_latch latch(end - begin - 1);
+        for (size_t i = begin + 1; i < end; ++i) {
+          if (!pool->post(bind(&push_mixer::pooled_exchange, this,
+                               candidates[i], &my_args, &results[i - begin],
+                               &latch))) {
+            exchange(candidates[i], &my_args, &results[i - begin]);
+            latch.count_down();
+          }
         }
-        msgpack::object her_args =
-            args_result.response.front()();
-        byte_buffer my_diff = pull(her_args);
-
-        // push to her and me
-        common::mprpc::rpc_result_object push_result;
-        communication_->push(she, my_diff, push_result);
-        if (handle_communication_error("push", push_result)) {
-          continue;
+        exchange(candidates[begin], &my_args, &results[0]);
+        // the tasks refer to `my_args`, `results` and `latch`
+        latch.wait();
+        round.add_phase("exchange", elapsed_since(phase_start));
+
+        vector<msgpack::object> her_diffs;
+        vector<string> her_names;
+        for (size_t i = 0; i < results.size(); ++i) {
+          const string her_name = peer_name(*candidates[begin + i]);
+          const exchange_result& r = results[i];
+          if (!r.ok) {
+            round.add_failed_peer(her_name);
+            continue;
+          }
+          round.add_peer_latency(her_name, "pull", r.pull_sec);
+          round.add_peer_latency(her_name, "get_pull_argument",
+                                 r.get_pull_argument_sec);
+          round.add_peer_latency(her_name, "push", r.push_sec);
+          round.add_phase("pull", r.pull_sec);
+          round.add_phase("serialize", r.serialize_sec);
+          round.add_phase("push", r.push_sec);
+
+          msgpack::object her_diff = r.pull_result.response.front()();
+          her_diffs.push_back(her_diff);
+          her_names.push_back(her_name);
+
+          // count size
+          s_pull += her_diff.via.raw.size;
+          s_push += r.pushed_size;
+          round.add_bytes_in(her_diff.via.raw.size);
+          round.add_bytes_out(r.pushed_size);
         }
-        push(her_diff);
 
-        // count size
-        s_pull += her_diff.via.raw.size;
-        s_push += my_diff.size();
-      }
-      if (candidates.size() == 0U) {
-        LOG(WARNING) << "no mix peer selected in mix strategy";
+        // push to me
+        phase_start = get_clock_time();
+        const vector<string> errors = push_all(her_diffs);
+        round.add_phase("fold", elapsed_since(phase_start));
+        for (size_t i = 0; i < errors.size(); ++i) {
+          if (!errors[i].empty()) {
+            LOG(WARNING) << "failed to apply the diff of " << her_names[i]
+                         << ": " << errors[i];
+            round.add_failed_peer(her_names[i]);
+          }
+        }
       }
     } catch (const std::exception& e) {
       LOG(WARNING) << "error in mix process: " << e.what();
+      stats_.add_round(round);
       return;
     }
 
@@ -418,6 +518,8 @@ void push_mixer::mix() {
   }
 
   clock_time end = get_clock_time();
+  round.add_phase("total", static_cast<double>(end - start));
+  stats_.add_round(round);
   LOG(INFO) << (end - start) << " time elapsed "
             << s_pull << " pulled  "
             << s_push << " pushed";
@@ -425,15 +527,13 @@ void push_mixer::mix() {
   {
     scoped_lock lk(m_);
     mix_count_++;
+    scheduler_.mixed(static_cast<double>(end - start), round.bytes());
   }
 }
 
 byte_buffer push_mixer::pull(const msgpack::object& arg_obj) {
-  if (arg_obj.type != msgpack::type::RAW) {
-    throw msgpack::rpc::argument_error();
-  }
   msgpack::unpacked msg;
-  msgpack::unpack(&msg, arg_obj.via.raw.ptr, arg_obj.via.raw.size);
+  unpack_diff(arg_obj, msg);
   msgpack::object arg = msg.get();
 
   scoped_rlock lk_read(model_mutex_);
@@ -469,34 +569,123 @@ byte_buffer push_mixer::get_pull_argument(int dummy_arg) {
   return byte_buffer(sbuf.data(), sbuf.size());
 }
 
-int push_mixer::push(const msgpack::object& diff_obj) {
-  if (diff_obj.type != msgpack::type::RAW) {
-    throw msgpack::rpc::argument_error();
+void push_mixer::exchange(
+    const pair<string, int>* peer,
+    const byte_buffer* my_args,
+    exchange_result* result) {
+  const pair<string, int>& she = *peer;
+  try {
+    // pull from her
+    clock_time phase_start = get_clock_time();
+    communication_->pull(she, *my_args, result->pull_result);
+    result->pull_sec = elapsed_since(phase_start);
+    if (handle_communication_error("pull", result->pull_result)) {
+      return;
+    }
+
+    // pull from me
+    phase_start = get_clock_time();
+    common::mprpc::rpc_result_object args_result;
+    communication_->get_pull_argument(she, args_result);
+    result->get_pull_argument_sec = elapsed_since(phase_start);
+    if (handle_communication_error("get_pull_argument", args_result)) {
+      return;
+    }
+    msgpack::object her_args = args_result.response.front()();
+    phase_start = get_clock_time();
+    byte_buffer my_diff = pull(her_args);
+    result->serialize_sec = elapsed_since(phase_start);
+
+    // push to her
+    phase_start = get_clock_time();
+    common::mprpc::rpc_result_object push_result;
+    communication_->push(she, my_diff, push_result);
+    result->push_sec = elapsed_since(phase_start);
+    if (handle_communication_error("push", push_result)) {
+      return;
+    }
+    result->pushed_size = my_diff.size();
+    result->ok = true;
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "error in mix with " << she.first << ":" << she.second
+                 << ": " << e.what();
   }
+}
 
-  msgpack::unpacked msg;
-  msgpack::unpack(&msg, diff_obj.via.raw.ptr, diff_obj.via.raw.size);
-  msgpack::object diff = msg.get();
+void push_mixer::pooled_exchange(
+    const pair<string, int>* peer,
+    const byte_buffer* my_args,
+    exchange_result* result,
+    exchange_latch* latch) {
+  exchange(peer, my_args, result);
+  latch->count_down();
+}
 
-  scoped_wlock lk_write(model_mutex_);
-  // Prevent `stabilizer_loop` to awake from `wait` and protect
-  // status values.
+void push_mixer::exchange_latch::count_down() {
   scoped_lock lk(m_);
+  if (--count_ == 0) {
+    c_.notify_all();
+  }
+}
 
-  core::framework::push_mixable* mixable =
-    dynamic_cast<core::framework::push_mixable*>(driver_->get_mixable());
+void push_mixer::exchange_latch::wait() {
+  common::unique_lock lk(m_);
+  while (count_ > 0) {
+    c_.wait(m_);
+  }
+}
 
-  msgpack::sbuffer sbuf;
-  stream_writer<msgpack::sbuffer> st(sbuf);
-  core::framework::jubatus_packer jp(st);
-  packer pk(jp);
+int push_mixer::push(const msgpack::object& diff_obj) {
+  const vector<string> errors =
+      push_all(vector<msgpack::object>(1, diff_obj));
+  if (!errors[0].empty()) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "failed to apply pushed diff: " + errors[0]));
+  }
+  return 0;
+}
 
-  mixable->push(diff);
+vector<string> push_mixer::push_all(const vector<msgpack::object>& diff_objs) {
+  vector<string> errors(diff_objs.size());
+  uint64_t failures = 0;
+  for (size_t i = 0; i < diff_objs.size(); ++i) {
+    try {
+      // unpacked before taking the model lock
+      msgpack::unpacked msg;
+      unpack_diff(diff_objs[i], msg);
+
+      scoped_wlock lk_write(model_mutex_);
+      const clock_time locked = get_clock_time();
+      // Prevent `stabilizer_loop` to awake from `wait` and protect
+      // status values.
+      scoped_lock lk(m_);
+
+      push_to_model(msg.get());
+      event_model_mixed();
+
+      counter_ = 0;
+      ticktime_ = get_clock_time();
+      stats_.add_event("push_lock_hold",
+          static_cast<double>(ticktime_ - locked));
+      ++pushed_diffs_;
+    } catch (const std::exception& e) {
+      // the diffs applied before stay in the model
+      errors[i] = e.what();
+      ++failures;
+    }
+  }
 
-  counter_ = 0;
-  ticktime_ = get_clock_time();
+  if (failures > 0) {
+    scoped_lock lk(m_);
+    failed_pushes_ += failures;
+  }
+  return errors;
+}
 
-  return 0;
+void push_mixer::push_to_model(const msgpack::object& diff) {
+  core::framework::push_mixable* mixable =
+    dynamic_cast<core::framework::push_mixable*>(driver_->get_mixable());
+  mixable->push(diff);
 }
 
 }  // namespace mixer
@@ -28,6 +28,9 @@
 #include "jubatus/core/common/byte_buffer.hpp"
 #include "../../common/lock_service.hpp"
 #include "../../common/mprpc/rpc_mclient.hpp"
+#include "../../common/mprpc/rpc_worker_pool.hpp"
+#include "mix_scheduler.hpp"
+#include "mix_statistics.hpp"
 #include "mixer.hpp"
 
 namespace jubatus {
@@ -45,7 +48,8 @@ class push_communication {
       const std::string& type,
       const std::string& name,
       int timeout_sec,
-      const std::pair<std::string, int>& my_id);
+      const std::pair<std::string, int>& my_id,
+      uint64_t bandwidth_limit = 0);
 
   // Call update_members once before using get_diff and put_diff
   virtual size_t update_members() = 0;
@@ -76,6 +80,16 @@ class push_communication {
 
   virtual bool register_active_list() const = 0;
   virtual bool unregister_active_list() const = 0;
+
+  // blocks until `bytes` may be transferred within the MIX bandwidth
+  // limit; called by the side which starts a transfer, never in a reply
+  virtual void throttle(size_t bytes) const {
+  }
+
+  virtual void get_status(
+      const std::string& prefix,
+      server_base::status_t& status) const {
+  }
 };
 
 class push_mixer : public jubatus::server::framework::mixer::mixer {
@@ -89,6 +103,7 @@ class push_mixer : public jubatus::server::framework::mixer::mixer {
 
   void register_api(rpc_server_t& server);
   void set_driver(core::driver::driver_base*);
+  void set_scheduler(const mix_scheduler& scheduler);
 
   void start();
   void stop();
@@ -109,13 +124,81 @@ class push_mixer : public jubatus::server::framework::mixer::mixer {
   void mixer_loop();
   void mix();
 
-  core::common::byte_buffer pull(const msgpack::object& arg);
-  core::common::byte_buffer get_pull_argument(int dummy_arg);
+  // read the local model
+  virtual core::common::byte_buffer pull(const msgpack::object& arg);
+  virtual core::common::byte_buffer get_pull_argument(int dummy_arg);
   int push(const msgpack::object& diff);
 
+  // applies diffs pulled from peers one by one, taking the model lock for
+  // each diff so that updates are never blocked for a whole batch (push
+  // mixables cannot fold diffs beforehand); returns the error of each
+  // diff, empty if it has been applied
+  std::vector<std::string> push_all(const std::vector<msgpack::object>& diffs);
+
+  // applies one diff to the model; called under the model lock
+  virtual void push_to_model(const msgpack::object& diff);
+
+  // result of exchanging diffs with one peer in a MIX round
+  struct exchange_result {
+    exchange_result()
+        : ok(false),
+          pull_sec(0),
+          get_pull_argument_sec(0),
+          serialize_sec(0),
+          push_sec(0),
+          pushed_size(0) {
+    }
+
+    bool ok;
+    // owns the zone of the diff pulled from the peer
+    jubatus::server::common::mprpc::rpc_result_object pull_result;
+    double pull_sec;
+    double get_pull_argument_sec;
+    double serialize_sec;
+    double push_sec;
+    size_t pushed_size;
+  };
+
+  // pulls her diff and pushes my diff to her; her diff is not applied here
+  void exchange(
+      const std::pair<std::string, int>* peer,
+      const core::common::byte_buffer* my_args,
+      exchange_result* result);
+
+  // counts down the exchanges of a batch running in `exchange_pool_`
+  class exchange_latch {
+   public:
+    explicit exchange_latch(size_t count)
+        : count_(count) {
+    }
+
+    void count_down();
+    void wait();
+
+   private:
+    size_t count_;
+    jubatus::util::concurrent::mutex m_;
+    jubatus::util::concurrent::condition c_;
+  };
+
+  // exchange() run in `exchange_pool_`
+  void pooled_exchange(
+      const std::pair<std::string, int>* peer,
+      const core::common::byte_buffer* my_args,
+      exchange_result* result,
+      exchange_latch* latch);
+
+  // maximum number of peers to exchange diffs with at once
+  static const size_t MAX_CONCURRENT_EXCHANGES = 8;
+
+  // peers exchanged with at once in a round; the diffs of a batch are
+  // applied before the next batch starts
+  virtual size_t max_concurrent_exchanges() const {
+    return MAX_CONCURRENT_EXCHANGES;
+  }
+
   jubatus::util::lang::shared_ptr<push_communication> communication_;
-  unsigned int count_threshold_;
-  unsigned int tick_threshold_;
+  mix_scheduler scheduler_;
   const std::pair<std::string, int> my_id_;
 
   unsigned int counter_;
@@ -128,7 +211,7 @@ class push_mixer : public jubatus::server::framework::mixer::mixer {
   jubatus::util::concurrent::thread t_;
 
   // This mutex is used to protect status values (`counter_`, `mix_count_`,
-  // `ticktime_`, `is_running_`, `is_obsolete_`) and to prevent
+  // `ticktime_`, `is_running_`, `is_obsolete_`, `scheduler_`) and to prevent
   // `stabilizer_loop` while MIX-RPC is being called.
   mutable jubatus::util::concurrent::mutex m_;
 
@@ -140,6 +223,20 @@ class push_mixer : public jubatus::server::framework::mixer::mixer {
   jubatus::util::concurrent::condition c_;
   core::driver::driver_base* driver_;
 
+  // phase-level timings and byte counts of recent MIX rounds
+  mix_statistics stats_;
+
+  // number of diffs applied and failed by push_all; protected by `m_`
+  uint64_t pushed_diffs_;
+  uint64_t failed_pushes_;
+
+  // threads exchanging with the peers of a batch but the first, which is
+  // handled by the mixing thread; created in the first round, as the size
+  // is given by the virtual max_concurrent_exchanges(), and protected by
+  // `m_`
+  jubatus::util::lang::shared_ptr<common::mprpc::rpc_worker_pool>
+      exchange_pool_;
+
  private:  // deleted methods
   push_mixer();
 };
@@ -14,12 +14,20 @@
 // License along with this library; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 #include <gtest/gtest.h>
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/core/common/exception.hpp"
 #include "jubatus/core/common/version.hpp"
 #include "jubatus/core/common/byte_buffer.hpp"
 #include "jubatus/core/framework/mixable.hpp"
@@ -55,6 +63,291 @@ TEST(push_communication, update_members) {
   ASSERT_EQ(4u, list.size());
 }
 
+namespace {
+
+byte_buffer make_packed(const string& s) {
+  msgpack::sbuffer sbuf;
+  msgpack::pack(sbuf, s);
+  return byte_buffer(sbuf.data(), sbuf.size());
+}
+
+string unpack_string(const byte_buffer& buf) {
+  msgpack::unpacked msg;
+  msgpack::unpack(&msg, buf.ptr(), buf.size());
+  return msg.get().as<string>();
+}
+
+// a diff as received by the push RPC: a raw of a packed string
+msgpack::object make_diff(const string& s, msgpack::zone& zone) {
+  return msgpack::object(make_packed(s), &zone);
+}
+
+common::mprpc::rpc_response_t make_response(const string& s) {
+  common::mprpc::rpc_response_t res;
+  res.zone = mp::shared_ptr<msgpack::zone>(new msgpack::zone);
+  res.response.a3 = msgpack::object(make_packed(s), res.zone.get());
+  return res;
+}
+
+// peers replying with their port as the diff; records the pull argument
+// each peer got and how many exchanges ran at once
+class push_communication_stub : public push_communication {
+ public:
+  explicit push_communication_stub(size_t peers)
+      : running_(0),
+        max_running_(0) {
+    for (size_t i = 0; i <= peers; ++i) {
+      servers_.push_back(make_pair("127.0.0.1", 1111 + i));
+    }
+  }
+
+  size_t update_members() {
+    return servers_.size();
+  }
+
+  shared_ptr<common::try_lockable> create_lock() {
+    return shared_ptr<common::try_lockable>();
+  }
+
+  const vector<pair<string, int> >& servers_list() const {
+    return servers_;
+  }
+
+  void pull(
+      const pair<string, int>& server,
+      const byte_buffer& arg,
+      common::mprpc::rpc_result_object& result) const {
+    {
+      jubatus::util::concurrent::scoped_lock lk(m_);
+      ++running_;
+      max_running_ = std::max(max_running_, running_);
+      pull_arguments_[server.second] = unpack_string(arg);
+    }
+    ::usleep(10000);
+    result.response.push_back(make_response(
+        jubatus::util::lang::lexical_cast<string>(server.second)));
+
+    jubatus::util::concurrent::scoped_lock lk(m_);
+    --running_;
+  }
+
+  void get_pull_argument(
+      const pair<string, int>& server,
+      common::mprpc::rpc_result_object& result) const {
+    result.response.push_back(make_response("theirs"));
+  }
+
+  void push(
+      const pair<string, int>& server,
+      const byte_buffer& diff,
+      common::mprpc::rpc_result_object& result) const {
+    result.response.push_back(make_response("ok"));
+  }
+
+  bool register_active_list() const {
+    return true;
+  }
+  bool unregister_active_list() const {
+    return true;
+  }
+
+  mutable std::map<int, string> pull_arguments_;
+  mutable size_t running_;
+  mutable size_t max_running_;
+
+ private:
+  vector<pair<string, int> > servers_;
+  mutable jubatus::util::concurrent::mutex m_;
+};
+
+}  // namespace
+
+// records the diffs pushed to the model; "bad" fails to apply
+class push_recorder : public push_mixer {
+ public:
+  push_recorder(
+      jubatus::util::lang::shared_ptr<push_communication> communication,
+      jubatus::util::concurrent::rw_mutex& mutex,
+      const std::pair<std::string, int>& my_id,
+      size_t width = MAX_CONCURRENT_EXCHANGES)
+      : push_mixer(communication, mutex, 0u, 0u, my_id),
+        width_(width),
+        pull_argument_calls_(0) {
+  }
+
+  vector<const pair<string, int>*> filter_candidates(
+      const vector<pair<string, int> >& candidates) {
+    vector<const pair<string, int>*> result;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      if (candidates[i] != my_id_) {
+        result.push_back(&candidates[i]);
+      }
+    }
+    return result;
+  }
+
+  string type() const {
+    return "push_recorder";
+  }
+
+  using push_mixer::mix;
+  using push_mixer::push;
+  using push_mixer::push_all;
+
+  const size_t width_;
+  vector<string> pushed_;
+  size_t pull_argument_calls_;
+
+ protected:
+  size_t max_concurrent_exchanges() const {
+    return width_;
+  }
+
+  // tells how many diffs had been applied when the argument was made
+  byte_buffer get_pull_argument(int) {
+    ++pull_argument_calls_;
+    return make_packed(
+        "after" + jubatus::util::lang::lexical_cast<string>(pushed_.size()));
+  }
+
+  byte_buffer pull(const msgpack::object&) {
+    return make_packed("mine");
+  }
+
+  void push_to_model(const msgpack::object& diff) {
+    string s;
+    diff.convert(&s);
+    if (s == "bad") {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error("bad diff"));
+    }
+    pushed_.push_back(s);
+  }
+};
+
+TEST(push_mixer, push_all_applies_diffs_in_order) {
+  jubatus::util::lang::shared_ptr<common::lock_service> zk(new zk_stub());
+  const pair<string, int> my_id(std::make_pair("127.0.0.1", 1112));
+  jubatus::util::lang::shared_ptr<push_communication> com =
+    push_communication::create(zk, "test_type", "test_name", 1, my_id);
+  jubatus::util::concurrent::rw_mutex mutex;
+  push_recorder mixer(com, mutex, my_id);
+
+  msgpack::zone zone;
+  vector<msgpack::object> diffs;
+  diffs.push_back(make_diff("a", zone));
+  diffs.push_back(make_diff("b", zone));
+  diffs.push_back(make_diff("c", zone));
+  const vector<string> errors = mixer.push_all(diffs);
+
+  ASSERT_EQ(3u, errors.size());
+  for (size_t i = 0; i < errors.size(); ++i) {
+    EXPECT_EQ("", errors[i]);
+  }
+  ASSERT_EQ(3u, mixer.pushed_.size());
+  EXPECT_EQ("a", mixer.pushed_[0]);
+  EXPECT_EQ("b", mixer.pushed_[1]);
+  EXPECT_EQ("c", mixer.pushed_[2]);
+
+  server_base::status_t status;
+  mixer.get_status(status);
+  EXPECT_EQ("3", status["push_mixer.pushed_diffs"]);
+  EXPECT_EQ("0", status["push_mixer.failed_pushes"]);
+}
+
+TEST(push_mixer, push_all_reports_failure_per_diff) {
+  jubatus::util::lang::shared_ptr<common::lock_service> zk(new zk_stub());
+  const pair<string, int> my_id(std::make_pair("127.0.0.1", 1112));
+  jubatus::util::lang::shared_ptr<push_communication> com =
+    push_communication::create(zk, "test_type", "test_name", 1, my_id);
+  jubatus::util::concurrent::rw_mutex mutex;
+  push_recorder mixer(com, mutex, my_id);
+
+  msgpack::zone zone;
+  vector<msgpack::object> diffs;
+  diffs.push_back(make_diff("a", zone));
+  diffs.push_back(make_diff("bad", zone));
+  diffs.push_back(msgpack::object(1));  // not a raw
+  diffs.push_back(make_diff("d", zone));
+  const vector<string> errors = mixer.push_all(diffs);
+
+  // a failed diff does not keep the others from being applied
+  ASSERT_EQ(4u, errors.size());
+  EXPECT_EQ("", errors[0]);
+  EXPECT_NE("", errors[1]);
+  EXPECT_NE("", errors[2]);
+  EXPECT_EQ("", errors[3]);
+  ASSERT_EQ(2u, mixer.pushed_.size());
+  EXPECT_EQ("a", mixer.pushed_[0]);
+  EXPECT_EQ("d", mixer.pushed_[1]);
+
+  server_base::status_t status;
+  mixer.get_status(status);
+  EXPECT_EQ("2", status["push_mixer.pushed_diffs"]);
+  EXPECT_EQ("2", status["push_mixer.failed_pushes"]);
+}
+
+TEST(push_mixer, push_throws_on_failure) {
+  jubatus::util::lang::shared_ptr<common::lock_service> zk(new zk_stub());
+  const pair<string, int> my_id(std::make_pair("127.0.0.1", 1112));
+  jubatus::util::lang::shared_ptr<push_communication> com =
+    push_communication::create(zk, "test_type", "test_name", 1, my_id);
+  jubatus::util::concurrent::rw_mutex mutex;
+  push_recorder mixer(com, mutex, my_id);
+
+  msgpack::zone zone;
+  EXPECT_EQ(0, mixer.push(make_diff("a", zone)));
+  EXPECT_THROW(mixer.push(make_diff("bad", zone)),
+               core::common::exception::jubatus_exception);
+  ASSERT_EQ(1u, mixer.pushed_.size());
+  EXPECT_EQ("a", mixer.pushed_[0]);
+}
+
+TEST(push_mixer, exchanges_in_batches) {
+  // me (127.0.0.1:1111) and 5 peers
+  shared_ptr<push_communication_stub> com(new push_communication_stub(5));
+  jubatus::util::concurrent::rw_mutex mutex;
+  push_recorder mixer(com, mutex, make_pair("127.0.0.1", 1111), 2);
+
+  mixer.mix();
+
+  // at most 2 peers at once
+  EXPECT_LE(com->max_running_, 2u);
+
+  // every batch pulls with an argument made after the diffs of the
+  // previous batches have been applied
+  EXPECT_EQ(3u, mixer.pull_argument_calls_);
+  ASSERT_EQ(5u, com->pull_arguments_.size());
+  EXPECT_EQ("after0", com->pull_arguments_[1112]);
+  EXPECT_EQ("after0", com->pull_arguments_[1113]);
+  EXPECT_EQ("after2", com->pull_arguments_[1114]);
+  EXPECT_EQ("after2", com->pull_arguments_[1115]);
+  EXPECT_EQ("after4", com->pull_arguments_[1116]);
+
+  // the diffs are applied in the order of peers
+  ASSERT_EQ(5u, mixer.pushed_.size());
+  EXPECT_EQ("1112", mixer.pushed_[0]);
+  EXPECT_EQ("1113", mixer.pushed_[1]);
+  EXPECT_EQ("1114", mixer.pushed_[2]);
+  EXPECT_EQ("1115", mixer.pushed_[3]);
+  EXPECT_EQ("1116", mixer.pushed_[4]);
+}
+
+TEST(push_mixer, exchanges_one_at_a_time) {
+  shared_ptr<push_communication_stub> com(new push_communication_stub(3));
+  jubatus::util::concurrent::rw_mutex mutex;
+  push_recorder mixer(com, mutex, make_pair("127.0.0.1", 1111), 1);
+
+  mixer.mix();
+
+  EXPECT_EQ(1u, com->max_running_);
+  EXPECT_EQ(3u, mixer.pull_argument_calls_);
+  EXPECT_EQ("after0", com->pull_arguments_[1112]);
+  EXPECT_EQ("after1", com->pull_arguments_[1113]);
+  EXPECT_EQ("after2", com->pull_arguments_[1114]);
+  EXPECT_EQ(3u, mixer.pushed_.size());
+}
+
 }  // namespace mixer
 }  // namespace framework
 }  // namespace server
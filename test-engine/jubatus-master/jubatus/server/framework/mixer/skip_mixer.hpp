@@ -59,6 +59,14 @@ class skip_mixer : public push_mixer {
   std::string type() const {
     return "skip_mixer";
   }
+
+ protected:
+  // one peer at a time: the diff sent to the next peer includes the one
+  // pulled from the previous peer, which spreads a diff to all servers in
+  // log N hops within a round
+  size_t max_concurrent_exchanges() const {
+    return 1;
+  }
 };
 
 }  // namespace mixer
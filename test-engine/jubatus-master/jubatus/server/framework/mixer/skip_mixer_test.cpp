@@ -79,6 +79,31 @@ TEST(skip_mixer, filter_candidates_4) {
   EXPECT_EQ(1113, result[1]->second);
 }
 
+class skip_mixer_for_test : public skip_mixer {
+ public:
+  skip_mixer_for_test(
+      jubatus::util::lang::shared_ptr<push_communication> communication,
+      jubatus::util::concurrent::rw_mutex& mutex,
+      const std::pair<std::string, int>& my_id)
+      : skip_mixer(communication, mutex, 0u, 0u, my_id) {
+  }
+
+  using skip_mixer::max_concurrent_exchanges;
+};
+
+TEST(skip_mixer, exchanges_one_peer_at_a_time) {
+  jubatus::util::lang::shared_ptr<common::lock_service> zk(new zk_stub());
+  const pair<string, int> my_id(std::make_pair("127.0.0.1", 1112));
+  jubatus::util::lang::shared_ptr<push_communication> com =
+    push_communication::create(zk, "test_type", "test_name", 1, my_id);
+
+  jubatus::util::concurrent::rw_mutex mutex;
+  skip_mixer_for_test mixer(com, mutex, my_id);
+
+  // each peer gets the diffs pulled from the previous ones
+  EXPECT_EQ(1u, mixer.max_concurrent_exchanges());
+}
+
 }  // namespace mixer
 }  // namespace framework
 }  // namespace server
@@ -0,0 +1,255 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "model_delta.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "jubatus/core/common/exception.hpp"
+#include "../common/crc32.hpp"
+
+using std::string;
+using std::vector;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+const uint64_t MIN_CHUNK_SIZE = 16 * 1024;
+const uint64_t MAX_CHUNK_SIZE = 256 * 1024;
+// a boundary is put where the top 16 bits of the gear hash are zero, which
+// makes chunks about 64KB (after MIN_CHUNK_SIZE) on average
+const uint64_t BOUNDARY_MASK = 0xffff000000000000ULL;
+
+// random values for each byte, fixed so that the same model is always
+// split at the same places
+class gear_table {
+ public:
+  gear_table() {
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < 256; ++i) {
+      // splitmix64
+      x += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = x;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      table_[i] = z ^ (z >> 31);
+    }
+  }
+
+  uint64_t operator[](unsigned char c) const {
+    return table_[c];
+  }
+
+ private:
+  uint64_t table_[256];
+};
+
+const gear_table GEAR;
+
+bool stat_file(const string& path, uint64_t& size, int64_t& mtime) {
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  size = st.st_size;
+  mtime = st.st_mtime;
+  return true;
+}
+
+datum_key chunk_key(const char* data, uint64_t size) {
+  return hash128(data, size, 0);
+}
+
+}  // namespace
+
+void split_chunks(const char* data, size_t size, vector<uint64_t>& ends) {
+  ends.clear();
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+  uint64_t begin = 0;
+  while (begin < size) {
+    const uint64_t limit = std::min<uint64_t>(size, begin + MAX_CHUNK_SIZE);
+    uint64_t i = std::min<uint64_t>(limit, begin + MIN_CHUNK_SIZE);
+    uint64_t h = 0;
+    for (; i < limit; ++i) {
+      h = (h << 1) + GEAR[p[i]];
+      if ((h & BOUNDARY_MASK) == 0) {
+        ++i;
+        break;
+      }
+    }
+    ends.push_back(i);
+    begin = i;
+  }
+}
+
+model_delta_base::model_delta_base()
+    : size_(0),
+      crc32_(0),
+      file_size_(0),
+      file_mtime_(0) {
+}
+
+void model_delta_base::reset(
+    const string& path,
+    const vector<string>& chain,
+    const char* data,
+    size_t size,
+    uint32_t crc32) {
+  clear();
+  if (!stat_file(path, file_size_, file_mtime_)) {
+    return;
+  }
+
+  vector<uint64_t> ends;
+  split_chunks(data, size, ends);
+  uint64_t begin = 0;
+  for (size_t i = 0; i < ends.size(); ++i) {
+    const uint64_t chunk_size = ends[i] - begin;
+    // keeps the first one of the same chunks
+    index_.insert(std::make_pair(chunk_key(data + begin, chunk_size),
+                                 std::make_pair(begin, chunk_size)));
+    begin = ends[i];
+  }
+  path_ = path;
+  chain_ = chain;
+  size_ = size;
+  crc32_ = crc32;
+}
+
+void model_delta_base::clear() {
+  path_.clear();
+  chain_.clear();
+  size_ = 0;
+  crc32_ = 0;
+  file_size_ = 0;
+  file_mtime_ = 0;
+  index_.clear();
+}
+
+bool model_delta_base::usable_for(
+    const string& path,
+    size_t max_chain) const {
+  if (path_.empty() || chain_.size() + 1 > max_chain) {
+    return false;
+  }
+  if (path == path_ ||
+      std::find(chain_.begin(), chain_.end(), path) != chain_.end()) {
+    return false;
+  }
+  uint64_t file_size;
+  int64_t file_mtime;
+  return stat_file(path_, file_size, file_mtime) &&
+      file_size == file_size_ && file_mtime == file_mtime_;
+}
+
+void model_delta_base::make_delta(
+    const char* data,
+    size_t size,
+    uint32_t crc32,
+    model_delta_header& header,
+    vector<char>& literals) const {
+  const string::size_type slash = path_.rfind('/');
+  header.base = slash == string::npos ? path_ : path_.substr(slash + 1);
+  header.base_size = size_;
+  header.base_crc32 = crc32_;
+  header.size = size;
+  header.crc32 = crc32;
+  header.ops.clear();
+
+  vector<uint64_t> ends;
+  split_chunks(data, size, ends);
+  uint64_t begin = 0;
+  for (size_t i = 0; i < ends.size(); ++i) {
+    const uint64_t chunk_size = ends[i] - begin;
+    index_t::const_iterator it =
+        index_.find(chunk_key(data + begin, chunk_size));
+    delta_op op;
+    if (it != index_.end() && it->second.second == chunk_size) {
+      op.from_base = true;
+      op.offset = it->second.first;
+    } else {
+      op.from_base = false;
+      op.offset = literals.size();
+      literals.insert(literals.end(), data + begin, data + ends[i]);
+    }
+    op.size = chunk_size;
+
+    // merges contiguous ranges
+    if (!header.ops.empty()) {
+      delta_op& last = header.ops.back();
+      if (last.from_base == op.from_base &&
+          last.offset + last.size == op.offset) {
+        last.size += op.size;
+        begin = ends[i];
+        continue;
+      }
+    }
+    header.ops.push_back(op);
+    begin = ends[i];
+  }
+}
+
+vector<string> model_delta_base::chain() const {
+  vector<string> chain(chain_);
+  chain.insert(chain.begin(), path_);
+  return chain;
+}
+
+void apply_delta(
+    const model_delta_header& header,
+    const char* literals,
+    size_t literals_size,
+    const vector<char>& base,
+    vector<char>& out) {
+  const char* base_data = base.empty() ? NULL : &base[0];
+  if (base.size() != header.base_size ||
+      common::calc_crc32(base_data, base.size()) != header.base_crc32) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "base model has been modified: " + header.base));
+  }
+
+  out.clear();
+  out.reserve(header.size);
+  for (size_t i = 0; i < header.ops.size(); ++i) {
+    const delta_op& op = header.ops[i];
+    const uint64_t source_size = op.from_base ? base.size() : literals_size;
+    if (op.offset > source_size || op.size > source_size - op.offset) {
+      throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+          "delta refers out of range"));
+    }
+    const char* source = op.from_base ? base_data : literals;
+    out.insert(out.end(), source + op.offset, source + op.offset + op.size);
+  }
+
+  if (out.size() != header.size || common::calc_crc32(
+          out.empty() ? NULL : &out[0], out.size()) != header.crc32) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "model rebuilt from delta is broken"));
+  }
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
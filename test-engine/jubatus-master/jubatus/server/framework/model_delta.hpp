@@ -0,0 +1,139 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_MODEL_DELTA_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_MODEL_DELTA_HPP_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <msgpack.hpp>
+
+#include "datum_cache.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+// splits a serialized model into content-defined chunks and returns their
+// end offsets; a boundary depends only on the bytes just before it, so
+// changing some bytes of the model changes only the chunks around them
+void split_chunks(const char* data, size_t size, std::vector<uint64_t>& ends);
+
+// a range of the model copied from the base model, or from the literals
+// stored in the delta
+struct delta_op {
+  delta_op()
+      : from_base(false),
+        offset(0),
+        size(0) {
+  }
+
+  bool from_base;
+  uint64_t offset;
+  uint64_t size;
+
+  MSGPACK_DEFINE(from_base, offset, size);
+};
+
+// head of the user data of a delta model file; the literals follow it
+struct model_delta_header {
+  model_delta_header()
+      : base_size(0),
+        base_crc32(0),
+        size(0),
+        crc32(0) {
+  }
+
+  // file name of the base model, in the same directory as the delta
+  std::string base;
+  uint64_t base_size;
+  uint32_t base_crc32;
+  // the user data rebuilt from the base and the delta
+  uint64_t size;
+  uint32_t crc32;
+  std::vector<delta_op> ops;
+
+  MSGPACK_DEFINE(base, base_size, base_crc32, size, crc32, ops);
+};
+
+// model_delta_base
+//   Chunks of the user data of the last saved model, to save the next one
+//   as a delta against it. Only hashes of the chunks are kept.
+class model_delta_base {
+ public:
+  model_delta_base();
+
+  // `path` has been saved with `data` as its user data; `chain` is the
+  // paths of the bases `path` depends on (empty for a full model file)
+  void reset(
+      const std::string& path,
+      const std::vector<std::string>& chain,
+      const char* data,
+      size_t size,
+      uint32_t crc32);
+  void clear();
+
+  // whether a delta to be saved at `path` can refer to this base: the base
+  // file is unchanged since it was saved, the delta would not overwrite a
+  // file in the chain, and the chain is shorter than `max_chain`
+  bool usable_for(const std::string& path, size_t max_chain) const;
+
+  // makes a delta from this base to `data`; appends the literals to
+  // `literals`
+  void make_delta(
+      const char* data,
+      size_t size,
+      uint32_t crc32,
+      model_delta_header& header,
+      std::vector<char>& literals) const;
+
+  const std::string& path() const {
+    return path_;
+  }
+
+  // paths of the base and the bases it depends on
+  std::vector<std::string> chain() const;
+
+ private:
+  typedef std::map<datum_key, std::pair<uint64_t, uint64_t> > index_t;
+
+  std::string path_;
+  std::vector<std::string> chain_;
+  uint64_t size_;
+  uint32_t crc32_;
+  // size and modification time of the file when it was saved
+  uint64_t file_size_;
+  int64_t file_mtime_;
+  index_t index_;
+};
+
+// rebuilds the user data from `base` and the delta
+void apply_delta(
+    const model_delta_header& header,
+    const char* literals,
+    size_t literals_size,
+    const std::vector<char>& base,
+    std::vector<char>& out);
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_MODEL_DELTA_HPP_
@@ -0,0 +1,183 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "jubatus/core/common/exception.hpp"
+#include "../common/crc32.hpp"
+#include "model_delta.hpp"
+
+using std::string;
+using std::vector;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+vector<char> make_data(size_t size, unsigned int seed) {
+  vector<char> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = static_cast<char>(seed >> 16);
+  }
+  return data;
+}
+
+std::set<string> chunks_of(const vector<char>& data) {
+  vector<uint64_t> ends;
+  split_chunks(&data[0], data.size(), ends);
+  std::set<string> chunks;
+  uint64_t begin = 0;
+  for (size_t i = 0; i < ends.size(); ++i) {
+    chunks.insert(string(&data[begin], &data[0] + ends[i]));
+    begin = ends[i];
+  }
+  return chunks;
+}
+
+uint32_t crc32_of(const vector<char>& data) {
+  return common::calc_crc32(&data[0], data.size());
+}
+
+class model_delta_test : public ::testing::Test {
+ protected:
+  model_delta_test() {
+    char path[] = "/tmp/jubatus_model_delta_test_XXXXXX";
+    const int fd = ::mkstemp(path);
+    ::close(fd);
+    path_ = path;
+  }
+
+  ~model_delta_test() {
+    ::unlink(path_.c_str());
+  }
+
+  string path_;
+};
+
+}  // namespace
+
+TEST(split_chunks, boundaries) {
+  const vector<char> data = make_data(4 * 1024 * 1024, 1);
+  vector<uint64_t> ends;
+  split_chunks(&data[0], data.size(), ends);
+
+  ASSERT_FALSE(ends.empty());
+  EXPECT_EQ(data.size(), ends.back());
+  uint64_t begin = 0;
+  for (size_t i = 0; i < ends.size(); ++i) {
+    ASSERT_LT(begin, ends[i]);
+    EXPECT_LE(ends[i] - begin, 256u * 1024);
+    if (i + 1 < ends.size()) {
+      EXPECT_GE(ends[i] - begin, 16u * 1024);
+    }
+    begin = ends[i];
+  }
+
+  split_chunks(NULL, 0, ends);
+  EXPECT_TRUE(ends.empty());
+}
+
+TEST(split_chunks, insertion_changes_nearby_chunks) {
+  const vector<char> data = make_data(4 * 1024 * 1024, 2);
+  vector<char> changed(data);
+  const vector<char> inserted = make_data(100, 3);
+  changed.insert(changed.begin() + data.size() / 2,
+                 inserted.begin(), inserted.end());
+
+  const std::set<string> before = chunks_of(data);
+  const std::set<string> after = chunks_of(changed);
+  size_t common_chunks = 0;
+  for (std::set<string>::const_iterator it = after.begin();
+       it != after.end(); ++it) {
+    common_chunks += before.count(*it);
+  }
+  EXPECT_GE(common_chunks + 3, before.size());
+}
+
+TEST_F(model_delta_test, make_and_apply) {
+  const vector<char> base = make_data(2 * 1024 * 1024, 4);
+  FILE* fp = fopen(path_.c_str(), "wb");
+  ASSERT_TRUE(fp != NULL);
+  fwrite(&base[0], 1, base.size(), fp);
+  fclose(fp);
+
+  model_delta_base delta_base;
+  delta_base.reset(path_, vector<string>(), &base[0], base.size(),
+                   crc32_of(base));
+  ASSERT_TRUE(delta_base.usable_for(path_ + ".next", 1));
+  EXPECT_FALSE(delta_base.usable_for(path_, 1));
+  EXPECT_FALSE(delta_base.usable_for(path_ + ".next", 0));
+
+  vector<char> data(base);
+  data[100] ^= 1;
+  data.erase(data.begin() + 1024 * 1024, data.begin() + 1024 * 1024 + 50);
+
+  model_delta_header header;
+  vector<char> literals;
+  delta_base.make_delta(&data[0], data.size(), crc32_of(data), header,
+                        literals);
+  EXPECT_EQ(path_.substr(path_.rfind('/') + 1), header.base);
+  EXPECT_LT(literals.size(), data.size() / 4);
+
+  vector<char> rebuilt;
+  apply_delta(header, &literals[0], literals.size(), base, rebuilt);
+  EXPECT_TRUE(data == rebuilt);
+
+  vector<char> broken_base(base);
+  broken_base[0] ^= 1;
+  EXPECT_THROW(
+      apply_delta(header, &literals[0], literals.size(), broken_base,
+                  rebuilt),
+      core::common::exception::runtime_error);
+}
+
+TEST_F(model_delta_test, modified_base_is_not_used) {
+  const vector<char> base = make_data(1024, 5);
+  FILE* fp = fopen(path_.c_str(), "wb");
+  ASSERT_TRUE(fp != NULL);
+  fwrite(&base[0], 1, base.size(), fp);
+  fclose(fp);
+
+  model_delta_base delta_base;
+  delta_base.reset(path_, vector<string>(1, "/tmp/older"), &base[0],
+                   base.size(), crc32_of(base));
+  EXPECT_TRUE(delta_base.usable_for("/tmp/newer", 2));
+  EXPECT_FALSE(delta_base.usable_for("/tmp/newer", 1));
+  EXPECT_FALSE(delta_base.usable_for("/tmp/older", 2));
+  ASSERT_EQ(2u, delta_base.chain().size());
+  EXPECT_EQ(path_, delta_base.chain()[0]);
+
+  fp = fopen(path_.c_str(), "ab");
+  ASSERT_TRUE(fp != NULL);
+  fputc('x', fp);
+  fclose(fp);
+  EXPECT_FALSE(delta_base.usable_for("/tmp/newer", 2));
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
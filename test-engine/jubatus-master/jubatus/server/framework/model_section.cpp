@@ -0,0 +1,229 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include "model_section.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "jubatus/util/concurrent/thread.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/cast.h"
+#include "jubatus/util/lang/function.h"
+#include "jubatus/util/lang/shared_ptr.h"
+#include "jubatus/core/common/exception.hpp"
+#include "../common/affinity.hpp"
+#include "../common/crc32.hpp"
+
+using std::string;
+using std::vector;
+using jubatus::util::concurrent::thread;
+using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+void compress_section(
+    const char* data,
+    model_section& section,
+    vector<char>& out,
+    string& error) {
+  uLongf size = ::compressBound(section.raw_size);
+  out.resize(size);
+  const int ret = ::compress2(
+      reinterpret_cast<Bytef*>(&out[0]), &size,
+      reinterpret_cast<const Bytef*>(data), section.raw_size,
+      Z_BEST_SPEED);
+  if (ret != Z_OK) {
+    error = "failed to compress model: " + lexical_cast<string>(ret);
+    return;
+  }
+  out.resize(size);
+  section.size = size;
+  section.crc32 = common::calc_crc32(data, section.raw_size);
+}
+
+void decompress_section(
+    const char* data,
+    const model_section& section,
+    char* out,
+    string& error) {
+  uLongf size = section.raw_size;
+  const int ret = ::uncompress(
+      reinterpret_cast<Bytef*>(out), &size,
+      reinterpret_cast<const Bytef*>(data), section.size);
+  if (ret != Z_OK || size != section.raw_size) {
+    error = "failed to decompress model: " + lexical_cast<string>(ret);
+    return;
+  }
+  if (common::calc_crc32(out, size) != section.crc32) {
+    error = "invalid crc32 checksum of model section";
+  }
+}
+
+// the t-th of n threads takes sections t, t + n, t + 2n, ...
+void compress_worker(
+    const vector<const char*>* inputs,
+    vector<model_section>* sections,
+    vector<vector<char> >* outputs,
+    string* error,
+    size_t t,
+    size_t n) {
+  for (size_t i = t; i < sections->size() && error->empty(); i += n) {
+    compress_section((*inputs)[i], (*sections)[i], (*outputs)[i], *error);
+  }
+}
+
+void decompress_worker(
+    const vector<const char*>* inputs,
+    const vector<model_section>* sections,
+    const vector<char*>* outputs,
+    string* error,
+    size_t t,
+    size_t n) {
+  for (size_t i = t; i < sections->size() && error->empty(); i += n) {
+    decompress_section((*inputs)[i], (*sections)[i], (*outputs)[i], *error);
+  }
+}
+
+typedef jubatus::util::lang::function<void(string*, size_t, size_t)>
+    worker_t;
+
+// runs `worker` on `threads` threads, including the calling one
+void run_workers(const worker_t& worker, size_t threads) {
+  vector<string> errors(threads);
+  vector<shared_ptr<thread> > workers;
+  for (size_t t = 1; t < threads; ++t) {
+    shared_ptr<thread> th(new thread(
+        jubatus::util::lang::bind(worker, &errors[t], t, threads)));
+    th->start();
+    workers.push_back(th);
+  }
+  worker(&errors[0], 0, threads);
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t]->join();
+  }
+  for (size_t t = 0; t < errors.size(); ++t) {
+    if (!errors[t].empty()) {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error(errors[t]));
+    }
+  }
+}
+
+size_t thread_num(size_t threads, size_t sections) {
+  return std::max<size_t>(1, std::min(threads, sections));
+}
+
+}  // namespace
+
+uint64_t model_section_index::compressed_size() const {
+  uint64_t size = 0;
+  for (size_t i = 0; i < sections.size(); ++i) {
+    size += sections[i].size;
+  }
+  return size;
+}
+
+size_t default_section_threads() {
+  vector<int> cpus;
+  if (!common::get_allowed_cpus(cpus) || cpus.empty()) {
+    return 1;
+  }
+  return cpus.size();
+}
+
+void compress_sections(
+    const char* data,
+    size_t size,
+    size_t section_size,
+    size_t threads,
+    model_section_index& index,
+    vector<char>& out) {
+  index.raw_size = size;
+  index.sections.clear();
+  vector<const char*> inputs;
+  for (size_t offset = 0; offset < size; offset += section_size) {
+    model_section section;
+    section.raw_size = std::min(section_size, size - offset);
+    index.sections.push_back(section);
+    inputs.push_back(data + offset);
+  }
+
+  vector<vector<char> > outputs(index.sections.size());
+  run_workers(
+      jubatus::util::lang::bind(&compress_worker,
+          &inputs, &index.sections, &outputs,
+          jubatus::util::lang::_1, jubatus::util::lang::_2,
+          jubatus::util::lang::_3),
+      thread_num(threads, index.sections.size()));
+
+  out.clear();
+  out.reserve(index.compressed_size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    out.insert(out.end(), outputs[i].begin(), outputs[i].end());
+  }
+}
+
+void decompress_sections(
+    const model_section_index& index,
+    const char* data,
+    size_t size,
+    size_t threads,
+    vector<char>& out) {
+  uint64_t raw_size = 0;
+  bool empty_section = false;
+  for (size_t i = 0; i < index.sections.size(); ++i) {
+    raw_size += index.sections[i].raw_size;
+    empty_section |= index.sections[i].raw_size == 0;
+  }
+  if (index.compressed_size() != size || raw_size != index.raw_size ||
+      empty_section) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "model section index is broken"));
+  }
+
+  out.resize(index.raw_size);
+  vector<const char*> inputs;
+  vector<char*> outputs;
+  uint64_t offset = 0;
+  uint64_t raw_offset = 0;
+  for (size_t i = 0; i < index.sections.size(); ++i) {
+    inputs.push_back(data + offset);
+    outputs.push_back(&out[0] + raw_offset);
+    offset += index.sections[i].size;
+    raw_offset += index.sections[i].raw_size;
+  }
+
+  run_workers(
+      jubatus::util::lang::bind(&decompress_worker,
+          &inputs, &index.sections, &outputs,
+          jubatus::util::lang::_1, jubatus::util::lang::_2,
+          jubatus::util::lang::_3),
+      thread_num(threads, index.sections.size()));
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
@@ -0,0 +1,86 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_MODEL_SECTION_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_MODEL_SECTION_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <msgpack.hpp>
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+// a compressed part of the user data
+struct model_section {
+  model_section()
+      : size(0),
+        raw_size(0),
+        crc32(0) {
+  }
+
+  uint64_t size;
+  uint64_t raw_size;
+  // of the uncompressed data
+  uint32_t crc32;
+
+  MSGPACK_DEFINE(size, raw_size, crc32);
+};
+
+// index of the sections, stored before them in a model file; sections
+// follow each other in this order
+struct model_section_index {
+  model_section_index()
+      : raw_size(0) {
+  }
+
+  uint64_t raw_size;
+  std::vector<model_section> sections;
+
+  MSGPACK_DEFINE(raw_size, sections);
+
+  uint64_t compressed_size() const;
+};
+
+// number of threads to (de)compress sections with: CPUs this process may
+// run on
+size_t default_section_threads();
+
+// splits `data` into sections of `section_size` bytes and compresses them
+// with `threads` threads; the compressed sections are stored in `out`
+void compress_sections(
+    const char* data,
+    size_t size,
+    size_t section_size,
+    size_t threads,
+    model_section_index& index,
+    std::vector<char>& out);
+
+// decompresses and checks the sections in `data` with `threads` threads
+void decompress_sections(
+    const model_section_index& index,
+    const char* data,
+    size_t size,
+    size_t threads,
+    std::vector<char>& out);
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_MODEL_SECTION_HPP_
@@ -0,0 +1,99 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "jubatus/core/common/exception.hpp"
+#include "model_section.hpp"
+
+using std::vector;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+namespace {
+
+vector<char> make_data(size_t size) {
+  vector<char> data(size);
+  unsigned int seed = 1;
+  for (size_t i = 0; i < size; ++i) {
+    seed = seed * 1103515245 + 12345;
+    // compressible: few distinct bytes
+    data[i] = static_cast<char>((seed >> 16) % 8);
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(model_section, round_trip) {
+  const vector<char> data = make_data(1000000);
+  for (size_t threads = 1; threads <= 4; ++threads) {
+    model_section_index index;
+    vector<char> compressed;
+    compress_sections(&data[0], data.size(), 300000, threads, index,
+                      compressed);
+    ASSERT_EQ(4u, index.sections.size());
+    EXPECT_EQ(100000u, index.sections[3].raw_size);
+    EXPECT_EQ(data.size(), index.raw_size);
+    EXPECT_EQ(compressed.size(), index.compressed_size());
+    EXPECT_LT(compressed.size(), data.size());
+
+    vector<char> decompressed;
+    decompress_sections(index, &compressed[0], compressed.size(), threads,
+                        decompressed);
+    EXPECT_TRUE(data == decompressed);
+  }
+}
+
+TEST(model_section, empty) {
+  model_section_index index;
+  vector<char> compressed;
+  compress_sections(NULL, 0, 1024, 4, index, compressed);
+  EXPECT_TRUE(index.sections.empty());
+  EXPECT_TRUE(compressed.empty());
+
+  vector<char> decompressed(1);
+  decompress_sections(index, NULL, 0, 4, decompressed);
+  EXPECT_TRUE(decompressed.empty());
+}
+
+TEST(model_section, broken) {
+  const vector<char> data = make_data(100000);
+  model_section_index index;
+  vector<char> compressed;
+  compress_sections(&data[0], data.size(), 30000, 2, index, compressed);
+
+  vector<char> decompressed;
+  EXPECT_THROW(
+      decompress_sections(index, &compressed[0], compressed.size() - 1, 2,
+                          decompressed),
+      core::common::exception::runtime_error);
+
+  compressed[compressed.size() / 2] ^= 1;
+  EXPECT_THROW(
+      decompress_sections(index, &compressed[0], compressed.size(), 2,
+                          decompressed),
+      core::common::exception::runtime_error);
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
@@ -48,21 +48,24 @@ proxy::proxy(const proxy_argv& a)
   register_async_broadcast<std::map<std::string, std::string>, std::string>(
       "save",
       jubatus::util::lang::function<
-          std::map<std::string, std::string>(
-            std::map<std::string, std::string>,
-            std::map<std::string, std::string>)>(
-          &jubatus::server::framework::merge<std::string, std::string>));
+          void(std::map<std::string, std::string>&,
+               std::map<std::string, std::string>&)>(
+          &inplace::merge<std::string, std::string>));
   register_async_broadcast<bool, std::string>(
       "load",
-      jubatus::util::lang::function<bool(bool, bool)>(
-          &jubatus::server::framework::all_and));
+      jubatus::util::lang::function<void(bool&, bool&)>(
+          &inplace::all_and));
   register_async_broadcast<status_type>(
       "get_status",
-      jubatus::util::lang::function<status_type(status_type, status_type)>(
-          &jubatus::server::framework::merge<std::string, string_map>));
+      jubatus::util::lang::function<void(status_type&, status_type&)>(
+          &inplace::merge<std::string, string_map>));
   rpc_server::add<status_type()>(
       "get_proxy_status",
       jubatus::util::lang::bind(&proxy::get_status, this));
+  rpc_server::add<routing_table(std::string, std::string)>(
+      "get_routing_table",
+      jubatus::util::lang::bind(&proxy::get_routing_table, this,
+          jubatus::util::lang::_1, jubatus::util::lang::_2));
 }
 
 proxy::~proxy() {
@@ -29,6 +29,7 @@
 #include "jubatus/util/lang/function.h"
 #include "jubatus/util/lang/bind.h"
 
+#include "aggregators.hpp"
 #include "proxy_common.hpp"
 #include "server_util.hpp"
 #include "../common/logger/logger.hpp"
@@ -62,198 +63,332 @@ class proxy
   int run();
 
   // async random method ( arity 0-4 )
+  //   Arguments other than the name are not decoded by the proxy; the
+  //   request is forwarded as it is and the response is relayed without
+  //   re-encoding.
   template<typename R>
   void register_async_random(const std::string& method_name) {
-    typedef typename msgpack::type::tuple<std::string> packed_args_type;
-    register_async_vrandom_inner<R, packed_args_type>(method_name);
+    register_async_vrandom_inner<R>(method_name);
   }
 
   template<typename R, typename A0>
   void register_async_random(const std::string& method_name) {
-    typedef typename msgpack::type::tuple<std::string, A0> packed_args_type;
-    register_async_vrandom_inner<R, packed_args_type>(method_name);
+    register_async_vrandom_inner<R>(method_name);
   }
 
   template<typename R, typename A0, typename A1>
   void register_async_random(const std::string& method_name) {
-    typedef typename msgpack::type::tuple<std::string, A0, A1>
-      packed_args_type;
-    register_async_vrandom_inner<R, packed_args_type>(method_name);
+    register_async_vrandom_inner<R>(method_name);
   }
 
   template<typename R, typename A0, typename A1, typename A2>
   void register_async_random(const std::string& method_name) {
-    typedef typename msgpack::type::tuple<std::string, A0, A1, A2>
-      packed_args_type;
-    register_async_vrandom_inner<R, packed_args_type>(method_name);
+    register_async_vrandom_inner<R>(method_name);
   }
 
   template<typename R, typename A0, typename A1, typename A2, typename A3>
   void register_async_random(const std::string& method_name) {
-    typedef typename msgpack::type::tuple<std::string, A0, A1, A2, A3>
-      packed_args_type;
-    register_async_vrandom_inner<R, packed_args_type>(method_name);
+    register_async_vrandom_inner<R>(method_name);
+  }
+
+  // async analysis method ( arity 0-4 )
+  //   Same as register_async_random, but serving-only replicas may be
+  //   chosen as well as active servers.
+  template<typename R>
+  void register_async_analysis(const std::string& method_name) {
+    register_async_vrandom_inner<R>(method_name, true);
+  }
+
+  template<typename R, typename A0>
+  void register_async_analysis(const std::string& method_name) {
+    register_async_vrandom_inner<R>(method_name, true);
+  }
+
+  template<typename R, typename A0, typename A1>
+  void register_async_analysis(const std::string& method_name) {
+    register_async_vrandom_inner<R>(method_name, true);
+  }
+
+  template<typename R, typename A0, typename A1, typename A2>
+  void register_async_analysis(const std::string& method_name) {
+    register_async_vrandom_inner<R>(method_name, true);
+  }
+
+  template<typename R, typename A0, typename A1, typename A2, typename A3>
+  void register_async_analysis(const std::string& method_name) {
+    register_async_vrandom_inner<R>(method_name, true);
   }
 
   // async broadcast method ( arity 0-4 )
+  //   Arguments are forwarded without decoding; responses are decoded as R
+  //   only when they need to be aggregated.
   template<typename R>
   void register_async_broadcast(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string> packed_args_type;
-    register_async_vbroadcast_inner<R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vbroadcast_inner<R>(method_name, agg);
   }
 
   template<typename R, typename A0>
   void register_async_broadcast(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, A0> packed_args_type;
-    register_async_vbroadcast_inner<R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vbroadcast_inner<R>(method_name, agg);
   }
 
   template<typename R, typename A0, typename A1>
   void register_async_broadcast(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, A0, A1> packed_args_type;
-    register_async_vbroadcast_inner<R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vbroadcast_inner<R>(method_name, agg);
   }
 
   template<typename R, typename A0, typename A1, typename A2>
   void register_async_broadcast(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, A0, A1, A2>
-      packed_args_type;
-    register_async_vbroadcast_inner<R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vbroadcast_inner<R>(method_name, agg);
   }
 
   template<typename R, typename A0, typename A1, typename A2, typename A3>
   void register_async_broadcast(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, A0, A1, A2, A3>
-      packed_args_type;
-    register_async_vbroadcast_inner<R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vbroadcast_inner<R>(method_name, agg);
+  }
+
+  // async scatter method ( arity 0-4 )
+  //   Routed as an analysis method when every server has the whole model,
+  //   so serving-only replicas may answer as well; scatter methods never
+  //   update the model.
+  //   With --partitioned, the request is broadcast to all servers, each of
+  //   which answers from the rows it owns, and the results are aggregated.
+  template<typename R>
+  void register_async_scatter(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vscatter_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0>
+  void register_async_scatter(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vscatter_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0, typename A1>
+  void register_async_scatter(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vscatter_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0, typename A1, typename A2>
+  void register_async_scatter(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vscatter_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0, typename A1, typename A2, typename A3>
+  void register_async_scatter(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vscatter_inner<R>(method_name, agg);
+  }
+
+  // async scatter method returning the k best results ( arity 1-4 )
+  //   Same as register_async_scatter, but the aggregator also takes k,
+  //   which is the last argument of the request.
+  template<typename R, typename A0>
+  void register_async_scatter_k(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&, size_t)> agg) {
+    register_async_vscatter_k_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0, typename A1>
+  void register_async_scatter_k(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&, size_t)> agg) {
+    register_async_vscatter_k_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0, typename A1, typename A2>
+  void register_async_scatter_k(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&, size_t)> agg) {
+    register_async_vscatter_k_inner<R>(method_name, agg);
+  }
+
+  template<typename R, typename A0, typename A1, typename A2, typename A3>
+  void register_async_scatter_k(
+      const std::string& method_name,
+      jubatus::util::lang::function<void(R&, R&, size_t)> agg) {
+    register_async_vscatter_k_inner<R>(method_name, agg);
   }
 
   // async cht method ( arity 0-4 )
+  //   Only the name and the ID are decoded by the proxy.
   template<int N, typename R>
   void register_async_cht(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, std::string>
-      packed_args_type;
-    register_async_vcht_inner<N, R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vcht_inner<N, R>(method_name, agg);
   }
 
   template<int N, typename R, typename A0>
   void register_async_cht(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, std::string, A0>
-      packed_args_type;
-    register_async_vcht_inner<N, R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vcht_inner<N, R>(method_name, agg);
   }
 
   template<int N, typename R, typename A0, typename A1>
   void register_async_cht(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, std::string, A0, A1>
-      packed_args_type;
-    register_async_vcht_inner<N, R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vcht_inner<N, R>(method_name, agg);
   }
 
   template<int N, typename R, typename A0, typename A1, typename A2>
   void register_async_cht(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, std::string, A0, A1, A2>
-      packed_args_type;
-    register_async_vcht_inner<N, R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vcht_inner<N, R>(method_name, agg);
   }
 
   template<int N, typename R, typename A0, typename A1, typename A2,
            typename A3>
   void register_async_cht(
       const std::string& method_name,
-      jubatus::util::lang::function<R(R, R)> agg) {
-    typedef typename msgpack::type::tuple<std::string, std::string, A0, A1, A2,
-        A3> packed_args_type;
-    register_async_vcht_inner<N, R, packed_args_type>(method_name, agg);
+      jubatus::util::lang::function<void(R&, R&)> agg) {
+    register_async_vcht_inner<N, R>(method_name, agg);
   }
 
  private:
-  template<typename R, typename Tuple>
-  void register_async_vrandom_inner(const std::string& method_name) {
+  // packed arguments are kept as msgpack::object, which refers to the
+  // buffer of the received request, and forwarded as they are
+  typedef msgpack::object raw_args_type;
+  typedef common::mprpc::async_vmethod<raw_args_type>::type raw_vfunc_type;
+
+  template<typename R>
+  void register_async_vrandom_inner(
+      const std::string& method_name,
+      bool analysis = false) {
     using mp::placeholders::_1;
     using mp::placeholders::_2;
-    typedef typename common::mprpc::async_vmethod<Tuple>::type vfunc_type;
 
-    vfunc_type f = mp::bind(
-        &proxy::template random_async_vproxy<R, Tuple>,
-        this, /* request */_1, method_name, /* packed_args */_2);
-    add_async_vmethod<Tuple>(method_name, f);
+    raw_vfunc_type f = mp::bind(
+        &proxy::template random_async_vproxy<R>,
+        this, /* request */_1, method_name, /* packed_args */_2, analysis);
+    add_async_vmethod<raw_args_type>(method_name, f);
   }
 
-  template<typename R, typename Tuple>
+  template<typename R>
   void register_async_vbroadcast_inner(
       const std::string& method_name,
-      const jubatus::util::lang::function<R(R, R)>& agg) {
+      const jubatus::util::lang::function<void(R&, R&)>& agg) {
+    using mp::placeholders::_1;
+    using mp::placeholders::_2;
+
+    raw_vfunc_type f = mp::bind(
+        &proxy::template broadcast_async_vproxy<R>,
+        this, /* request */_1, method_name, /* packed_args */_2, agg);
+    add_async_vmethod<raw_args_type>(method_name, f);
+  }
+
+  template<typename R>
+  void register_async_vscatter_inner(
+      const std::string& method_name,
+      const jubatus::util::lang::function<void(R&, R&)>& agg) {
+    if (a_.partitioned) {
+      register_async_vbroadcast_inner<R>(method_name, agg);
+    } else {
+      register_async_vrandom_inner<R>(method_name, true);
+    }
+  }
+
+  template<typename R>
+  void register_async_vscatter_k_inner(
+      const std::string& method_name,
+      const jubatus::util::lang::function<void(R&, R&, size_t)>& agg) {
     using mp::placeholders::_1;
     using mp::placeholders::_2;
-    typedef typename common::mprpc::async_vmethod<Tuple>::type vfunc_type;
 
-    vfunc_type f = mp::bind(
-        &proxy::template broadcast_async_vproxy<R, Tuple>,
+    if (!a_.partitioned) {
+      register_async_vrandom_inner<R>(method_name, true);
+      return;
+    }
+    raw_vfunc_type f = mp::bind(
+        &proxy::template scatter_k_async_vproxy<R>,
         this, /* request */_1, method_name, /* packed_args */_2, agg);
-    add_async_vmethod<Tuple>(method_name, f);
+    add_async_vmethod<raw_args_type>(method_name, f);
   }
 
-  template<int N, typename R, typename Tuple>
+  template<int N, typename R>
   void register_async_vcht_inner(
       const std::string& method_name,
-      const jubatus::util::lang::function<R(R, R)>& agg) {
+      const jubatus::util::lang::function<void(R&, R&)>& agg) {
     using mp::placeholders::_1;
     using mp::placeholders::_2;
-    typedef typename common::mprpc::async_vmethod<Tuple>::type vfunc_type;
 
-    vfunc_type f = mp::bind(
-        &proxy::template cht_async_vproxy<N, R, Tuple>,
+    raw_vfunc_type f = mp::bind(
+        &proxy::template cht_async_vproxy<N, R>,
         this, /* request */_1, method_name, /* packed_args */_2, agg);
-    add_async_vmethod<Tuple>(method_name, f);
+    add_async_vmethod<raw_args_type>(method_name, f);
   }
 
  private:
-  template<typename R, typename Tuple>
+  // decodes the first N arguments only (msgpack ignores the rest)
+  template<typename Head>
+  static Head peek_args(const raw_args_type& args) {
+    Head head;
+    args.convert(&head);
+    return head;
+  }
+
+  template<typename R>
   void random_async_vproxy(
       request_type req,
       const std::string& method_name,
-      const Tuple& args) {
+      const raw_args_type& args,
+      bool analysis) {
     std::vector<std::pair<std::string, int> > list;
-    std::string name = args.template get<0>();
+    std::string name =
+        peek_args<msgpack::type::tuple<std::string> >(args).template get<0>();
 
     update_request_counter();
 
-    get_members_(name, list);
-    const std::pair<std::string, int>& c = list[rng_(list.size())];
+    if (analysis) {
+      get_analysis_members_(name, list);
+    } else {
+      get_members_(name, list);
+    }
+
+    // the first candidate gets the request; the others are used in turn
+    // when a server rejects the request as busy
+    host_list_type candidates;
+    order_candidates_(list, candidates);
 
     update_forward_counter();
 
-    async_task_loop::template call_apply<R, Tuple>(
-        c.first, c.second, method_name, args, a_, a_.interconnect_timeout, req);
+    // the response of a single server is relayed without decoding
+    async_task_loop::template call_apply_with_retry<
+        msgpack::object, raw_args_type>(
+        candidates, method_name, args, a_, a_.interconnect_timeout, req);
   }
 
-  template<typename R, typename Tuple>
+  template<typename R>
   void broadcast_async_vproxy(
       request_type req,
       const std::string& method_name,
-      const Tuple& args,
-      jubatus::util::lang::function<R(R, R)>& agg) {
+      const raw_args_type& args,
+      jubatus::util::lang::function<void(R&, R&)>& agg) {
     std::vector<std::pair<std::string, int> > list;
-    std::string name = args.template get<0>();
+    std::string name =
+        peek_args<msgpack::type::tuple<std::string> >(args).template get<0>();
 
     update_request_counter();
 
@@ -261,19 +396,39 @@ class proxy
 
     update_forward_counter(list.size());
 
-    async_task_loop::template call_apply<R, Tuple>(
-        list, method_name, args, a_, a_.interconnect_timeout, req, agg);
+    forward<R>(list, method_name, args, req, agg);
   }
 
-  template<int N, typename R, typename Tuple>
+  template<typename R>
+  void scatter_k_async_vproxy(
+      request_type req,
+      const std::string& method_name,
+      const raw_args_type& args,
+      jubatus::util::lang::function<void(R&, R&, size_t)>& agg) {
+    // only k (the last argument) is decoded in addition to the name
+    if (args.type != msgpack::type::ARRAY || args.via.array.size < 2) {
+      throw msgpack::type_error();
+    }
+    const size_t k = args.via.array.ptr[args.via.array.size - 1]
+        .as<uint32_t>();
+    jubatus::util::lang::function<void(R&, R&)> merge_k =
+        jubatus::util::lang::bind(
+            agg, jubatus::util::lang::_1, jubatus::util::lang::_2, k);
+
+    broadcast_async_vproxy<R>(req, method_name, args, merge_k);
+  }
+
+  template<int N, typename R>
   void cht_async_vproxy(
       request_type req,
       const std::string& method_name,
-      const Tuple& args,
-      jubatus::util::lang::function<R(R, R)>& agg) {
+      const raw_args_type& args,
+      jubatus::util::lang::function<void(R&, R&)>& agg) {
     std::vector<std::pair<std::string, int> > list;
-    std::string name = args.template get<0>();
-    std::string id = args.template get<1>();
+    msgpack::type::tuple<std::string, std::string> head =
+        peek_args<msgpack::type::tuple<std::string, std::string> >(args);
+    std::string name = head.template get<0>();
+    std::string id = head.template get<1>();
 
     update_request_counter();
 
@@ -281,8 +436,24 @@ class proxy
 
     update_forward_counter(list.size());
 
-    async_task_loop::template call_apply<R, Tuple>(
-        list, method_name, args, a_, a_.interconnect_timeout, req, agg);
+    forward<R>(list, method_name, args, req, agg);
+  }
+
+  template<typename R>
+  void forward(
+      const host_list_type& list,
+      const std::string& method_name,
+      const raw_args_type& args,
+      request_type req,
+      jubatus::util::lang::function<void(R&, R&)>& agg) {
+    if (list.size() == 1) {
+      // nothing to aggregate; relay the response without decoding
+      async_task_loop::template call_apply<msgpack::object, raw_args_type>(
+          list, method_name, args, a_, a_.interconnect_timeout, req);
+    } else {
+      async_task_loop::template call_apply<R, raw_args_type>(
+          list, method_name, args, a_, a_.interconnect_timeout, req, agg);
+    }
   }
 
  public:
@@ -296,7 +467,8 @@ class proxy
   class async_task : public mp::enable_shared_from_this<async_task<Res> > {
    public:
     typedef jubatus::util::lang::shared_ptr<Res> result_ptr;
-    typedef jubatus::util::lang::function<Res(Res, Res)> reducer_type;
+    // folds a response (rhs) into the result so far (lhs)
+    typedef jubatus::util::lang::function<void(Res&, Res&)> reducer_type;
 
    public:
     async_task(
@@ -312,9 +484,19 @@ class proxy
           reducer_(reducer),
           running_count_(0),
           cancelled_(false),
+          server_busy_(false),
           timer_id_(-1) {
     }
 
+    /*
+     * Servers to resend a request to when a server rejects it with
+     * SERVER_BUSY_ERROR. The request has not been executed in that case,
+     * so it is safe to resend it.
+     */
+    void set_spare_hosts(const host_list_type& hosts) {
+      spare_hosts_.assign(hosts.rbegin(), hosts.rend());
+    }
+
     virtual ~async_task() {
       cancel_timeout();
     }
@@ -331,6 +513,12 @@ class proxy
         try {
           try {
             done_one_inner(f, future_index);
+          } catch (const jubatus::server::common::mprpc::rpc_server_busy&) {
+            if (resend(future_index)) {
+              return;  // still running on the spare server
+            }
+            server_busy_ = true;
+            throw;
           } catch (const jubatus::server::common::mprpc::rpc_io_error&) {
             if (!transport_error_) {
               transport_error_ = "connect error in proxy";
@@ -366,31 +554,24 @@ class proxy
 
           if (transport_error_) {
             req_.error(*transport_error_);
+          } else if (server_busy_) {
+            // let the client retry later
+            req_.error(jcm::SERVER_BUSY_ERROR,
+                       std::string("server busy: ") + method_name_);
           } else {
             req_.error(get_error_message(errors_[0]));
           }
         } else {
-          req_.result<Res>(aggregate_results());
+          if (result_) {
+            req_.result<Res>(*result_);
+          } else {
+            // TODO(kmaehashi): we should raise exception ?
+            req_.result<Res>(Res());
+          }
         }
       }
     }
 
-    Res aggregate_results() {
-      if (results_.size() == 0) {
-        return Res();  // TODO(kmaehashi): we should raise exception ?
-      }
-
-      if (!reducer_ || results_.size() == 1) {
-        return *(results_[0]);
-      }
-
-      Res tmp_result = *(results_[0]);
-      for (size_t i = 1; i < results_.size(); ++i) {
-        tmp_result = reducer_(tmp_result, *(results_[i]));
-      }
-      return tmp_result;
-    }
-
     void set_timeout(int timeout_sec) {
       cancel_timeout();
       if (timeout_sec > 0) {
@@ -445,21 +626,16 @@ class proxy
         set_timeout(timeout_sec);
       }
 
-      msgpack::rpc::session_pool& pool = at_loop_->pool();
+      if (!spare_hosts_.empty()) {
+        resend_ = jubatus::util::lang::bind(
+            &async_task<Res>::template send<Args>, this, method_name, args,
+            jubatus::util::lang::_1);
+      }
+
+      futures_.resize(hosts_.size());
+      sessions_.resize(hosts_.size());
       for (size_t i = 0; i < hosts_.size(); ++i) {
-        msgpack::rpc::session s = pool.get_session(hosts_[i].first,
-                                                   hosts_[i].second);
-        // disable msgpack::rpc::session's timeout.
-        // because session timeout is managed by proxy::async_task
-        s.set_timeout(0);
-
-        // apply async method call and set its callback
-        msgpack::rpc::future f = s.call_apply(method_name, args);
-        futures_.push_back(f);
-        sessions_.push_back(s);
-        f.attach_callback(
-            mp::bind(&async_task<Res>::done_one, this->shared_from_this(),
-                     mp::placeholders::_1, i));
+        send<Args>(method_name, args, i);
       }
     }
 
@@ -473,22 +649,71 @@ class proxy
 
     int running_count_;
     bool cancelled_;
+    bool server_busy_;
     int timer_id_;
 
+    host_list_type spare_hosts_;
+    jubatus::util::lang::function<void(size_t)> resend_;
+
     std::vector<msgpack::rpc::future> futures_;
     std::vector<msgpack::rpc::session> sessions_;
-    std::vector<result_ptr> results_;
+    // responses are folded into result_ as they arrive, so that each of
+    // them is released as soon as it is aggregated
+    result_ptr result_;
+    msgpack::rpc::future result_future_;
     std::vector<jubatus::server::common::mprpc::rpc_error> errors_;
     jubatus::util::data::optional<std::string> transport_error_;
 
     mp::pthread_recursive_mutex lock_;
 
+    template<typename Args>
+    void send(const std::string& method_name, const Args& args, size_t i) {
+      msgpack::rpc::session s = at_loop_->pool().get_session(
+          hosts_[i].first, hosts_[i].second);
+      // disable msgpack::rpc::session's timeout.
+      // because session timeout is managed by proxy::async_task
+      s.set_timeout(0);
+
+      // apply async method call and set its callback
+      msgpack::rpc::future f = s.call_apply(method_name, args);
+      futures_[i] = f;
+      sessions_[i] = s;
+      f.attach_callback(
+          mp::bind(&async_task<Res>::done_one, this->shared_from_this(),
+                   mp::placeholders::_1, i));
+    }
+
+    // resend i-th request to a spare host; called with lock_ held
+    bool resend(int future_index) {
+      if (spare_hosts_.empty() || !resend_) {
+        return false;
+      }
+      LOG(INFO) << "server busy: " << hosts_[future_index].first << ":"
+                << hosts_[future_index].second << ", retrying on "
+                << spare_hosts_.back().first << ":"
+                << spare_hosts_.back().second;
+      hosts_[future_index] = spare_hosts_.back();
+      spare_hosts_.pop_back();
+      resend_(future_index);
+      return true;
+    }
+
     void done_one_inner(msgpack::rpc::future f, int future_index) {
       namespace jcm = jubatus::server::common::mprpc;
 
       try {
-        result_ptr result(new Res(f.get<Res>()));
-        results_.push_back(result);
+        if (!result_) {
+          result_.reset(new Res(f.get<Res>()));
+          // keep the future, which owns the zone a relayed (undecoded)
+          // msgpack::object result refers to
+          result_future_ = f;
+          if (reducer_) {
+            inplace::presize(*result_, hosts_.size());
+          }
+        } else if (reducer_) {
+          Res response = f.get<Res>();
+          reducer_(*result_, response);
+        }
       }
       JUBATUS_MSGPACKRPC_EXCEPTION_DEFAULT_HANDLER(method_name_);
     }
@@ -569,6 +794,28 @@ class proxy
                             reducer);
     }
 
+    /*
+     * call_apply (for single server chosen from candidates)
+     *   Sends to candidates[0]; when the server is busy, the request is
+     *   resent to the next candidate.
+     */
+    template<typename Res, typename Args>
+    static void call_apply_with_retry(
+        const host_list_type& candidates,
+        const std::string& method_name,
+        const Args& args,
+        const proxy_argv& a,
+        int timeout_sec,
+        request_type req) {
+      async_task_loop* at_loop = get_private_async_task_loop(a);
+      host_list_type hosts(candidates.begin(), candidates.begin() + 1);
+      mp::shared_ptr<async_task<Res> > task(
+          new async_task<Res>(at_loop, hosts, method_name, req));
+      task->set_spare_hosts(
+          host_list_type(candidates.begin() + 1, candidates.end()));
+      task->template call_apply<Args>(method_name, args, timeout_sec);
+    }
+
    private:
     static async_task_loop* startup(const proxy_argv& a) {
       async_task_loop* at_loop = new async_task_loop(a);
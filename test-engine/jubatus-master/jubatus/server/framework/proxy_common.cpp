@@ -18,15 +18,20 @@
 
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/function.h"
 #include "jubatus/core/common/exception.hpp"
 #include "server_util.hpp"
 #include "../common/logger/logger.hpp"
 #include "../common/membership.hpp"
+#include "../common/network.hpp"
 #include "../common/signals.hpp"
 
 using jubatus::util::system::time::clock_time;
@@ -56,7 +61,8 @@ proxy_common::proxy_common(const proxy_argv& a)
     : a_(a),
       request_counter_(0),
       forward_counter_(0),
-      start_time_(get_clock_time()) {
+      start_time_(get_clock_time()),
+      routing_generation_(0) {
   common::prepare_signal_handling();
 
   zk_.reset(common::create_lock_service(
@@ -64,6 +70,14 @@ proxy_common::proxy_common(const proxy_argv& a)
   zk_->push_cleanup(&jubatus::server::common::shutdown_server);
   register_lock_service(zk_);
   jubatus::server::common::prepare_jubatus(*zk_, a_.type, "");
+
+  if (a_.prefer_local) {
+    const common::address_list addrs = common::get_network_address();
+    for (size_t i = 0; i < addrs.size(); ++i) {
+      local_addresses_.insert(addrs[i]->address());
+    }
+    local_addresses_.insert(a_.eth);
+  }
 }
 
 proxy_common::~proxy_common() {
@@ -98,6 +112,34 @@ void proxy_common::get_members_(
   }
 }
 
+void proxy_common::get_analysis_members_(
+    const std::string& name, std::vector<std::pair<std::string, int> >& ret) {
+  ret.clear();
+  std::vector<std::string> list;
+  std::vector<std::string> servings;
+  std::string path;
+  common::build_actor_path(path, a_.type, name);
+
+  {
+    jubatus::util::concurrent::scoped_lock lk(mutex_);
+    zk_->list(path + "/actives", list);
+    zk_->list(path + "/servings", servings);
+  }
+  list.insert(list.end(), servings.begin(), servings.end());
+
+  if (list.empty()) {
+    throw JUBATUS_EXCEPTION(no_worker(name));
+  }
+
+  for (std::vector<std::string>::const_iterator it = list.begin();
+       it != list.end(); ++it) {
+    std::string ip;
+    int port;
+    common::revert(*it, ip, port);
+    ret.push_back(make_pair(ip, port));
+  }
+}
+
 void proxy_common::get_members_from_cht_(
     const std::string& name,
     const std::string& id,
@@ -113,6 +155,126 @@ void proxy_common::get_members_from_cht_(
   }
 }
 
+void proxy_common::order_candidates_(
+    const std::vector<std::pair<std::string, int> >& list,
+    std::vector<std::pair<std::string, int> >& ret) {
+  ret.clear();
+  ret.reserve(list.size());
+
+  jubatus::util::concurrent::scoped_lock lk(mutex_);
+  const size_t first = rng_(list.size());
+  if (local_addresses_.empty()) {
+    for (size_t i = 0; i < list.size(); ++i) {
+      ret.push_back(list[(first + i) % list.size()]);
+    }
+    return;
+  }
+
+  // local servers, then remote ones, each starting at a random position
+  std::vector<std::pair<std::string, int> > remotes;
+  for (size_t i = 0; i < list.size(); ++i) {
+    const std::pair<std::string, int>& s = list[(first + i) % list.size()];
+    if (local_addresses_.count(s.first)) {
+      ret.push_back(s);
+    } else {
+      remotes.push_back(s);
+    }
+  }
+  if (!ret.empty()) {
+    std::rotate(ret.begin(), ret.begin() + rng_(ret.size()), ret.end());
+  }
+  ret.insert(ret.end(), remotes.begin(), remotes.end());
+}
+
+routing_table proxy_common::get_routing_table(
+    const std::string& name,
+    const std::string& known_version) {
+  update_request_counter();
+
+  routing_table table;
+  uint64_t generation;
+  bool watched;
+  {
+    jubatus::util::concurrent::scoped_lock lk(routing_mutex_);
+    std::map<std::string, routing_table>::const_iterator it =
+        routing_tables_.find(name);
+    if (it != routing_tables_.end()) {
+      table = it->second;
+    }
+    generation = routing_generation_;
+    watched = routing_watched_.count(name) > 0;
+  }
+
+  if (table.version.empty()) {
+    if (!watched) {
+      // watchers are set before reading, so that no change is missed
+      std::string path;
+      common::build_actor_path(path, a_.type, name);
+      const jubatus::util::lang::function<void(int, int, std::string)>
+          watcher = jubatus::util::lang::bind(
+              &proxy_common::routing_changed_, this,
+              jubatus::util::lang::_1, jubatus::util::lang::_2, name);
+      {
+        jubatus::util::concurrent::scoped_lock lk(mutex_);
+        watched = zk_->bind_child_watcher(path + "/actives", watcher);
+        watched = zk_->bind_child_watcher(path + "/cht", watcher) && watched;
+      }
+      if (watched) {
+        jubatus::util::concurrent::scoped_lock lk(routing_mutex_);
+        routing_watched_.insert(name);
+      }
+    }
+
+    build_routing_table_(name, table);
+
+    if (watched) {
+      jubatus::util::concurrent::scoped_lock lk(routing_mutex_);
+      if (generation == routing_generation_) {
+        routing_tables_[name] = table;
+      }
+    }
+  }
+
+  if (table.version == known_version) {
+    table.members.clear();
+    table.ring.clear();
+  }
+  return table;
+}
+
+void proxy_common::build_routing_table_(
+    const std::string& name,
+    routing_table& table) {
+  get_members_(name, table.members);
+  {
+    jubatus::util::concurrent::scoped_lock lk(mutex_);
+    common::cht ht(zk_, a_.type, name);
+    ht.get_ring(table.ring);
+  }
+
+  std::sort(table.members.begin(), table.members.end());
+  std::ostringstream digest;
+  for (size_t i = 0; i < table.members.size(); ++i) {
+    digest << common::build_loc_str(
+        table.members[i].first, table.members[i].second) << ',';
+  }
+  for (size_t i = 0; i < table.ring.size(); ++i) {
+    digest << table.ring[i].first << ',';
+  }
+  table.version = common::make_hash(digest.str());
+}
+
+void proxy_common::routing_changed_(
+    int type,
+    int state,
+    const std::string& name) {
+  jubatus::util::concurrent::scoped_lock lk(routing_mutex_);
+  routing_tables_.erase(name);
+  routing_watched_.erase(name);
+  ++routing_generation_;
+  DLOG(INFO) << "routing table of " << name << " is dropped";
+}
+
 void proxy_common::update_request_counter() {
   jubatus::util::concurrent::scoped_lock lk(mutex_);
   ++request_counter_;
@@ -172,6 +334,8 @@ proxy_common::status_type proxy_common::get_status() {
       jubatus::util::lang::lexical_cast<std::string>(a_.session_pool_expire);
   data["session_pool_size"] =
       jubatus::util::lang::lexical_cast<std::string>(a_.session_pool_size);
+  data["prefer_local"] =
+      jubatus::util::lang::lexical_cast<std::string>(a_.prefer_local);
 
   data["request_count"] =
       jubatus::util::lang::lexical_cast<std::string>(request_counter_);
@@ -18,9 +18,11 @@
 #define JUBATUS_SERVER_FRAMEWORK_PROXY_COMMON_HPP_
 
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
+#include <msgpack.hpp>
 
 #include "jubatus/util/concurrent/lock.h"
 #include "jubatus/util/concurrent/rwmutex.h"
@@ -45,6 +47,17 @@ class no_worker : public jubatus::core::common::exception::runtime_error {
   }
 };
 
+// routing table for clients sending requests to servers directly
+struct routing_table {
+  // digest of members and ring; changes whenever either of them changes
+  std::string version;
+  std::vector<std::pair<std::string, int> > members;
+  // CHT ring as (hash, node) sorted by hash
+  std::vector<std::pair<std::string, std::pair<std::string, int> > > ring;
+
+  MSGPACK_DEFINE(version, members, ring);
+};
+
 class proxy_common {
  public:
   typedef std::map<std::string, std::string> string_map;
@@ -58,14 +71,34 @@ class proxy_common {
       const std::string& name,
       std::vector<std::pair<std::string, int> >& ret);
 
+  // active servers and serving-only replicas, which both answer analysis
+  // requests
+  void get_analysis_members_(
+      const std::string& name,
+      std::vector<std::pair<std::string, int> >& ret);
+
   void get_members_from_cht_(
       const std::string& name,
       const std::string& id,
       std::vector<std::pair<std::string, int> >& ret,
       size_t n);
 
+  // orders the servers to try for a request any of them can serve: a
+  // randomly chosen one first and the others in turn; with prefer_local,
+  // servers on this host come before the remote ones
+  void order_candidates_(
+      const std::vector<std::pair<std::string, int> >& list,
+      std::vector<std::pair<std::string, int> >& ret);
+
   status_type get_status();
 
+  // returns an empty table (except for its version) when the version
+  // is the same as the one the client knows; tables are cached until the
+  // members or the ring of the cluster change
+  routing_table get_routing_table(
+      const std::string& name,
+      const std::string& known_version);
+
   void update_request_counter();
   void update_forward_counter(const uint64_t = 1);
 
@@ -74,8 +107,23 @@ class proxy_common {
   uint64_t forward_counter_;
   jubatus::util::system::time::clock_time start_time_;
   jubatus::util::math::random::mtrand rng_;
+  // addresses of this host, used with prefer_local
+  std::set<std::string> local_addresses_;
   jubatus::util::concurrent::mutex mutex_;
   jubatus::util::lang::shared_ptr<common::lock_service> zk_;
+
+ private:
+  void build_routing_table_(const std::string& name, routing_table& table);
+  // ZooKeeper watcher of the members and the ring of cluster `name`
+  void routing_changed_(int type, int state, const std::string& name);
+
+  std::map<std::string, routing_table> routing_tables_;
+  // clusters whose members and ring are being watched
+  std::set<std::string> routing_watched_;
+  // bumped whenever a cached table is dropped, so that a table built
+  // across the change is not cached
+  uint64_t routing_generation_;
+  jubatus::util::concurrent::mutex routing_mutex_;
 };
 
 }  // namespace framework
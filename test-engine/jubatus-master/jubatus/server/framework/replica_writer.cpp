@@ -0,0 +1,109 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "replica_writer.hpp"
+
+#include <map>
+#include <string>
+
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/cast.h"
+#include "../common/logger/logger.hpp"
+
+using jubatus::util::concurrent::scoped_lock;
+using jubatus::util::lang::lexical_cast;
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+write_quorum parse_write_quorum(const std::string& quorum) {
+  if (quorum == "primary") {
+    return WRITE_QUORUM_PRIMARY;
+  } else if (quorum == "all") {
+    return WRITE_QUORUM_ALL;
+  }
+  throw JUBATUS_EXCEPTION(
+      jubatus::core::common::exception::runtime_error(
+          "unknown replica write quorum: " + quorum));
+}
+
+replica_writer::replica_writer(const server_argv& a)
+    : self_host_(a.eth),
+      self_port_(a.port),
+      timeout_sec_(a.interconnect_timeout),
+      quorum_(parse_write_quorum(a.replica_write_quorum)) {
+  // replica writes not waited for are completed by this thread
+  pool_.start(1);
+}
+
+replica_writer::~replica_writer() {
+  pool_.end();
+  pool_.join();
+}
+
+void replica_writer::get_status(server_base::status_t& status) const {
+  scoped_lock lk(m_);
+  status["replica.write_quorum"] =
+      quorum_ == WRITE_QUORUM_ALL ? "all" : "primary";
+  for (std::map<std::string, replica_counter>::const_iterator
+       it = counters_.begin(); it != counters_.end(); ++it) {
+    status["replica." + it->first + ".writes"] =
+        lexical_cast<std::string>(it->second.writes);
+    status["replica." + it->first + ".failures"] =
+        lexical_cast<std::string>(it->second.failures);
+  }
+}
+
+bool replica_writer::is_self(const host_type& host) const {
+  return host.first == self_host_ && host.second == self_port_;
+}
+
+void replica_writer::count(
+    const host_type& host,
+    bool failed,
+    const std::string& what) {
+  const std::string id = host_string(host);
+  if (failed) {
+    LOG(WARNING) << "cannot write replica (" << what << "): " << id;
+  }
+
+  scoped_lock lk(m_);
+  replica_counter& c = counters_[id];
+  ++c.writes;
+  if (failed) {
+    ++c.failures;
+  }
+}
+
+void replica_writer::replica_done(
+    msgpack::rpc::future f,
+    const host_type& host) {
+  try {
+    f.get<msgpack::object>();
+    count(host, false, "");
+  } catch (const std::exception& e) {
+    count(host, true, e.what());
+  }
+}
+
+std::string replica_writer::host_string(const host_type& host) {
+  return host.first + "_" + lexical_cast<std::string>(host.second);
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
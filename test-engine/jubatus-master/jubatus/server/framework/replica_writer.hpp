@@ -0,0 +1,180 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef JUBATUS_SERVER_FRAMEWORK_REPLICA_WRITER_HPP_
+#define JUBATUS_SERVER_FRAMEWORK_REPLICA_WRITER_HPP_
+
+#include <stdint.h>
+#include <exception>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <jubatus/msgpack/rpc/future.h>
+#include <jubatus/msgpack/rpc/session_pool.h>
+#include "jubatus/util/concurrent/mutex.h"
+#include "jubatus/util/lang/function.h"
+#include "jubatus/util/lang/noncopyable.h"
+
+#include "jubatus/core/common/exception.hpp"
+#include "server_base.hpp"
+#include "server_util.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+
+enum write_quorum {
+  WRITE_QUORUM_PRIMARY,  // acknowledge when the primary node is written
+  WRITE_QUORUM_ALL  // acknowledge when all replicas are written
+};
+
+// replica_writer
+//   Writes a CHT-replicated update to its primary and replica nodes at once.
+//   Remote nodes are called concurrently over a pooled session, and the
+//   local node (when this server is one of them) is written in the calling
+//   thread meanwhile.
+class replica_writer : jubatus::util::lang::noncopyable {
+ public:
+  typedef std::pair<std::string, int> host_type;
+  typedef std::vector<host_type> host_list_type;
+
+  explicit replica_writer(const server_argv& a);
+  ~replica_writer();
+
+  // nodes[0] is the primary. Returns the result of the primary.
+  // Failure of the primary is always an error; failures of the replicas
+  // are errors only with WRITE_QUORUM_ALL, otherwise they are counted and
+  // the request returns without waiting for them.
+  template<typename Res, typename Args>
+  Res write(
+      const host_list_type& nodes,
+      const std::string& method,
+      const Args& args,
+      const jubatus::util::lang::function<Res()>& local);
+
+  write_quorum quorum() const {
+    return quorum_;
+  }
+
+  void get_status(server_base::status_t& status) const;
+
+ private:
+  struct replica_counter {
+    replica_counter()
+        : writes(0),
+          failures(0) {
+    }
+    uint64_t writes;
+    uint64_t failures;
+  };
+
+  bool is_self(const host_type& host) const;
+  void count(const host_type& host, bool failed, const std::string& what);
+  void replica_done(msgpack::rpc::future f, const host_type& host);
+
+  static std::string host_string(const host_type& host);
+
+  const std::string self_host_;
+  const int self_port_;
+  const int timeout_sec_;
+  const write_quorum quorum_;
+
+  msgpack::rpc::session_pool pool_;
+
+  mutable jubatus::util::concurrent::mutex m_;
+  std::map<std::string, replica_counter> counters_;
+};
+
+write_quorum parse_write_quorum(const std::string& quorum);
+
+template<typename Res, typename Args>
+Res replica_writer::write(
+    const host_list_type& nodes,
+    const std::string& method,
+    const Args& args,
+    const jubatus::util::lang::function<Res()>& local) {
+  std::vector<msgpack::rpc::future> futures(nodes.size());
+  std::vector<bool> remote(nodes.size(), false);
+  int local_index = -1;
+
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (is_self(nodes[i])) {
+      local_index = static_cast<int>(i);
+      continue;
+    }
+    msgpack::rpc::session s =
+        pool_.get_session(nodes[i].first, nodes[i].second);
+    s.set_timeout(timeout_sec_);
+    futures[i] = s.call_apply(method, args);
+    remote[i] = true;
+  }
+
+  Res result = Res();
+  std::string failed;
+
+  if (local_index >= 0) {
+    try {
+      result = local();
+      count(nodes[local_index], false, "");
+    } catch (const std::exception& e) {
+      count(nodes[local_index], true, e.what());
+      if (local_index == 0 || quorum_ == WRITE_QUORUM_ALL) {
+        failed = method + " (" + e.what() + "): "
+            + host_string(nodes[local_index]);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (!remote[i]) {
+      continue;
+    }
+    if (i > 0 && quorum_ == WRITE_QUORUM_PRIMARY) {
+      // counted when it completes, without blocking this request
+      futures[i].attach_callback(
+          mp::bind(&replica_writer::replica_done, this,
+                   mp::placeholders::_1, nodes[i]));
+      continue;
+    }
+    try {
+      if (i == 0) {
+        result = futures[i].get<Res>();
+      } else {
+        futures[i].get<msgpack::object>();
+      }
+      count(nodes[i], false, "");
+    } catch (const std::exception& e) {
+      count(nodes[i], true, e.what());
+      if (failed.empty()) {
+        failed = method + " (" + e.what() + "): " + host_string(nodes[i]);
+      }
+    }
+  }
+
+  if (!failed.empty()) {
+    throw JUBATUS_EXCEPTION(
+        jubatus::core::common::exception::runtime_error(failed));
+  }
+  return result;
+}
+
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
+
+#endif  // JUBATUS_SERVER_FRAMEWORK_REPLICA_WRITER_HPP_
@@ -16,10 +16,15 @@
 
 #include "save_load.hpp"
 
+#include <dirent.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <string>
 #include <vector>
+#include "jubatus/util/concurrent/lock.h"
 #include "jubatus/util/lang/cast.h"
 #include "jubatus/util/text/json.h"
 
@@ -30,6 +35,8 @@
 
 #include "../common/logger/logger.hpp"
 #include "../common/crc32.hpp"
+#include "model_delta.hpp"
+#include "model_section.hpp"
 
 using jubatus::core::common::write_big_endian;
 using jubatus::core::common::read_big_endian;
@@ -44,6 +51,17 @@ namespace {
 
 const char magic_number[8] = "jubatus";
 const uint64_t format_version = 1;
+// the user data is a delta against another model file
+const uint64_t delta_format_version = 2;
+// the user data is an index of sections, which are compressed separately
+// and follow the user data
+const uint64_t sectioned_format_version = 3;
+
+// sections are (de)compressed in parallel
+const size_t MODEL_SECTION_SIZE = 8 * 1024 * 1024;
+
+// bases of a delta are followed at most this many times
+const size_t MAX_DELTA_CHAIN = 1024;
 
 uint32_t jubatus_version_major = -1;
 uint32_t jubatus_version_minor = -1;
@@ -85,11 +103,13 @@ struct system_data_container {
 
 uint32_t calc_crc32(const char* header,  // header size is 28 (fixed)
     const char* system_data, uint64_t system_data_size,
-    const char* user_data, uint64_t user_data_size) {
+    const char* user_data, uint64_t user_data_size,
+    const char* extra_data = NULL, uint64_t extra_data_size = 0) {
   uint32_t crc32 = common::calc_crc32(header, 28);
   crc32 = common::calc_crc32(&header[32], 16, crc32);
   crc32 = common::calc_crc32(system_data, system_data_size, crc32);
   crc32 = common::calc_crc32(user_data, user_data_size, crc32);
+  crc32 = common::calc_crc32(extra_data, extra_data_size, crc32);
   return crc32;
 }
 
@@ -108,60 +128,112 @@ bool compare_config(const std::string& left, const std::string& right) {
       lexical_cast<std::string>(lexical_cast<json>(right));
 }
 
-}  // namespace
-
-void save_server(FILE* fp,
-    const server_base& server, const std::string& id) {
-  init_versions();
-
-  msgpack::sbuffer system_data_buf;
-  msgpack::pack(&system_data_buf, system_data_container(server, id));
+void pack_user_data(const server_base& server, msgpack::sbuffer& buf) {
+  core::framework::stream_writer<msgpack::sbuffer> st(buf);
+  core::framework::jubatus_packer jp(st);
+  core::framework::packer packer(jp);
+  packer.pack_array(2);
 
-  msgpack::sbuffer user_data_buf;
-  {
-    core::framework::stream_writer<msgpack::sbuffer> st(user_data_buf);
-    core::framework::jubatus_packer jp(st);
-    core::framework::packer packer(jp);
-    packer.pack_array(2);
+  uint64_t user_data_version = server.user_data_version();
+  packer.pack(user_data_version);
+  server.get_driver()->pack(packer);
+}
 
-    uint64_t user_data_version = server.user_data_version();
-    packer.pack(user_data_version);
-    server.get_driver()->pack(packer);
-  }
+/**
+ * Write a model file.
+ * The user data is `user_data` followed by `extra_data`.
+ */
+void write_model_file(
+    FILE* fp,
+    uint64_t version,
+    const char* system_data, uint64_t system_data_size,
+    const char* user_data, uint64_t user_data_size,
+    const char* extra_data = NULL, uint64_t extra_data_size = 0) {
+  init_versions();
 
   char header_buf[48];
   std::memcpy(header_buf, magic_number, 8);
-  write_big_endian(format_version, &header_buf[8]);
+  write_big_endian(version, &header_buf[8]);
   write_big_endian(jubatus_version_major, &header_buf[16]);
   write_big_endian(jubatus_version_minor, &header_buf[20]);
   write_big_endian(jubatus_version_maintenance, &header_buf[24]);
   // write_big_endian(crc32, &header_buf[28]);  // skipped
-  write_big_endian(static_cast<uint64_t>(system_data_buf.size()),
-                   &header_buf[32]);
-  write_big_endian(static_cast<uint64_t>(user_data_buf.size()),
-                   &header_buf[40]);
+  write_big_endian(system_data_size, &header_buf[32]);
+  write_big_endian(user_data_size + extra_data_size, &header_buf[40]);
 
   uint32_t crc32 = calc_crc32(header_buf,
-      system_data_buf.data(), system_data_buf.size(),
-      user_data_buf.data(), user_data_buf.size());
+      system_data, system_data_size,
+      user_data, user_data_size,
+      extra_data, extra_data_size);
   write_big_endian(crc32, &header_buf[28]);
 
   if (!fwrite_helper(header_buf, sizeof(header_buf), fp)) {
     throw std::ios_base::failure("Failed to write header_buf.");
   }
-  if (!fwrite_helper(system_data_buf.data(), system_data_buf.size(), fp)) {
+  if (!fwrite_helper(system_data, system_data_size, fp)) {
     throw std::ios_base::failure("Failed to write system_data_buf.");
   }
-  if (!fwrite_helper(user_data_buf.data(), user_data_buf.size(), fp)) {
+  if (!fwrite_helper(user_data, user_data_size, fp)) {
     throw std::ios_base::failure("Failed to write user_data_buf.");
   }
+  if (!fwrite_helper(extra_data, extra_data_size, fp)) {
+    throw std::ios_base::failure("Failed to write delta literals.");
+  }
 }
 
-void load_server(
-    std::istream& is,
-    server_base& server,
-    const std::string& id,
-    bool overwrite_config) {
+/**
+ * Write a model file with the user data compressed in sections.
+ */
+void write_sectioned_model_file(
+    FILE* fp,
+    const char* system_data, uint64_t system_data_size,
+    const char* user_data, uint64_t user_data_size) {
+  model_section_index index;
+  std::vector<char> sections;
+  compress_sections(user_data, user_data_size, MODEL_SECTION_SIZE,
+      default_section_threads(), index, sections);
+  msgpack::sbuffer index_buf;
+  msgpack::pack(&index_buf, index);
+
+  write_model_file(fp, sectioned_format_version,
+      system_data, system_data_size,
+      index_buf.data(), index_buf.size());
+  if (!fwrite_helper(sections.empty() ? NULL : &sections[0],
+                     sections.size(), fp)) {
+    throw std::ios_base::failure("Failed to write model sections.");
+  }
+}
+
+/**
+ * Write a full model file, in the sectioned format only when `sectioned`
+ * is set; servers before the sectioned format can read the plain one.
+ */
+void write_full_model_file(
+    FILE* fp,
+    bool sectioned,
+    const char* system_data, uint64_t system_data_size,
+    const char* user_data, uint64_t user_data_size) {
+  if (sectioned) {
+    write_sectioned_model_file(fp, system_data, system_data_size,
+        user_data, user_data_size);
+  } else {
+    write_model_file(fp, format_version, system_data, system_data_size,
+        user_data, user_data_size);
+  }
+}
+
+struct model_file {
+  uint64_t version;
+  std::vector<char> system_data;
+  std::vector<char> user_data;
+};
+
+/**
+ * Read a model file and check its header and checksum.
+ * The user data of a sectioned model file is decompressed, and the file is
+ * returned as a full model file.
+ */
+void read_model_file(std::istream& is, model_file& file) {
   init_versions();
 
   char header_buf[48];
@@ -171,7 +243,9 @@ void load_server(
         core::common::exception::runtime_error("invalid file format"));
   }
   uint64_t format_version_read = read_big_endian<uint64_t>(&header_buf[8]);
-  if (format_version_read != format_version) {
+  if (format_version_read != format_version &&
+      format_version_read != delta_format_version &&
+      format_version_read != sectioned_format_version) {
     throw JUBATUS_EXCEPTION(
         core::common::exception::runtime_error(
           "invalid format version: " +
@@ -212,22 +286,144 @@ void load_server(
         core::common::exception::runtime_error(ss.str()));
   }
 
-  system_data_container system_data_actual;
+  if (format_version_read == sectioned_format_version) {
+    model_section_index index;
+    try {
+      msgpack::unpacked unpacked;
+      msgpack::unpack(&unpacked, &user_data_buf[0], user_data_size);
+      unpacked.get().convert(&index);
+    } catch (const msgpack::type_error&) {
+      throw JUBATUS_EXCEPTION(
+          core::common::exception::runtime_error(
+            "model section index is broken"));
+    }
+    std::vector<char> sections(index.compressed_size());
+    is.read(sections.empty() ? NULL : &sections[0], sections.size());
+
+    std::vector<char> decompressed;
+    decompress_sections(index, sections.empty() ? NULL : &sections[0],
+        sections.size(), default_section_threads(), decompressed);
+    user_data_buf.swap(decompressed);
+    format_version_read = format_version;
+  }
+
+  file.version = format_version_read;
+  file.system_data.swap(system_data_buf);
+  file.user_data.swap(user_data_buf);
+}
+
+std::string dir_name(const std::string& path) {
+  const std::string::size_type slash = path.rfind('/');
+  return slash == std::string::npos ? std::string(".") :
+      path.substr(0, slash);
+}
+
+std::string base_name(const std::string& path) {
+  const std::string::size_type slash = path.rfind('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/**
+ * Unpack the header of a delta model file; the literals start at
+ * `literals_offset` of the user data.
+ */
+void unpack_delta_header(
+    const model_file& file,
+    model_delta_header& header,
+    size_t& literals_offset) {
+  literals_offset = 0;
   try {
     msgpack::unpacked unpacked;
-    msgpack::unpack(&unpacked, &system_data_buf[0], system_data_size);
-    unpacked.get().convert(&system_data_actual);
+    msgpack::unpack(&unpacked, file.user_data.empty() ? NULL :
+                    &file.user_data[0], file.user_data.size(),
+                    &literals_offset);
+    unpacked.get().convert(&header);
   } catch (const msgpack::type_error&) {
     throw JUBATUS_EXCEPTION(
-        core::common::exception::runtime_error(
-          "system data is broken"));
+        core::common::exception::runtime_error("delta header is broken"));
+  }
+  if (header.base.empty() || header.base.find('/') != std::string::npos) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "invalid base model name: " + header.base));
+  }
+}
+
+/**
+ * Whether `path` is a delta model file; only the head of the file is read.
+ */
+bool is_delta_model_file(const std::string& path) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  char header_buf[16];
+  if (!ifs.read(header_buf, sizeof(header_buf)) ||
+      std::memcmp(header_buf, magic_number, 8) != 0) {
+    return false;
   }
+  return read_big_endian<uint64_t>(&header_buf[8]) == delta_format_version;
+}
 
-  if (overwrite_config) {
-    server.set_config(system_data_actual.config);
+/**
+ * Replace the user data of a delta model file with the whole user data
+ * rebuilt from its chain of bases.
+ */
+void resolve_delta(const std::string& dir, model_file& file, size_t depth) {
+  if (file.version != delta_format_version) {
+    return;
   }
+  if (depth >= MAX_DELTA_CHAIN) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "chain of delta model files is too long"));
+  }
+
+  model_delta_header header;
+  size_t literals_offset = 0;
+  unpack_delta_header(file, header, literals_offset);
 
-  system_data_container system_data_expected(server, id);
+  const std::string base_path = dir + '/' + header.base;
+  std::ifstream ifs(base_path.c_str(), std::ios::binary);
+  if (!ifs) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot open base model file")
+      << core::common::exception::error_file_name(base_path)
+      << core::common::exception::error_errno(errno));
+  }
+  model_file base;
+  ifs.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+  try {
+    read_model_file(ifs, base);
+  } catch (const std::ios_base::failure&) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot read base model file")
+      << core::common::exception::error_file_name(base_path)
+      << core::common::exception::error_errno(errno));
+  }
+  resolve_delta(dir, base, depth + 1);
+
+  std::vector<char> user_data;
+  apply_delta(header,
+      &file.user_data[0] + literals_offset,
+      file.user_data.size() - literals_offset,
+      base.user_data, user_data);
+  file.user_data.swap(user_data);
+  file.version = format_version;
+}
+
+void unpack_system_data(
+    const model_file& file,
+    system_data_container& system_data) {
+  try {
+    msgpack::unpacked unpacked;
+    msgpack::unpack(&unpacked, &file.system_data[0], file.system_data.size());
+    unpacked.get().convert(&system_data);
+  } catch (const msgpack::type_error&) {
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error(
+          "system data is broken"));
+  }
+}
+
+void check_system_data(
+    const system_data_container& system_data_actual,
+    const system_data_container& system_data_expected) {
   if (system_data_actual.version != system_data_expected.version) {
     throw JUBATUS_EXCEPTION(
         core::common::exception::runtime_error(
@@ -250,10 +446,15 @@ void load_server(
           "server config mismatched: " + system_data_actual.config +
           ", expected " + system_data_expected.config));
   }
+}
 
+void unpack_user_data(
+    const model_file& file,
+    uint64_t user_data_version_expected,
+    core::driver::driver_base& driver) {
   try {
     msgpack::unpacked unpacked;
-    msgpack::unpack(&unpacked, &user_data_buf[0], user_data_size);
+    msgpack::unpack(&unpacked, &file.user_data[0], file.user_data.size());
 
     std::vector<msgpack::object> objs;
     unpacked.get().convert(&objs);
@@ -262,7 +463,6 @@ void load_server(
           core::common::exception::runtime_error("invalid user container"));
     }
 
-    uint64_t user_data_version_expected = server.user_data_version();
     uint64_t user_data_version_actual;
     objs[0].convert(&user_data_version_actual);
     if (user_data_version_actual != user_data_version_expected) {
@@ -274,7 +474,7 @@ void load_server(
             lexical_cast<string>(user_data_version_expected)));
     }
 
-    server.get_driver()->unpack(objs[1]);
+    driver.unpack(objs[1]);
   } catch (const msgpack::type_error&) {
     throw JUBATUS_EXCEPTION(
         core::common::exception::runtime_error(
@@ -282,6 +482,244 @@ void load_server(
   }
 }
 
+}  // namespace
+
+void save_server(FILE* fp,
+    const server_base& server, const std::string& id) {
+  msgpack::sbuffer system_data_buf;
+  msgpack::pack(&system_data_buf, system_data_container(server, id));
+
+  msgpack::sbuffer user_data_buf;
+  pack_user_data(server, user_data_buf);
+
+  write_full_model_file(fp, server.argv().compress_model,
+      system_data_buf.data(), system_data_buf.size(),
+      user_data_buf.data(), user_data_buf.size());
+}
+
+void save_server_delta(FILE* fp,
+    const server_base& server, const std::string& id,
+    const std::string& path, size_t max_chain,
+    model_delta_base& base) {
+  msgpack::sbuffer system_data_buf;
+  msgpack::pack(&system_data_buf, system_data_container(server, id));
+
+  msgpack::sbuffer user_data_buf;
+  pack_user_data(server, user_data_buf);
+  const uint32_t user_data_crc32 =
+      common::calc_crc32(user_data_buf.data(), user_data_buf.size());
+
+  std::vector<std::string> chain;
+  if (base.usable_for(path, max_chain)) {
+    model_delta_header header;
+    std::vector<char> literals;
+    base.make_delta(user_data_buf.data(), user_data_buf.size(),
+                    user_data_crc32, header, literals);
+    msgpack::sbuffer header_buf;
+    msgpack::pack(&header_buf, header);
+
+    LOG(INFO) << "saving delta against " << base.path() << ": "
+              << literals.size() << " of " << user_data_buf.size()
+              << " bytes changed";
+    write_model_file(fp, delta_format_version,
+        system_data_buf.data(), system_data_buf.size(),
+        header_buf.data(), header_buf.size(),
+        literals.empty() ? NULL : &literals[0], literals.size());
+    chain = base.chain();
+  } else {
+    write_full_model_file(fp, server.argv().compress_model,
+        system_data_buf.data(), system_data_buf.size(),
+        user_data_buf.data(), user_data_buf.size());
+  }
+
+  // the next save makes a delta against this one
+  if (fflush(fp) != 0) {
+    throw std::ios_base::failure("Failed to flush model file.");
+  }
+  base.reset(path, chain, user_data_buf.data(), user_data_buf.size(),
+             user_data_crc32);
+}
+
+void load_server(
+    std::istream& is,
+    server_base& server,
+    const std::string& id,
+    bool overwrite_config,
+    const std::string& path) {
+  model_file file;
+  read_model_file(is, file);
+  resolve_delta(dir_name(path), file, 0);
+
+  system_data_container system_data_actual;
+  unpack_system_data(file, system_data_actual);
+
+  if (overwrite_config) {
+    server.set_config(system_data_actual.config);
+  }
+
+  check_system_data(system_data_actual, system_data_container(server, id));
+  unpack_user_data(file, server.user_data_version(), *server.get_driver());
+}
+
+void load_server_detached(
+    std::istream& is,
+    server_base& server,
+    const std::string& id,
+    const std::string& path,
+    const jubatus::util::lang::function<void(const std::string&)>& progress) {
+  progress("reading");
+  model_file file;
+  read_model_file(is, file);
+  resolve_delta(dir_name(path), file, 0);
+
+  system_data_container system_data_actual;
+  unpack_system_data(file, system_data_actual);
+  {
+    jubatus::util::concurrent::scoped_rlock lk(server.rw_mutex());
+    check_system_data(system_data_actual, system_data_container(server, id));
+  }
+
+  progress("unpacking");
+  core::driver::driver_base* driver =
+      server.prepare_driver(system_data_actual.config);
+  if (!driver) {
+    // the server cannot build another driver; unpack into the serving one
+    jubatus::util::concurrent::scoped_wlock lk(server.rw_mutex());
+    unpack_user_data(file, server.user_data_version(), *server.get_driver());
+    return;
+  }
+
+  try {
+    unpack_user_data(file, server.user_data_version(), *driver);
+    std::vector<char>().swap(file.user_data);
+
+    progress("swapping");
+    // waits for nolock methods still using the previous driver; the order
+    // is the same as that of nolock methods which take rw_mutex() inside
+    jubatus::util::concurrent::scoped_wlock dlk(server.driver_mutex());
+    jubatus::util::concurrent::scoped_wlock lk(server.rw_mutex());
+    server.commit_driver();
+  } catch (...) {
+    server.discard_driver();
+    throw;
+  }
+  // the previous model is released out of the lock
+  server.discard_driver();
+}
+
+void compact_model_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    bool sectioned) {
+  std::ifstream ifs(input_path.c_str(), std::ios::binary);
+  if (!ifs) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot open input file")
+      << core::common::exception::error_file_name(input_path)
+      << core::common::exception::error_errno(errno));
+  }
+  model_file file;
+  ifs.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+  try {
+    read_model_file(ifs, file);
+  } catch (const std::ios_base::failure&) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot read input file")
+      << core::common::exception::error_file_name(input_path)
+      << core::common::exception::error_errno(errno));
+  }
+  resolve_delta(dir_name(input_path), file, 0);
+
+  FILE* fp = fopen(output_path.c_str(), "wb");
+  if (!fp) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot open output file")
+      << core::common::exception::error_file_name(output_path)
+      << core::common::exception::error_errno(errno));
+  }
+  bool written = true;
+  try {
+    write_full_model_file(fp, sectioned,
+        &file.system_data[0], file.system_data.size(),
+        file.user_data.empty() ? NULL : &file.user_data[0],
+        file.user_data.size());
+  } catch (const std::ios_base::failure&) {
+    written = false;
+  }
+  if (fclose(fp) != 0 || !written) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot write output file")
+      << core::common::exception::error_file_name(output_path)
+      << core::common::exception::error_errno(errno));
+  }
+}
+
+void materialize_delta_dependants(const std::string& path, bool sectioned) {
+  const std::string dir = dir_name(path);
+  const std::string name = base_name(path);
+  const std::string suffix = ".jubatus";
+
+  DIR* d = opendir(dir.c_str());
+  if (!d) {
+    throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot open datadir")
+        << core::common::exception::error_file_name(dir)
+        << core::common::exception::error_errno(errno));
+  }
+  std::vector<std::string> dependants;
+  for (struct dirent* entry = readdir(d); entry; entry = readdir(d)) {
+    const std::string file_name(entry->d_name);
+    if (file_name == name || file_name.size() < suffix.size() ||
+        file_name.compare(file_name.size() - suffix.size(), suffix.size(),
+                          suffix) != 0) {
+      continue;
+    }
+    const std::string file_path = dir + '/' + file_name;
+    if (!is_delta_model_file(file_path)) {
+      continue;
+    }
+    try {
+      std::ifstream ifs(file_path.c_str(), std::ios::binary);
+      ifs.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+      model_file file;
+      read_model_file(ifs, file);
+      model_delta_header header;
+      size_t literals_offset;
+      unpack_delta_header(file, header, literals_offset);
+      if (header.base == name) {
+        dependants.push_back(file_path);
+      }
+    } catch (const std::exception& e) {
+      // a broken delta cannot be loaded anyway
+      LOG(WARNING) << "cannot read delta model file " << file_path << ": "
+                   << e.what();
+    }
+  }
+  closedir(d);
+
+  for (size_t i = 0; i < dependants.size(); ++i) {
+    // deltas based on the dependant are still valid, as its user data
+    // stays the same
+    const std::string tmp_path = dependants[i] + ".tmp";
+    try {
+      compact_model_file(dependants[i], tmp_path, sectioned);
+    } catch (...) {
+      std::remove(tmp_path.c_str());
+      throw;
+    }
+    if (std::rename(tmp_path.c_str(), dependants[i].c_str()) != 0) {
+      const int rename_errno = errno;
+      std::remove(tmp_path.c_str());
+      throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot replace model file")
+        << core::common::exception::error_file_name(dependants[i])
+        << core::common::exception::error_errno(rename_errno));
+    }
+    LOG(INFO) << "rewrote " << dependants[i] << " as a full model, as "
+              << "its base " << path << " is overwritten";
+  }
+}
+
 }  // namespace framework
 }  // namespace server
 }  // namespace jubatus
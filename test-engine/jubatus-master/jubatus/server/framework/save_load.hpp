@@ -21,21 +21,59 @@
 #include <string>
 #include <iostream>
 
+#include "jubatus/util/lang/function.h"
 #include "server_base.hpp"
 
 namespace jubatus {
 namespace server {
 namespace framework {
 
+class model_delta_base;
+
+// whole models are written in the sectioned format (version 3) only when
+// the server runs with --compress_model, and in the plain one otherwise
 void save_server(
     FILE* fp,
     const server_base& server,
     const std::string& id);
+// saves only the parts of the model changed since `base` if it can be used
+// as the base of `path`, and the whole model otherwise; `base` is updated
+// to this save
+void save_server_delta(
+    FILE* fp,
+    const server_base& server,
+    const std::string& id,
+    const std::string& path,
+    size_t max_chain,
+    model_delta_base& base);
+// `path` is where `is` is read from; bases of a delta are looked up in the
+// same directory
 void load_server(
     std::istream& is,
     server_base& server,
     const std::string& id,
-    bool overwrite_config);
+    bool overwrite_config,
+    const std::string& path);
+// loads a model file into a driver built by server.prepare_driver() while
+// the current model keeps serving, and swaps it in under the write lock;
+// `progress` is called with the name of each step
+void load_server_detached(
+    std::istream& is,
+    server_base& server,
+    const std::string& id,
+    const std::string& path,
+    const jubatus::util::lang::function<void(const std::string&)>& progress);
+
+// rewrites a model file (a delta with its bases) as a single full model
+// file, in the sectioned format if `sectioned` is set
+void compact_model_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    bool sectioned);
+
+// rewrites delta model files based on `path`, in the same directory, as
+// full model files so that `path` can be overwritten
+void materialize_delta_dependants(const std::string& path, bool sectioned);
 
 }  // namespace framework
 }  // namespace server
@@ -0,0 +1,144 @@
+// Jubatus: Online machine learning framework for distributed environment
+// Copyright (C) 2014 Preferred Networks and Nippon Telegraph and Telephone Corporation.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License version 2.1 as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "jubatus/core/common/big_endian.hpp"
+#include "jubatus/core/driver/driver.hpp"
+#include "save_load.hpp"
+#include "server_base.hpp"
+#include "server_util.hpp"
+
+namespace jubatus {
+namespace server {
+namespace framework {
+namespace {
+
+class vector_driver : public core::driver::driver_base {
+ public:
+  vector_driver()
+      : values(4096) {
+  }
+
+  void pack(core::framework::packer& packer) const {
+    packer.pack(values);
+  }
+
+  void unpack(msgpack::object o) {
+    o.convert(&values);
+  }
+
+  void clear() {
+    values.assign(values.size(), 0);
+  }
+
+  std::vector<int> values;
+};
+
+class vector_server : public server_base {
+ public:
+  explicit vector_server(const server_argv& a)
+      : server_base(a) {
+  }
+
+  mixer::mixer* get_mixer() const {
+    return NULL;
+  }
+
+  core::driver::driver_base* get_driver() const {
+    return const_cast<vector_driver*>(&driver_);
+  }
+
+  void get_status(status_t& status) const {
+  }
+
+  void set_config(const std::string& config) {
+  }
+
+  std::string get_config() const {
+    return "{}";
+  }
+
+  uint64_t user_data_version() const {
+    return 1;
+  }
+
+  vector_driver& driver() {
+    return driver_;
+  }
+
+ private:
+  vector_driver driver_;
+};
+
+uint64_t read_format_version(const std::string& path) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  char header_buf[16];
+  ifs.read(header_buf, sizeof(header_buf));
+  return core::common::read_big_endian<uint64_t>(&header_buf[8]);
+}
+
+std::string saved_path(const std::map<std::string, std::string>& ret) {
+  return ret.empty() ? std::string() : ret.begin()->second;
+}
+
+TEST(save_server_delta, overwrite_base_of_delta) {
+  char dir[] = "/tmp/save_load_test_XXXXXX";
+  ASSERT_TRUE(::mkdtemp(dir) != NULL);
+
+  server_argv a;
+  a.type = "save_load_test";
+  a.datadir = dir;
+  a.save_delta_chain = 4;
+  vector_server server(a);
+
+  server.driver().values[0] = 1;
+  const std::string path_a = saved_path(server.save("A"));
+  ASSERT_EQ(1u, read_format_version(path_a));
+
+  server.driver().values[0] = 2;
+  const std::string path_b = saved_path(server.save("B"));
+  ASSERT_EQ(2u, read_format_version(path_b));  // a delta against A
+
+  // B must stay loadable after its base is overwritten
+  server.driver().values[0] = 3;
+  server.save("A");
+  EXPECT_EQ(1u, read_format_version(path_b));
+
+  server.driver().clear();
+  server.load("B");
+  EXPECT_EQ(2, server.driver().values[0]);
+  server.load("A");
+  EXPECT_EQ(3, server.driver().values[0]);
+
+  std::remove(path_a.c_str());
+  std::remove(path_b.c_str());
+  ::rmdir(dir);
+}
+
+}  // namespace
+}  // namespace framework
+}  // namespace server
+}  // namespace jubatus
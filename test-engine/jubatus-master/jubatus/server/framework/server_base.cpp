@@ -25,10 +25,16 @@
 #include <vector>
 #include <map>
 
+#include "jubatus/core/common/assert.hpp"
 #include "jubatus/core/common/exception.hpp"
 #include "jubatus/core/framework/mixable.hpp"
+#include "jubatus/util/concurrent/lock.h"
+#include "jubatus/util/lang/bind.h"
+#include "jubatus/util/lang/cast.h"
 #include "jubatus/util/system/syscall.h"
+#include "datum_cache.hpp"
 #include "mixer/mixer.hpp"
+#include "model_delta.hpp"
 #include "save_load.hpp"
 #include "../common/logger/logger.hpp"
 
@@ -69,7 +75,7 @@ void load_file_impl(
 
   ifs.exceptions(std::ios_base::failbit | std::ios_base::badbit);
   try {
-    framework::load_server(ifs, server, id, overwrite_config);
+    framework::load_server(ifs, server, id, overwrite_config, path);
     ifs.close();
   } catch (const std::ios_base::failure&) {
     throw JUBATUS_EXCEPTION(
@@ -124,7 +130,19 @@ server_base::server_base(const server_argv& a)
       last_saved_(0, 0),
       last_saved_path_(""),
       last_loaded_(0, 0),
-      last_loaded_path_("") {
+      last_loaded_path_(""),
+      analysis_cache_(NULL),
+      update_log_(NULL),
+      delta_base_(new model_delta_base),
+      loading_(false),
+      load_started_(0, 0),
+      load_sec_(0) {
+}
+
+server_base::~server_base() {
+  // the load thread uses members of the derived server, which are gone by
+  // now; join_background_load() must have been called
+  JUBATUS_ASSERT(!load_thread_);
 }
 
 bool server_base::clear() {
@@ -144,6 +162,11 @@ std::map<std::string, std::string> server_base::save(const std::string& id) {
   const std::string path = build_local_path(argv_, argv_.type, id);
   LOG(INFO) << "starting save to " << path;
 
+  // saves are serialized so that no delta is rewritten while it is saved
+  jubatus::util::concurrent::scoped_lock lk(delta_m_);
+  // deltas saved against `path` would be broken by overwriting it
+  framework::materialize_delta_dependants(path, argv_.compress_model);
+
   fp_holder fp(fopen(path.c_str(), "wb"));
   if (fp.get() == 0) {
     throw JUBATUS_EXCEPTION(
@@ -162,7 +185,12 @@ std::map<std::string, std::string> server_base::save(const std::string& id) {
   }
 
   try {
-    framework::save_server(fp.get(), *this, id);
+    if (argv_.save_delta_chain > 0) {
+      framework::save_server_delta(fp.get(), *this, id, path,
+                                   argv_.save_delta_chain, *delta_base_);
+    } else {
+      framework::save_server(fp.get(), *this, id);
+    }
     if (fp.close()) {
       goto write_failure;
     }
@@ -205,7 +233,12 @@ bool server_base::load(const std::string& id) {
         "model ID contains invalid character"));
   }
 
-  load_file_impl(*this, build_local_path(argv_, argv_.type, id), id, false);
+  const std::string path = build_local_path(argv_, argv_.type, id);
+  if (argv_.background_load) {
+    start_background_load(path, id);
+    return true;
+  }
+  load_file_impl(*this, path, id, false);
   return true;
 }
 
@@ -217,6 +250,150 @@ void server_base::load_file(const std::string& path) {
   load_file_impl(*this, path, "", true);
 }
 
+core::driver::driver_base* server_base::prepare_driver(
+    const std::string& config) {
+  return NULL;
+}
+
+void server_base::commit_driver() {
+}
+
+void server_base::discard_driver() {
+}
+
+void server_base::get_load_status(status_t& status) const {
+  jubatus::util::concurrent::scoped_lock lk(load_m_);
+  status["background_load.state"] = load_state_.empty() ? "idle" : load_state_;
+  status["background_load.path"] = load_path_;
+  status["background_load.error"] = load_error_;
+  status["background_load.started"] =
+      jubatus::util::lang::lexical_cast<std::string>(load_started_.sec);
+  const double elapsed = loading_ ?
+      static_cast<double>(
+          jubatus::util::system::time::get_clock_time() - load_started_) :
+      load_sec_;
+  status["background_load.elapsed_sec"] =
+      jubatus::util::lang::lexical_cast<std::string>(elapsed);
+}
+
+void server_base::check_updatable() const {
+  jubatus::util::concurrent::scoped_lock lk(load_m_);
+  if (loading_) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "cannot update while a model is being loaded: " + load_path_));
+  }
+}
+
+void server_base::check_unpartitioned(
+    const std::string& method,
+    const std::string& alternative) const {
+  if (argv_.partitioned) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        method + " is not supported in partitioned mode, as each server "
+        "has only a part of the rows; use " + alternative + " instead"));
+  }
+}
+
+/**
+ * Starts loading a model file in the background; errors found before
+ * starting (e.g., the file cannot be opened) are thrown to the caller.
+ */
+void server_base::start_background_load(
+    const std::string& path,
+    const std::string& id) {
+  if (!std::ifstream(path.c_str(), std::ios::binary)) {
+    throw JUBATUS_EXCEPTION(
+      core::common::exception::runtime_error("cannot open input file")
+      << core::common::exception::error_file_name(path)
+      << core::common::exception::error_errno(errno));
+  }
+
+  jubatus::util::concurrent::scoped_lock lk(load_m_);
+  if (loading_) {
+    throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+        "another model is being loaded: " + load_path_));
+  }
+  if (load_thread_) {
+    load_thread_->join();
+  }
+  loading_ = true;
+  load_state_ = "starting";
+  load_path_ = path;
+  load_error_.clear();
+  load_started_ = jubatus::util::system::time::get_clock_time();
+  load_thread_.reset(new jubatus::util::concurrent::thread(
+      jubatus::util::lang::bind(
+          &server_base::load_in_background, this, path, id)));
+  load_thread_->start();
+}
+
+void server_base::join_background_load() {
+  jubatus::util::lang::shared_ptr<jubatus::util::concurrent::thread> t;
+  {
+    jubatus::util::concurrent::scoped_lock lk(load_m_);
+    t.swap(load_thread_);
+  }
+  if (t) {
+    t->join();
+  }
+}
+
+void server_base::load_in_background(
+    const std::string& path,
+    const std::string& id) {
+  LOG(INFO) << "starting background load from " << path;
+
+  std::string error;
+  try {
+    std::ifstream ifs(path.c_str(), std::ios::binary);
+    if (!ifs) {
+      throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot open input file")
+        << core::common::exception::error_file_name(path)
+        << core::common::exception::error_errno(errno));
+    }
+
+    ifs.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+    try {
+      framework::load_server_detached(ifs, *this, id, path,
+          jubatus::util::lang::bind(
+              &server_base::set_load_state, this,
+              jubatus::util::lang::_1));
+    } catch (const std::ios_base::failure&) {
+      throw JUBATUS_EXCEPTION(
+        core::common::exception::runtime_error("cannot read input file")
+        << core::common::exception::error_file_name(path)
+        << core::common::exception::error_errno(errno));
+    }
+    update_loaded_status(path);
+  } catch (const std::exception& e) {
+    error = e.what();
+  }
+
+  jubatus::util::concurrent::scoped_lock lk(load_m_);
+  loading_ = false;
+  load_sec_ = static_cast<double>(
+      jubatus::util::system::time::get_clock_time() - load_started_);
+  if (error.empty()) {
+    load_state_ = "done";
+    LOG(INFO) << "loaded from " << path << " in the background ("
+              << load_sec_ << " sec)";
+  } else {
+    load_state_ = "failed";
+    load_error_ = error;
+    LOG(ERROR) << "failed to load from " << path << ": " << error;
+  }
+}
+
+void server_base::set_load_state(const std::string& state) {
+  jubatus::util::concurrent::scoped_lock lk(load_m_);
+  load_state_ = state;
+}
+
+std::vector<std::string> server_base::unlogged_update_methods() const {
+  return std::vector<std::string>();
+}
+
 void server_base::event_model_updated() {
   ++update_count_;
   if (mixer::mixer* m = get_mixer()) {
@@ -224,6 +401,18 @@ void server_base::event_model_updated() {
   }
 }
 
+void server_base::set_update_log(common::update_log* log) {
+  update_log_ = log;
+}
+
+void server_base::register_analysis_cache(datum_cache_base& cache) {
+  analysis_cache_ = &cache;
+  if (mixer::mixer* m = get_mixer()) {
+    m->set_mixed_callback(
+        jubatus::util::lang::bind(&datum_cache_base::invalidate, &cache));
+  }
+}
+
 void server_base::update_saved_status(const std::string& path) {
   jubatus::util::concurrent::scoped_wlock lock(status_mutex_);
   last_saved_ = jubatus::util::system::time::get_clock_time();
@@ -234,6 +423,9 @@ void server_base::update_loaded_status(const std::string& path) {
   jubatus::util::concurrent::scoped_wlock lock(status_mutex_);
   last_loaded_ = jubatus::util::system::time::get_clock_time();
   last_loaded_path_ = path;
+  if (analysis_cache_) {
+    analysis_cache_->invalidate();
+  }
 }
 
 bool validate_model_id(const std::string& id) {
@@ -22,7 +22,9 @@
 #include <string>
 #include <vector>
 #include "jubatus/util/system/time_util.h"
+#include "jubatus/util/concurrent/mutex.h"
 #include "jubatus/util/concurrent/rwmutex.h"
+#include "jubatus/util/concurrent/thread.h"
 #include "jubatus/util/lang/shared_ptr.h"
 
 #include "jubatus/core/driver/driver.hpp"
@@ -32,18 +34,26 @@ using jubatus::util::system::time::clock_time;
 
 namespace jubatus {
 namespace server {
+
+namespace common {
+class update_log;
+}  // namespace common
+
 namespace framework {
 
 namespace mixer {
 class mixer;
 }  // namespace mixer
 
+class datum_cache_base;
+class model_delta_base;
+
 class server_base {
  public:
   typedef std::map<std::string, std::string> status_t;
 
   explicit server_base(const server_argv& a);
-  virtual ~server_base() {}
+  virtual ~server_base();
 
   virtual mixer::mixer* get_mixer() const = 0;
 
@@ -56,7 +66,47 @@ class server_base {
   virtual bool load(const std::string& id);
   virtual void load_file(const std::string& path);
 
+  // Loading a model in the background (--background_load):
+  // prepare_driver() builds a driver for `config` apart from the serving
+  // one, which the model is unpacked into without the lock; commit_driver()
+  // makes it the serving driver under the write lock and driver_mutex(),
+  // and discard_driver() then releases the previous one without the lock
+  // (or the new one if the load failed). Servers which cannot build another
+  // driver return NULL from prepare_driver(), and the model is unpacked
+  // under the write lock. Updates fail while the load is in progress, as
+  // they would be applied to the driver being replaced.
+  virtual core::driver::driver_base* prepare_driver(
+      const std::string& config);
+  virtual void commit_driver();
+  virtual void discard_driver();
+
+  void get_load_status(status_t& status) const;
+  // throws while a model is loaded in the background
+  void check_updatable() const;
+  // throws if the server runs with --partitioned, where `method` would see
+  // only the rows of this server; `alternative` is suggested instead
+  void check_unpartitioned(
+      const std::string& method,
+      const std::string& alternative) const;
+  // waits for the background load, if any; to be called before the
+  // derived server is destroyed
+  void join_background_load();
+
+  // update methods which are not to be written to the update log, as
+  // replaying them would be forwarded to other servers again
+  virtual std::vector<std::string> unlogged_update_methods() const;
+
+  // the update log requests are written to, or NULL; the part of an
+  // unlogged update applied on this server is written by local_update
+  void set_update_log(common::update_log* log);
+  common::update_log* update_log() const {
+    return update_log_;
+  }
+
   void event_model_updated();
+  // invalidates `cache` whenever MIX or load modifies the model; other
+  // updates are to invalidate it by themselves
+  void register_analysis_cache(datum_cache_base& cache);
   void update_saved_status(const std::string& path);
   void update_loaded_status(const std::string& path);
 
@@ -71,6 +121,13 @@ class server_base {
     return rw_mutex_;
   }
 
+  // held shared by methods which use the driver without rw_mutex() (nolock
+  // methods) and exclusively to swap the driver, so that the previous one
+  // is not released while they are using it
+  jubatus::util::concurrent::rw_mutex& driver_mutex() {
+    return driver_mutex_;
+  }
+
   const server_argv& argv() const {
     return argv_;
   }
@@ -103,6 +160,28 @@ class server_base {
   clock_time last_loaded_;
   std::string last_loaded_path_;
   jubatus::util::concurrent::rw_mutex rw_mutex_;
+  jubatus::util::concurrent::rw_mutex driver_mutex_;
+  datum_cache_base* analysis_cache_;
+  common::update_log* update_log_;
+
+  // the last saved model, which the next save is a delta against; delta_m_
+  // is held through a save
+  jubatus::util::lang::shared_ptr<model_delta_base> delta_base_;
+  jubatus::util::concurrent::mutex delta_m_;
+
+  void start_background_load(const std::string& path, const std::string& id);
+  void load_in_background(const std::string& path, const std::string& id);
+  void set_load_state(const std::string& state);
+
+  jubatus::util::lang::shared_ptr<jubatus::util::concurrent::thread>
+      load_thread_;
+  bool loading_;
+  std::string load_state_;
+  std::string load_path_;
+  std::string load_error_;
+  clock_time load_started_;
+  double load_sec_;
+  mutable jubatus::util::concurrent::mutex load_m_;
 
   // Mutex that protect save/load status values.
   mutable jubatus::util::concurrent::rw_mutex status_mutex_;
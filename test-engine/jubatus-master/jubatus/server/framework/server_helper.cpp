@@ -96,13 +96,25 @@ void term_if_deleted(string path) {
 void server_helper_impl::prepare_for_run(const server_argv& a, bool use_cht) {
 #ifdef HAVE_ZOOKEEPER_H
   if (!a.is_standalone()) {
+    if (!a.listen_unix.empty()) {
+      register_unix_socket(
+          *zk_, a.type, a.name, a.eth, a.port, a.listen_unix);
+    }
+
+    if (a.serving_only) {
+      // serving replicas neither own CHT ranges nor take part in get_diff;
+      // the mixer registers them under servings once they are up to date
+      LOG(INFO) << "serving only, not registered as a node";
+      return;
+    }
+
     if (use_cht) {
       common::cht::setup_cht_dir(*zk_, a.type, a.name);
       common::cht ht(zk_, a.type, a.name);
       ht.register_node(a.eth, a.port);
     }
 
-    register_actor(*zk_, a.type, a.name, a.eth, a.port);
+    register_actor(*zk_, a.type, a.name, a.eth, a.port, a.mix_port());
 
     // if regestered actor was deleted, this server should finish
     watch_delete_actor(*zk_, a.type, a.name, a.eth, a.port, term_if_deleted);
@@ -29,6 +29,7 @@
 
 #include "jubatus/core/common/jsonconfig.hpp"
 #include "mixer/mixer.hpp"
+#include "checkpointer.hpp"
 #include "server_util.hpp"
 #include "../../config.hpp"
 #include "../common/lock_service.hpp"
@@ -71,7 +72,8 @@ class server_helper {
   explicit server_helper(const server_argv& a, bool use_cht = false)
       : impl_(a),
         start_time_(get_clock_time()),
-        use_cht_(use_cht) {
+        use_cht_(use_cht),
+        rpc_server_(NULL) {
     impl_.prepare_for_start(a, use_cht);
     server_.reset(new Server(a, impl_.zk()));
 
@@ -156,7 +158,21 @@ class server_helper {
     data["timeout"] = jubatus::util::lang::lexical_cast<std::string>(a.timeout);
     data["threadnum"] =
         jubatus::util::lang::lexical_cast<std::string>(a.threadnum);
+    data["update_threadnum"] =
+        jubatus::util::lang::lexical_cast<std::string>(a.update_threadnum);
+    data["analysis_threadnum"] =
+        jubatus::util::lang::lexical_cast<std::string>(a.analysis_threadnum);
+    if (rpc_server_) {
+      rpc_server_->get_status(data);
+    }
+    if (checkpointer_) {
+      checkpointer_->get_status(data);
+    }
+    if (a.background_load) {
+      server_->get_load_status(data);
+    }
     data["datadir"] = a.datadir;
+    data["listen_unix"] = a.listen_unix;
     data["is_standalone"] = jubatus::util::lang::lexical_cast<std::string>(
         a.is_standalone());
     data["VERSION"] = JUBATUS_VERSION;
@@ -212,22 +228,67 @@ class server_helper {
           use_cht_);
 
       data["mixer"] = a.mixer;
+      data["partitioned"] = jubatus::util::lang::lexical_cast<std::string>(
+          a.partitioned);
+      data["serving_only"] = jubatus::util::lang::lexical_cast<std::string>(
+          a.serving_only);
       server_->get_mixer()->get_status(data);
     }
 
     return status;
   }
 
+  ~server_helper() {
+    // the background load uses the drivers of the server, which must not
+    // be destroyed under it
+    server_->join_background_load();
+  }
+
   int start(common::mprpc::rpc_server& serv) {
     const server_argv& a = server_->argv();
 
     try {
+      if (a.update_log) {
+        // replay updates lost by the last crash before accepting new ones
+        checkpointer_.reset(new checkpointer(*server_, serv));
+        checkpointer_->recover();
+        // a load replaces the model, so updates logged before it must not
+        // be replayed after recovering from a checkpoint taken before it
+        serv.set_barrier("load", jubatus::util::lang::bind(
+            &checkpointer::checkpoint_after, checkpointer_.get(),
+            jubatus::util::lang::_1));
+      }
+
       serv.listen(a.port, a.bind_address);
       LOG(INFO) << "start listening at port " << a.port;
+      if (!a.listen_unix.empty()) {
+        serv.listen_unix(a.listen_unix);
+        LOG(INFO) << "start listening at " << a.listen_unix;
+      }
 
       start_time_ = get_clock_time();
+      serv.set_worker_pool(common::mprpc::UPDATE_REQUEST, a.update_threadnum);
+      serv.set_worker_pool(
+          common::mprpc::ANALYSIS_REQUEST, a.analysis_threadnum);
+      serv.set_inflight_limit(
+          common::mprpc::UPDATE_REQUEST, a.update_max_inflight);
+      serv.set_inflight_limit(
+          common::mprpc::ANALYSIS_REQUEST, a.analysis_max_inflight);
+      serv.set_request_deadline(a.request_deadline);
+      serv.set_read_only(a.serving_only);
+      rpc_server_ = &serv;
       serv.start(a.threadnum, true);
 
+      if (!a.is_standalone() && a.mix_port_offset > 0) {
+        // MIX RPCs do not wait behind (nor hold up) client requests;
+        // peers find the port in the membership registered below
+        mix_server_.reset(new common::mprpc::rpc_server(a.timeout));
+        server_->get_mixer()->register_api(*mix_server_);
+        mix_server_->listen(a.mix_port(), a.bind_address);
+        mix_server_->start(MIX_SERVER_THREADS, true);
+        LOG(INFO) << "start listening MIX at port " << a.mix_port();
+      }
+
       // RPC server started, then register group membership
       impl_.prepare_for_run(a, use_cht_);
       LOG(INFO) << common::get_program_name() << " RPC server startup";
@@ -242,14 +303,28 @@ class server_helper {
         server_->get_mixer()->start();
       }
 
+      if (checkpointer_) {
+        checkpointer_->start();
+      }
+
       // wait for termination
       serv.join();
+      server_->join_background_load();
+
+      if (checkpointer_) {
+        LOG(INFO) << "taking the last checkpoint";
+        checkpointer_->stop();
+      }
 
       return 0;
     } catch (const mp::system_error& e) {
       if (e.code == EADDRINUSE) {
         LOG(FATAL) << "server failed to start: any process using port "
-            << a.port << "?";
+            << a.port
+            << (a.mix_port_offset > 0 ?
+                " or " + jubatus::util::lang::lexical_cast<std::string>(
+                    a.mix_port()) : std::string())
+            << "?";
       } else {
         LOG(FATAL) << "server failed to start: " << e.what();
       }
@@ -270,6 +345,11 @@ class server_helper {
       impl_.prepare_for_stop(server_->argv());
     }
 
+    if (mix_server_) {
+      LOG(INFO) << "stopping MIX RPC server";
+      mix_server_->end();
+    }
+
     LOG(INFO) << "stopping RPC server";
     serv.end();
   }
@@ -282,11 +362,23 @@ class server_helper {
     return server_->rw_mutex();
   }
 
+  jubatus::util::concurrent::rw_mutex& driver_mutex() {
+    return server_->driver_mutex();
+  }
+
  private:
   jubatus::util::lang::shared_ptr<Server> server_;
   server_helper_impl impl_;
   clock_time start_time_;
   const bool use_cht_;
+  common::mprpc::rpc_server* rpc_server_;
+
+  // dedicated listener for MIX RPCs (with mix_port_offset)
+  static const int MIX_SERVER_THREADS = 2;
+  jubatus::util::lang::shared_ptr<common::mprpc::rpc_server> mix_server_;
+
+  // with update_log
+  jubatus::util::lang::shared_ptr<checkpointer> checkpointer_;
 };
 
 }  // namespace framework
@@ -297,9 +389,17 @@ class server_helper {
   ::jubatus::util::concurrent::scoped_rlock lk((p)->rw_mutex())
 
 #define JWLOCK_(p) \
+  (p)->server()->check_updatable(); \
   ::jubatus::util::concurrent::scoped_wlock lk((p)->rw_mutex()); \
   (p)->server()->event_model_updated()
 
-#define NOLOCK_(p)
+// nolock methods lock the model by themselves, but keep the driver from
+// being swapped by a background load while they use it
+#define NOLOCK_(p) \
+  ::jubatus::util::concurrent::scoped_rlock lk((p)->driver_mutex())
+
+#define NOLOCK_UPDATE_(p) \
+  (p)->server()->check_updatable(); \
+  ::jubatus::util::concurrent::scoped_rlock lk((p)->driver_mutex())
 
 #endif  // JUBATUS_SERVER_FRAMEWORK_SERVER_HELPER_HPP_
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
 
 #include "jubatus/util/text/json.h"
 #include "jubatus/util/lang/shared_ptr.h"
@@ -31,6 +32,7 @@
 
 #include "jubatus/core/common/exception.hpp"
 #include "../third_party/cmdline/cmdline.h"
+#include "../common/affinity.hpp"
 #include "../common/config.hpp"
 #include "../common/filesystem.hpp"
 #include "../common/logger/logger.hpp"
@@ -67,6 +69,22 @@ struct lower_bound_reader {
   int low;
 };
 
+struct double_lower_bound_reader {
+  explicit double_lower_bound_reader(double l)
+    : low(l) {}
+  double operator()(const std::string& s) const {
+    double ret = cmdline::default_reader<double>()(s);
+    if (ret < low) {
+      throw
+        cmdline::cmdline_error("value should be more than " +
+                               cmdline::detail::lexical_cast<std::string>(low));
+    }
+    return ret;
+  }
+ private:
+  double low;
+};
+
 void configure_logger(const std::string& log_config) {
   if (log_config.empty()) {
     if (!logger_configured_) {
@@ -190,8 +208,33 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
              cmdline::range(1, 65535));
   p.add<std::string>("listen_addr", 'b', "bind IP address", false, "");
   p.add<std::string>("listen_if", 'B', "bind network interfance", false, "");
+  p.add<std::string>("listen_unix", 0,
+      "also accept RPCs on this UNIX domain socket, for clients on the same "
+      "host", false, "");
   p.add<int>("thread", 'c', "concurrency = thread number", false, 2,
              lower_bound_reader(1));
+  p.add<int>("update_threads", 'U',
+             "dedicated threads for update methods (0: share --thread)",
+             false, 0, lower_bound_reader(0));
+  p.add<int>("analysis_threads", 'A',
+             "dedicated threads for analysis methods (0: share --thread)",
+             false, 0, lower_bound_reader(0));
+  p.add<int>("update_max_inflight", 0,
+             "max update requests in progress before rejecting "
+             "(0: unlimited, or 1024 per --update_threads)",
+             false, 0, lower_bound_reader(0));
+  p.add<int>("analysis_max_inflight", 0,
+             "max analysis requests in progress before rejecting "
+             "(0: unlimited, or 1024 per --analysis_threads)",
+             false, 0, lower_bound_reader(0));
+  p.add<double>("request_deadline", 0,
+                "drop requests queued on --update_threads or "
+                "--analysis_threads longer than this (sec, 0: disabled)",
+                false, 0, double_lower_bound_reader(0));
+  p.add<int>("analysis_cache_size", 0,
+             "reuse results of this many analysis requests on the same "
+             "datum until the model changes (0: disabled)",
+             false, 0, lower_bound_reader(0));
   p.add<int>("timeout", 't', "time out (sec)", false, 10,
              lower_bound_reader(0));
   p.add<std::string>("datadir", 'd', "directory to save and load models", false,
@@ -209,8 +252,28 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
       false, "");
   p.add<std::string>("model_file", 'm',
                      "model data to load at startup", false, "");
+  p.add<int>("save_delta_chain", 0,
+             "save only changes since the last save, up to this many times "
+             "in a row before saving the whole model (0: always whole)",
+             false, 0, lower_bound_reader(0));
+  p.add("background_load", 0,
+        "load models requested by load RPC in the background, serving the "
+        "current model until the new one is ready (updates fail meanwhile)");
+  p.add("compress_model", 0,
+        "save whole models in the sectioned format (version 3), which "
+        "servers older than this one cannot load");
+  p.add("update_log", 0,
+        "log update requests to datadir and recover them after a restart");
+  p.add<int>("checkpoint_interval", 0,
+             "save the model and truncate the update log every this many "
+             "seconds (0: only at exit)", false, 600, lower_bound_reader(0));
   p.add("daemon", 'D', "launch in daemon mode");
   p.add("config_test", 'T', "run a configuration file syntax test and exit");
+  p.add<std::string>("cpu_affinity", 0,
+                     "run threads only on these CPUs (e.g. 0-3,8)", false, "");
+  p.add<int>("numa_node", 0,
+             "allocate memory from this NUMA node, and run threads on its "
+             "CPUs unless cpu_affinity is given (-1: any)", false, -1);
 
   p.add<std::string>("zookeeper", 'z',
                      make_ignored_help("zookeeper location"), false);
@@ -226,11 +289,43 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
   p.add<int>("interval_count", 'i',
              make_ignored_help("mix interval by update count"), false, 512,
              lower_bound_reader(0));
+  p.add<int>("mix_target_staleness", 0,
+             make_ignored_help("adapt mix interval to the update rate so that "
+                               "about this many updates are left unmixed "
+                               "(0: fixed interval)"),
+             false, 0, lower_bound_reader(0));
+  p.add<int>("mix_network_budget", 0,
+             make_ignored_help("adapt mix interval so that MIX transfers at "
+                               "most this many bytes per sec (0: unlimited)"),
+             false, 0, lower_bound_reader(0));
+  p.add<int>("mix_min_interval", 0,
+             make_ignored_help("shortest adaptive mix interval by seconds; "
+                               "interval_sec is the longest"),
+             false, 1, lower_bound_reader(0));
+  p.add<int>("mix_bandwidth_limit", 0,
+             make_ignored_help("bytes per sec of MIX and model transfers "
+                               "this server sends or asks for (0: unlimited)"),
+             false, 0, lower_bound_reader(0));
+  p.add<int>("mix_port_offset", 0,
+             make_ignored_help("serve MIX RPCs on a dedicated listener at "
+                               "rpc-port + this value (0: use rpc-port)"),
+             false, 0, lower_bound_reader(0));
   p.add<int>("zookeeper_timeout", 'Z',
              make_ignored_help("zookeeper time out (sec)"), false, 10);
   p.add<int>("interconnect_timeout", 'I',
              make_ignored_help("interconnect time out between servers (sec)"),
              false, 10);
+  p.add<std::string>("replica_write_quorum", 0,
+                     make_ignored_help("acknowledge replicated writes when "
+                                       "written to primary or all"),
+                     false, "primary",
+                     cmdline::oneof<std::string>("primary", "all"));
+  p.add("partitioned", 0,
+        make_ignored_help("keep rows only on their CHT owners "
+                          "(model is not mixed)"));
+  p.add("serving_only", 0,
+        make_ignored_help("receive mixed models but reject update requests "
+                          "(read-only replica, requires linear_mixer)"));
 
   // APPLY CHANGES TO JUBAVISOR WHEN ARGUMENTS MODIFIED
 
@@ -251,7 +346,14 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
   port = p.get<int>("rpc-port");
   bind_address = p.get<std::string>("listen_addr");
   bind_if = p.get<std::string>("listen_if");
+  listen_unix = p.get<std::string>("listen_unix");
   threadnum = p.get<int>("thread");
+  update_threadnum = p.get<int>("update_threads");
+  analysis_threadnum = p.get<int>("analysis_threads");
+  update_max_inflight = p.get<int>("update_max_inflight");
+  analysis_max_inflight = p.get<int>("analysis_max_inflight");
+  request_deadline = p.get<double>("request_deadline");
+  analysis_cache_size = p.get<int>("analysis_cache_size");
   timeout = p.get<int>("timeout");
   program_name = common::get_program_name();
   datadir = p.get<std::string>("datadir");
@@ -259,8 +361,15 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
   log_config = p.get<std::string>("log_config");
   configpath = p.get<std::string>("configpath");
   modelpath = p.get<std::string>("model_file");
+  save_delta_chain = p.get<int>("save_delta_chain");
+  background_load = p.exist("background_load");
+  compress_model = p.exist("compress_model");
+  update_log = p.exist("update_log");
+  checkpoint_interval = p.get<int>("checkpoint_interval");
   daemon = p.exist("daemon");
   config_test = p.exist("config_test");
+  cpu_affinity = p.get<std::string>("cpu_affinity");
+  numa_node = p.get<int>("numa_node");
 
   // determine listen-address and IPaddr used as ZK 'node-name'
   // TODO(y-oda-oni-juba): check bind_address is valid format
@@ -287,13 +396,28 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
   mixer = p.get<std::string>("mixer");
   interval_sec = p.get<int>("interval_sec");
   interval_count = p.get<int>("interval_count");
+  mix_target_staleness = p.get<int>("mix_target_staleness");
+  mix_network_budget = p.get<int>("mix_network_budget");
+  mix_min_interval = p.get<int>("mix_min_interval");
+  mix_bandwidth_limit = p.get<int>("mix_bandwidth_limit");
+  mix_port_offset = p.get<int>("mix_port_offset");
   zookeeper_timeout = p.get<int>("zookeeper_timeout");
   interconnect_timeout = p.get<int>("interconnect_timeout");
+  replica_write_quorum = p.get<std::string>("replica_write_quorum");
+  partitioned = p.exist("partitioned");
+  serving_only = p.exist("serving_only");
 #else
   z = "";
   name = "";
   interval_sec = 16;
   interval_count = 512;
+  mix_target_staleness = 0;
+  mix_network_budget = 0;
+  mix_min_interval = 1;
+  mix_bandwidth_limit = 0;
+  mix_port_offset = 0;
+  partitioned = false;
+  serving_only = false;
 #endif
 
   if (!is_standalone() && name.empty()) {
@@ -303,6 +427,41 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
     exit(1);
   }
 
+  if (serving_only && (partitioned || mixer != "linear_mixer")) {
+    std::cerr << "serving_only requires linear_mixer and cannot be used "
+              << "with partitioned" << std::endl;
+    exit(1);
+  }
+
+  if (background_load && update_log) {
+    std::cerr << "background_load cannot be used with update_log"
+              << std::endl;
+    exit(1);
+  }
+
+  // only requests handed over to a worker pool wait in a queue; the
+  // others run as soon as they are received
+  if (request_deadline > 0) {
+    if (update_threadnum == 0 && analysis_threadnum == 0) {
+      std::cerr << "request_deadline requires update_threads or "
+                << "analysis_threads" << std::endl;
+      exit(1);
+    }
+    if (update_threadnum == 0) {
+      LOG(WARNING) << "request_deadline does not apply to update requests "
+                   << "without update_threads";
+    } else if (analysis_threadnum == 0) {
+      LOG(WARNING) << "request_deadline does not apply to analysis requests "
+                   << "without analysis_threads";
+    }
+  }
+
+  if (mix_port_offset > 0 && port + mix_port_offset > 65535) {
+    std::cerr << "mix_port_offset is too large for port " << port
+              << std::endl;
+    exit(1);
+  }
+
   if (is_standalone()) {
     if (configpath.empty() && modelpath.empty()) {
       std::cerr << "config path or model file must be specified "
@@ -357,8 +516,16 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
   check_ignored_option(p, "mixer");
   check_ignored_option(p, "interval_sec");
   check_ignored_option(p, "interval_count");
+  check_ignored_option(p, "mix_target_staleness");
+  check_ignored_option(p, "mix_network_budget");
+  check_ignored_option(p, "mix_min_interval");
+  check_ignored_option(p, "mix_bandwidth_limit");
+  check_ignored_option(p, "mix_port_offset");
   check_ignored_option(p, "zookeeper_timeout");
   check_ignored_option(p, "interconnect_timeout");
+  check_ignored_option(p, "replica_write_quorum");
+  check_ignored_option(p, "partitioned");
+  check_ignored_option(p, "serving_only");
 #endif
 
   // Daemonize the process.
@@ -374,15 +541,55 @@ server_argv::server_argv(int args, char** argv, const std::string& type)
     common::daemonize();
   }
 
+  // Place the process before any thread is started; threads inherit the
+  // CPU affinity and memory policy of the main thread.
+  if (!apply_placement()) {
+    exit(1);
+  }
+
   boot_message(common::get_program_name());
 }
 
+bool server_argv::apply_placement() {
+  std::vector<int> cpus;
+  if (!cpu_affinity.empty()) {
+    if (!common::parse_cpu_list(cpu_affinity, cpus)) {
+      std::cerr << "invalid cpu_affinity: " << cpu_affinity << std::endl;
+      return false;
+    }
+  } else if (numa_node >= 0) {
+    if (!common::get_numa_node_cpus(numa_node, cpus)) {
+      std::cerr << "can't get CPUs of NUMA node " << numa_node << std::endl;
+      return false;
+    }
+    cpu_affinity = common::format_cpu_list(cpus);
+  }
+
+  if (numa_node >= 0 && !common::set_numa_node(numa_node)) {
+    std::cerr << "can't set memory policy to NUMA node " << numa_node
+              << std::endl;
+    return false;
+  }
+  if (!cpus.empty() && !common::set_cpu_affinity(cpus)) {
+    std::cerr << "can't set cpu_affinity to " << cpu_affinity << std::endl;
+    return false;
+  }
+  return true;
+}
+
 server_argv::server_argv()
     : port(9199),
       timeout(10),
       zookeeper_timeout(10),
       interconnect_timeout(10),
       threadnum(2),
+      update_threadnum(0),
+      analysis_threadnum(0),
+      update_max_inflight(0),
+      analysis_max_inflight(0),
+      request_deadline(0),
+      analysis_cache_size(0),
+      replica_write_quorum("primary"),
       z(""),
       name(""),
       datadir("/tmp"),
@@ -390,7 +597,21 @@ server_argv::server_argv()
       log_config(""),
       eth("localhost"),
       interval_sec(5),
-      interval_count(1024) {
+      interval_count(1024),
+      mix_target_staleness(0),
+      mix_network_budget(0),
+      mix_min_interval(1),
+      mix_bandwidth_limit(0),
+      mix_port_offset(0),
+      cpu_affinity(""),
+      numa_node(-1),
+      update_log(false),
+      checkpoint_interval(600),
+      save_delta_chain(0),
+      background_load(false),
+      compress_model(false),
+      partitioned(false),
+      serving_only(false) {
 }
 
 void server_argv::boot_message(const std::string& progname) const {
@@ -405,11 +626,34 @@ void server_argv::boot_message(const std::string& progname) const {
   } else {
     ss << "multinode mode\n";
   }
+  if (!listen_unix.empty()) {
+    ss << "    listen unix          : " << listen_unix << '\n';
+  }
   ss << "    timeout              : " << timeout << '\n';
   ss << "    thread               : " << threadnum << '\n';
+  ss << "    update threads       : " << update_threadnum << '\n';
+  ss << "    analysis threads     : " << analysis_threadnum << '\n';
+  ss << "    update max inflight  : " << update_max_inflight << '\n';
+  ss << "    analysis max inflight: " << analysis_max_inflight << '\n';
+  ss << "    request deadline     : " << request_deadline << '\n';
+  ss << "    analysis cache size  : " << analysis_cache_size << '\n';
   ss << "    datadir              : " << datadir << '\n';
   ss << "    logdir               : " << logdir << '\n';
   ss << "    log config           : " << log_config << '\n';
+  ss << "    save delta chain     : " << save_delta_chain << '\n';
+  ss << "    background load      : " << background_load << '\n';
+  ss << "    compress model       : " << compress_model << '\n';
+  if (update_log) {
+    ss << "    checkpoint interval  : " << checkpoint_interval << '\n';
+  } else {
+    ss << "    update log           : disabled" << '\n';
+  }
+  if (!cpu_affinity.empty()) {
+    ss << "    cpu affinity         : " << cpu_affinity << '\n';
+  }
+  if (0 <= numa_node) {
+    ss << "    numa node            : " << numa_node << '\n';
+  }
 #ifdef HAVE_ZOOKEEPER_H
   ss << "    zookeeper            : " << z << '\n';
   ss << "    name                 : " << name << '\n';
@@ -423,8 +667,24 @@ void server_argv::boot_message(const std::string& progname) const {
   } else {
     ss << "    interval count       : disabled" << '\n';
   }
+  if (0 < mix_target_staleness || 0 < mix_network_budget) {
+    ss << "    mix target staleness : " << mix_target_staleness << '\n';
+    ss << "    mix network budget   : " << mix_network_budget << '\n';
+    ss << "    mix min interval     : " << mix_min_interval << '\n';
+  } else {
+    ss << "    adaptive mix         : disabled" << '\n';
+  }
+  if (0 < mix_bandwidth_limit) {
+    ss << "    mix bandwidth limit  : " << mix_bandwidth_limit << '\n';
+  } else {
+    ss << "    mix bandwidth limit  : unlimited" << '\n';
+  }
+  ss << "    mix port             : " << mix_port() << '\n';
   ss << "    zookeeper timeout    : " << zookeeper_timeout << '\n';
   ss << "    interconnect timeout : " << interconnect_timeout << '\n';
+  ss << "    replica write quorum : " << replica_write_quorum << '\n';
+  ss << "    partitioned          : " << partitioned << '\n';
+  ss << "    serving only         : " << serving_only << '\n';
 #endif
   LOG(INFO) << ss.str();
 }
@@ -467,6 +727,11 @@ proxy_argv::proxy_argv(int args, char** argv, const std::string& t)
                      false, "");
   p.add<std::string>("log_config", 'g',
                      "log4cxx XML configuration file", false, "");
+  p.add("partitioned", 0,
+        "broadcast queries to all servers and merge their results "
+        "(for servers started with --partitioned)");
+  p.add("prefer_local", 0,
+        "send requests routed to any server to one on this host first");
   p.add("version", 'v', "version");
 
   p.parse_check(args, argv);
@@ -490,6 +755,8 @@ proxy_argv::proxy_argv(int args, char** argv, const std::string& t)
   session_pool_size = p.get<int>("pool_size");
   logdir = p.get<std::string>("logdir");
   log_config = p.get<std::string>("log_config");
+  partitioned = p.exist("partitioned");
+  prefer_local = p.exist("prefer_local");
 
   // determine listen-address and IPaddr used as ZK 'node-name'
   // TODO(y-oda-oni-juba): check bind_address is valid format
@@ -553,7 +820,9 @@ proxy_argv::proxy_argv()
       z("localhost:2181"),
       logdir(""),
       log_config(""),
-      eth("") {
+      eth(""),
+      partitioned(false),
+      prefer_local(false) {
 }
 
 void proxy_argv::boot_message(const std::string& progname) const {
@@ -569,6 +838,8 @@ void proxy_argv::boot_message(const std::string& progname) const {
   ss << "    logdir               : " << logdir << '\n';
   ss << "    log config           : " << log_config << '\n';
   ss << "    zookeeper            : " << z << '\n';
+  ss << "    partitioned          : " << partitioned << '\n';
+  ss << "    prefer local         : " << prefer_local << '\n';
   LOG(INFO) << ss.str();
 }
 
@@ -72,10 +72,18 @@ struct server_argv {
   int port;
   std::string bind_address;
   std::string bind_if;
+  std::string listen_unix;
   int timeout;
   int zookeeper_timeout;
   int interconnect_timeout;
   int threadnum;
+  int update_threadnum;
+  int analysis_threadnum;
+  int update_max_inflight;
+  int analysis_max_inflight;
+  double request_deadline;
+  int analysis_cache_size;
+  std::string replica_write_quorum;
   std::string program_name;
   std::string type;
   std::string z;
@@ -88,19 +96,48 @@ struct server_argv {
   std::string eth;
   int interval_sec;
   int interval_count;
+  int mix_target_staleness;
+  int mix_network_budget;
+  int mix_min_interval;
+  int mix_bandwidth_limit;
+  int mix_port_offset;
   std::string mixer;
+  std::string cpu_affinity;
+  int numa_node;
+  bool update_log;
+  int checkpoint_interval;
+  int save_delta_chain;
+  bool background_load;
+  bool compress_model;
   bool daemon;
   bool config_test;
+  bool partitioned;
+  bool serving_only;
 
   MSGPACK_DEFINE(port, bind_address, bind_if, timeout,
       zookeeper_timeout, interconnect_timeout, threadnum,
       program_name, type, z, name, datadir, logdir, log_config, eth,
-      interval_sec, interval_count, mixer, daemon, config_test);
+      interval_sec, interval_count, mixer, daemon, config_test,
+      update_threadnum, analysis_threadnum, update_max_inflight,
+      analysis_max_inflight, request_deadline, replica_write_quorum,
+      partitioned, serving_only, mix_target_staleness, mix_network_budget,
+      mix_min_interval, mix_bandwidth_limit, mix_port_offset,
+      cpu_affinity, numa_node, analysis_cache_size, update_log,
+      checkpoint_interval, save_delta_chain, background_load,
+      compress_model, listen_unix);
 
   bool is_standalone() const {
     return (z == "");
   }
+
+  // port serving MIX RPCs
+  int mix_port() const {
+    return port + mix_port_offset;
+  }
   void boot_message(const std::string& progname) const;
+
+  // binds the process to cpu_affinity and numa_node
+  bool apply_placement();
 };
 
 std::string get_server_identifier(const server_argv& a);
@@ -125,6 +162,8 @@ struct proxy_argv {
   int session_pool_expire;
   int session_pool_size;
   bool daemon;
+  bool partitioned;
+  bool prefer_local;
 
   void boot_message(const std::string& progname) const;
 };
@@ -20,12 +20,14 @@
 #include <algorithm>
 #include <csignal>
 #include <string>
+#include <vector>
 
 #include "jubatus/util/concurrent/lock.h"
 #include "jubatus/util/lang/bind.h"
 
 #include "jubavisor.hpp"
 #include "jubatus/core/common/exception.hpp"
+#include "../common/affinity.hpp"
 #include "../common/logger/logger.hpp"
 #include "../common/membership.hpp"
 #include "../common/network.hpp"
@@ -56,9 +58,11 @@ jubavisor::jubavisor(
     const std::string& hosts,
     int port,
     int max,
-    const std::string& logfile)
+    const std::string& logfile,
+    const std::string& placement)
     : port_base_(port),
       logfile_(logfile),
+      placement_(placement),
       max_children_(max) {
   common::prepare_signal_handling();
   ::atexit(jubavisor::atexit_);
@@ -200,8 +204,16 @@ int jubavisor::start_(
     return -1;
   }
 
+  // placement given by the client wins
+  const bool place = placement_ != "none"
+      && argv.cpu_affinity.empty() && argv.numa_node < 0;
+
   for (unsigned int n = 0; n < N; ++n) {
-    process p(zk_->get_hosts(), argv);
+    framework::server_argv child_argv(argv);
+    if (place) {
+      place_(n, N, child_argv);
+    }
+    process p(zk_->get_hosts(), child_argv);
     p.set_names(str);
     it = children_.find(name);
 
@@ -219,6 +231,35 @@ int jubavisor::start_(
   return 0;
 }
 
+void jubavisor::place_(
+    unsigned int n,
+    unsigned int N,
+    framework::server_argv& argv) const {
+  std::vector<int> cpus;
+  const int nodes = common::get_numa_node_count();
+  if (placement_ == "numa" && 0 < nodes) {
+    // spread processes over nodes, then divide each node's CPUs among the
+    // processes on it
+    const unsigned int node = n % nodes;
+    const unsigned int on_node = N / nodes + (node < N % nodes ? 1 : 0);
+    if (!common::get_numa_node_cpus(node, cpus)) {
+      LOG(WARNING) << "cannot get CPUs of NUMA node " << node;
+      return;
+    }
+    argv.numa_node = node;
+    cpus = common::partition_cpus(cpus, n / nodes, on_node);
+  } else {
+    if (!common::get_allowed_cpus(cpus)) {
+      LOG(WARNING) << "cannot get CPUs to place processes";
+      return;
+    }
+    cpus = common::partition_cpus(cpus, n, N);
+  }
+  argv.cpu_affinity = common::format_cpu_list(cpus);
+  LOG(INFO) << "placing process " << n << " on CPUs " << argv.cpu_affinity
+            << " (NUMA node: " << argv.numa_node << ")";
+}
+
 int jubavisor::stop(std::string str, unsigned int N) {
   DLOG(ERROR) << str;
   process p(zk_->get_hosts());
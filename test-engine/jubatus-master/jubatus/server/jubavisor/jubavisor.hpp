@@ -39,7 +39,8 @@ class jubavisor {
       const std::string& hosts,
       int port,
       int max = 10,
-      const std::string& logfile = "");
+      const std::string& logfile = "",
+      const std::string& placement = "none");
   ~jubavisor();
 
   int start(std::string str, unsigned int N, framework::server_argv argv);
@@ -63,6 +64,11 @@ class jubavisor {
       const std::string& str,
       unsigned int N,
       const framework::server_argv& argv);
+  // assigns CPUs (and a NUMA node) to the n-th of N processes to start
+  void place_(
+      unsigned int n,
+      unsigned int N,
+      framework::server_argv& argv) const;
   //  int stop_(const std::string&, std::vector<process>&);
 
   jubatus::util::lang::shared_ptr<common::lock_service> zk_;
@@ -72,6 +78,7 @@ class jubavisor {
   child_map_t children_;
 
   std::string logfile_;
+  std::string placement_;
   jubatus::util::concurrent::mutex m_;
   unsigned int max_children_;
 };
@@ -89,6 +89,10 @@ int main(int argc, char* argv[]) try {
                      "log4cxx XML configuration file", false, "");
   p.add<int>("timeout", 't', "rpc timeout", false, 10);
   p.add("daemon", 'd', "daemonize the process");
+  p.add<std::string>("placement", 0,
+                     "divide CPUs among the processes started at once "
+                     "(none, cpu or numa)", false, "none",
+                     cmdline::oneof<std::string>("none", "cpu", "numa"));
   p.parse_check(argc, argv);
   int port = p.get<int>("rpc-port");
   std::string logfile = "";
@@ -119,7 +123,8 @@ int main(int argc, char* argv[]) try {
     LOG(INFO) << " starting with interactive mode on port " << port;
   }
 
-  jubavisor j(p.get<std::string>("zookeeper"), port, 16, logfile);
+  jubavisor j(p.get<std::string>("zookeeper"), port, 16, logfile,
+              p.get<std::string>("placement"));
   jubavisor_server serv(10 * 1024);
   {
     serv.set_start(bind(&jubavisor::start, &j, _1, _2, _3));
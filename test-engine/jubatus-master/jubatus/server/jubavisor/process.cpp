@@ -105,20 +105,70 @@ bool process::spawn_link(int p) {
       "-p", lexical_cast<std::string>(p),
       "-B", server_option_.bind_if,
       "-c", lexical_cast<std::string>(server_option_.threadnum),
+      "-U", lexical_cast<std::string>(server_option_.update_threadnum),
+      "-A", lexical_cast<std::string>(server_option_.analysis_threadnum),
+      "--update_max_inflight",
+      lexical_cast<std::string>(server_option_.update_max_inflight),
+      "--analysis_max_inflight",
+      lexical_cast<std::string>(server_option_.analysis_max_inflight),
+      "--request_deadline",
+      lexical_cast<std::string>(server_option_.request_deadline),
+      "--analysis_cache_size",
+      lexical_cast<std::string>(server_option_.analysis_cache_size),
       "-t", lexical_cast<std::string>(server_option_.timeout),
       "-Z", lexical_cast<std::string, int>(server_option_.zookeeper_timeout),
       "-I", lexical_cast<std::string, int>(server_option_.interconnect_timeout),
+      "--replica_write_quorum", server_option_.replica_write_quorum,
       "-d", server_option_.datadir,
       "-l", server_option_.logdir,
       "-g", server_option_.log_config,
+      "--checkpoint_interval",
+      lexical_cast<std::string>(server_option_.checkpoint_interval),
+      "--save_delta_chain",
+      lexical_cast<std::string>(server_option_.save_delta_chain),
       "-s", lexical_cast<std::string, int>(server_option_.interval_sec),
       "-i", lexical_cast<std::string, int>(server_option_.interval_count),
+      "--mix_target_staleness",
+      lexical_cast<std::string, int>(server_option_.mix_target_staleness),
+      "--mix_network_budget",
+      lexical_cast<std::string, int>(server_option_.mix_network_budget),
+      "--mix_min_interval",
+      lexical_cast<std::string, int>(server_option_.mix_min_interval),
+      "--mix_bandwidth_limit",
+      lexical_cast<std::string, int>(server_option_.mix_bandwidth_limit),
+      "--mix_port_offset",
+      lexical_cast<std::string, int>(server_option_.mix_port_offset),
       "-x", server_option_.mixer,
     };
     std::vector<const char*> arg_list;
     for (size_t i = 0; i < sizeof(argv) / sizeof(*argv); ++i) {
       arg_list.push_back(argv[i].c_str());
     }
+    if (server_option_.partitioned) {
+      arg_list.push_back("--partitioned");
+    }
+    if (server_option_.serving_only) {
+      arg_list.push_back("--serving_only");
+    }
+    if (server_option_.update_log) {
+      arg_list.push_back("--update_log");
+    }
+    if (server_option_.background_load) {
+      arg_list.push_back("--background_load");
+    }
+    if (server_option_.compress_model) {
+      arg_list.push_back("--compress_model");
+    }
+    const std::string numa_node =
+        lexical_cast<std::string>(server_option_.numa_node);
+    if (!server_option_.cpu_affinity.empty()) {
+      arg_list.push_back("--cpu_affinity");
+      arg_list.push_back(server_option_.cpu_affinity.c_str());
+    }
+    if (0 <= server_option_.numa_node) {
+      arg_list.push_back("--numa_node");
+      arg_list.push_back(numa_node.c_str());
+    }
     arg_list.push_back(NULL);
 
     execvp(cmd.c_str(), (char* const *) &arg_list[0]);
@@ -21,25 +21,32 @@ class anomaly_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<bool(std::string, std::string)>("clear_row",
         jubatus::util::lang::bind(&anomaly_impl::clear_row, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<id_with_score(std::string,
         jubatus::core::fv_converter::datum)>("add", jubatus::util::lang::bind(
-        &anomaly_impl::add, this, jubatus::util::lang::_2));
+        &anomaly_impl::add, this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<float(std::string, std::string,
         jubatus::core::fv_converter::datum)>("update",
         jubatus::util::lang::bind(&anomaly_impl::update, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<float(std::string, std::string,
         jubatus::core::fv_converter::datum)>("overwrite",
         jubatus::util::lang::bind(&anomaly_impl::overwrite, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &anomaly_impl::clear, this));
+        &anomaly_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<float(std::string, jubatus::core::fv_converter::datum)>(
         "calc_score", jubatus::util::lang::bind(&anomaly_impl::calc_score, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::string>(std::string)>("get_all_rows",
-        jubatus::util::lang::bind(&anomaly_impl::get_all_rows, this));
+        jubatus::util::lang::bind(&anomaly_impl::get_all_rows, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&anomaly_impl::get_config, this));
@@ -60,7 +67,7 @@ class anomaly_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   id_with_score add(const jubatus::core::fv_converter::datum& row) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->add(row);
   }
 
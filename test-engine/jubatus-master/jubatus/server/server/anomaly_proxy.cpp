@@ -19,22 +19,22 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "anomaly"));
     k.register_async_cht<2, bool>("clear_row",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_random<id_with_score, jubatus::core::fv_converter::datum>(
         "add");
     k.register_async_cht<2, float, jubatus::core::fv_converter::datum>("update",
-        jubatus::util::lang::function<float(float, float)>(
-        &jubatus::server::framework::pass<float>));
+        jubatus::util::lang::function<void(float&, float&)>(
+        &jubatus::server::framework::inplace::pass<float>));
     k.register_async_cht<2, float, jubatus::core::fv_converter::datum>(
-        "overwrite", jubatus::util::lang::function<float(float, float)>(
-        &jubatus::server::framework::pass<float>));
+        "overwrite", jubatus::util::lang::function<void(float&, float&)>(
+        &jubatus::server::framework::inplace::pass<float>));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
-    k.register_async_random<float, jubatus::core::fv_converter::datum>(
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
+    k.register_async_analysis<float, jubatus::core::fv_converter::datum>(
         "calc_score");
-    k.register_async_random<std::vector<std::string> >("get_all_rows");
+    k.register_async_analysis<std::vector<std::string> >("get_all_rows");
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
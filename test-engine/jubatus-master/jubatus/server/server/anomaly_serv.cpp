@@ -21,6 +21,7 @@
 #include <vector>
 #include "jubatus/util/concurrent/lock.h"
 #include "jubatus/util/text/json.h"
+#include "jubatus/util/lang/bind.h"
 #include "jubatus/util/lang/shared_ptr.h"
 
 #include "jubatus/core/common/assert.hpp"
@@ -39,13 +40,17 @@
 #include "../common/logger/logger.hpp"
 #include "../common/membership.hpp"
 #endif
+#include "../framework/local_update.hpp"
 #include "../framework/mixer/mixer_factory.hpp"
-#include "anomaly_client.hpp"
+#ifdef HAVE_ZOOKEEPER_H
+#include "../framework/replica_writer.hpp"
+#endif
 
 using std::string;
 using std::vector;
 using std::pair;
 using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
 using jubatus::util::text::json::json;
 using jubatus::core::fv_converter::datum;
 using jubatus::server::common::lock_service;
@@ -76,7 +81,9 @@ anomaly_serv::anomaly_serv(
     const server_argv& a,
     const jubatus::util::lang::shared_ptr<lock_service>& zk)
     : server_base(a),
-      mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())) {
+      mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())),
+      analysis_cache_(a.analysis_cache_size) {
+  register_analysis_cache(analysis_cache_);
 #ifdef HAVE_ZOOKEEPER_H
   if (a.is_standalone()) {
 #endif
@@ -91,6 +98,8 @@ anomaly_serv::anomaly_serv(
     string counter_path;
     common::build_actor_path(counter_path, a.type, a.name);
     idgen_zk->set_ls(zk_, counter_path);
+
+    replica_writer_.reset(new framework::replica_writer(a));
   }
 #endif
 }
@@ -101,6 +110,12 @@ anomaly_serv::~anomaly_serv() {
 void anomaly_serv::get_status(status_t& status) const {
   status_t my_status;
   my_status["storage"] = anomaly_->get_model()->type();
+#ifdef HAVE_ZOOKEEPER_H
+  if (replica_writer_) {
+    replica_writer_->get_status(my_status);
+  }
+#endif
+  analysis_cache_.get_status("analysis_cache", my_status);
 
   status.insert(my_status.begin(), my_status.end());
 }
@@ -110,12 +125,39 @@ uint64_t anomaly_serv::user_data_version() const {
 }
 
 void anomaly_serv::set_config(const std::string& config) {
+  anomaly_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(anomaly_.get());
+  analysis_cache_.invalidate();
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* anomaly_serv::prepare_driver(
+    const std::string& config) {
+  next_anomaly_ = make_driver(config);
+  next_config_ = config;
+  return next_anomaly_.get();
+}
+
+void anomaly_serv::commit_driver() {
+  anomaly_.swap(next_anomaly_);
+  config_.swap(next_config_);
+  mixer_->set_driver(anomaly_.get());
+  analysis_cache_.invalidate();
+  reset_id_generator();
+}
+
+void anomaly_serv::discard_driver() {
+  next_anomaly_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::anomaly> anomaly_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config conf_root(lexical_cast<json>(config));
   anomaly_serv_config conf =
     core::common::jsonconfig::config_cast_check<anomaly_serv_config>(conf_root);
 
-  config_ = config;
-
 #if 0
   // TODO(oda): we should use optional<jsonconfig::config> instead of
   //            jsonconfig::config ?
@@ -131,14 +173,11 @@ void anomaly_serv::set_config(const std::string& config) {
   my_id = common::build_loc_str(argv().eth, argv().port);
 #endif
 
-  anomaly_.reset(
+  return shared_ptr<core::driver::anomaly>(
       new core::driver::anomaly(
           core::anomaly::anomaly_factory::create_anomaly(
               conf.method, conf.parameter, my_id),
           core::fv_converter::make_fv_converter(conf.converter, &so_loader_)));
-  mixer_->set_driver(anomaly_.get());
-
-  LOG(INFO) << "config loaded: " << config;
 }
 
 string anomaly_serv::get_config() const {
@@ -149,6 +188,7 @@ string anomaly_serv::get_config() const {
 bool anomaly_serv::clear_row(const string& id) {
   check_set_config();
   anomaly_->clear_row(id);
+  analysis_cache_.invalidate();
   DLOG(INFO) << "row cleared: " << id;
   return true;
 }
@@ -167,6 +207,7 @@ id_with_score anomaly_serv::add(const datum& data) {
     event_model_updated();
     // TODO(unno): remove conversion code
     pair<string, float> res = anomaly_->add(id_str, data);
+    analysis_cache_.invalidate();
     return id_with_score(res.first, res.second);
 #ifdef HAVE_ZOOKEEPER_H
   } else {
@@ -183,29 +224,28 @@ id_with_score anomaly_serv::add_zk(const string&id_str, const datum& d) {
     throw JUBATUS_EXCEPTION(
       core::common::membership_error("no server found in cht: " + argv().name));
   }
-  // this sequences MUST success,
+  // the write to nodes[0] MUST success,
   // in case of failures the whole request should be canceled
-  DLOG(INFO) << "initial add request to "
-             << nodes[0].first << ":" << nodes[0].second;
+  DLOG(INFO) << "add request to "
+             << nodes[0].first << ":" << nodes[0].second
+             << " with " << (nodes.size() - 1) << " replica(s)";
+#ifdef HAVE_ZOOKEEPER_H
   try {
-    score = selective_update(nodes[0].first, nodes[0].second, id_str, d);
-  } catch (const std::runtime_error& e) {
+    score = replica_writer_->write<float>(
+        nodes,
+        anomaly_->is_updatable() ? "update" : "overwrite",
+        msgpack::type::tuple<const string&, const string&, const datum&>(
+            argv().name, id_str, d),
+        jubatus::util::lang::bind(
+            &anomaly_serv::update_locally, this, id_str, d));
+  } catch (const std::exception& e) {
     throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
-        "failed to add ID " + id_str + " (" + e.what() + "): " +
-            nodes[0].first + ":" + lexical_cast<string>(nodes[0].second)));
-  }
-
-  for (size_t i = 1; i < nodes.size(); ++i) {
-    DLOG(INFO) << "replica add request to "
-               << nodes[i].first << ":" << nodes[i].second;
-    try {
-      selective_update(nodes[i].first, nodes[i].second, id_str, d);
-    } catch (const std::runtime_error& e) {
-      LOG(WARNING) << "cannot create " << i << "th replica "
-                   << "(" << e.what() << "): "
-                   << nodes[i].first << ":" << nodes[i].second;
-    }
+        "failed to add ID " + id_str + ": " + e.what()));
   }
+#else
+  // cannot reach here, assertion!
+  JUBATUS_ASSERT_UNREACHABLE();
+#endif
   DLOG(INFO) << "point added: " << id_str;
   return id_with_score(id_str, score);
 }
@@ -214,6 +254,7 @@ float anomaly_serv::update(const string& id, const datum& data) {
   check_set_config();
 
   float score = anomaly_->update(id, data);
+  analysis_cache_.invalidate();
   DLOG(INFO) << "point updated: " << id;
   return score;
 }
@@ -222,6 +263,7 @@ float anomaly_serv::overwrite(const string& id, const datum& data) {
   check_set_config();
 
   float score = anomaly_->overwrite(id, data);
+  analysis_cache_.invalidate();
   DLOG(INFO) << "point overwritten: " << id;
   return score;
 }
@@ -229,13 +271,25 @@ float anomaly_serv::overwrite(const string& id, const datum& data) {
 bool anomaly_serv::clear() {
   check_set_config();
   anomaly_->clear();
+  analysis_cache_.invalidate();
   LOG(INFO) << "model cleared: " << argv().name;
   return true;
 }
 
 float anomaly_serv::calc_score(const datum& data) const {
   check_set_config();
-  return anomaly_->calc_score(data);
+  if (!analysis_cache_.enabled()) {
+    return anomaly_->calc_score(data);
+  }
+
+  const framework::datum_key key = framework::make_datum_key(data);
+  float score;
+  uint64_t generation;
+  if (!analysis_cache_.get(key, score, generation)) {
+    score = anomaly_->calc_score(data);
+    analysis_cache_.put(key, score, generation);
+  }
+  return score;
 }
 
 vector<string> anomaly_serv::get_all_rows() const {
@@ -266,33 +320,22 @@ void anomaly_serv::find_from_cht(
 }
 
 /*
- * Updates the model on the specified node and returns the score.
- * If the host/port of the current process is specified, update
- * is processed locally.
- * Caller is responsible for handling exceptions including RPC
- * errors.
+ * Updates the model of this server as a part of replicated add
+ * and returns the score.
  */
-float anomaly_serv::selective_update(
-    const string& host,
-    int port,
-    const string& id,
-    const datum& d) {
+float anomaly_serv::update_locally(const string& id, const datum& d) {
   // nolock context
-  if (host == argv().eth && port == argv().port) {
-    jubatus::util::concurrent::scoped_wlock lk(rw_mutex());
-    event_model_updated();
-    if (anomaly_->is_updatable()) {
-      return this->update(id, d);
-    } else {
-      return this->overwrite(id, d);
-    }
-  } else {  // needs no lock
-    client::anomaly c(host, port, argv().name, argv().interconnect_timeout);
-    if (anomaly_->is_updatable()) {
-      return c.update(id, d);
-    } else {
-      return c.overwrite(id, d);
-    }
+  const bool updatable = anomaly_->is_updatable();
+  // "add" is not logged; it is replayed as the update applied here
+  framework::local_update log(*this, updatable ? "update" : "overwrite",
+      msgpack::type::tuple<const string&, const string&, const datum&>(
+          argv().name, id, d));
+  jubatus::util::concurrent::scoped_wlock lk(rw_mutex());
+  event_model_updated();
+  if (updatable) {
+    return this->update(id, d);
+  } else {
+    return this->overwrite(id, d);
   }
 }
 
@@ -309,6 +352,17 @@ void anomaly_serv::load_file(const std::string& path) {
   reset_id_generator();
 }
 
+std::vector<std::string> anomaly_serv::unlogged_update_methods() const {
+  std::vector<std::string> methods;
+#ifdef HAVE_ZOOKEEPER_H
+  if (!argv().is_standalone()) {
+    // these forward the update to the CHT owners
+    methods.push_back("add");
+  }
+#endif
+  return methods;
+}
+
 void anomaly_serv::reset_id_generator() {
   if (argv().is_standalone()) {
     uint64_t counter = anomaly_->find_max_int_id() + 1;
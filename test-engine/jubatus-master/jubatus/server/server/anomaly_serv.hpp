@@ -26,11 +26,15 @@
 #include "jubatus/core/fv_converter/so_factory.hpp"
 #include "../common/global_id_generator_base.hpp"
 #include "../common/lock_service.hpp"
+#include "../framework/datum_cache.hpp"
 #include "../framework/server_base.hpp"
 #include "anomaly_types.hpp"
 
 namespace jubatus {
 namespace server {
+namespace framework {
+class replica_writer;
+}  // namespace framework
 
 class anomaly_serv : public framework::server_base {
  public:
@@ -51,6 +55,9 @@ class anomaly_serv : public framework::server_base {
   uint64_t user_data_version() const;
 
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
 
   bool clear_row(const std::string& id);
@@ -69,8 +76,12 @@ class anomaly_serv : public framework::server_base {
 
   virtual bool load(const std::string& id);
   void load_file(const std::string& path);
+  std::vector<std::string> unlogged_update_methods() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::anomaly> make_driver(
+      const std::string& config);
+
   id_with_score add_zk(
       const std::string& id,
       const core::fv_converter::datum& d);
@@ -80,9 +91,7 @@ class anomaly_serv : public framework::server_base {
       size_t n,
       std::vector<std::pair<std::string, int> >& out);
 
-  float selective_update(
-      const std::string& host,
-      int port,
+  float update_locally(
       const std::string& id,
       const core::fv_converter::datum& d);
 
@@ -90,10 +99,15 @@ class anomaly_serv : public framework::server_base {
 
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::anomaly> anomaly_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::anomaly> next_anomaly_;
+  std::string next_config_;
+  mutable framework::datum_cache<float> analysis_cache_;
   std::string config_;
 
   jubatus::util::lang::shared_ptr<common::lock_service> zk_;
   jubatus::util::lang::shared_ptr<common::global_id_generator_base> idgen_;
+  jubatus::util::lang::shared_ptr<framework::replica_writer> replica_writer_;
   jubatus::core::fv_converter::so_factory so_loader_;
 };
 
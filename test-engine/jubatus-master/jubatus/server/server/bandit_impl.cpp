@@ -21,25 +21,32 @@ class bandit_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<bool(std::string, std::string)>("register_arm",
         jubatus::util::lang::bind(&bandit_impl::register_arm, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("delete_arm",
         jubatus::util::lang::bind(&bandit_impl::delete_arm, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::string(std::string, std::string)>("select_arm",
         jubatus::util::lang::bind(&bandit_impl::select_arm, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string, std::string, double)>(
         "register_reward", jubatus::util::lang::bind(
         &bandit_impl::register_reward, this, jubatus::util::lang::_2,
-        jubatus::util::lang::_3, jubatus::util::lang::_4));
+        jubatus::util::lang::_3, jubatus::util::lang::_4),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::map<std::string, arm_info>(std::string, std::string)>(
         "get_arm_info", jubatus::util::lang::bind(&bandit_impl::get_arm_info,
-        this, jubatus::util::lang::_2));
+        this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("reset",
         jubatus::util::lang::bind(&bandit_impl::reset, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &bandit_impl::clear, this));
+        &bandit_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&bandit_impl::get_config, this));
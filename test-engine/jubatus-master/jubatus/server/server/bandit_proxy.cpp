@@ -19,27 +19,28 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "bandit"));
     k.register_async_broadcast<bool, std::string>("register_arm",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool, std::string>("delete_arm",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<1, std::string>("select_arm",
-        jubatus::util::lang::function<std::string(std::string, std::string)>(
-        &jubatus::server::framework::pass<std::string>));
+        jubatus::util::lang::function<void(std::string&, std::string&)>(
+        &jubatus::server::framework::inplace::pass<std::string>));
     k.register_async_cht<1, bool, std::string, double>("register_reward",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<1, std::map<std::string, arm_info> >("get_arm_info",
-        jubatus::util::lang::function<std::map<std::string, arm_info>(
-        std::map<std::string, arm_info>, std::map<std::string, arm_info>)>(
-        &jubatus::server::framework::pass<std::map<std::string, arm_info> >));
+        jubatus::util::lang::function<void(std::map<std::string, arm_info>&,
+        std::map<std::string, arm_info>&)>(
+        &jubatus::server::framework::inplace::pass<std::map<std::string,
+        arm_info> >));
     k.register_async_broadcast<bool, std::string>("reset",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_or));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_or));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
@@ -64,22 +64,44 @@ void bandit_serv::get_status(status_t& status) const {
 }
 
 void bandit_serv::set_config(const std::string& config) {
+  bandit_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(bandit_.get());
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* bandit_serv::prepare_driver(
+    const std::string& config) {
+  next_bandit_ = make_driver(config);
+  next_config_ = config;
+  return next_bandit_.get();
+}
+
+void bandit_serv::commit_driver() {
+  bandit_.swap(next_bandit_);
+  config_.swap(next_config_);
+  mixer_->set_driver(bandit_.get());
+}
+
+void bandit_serv::discard_driver() {
+  next_bandit_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::bandit> bandit_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config config_root(lexical_cast<json>(config));
   bandit_serv_config conf =
     core::common::jsonconfig::config_cast_check<bandit_serv_config>(
       config_root);
 
-  config_ = config;
-
   core::common::jsonconfig::config param;
   if (conf.parameter) {
     param = *conf.parameter;
   }
 
-  bandit_.reset(new core::driver::bandit(conf.method, param));
-  mixer_->set_driver(bandit_.get());
-
-  LOG(INFO) << "config loaded: " << config;
+  return shared_ptr<core::driver::bandit>(
+      new core::driver::bandit(conf.method, param));
 }
 
 bool bandit_serv::register_arm(const std::string& arm_id) {
@@ -44,6 +44,9 @@ class bandit_serv : public framework::server_base {
   uint64_t user_data_version() const;
   void get_status(status_t& status) const;
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
 
   bool register_arm(const std::string& arm_id);
   bool delete_arm(const std::string& arm_id);
@@ -56,8 +59,14 @@ class bandit_serv : public framework::server_base {
   bool clear();
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::bandit> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::bandit> bandit_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::bandit> next_bandit_;
+  std::string next_config_;
   std::string config_;
 };
 
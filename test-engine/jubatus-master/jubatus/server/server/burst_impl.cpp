@@ -21,33 +21,43 @@ class burst_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<int32_t(std::string, std::vector<document>)>(
         "add_documents", jubatus::util::lang::bind(&burst_impl::add_documents,
-        this, jubatus::util::lang::_2));
+        this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<window(std::string, std::string)>("get_result",
         jubatus::util::lang::bind(&burst_impl::get_result, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<window(std::string, std::string, double)>("get_result_at",
         jubatus::util::lang::bind(&burst_impl::get_result_at, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::map<std::string, window>(std::string)>(
         "get_all_bursted_results", jubatus::util::lang::bind(
-        &burst_impl::get_all_bursted_results, this));
+        &burst_impl::get_all_bursted_results, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::map<std::string, window>(std::string, double)>(
         "get_all_bursted_results_at", jubatus::util::lang::bind(
         &burst_impl::get_all_bursted_results_at, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<keyword_with_params>(std::string)>(
         "get_all_keywords", jubatus::util::lang::bind(
-        &burst_impl::get_all_keywords, this));
+        &burst_impl::get_all_keywords, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string, keyword_with_params)>("add_keyword",
         jubatus::util::lang::bind(&burst_impl::add_keyword, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("remove_keyword",
         jubatus::util::lang::bind(&burst_impl::remove_keyword, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("remove_all_keywords",
-        jubatus::util::lang::bind(&burst_impl::remove_all_keywords, this));
+        jubatus::util::lang::bind(&burst_impl::remove_all_keywords, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &burst_impl::clear, this));
+        &burst_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&burst_impl::get_config, this));
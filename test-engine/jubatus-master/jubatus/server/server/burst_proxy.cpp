@@ -19,38 +19,36 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "burst"));
     k.register_async_broadcast<int32_t, std::vector<document> >("add_documents",
-        jubatus::util::lang::function<int32_t(int32_t, int32_t)>(
-        &jubatus::server::framework::pass<int32_t>));
+        jubatus::util::lang::function<void(int32_t&, int32_t&)>(
+        &jubatus::server::framework::inplace::pass<int32_t>));
     k.register_async_cht<2, window>("get_result",
-        jubatus::util::lang::function<window(window, window)>(
-        &jubatus::server::framework::pass<window>));
+        jubatus::util::lang::function<void(window&, window&)>(
+        &jubatus::server::framework::inplace::pass<window>));
     k.register_async_cht<2, window, double>("get_result_at",
-        jubatus::util::lang::function<window(window, window)>(
-        &jubatus::server::framework::pass<window>));
+        jubatus::util::lang::function<void(window&, window&)>(
+        &jubatus::server::framework::inplace::pass<window>));
     k.register_async_broadcast<std::map<std::string, window> >(
-        "get_all_bursted_results",
-        jubatus::util::lang::function<std::map<std::string, window>(
-        std::map<std::string, window>, std::map<std::string, window>)>(
-        &jubatus::server::framework::merge<std::string, window>));
+        "get_all_bursted_results", jubatus::util::lang::function<void(
+        std::map<std::string, window>&, std::map<std::string, window>&)>(
+        &jubatus::server::framework::inplace::merge<std::string, window>));
     k.register_async_broadcast<std::map<std::string, window>, double>(
-        "get_all_bursted_results_at",
-        jubatus::util::lang::function<std::map<std::string, window>(
-        std::map<std::string, window>, std::map<std::string, window>)>(
-        &jubatus::server::framework::merge<std::string, window>));
-    k.register_async_random<std::vector<keyword_with_params> >(
+        "get_all_bursted_results_at", jubatus::util::lang::function<void(
+        std::map<std::string, window>&, std::map<std::string, window>&)>(
+        &jubatus::server::framework::inplace::merge<std::string, window>));
+    k.register_async_analysis<std::vector<keyword_with_params> >(
         "get_all_keywords");
     k.register_async_broadcast<bool, keyword_with_params>("add_keyword",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool, std::string>("remove_keyword",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool>("remove_all_keywords",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
@@ -121,17 +121,39 @@ void burst_serv::get_status(status_t& status) const {
 }
 
 void burst_serv::set_config(const std::string& config) {
-  core::common::jsonconfig::config config_root(lexical_cast<json>(config));
-  burst_serv_config conf = config_cast_check<burst_serv_config>(config_root);
-
+  burst_ = make_driver(config);
   config_ = config;
+  mixer_->set_driver(burst_.get());
+  LOG(INFO) << "config loaded: " << config;
+}
 
-  burst_options options = config_cast_check<burst_options>(conf.parameter);
+core::driver::driver_base* burst_serv::prepare_driver(
+    const std::string& config) {
+  next_burst_ = make_driver(config);
+  next_config_ = config;
+  return next_burst_.get();
+}
 
-  burst_.reset(new core::driver::burst(new core::burst::burst(options)));
+void burst_serv::commit_driver() {
+  burst_.swap(next_burst_);
+  config_.swap(next_config_);
   mixer_->set_driver(burst_.get());
+}
 
-  LOG(INFO) << "config loaded: " << config;
+void burst_serv::discard_driver() {
+  next_burst_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::burst> burst_serv::make_driver(
+    const std::string& config) {
+  core::common::jsonconfig::config config_root(lexical_cast<json>(config));
+  burst_serv_config conf = config_cast_check<burst_serv_config>(config_root);
+
+  burst_options options = config_cast_check<burst_options>(conf.parameter);
+
+  return shared_ptr<core::driver::burst>(
+      new core::driver::burst(new core::burst::burst(options)));
 }
 
 std::string burst_serv::get_config() const {
@@ -45,6 +45,9 @@ class burst_serv : public jubatus::server::framework::server_base {
 
   void get_status(status_t& status) const;
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
   uint64_t user_data_version() const;
 
@@ -63,8 +66,14 @@ class burst_serv : public jubatus::server::framework::server_base {
   void rehash_keywords();
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::burst> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::burst> burst_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::burst> next_burst_;
+  std::string next_config_;
   std::string config_;
 
   jubatus::util::lang::shared_ptr<common::lock_service> zk_;
@@ -22,21 +22,27 @@ class classifier_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<int32_t(std::string, std::vector<labeled_datum>)>("train",
         jubatus::util::lang::bind(&classifier_impl::train, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::vector<std::vector<estimate_result> >(std::string,
         std::vector<jubatus::core::fv_converter::datum>)>("classify",
         jubatus::util::lang::bind(&classifier_impl::classify, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::map<std::string, uint64_t>(std::string)>("get_labels",
-        jubatus::util::lang::bind(&classifier_impl::get_labels, this));
+        jubatus::util::lang::bind(&classifier_impl::get_labels, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("set_label",
         jubatus::util::lang::bind(&classifier_impl::set_label, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &classifier_impl::clear, this));
+        &classifier_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("delete_label",
         jubatus::util::lang::bind(&classifier_impl::delete_label, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&classifier_impl::get_config, this));
@@ -52,7 +58,7 @@ class classifier_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   int32_t train(const std::vector<labeled_datum>& data) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->train(data);
   }
 
@@ -68,17 +74,17 @@ class classifier_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   bool set_label(const std::string& new_label) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->set_label(new_label);
   }
 
   bool clear() {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->clear();
   }
 
   bool delete_label(const std::string& target_label) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->delete_label(target_label);
   }
 
@@ -19,18 +19,18 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "classifier"));
     k.register_async_random<int32_t, std::vector<labeled_datum> >("train");
-    k.register_async_random<std::vector<std::vector<estimate_result> >,
+    k.register_async_analysis<std::vector<std::vector<estimate_result> >,
         std::vector<jubatus::core::fv_converter::datum> >("classify");
-    k.register_async_random<std::map<std::string, uint64_t> >("get_labels");
+    k.register_async_analysis<std::map<std::string, uint64_t> >("get_labels");
     k.register_async_broadcast<bool, std::string>("set_label",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool, std::string>("delete_label",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_or));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_or));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
@@ -76,7 +76,9 @@ classifier_serv::classifier_serv(
     const framework::server_argv& a,
     const jubatus::util::lang::shared_ptr<lock_service>& zk)
     : server_base(a),
-      mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())) {
+      mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())),
+      analysis_cache_(a.analysis_cache_size) {
+  register_analysis_cache(analysis_cache_);
 }
 
 classifier_serv::~classifier_serv() {
@@ -85,17 +87,47 @@ classifier_serv::~classifier_serv() {
 void classifier_serv::get_status(status_t& status) const {
   status_t my_status;
   classifier_->get_status(my_status);
+  analysis_cache_.get_status("analysis_cache", my_status);
   status.insert(my_status.begin(), my_status.end());
 }
 
 void classifier_serv::set_config(const string& config) {
+  classifier_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(classifier_.get());
+  analysis_cache_.invalidate();
+
+  // TODO(kuenishi): switch the function when set_config is done
+  // because mixing method differs btwn PA, CW, etc...
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* classifier_serv::prepare_driver(
+    const std::string& config) {
+  next_classifier_ = make_driver(config);
+  next_config_ = config;
+  return next_classifier_.get();
+}
+
+void classifier_serv::commit_driver() {
+  classifier_.swap(next_classifier_);
+  config_.swap(next_config_);
+  mixer_->set_driver(classifier_.get());
+  analysis_cache_.invalidate();
+}
+
+void classifier_serv::discard_driver() {
+  next_classifier_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::classifier> classifier_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config config_root(lexical_cast<json>(config));
   classifier_serv_config conf =
     core::common::jsonconfig::config_cast_check<classifier_serv_config>(
       config_root);
 
-  config_ = config;
-
   core::common::jsonconfig::config param;
   if (conf.parameter) {
     param = *conf.parameter;
@@ -104,16 +136,11 @@ void classifier_serv::set_config(const string& config) {
   // Model owner moved to classifier_
   shared_ptr<core::storage::storage_base> model = make_model(argv());
 
-  classifier_.reset(
+  return shared_ptr<core::driver::classifier>(
       new core::driver::classifier(
         core::classifier::classifier_factory::create_classifier(
           conf.method, param, model),
         core::fv_converter::make_fv_converter(conf.converter, &so_loader_)));
-  mixer_->set_driver(classifier_.get());
-
-  // TODO(kuenishi): switch the function when set_config is done
-  // because mixing method differs btwn PA, CW, etc...
-  LOG(INFO) << "config loaded: " << config;
 }
 
 string classifier_serv::get_config() const {
@@ -142,6 +169,7 @@ int classifier_serv::train(const vector<labeled_datum>& data) {
     DLOG(INFO) << "trained: " << data[i].label;
     count++;
   }
+  analysis_cache_.invalidate();
   // TODO(kuenishi): send count incrementation to mixer
   return count;
 }
@@ -153,9 +181,18 @@ vector<vector<estimate_result> > classifier_serv::classify(
   vector<vector<estimate_result> > ret;
 
   for (size_t i = 0; i < data.size(); ++i) {
-    classify_result scores = classifier_->classify(data[i]);
-
     vector<estimate_result> r;
+    framework::datum_key key = framework::datum_key();
+    uint64_t generation = 0;
+    if (analysis_cache_.enabled()) {
+      key = framework::make_datum_key(data[i]);
+      if (analysis_cache_.get(key, r, generation)) {
+        ret.push_back(r);
+        continue;
+      }
+    }
+
+    classify_result scores = classifier_->classify(data[i]);
     for (classify_result::const_iterator p = scores.begin();
         p != scores.end(); ++p) {
       // convert to server IDL types
@@ -167,6 +204,9 @@ vector<vector<estimate_result> > classifier_serv::classify(
         LOG(WARNING) << "score is infinite: " << p->label << " = " << p->score;
       }
     }
+    if (analysis_cache_.enabled()) {
+      analysis_cache_.put(key, r, generation);
+    }
     ret.push_back(r);
   }
   return ret;  // vector<estimate_results> >::ok(ret);
@@ -181,6 +221,7 @@ bool classifier_serv::clear() {
   }
 
   classifier_->clear();
+  analysis_cache_.invalidate();
   LOG(INFO) << "model cleared: " << argv().name;
   return true;
 }
@@ -210,7 +251,9 @@ bool classifier_serv::set_label(const std::string& label) {
     event_model_updated();
   }
 
-  return classifier_->set_label(label);
+  const bool result = classifier_->set_label(label);
+  analysis_cache_.invalidate();
+  return result;
 }
 
 bool classifier_serv::delete_label(const std::string& label) {
@@ -221,7 +264,9 @@ bool classifier_serv::delete_label(const std::string& label) {
     event_model_updated();
   }
 
-  return classifier_->delete_label(label);
+  const bool result = classifier_->delete_label(label);
+  analysis_cache_.invalidate();
+  return result;
 }
 
 }  // namespace server
@@ -25,6 +25,7 @@
 #include "jubatus/core/driver/classifier.hpp"
 #include "jubatus/core/fv_converter/so_factory.hpp"
 #include "classifier_types.hpp"
+#include "../framework/datum_cache.hpp"
 #include "../framework/server_base.hpp"
 
 namespace jubatus {
@@ -50,6 +51,9 @@ class classifier_serv : public framework::server_base {
 
   int train(const std::vector<labeled_datum>& data);
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
   std::vector<std::vector<estimate_result> > classify(
       const std::vector<jubatus::core::fv_converter::datum>& data) const;
@@ -63,8 +67,16 @@ class classifier_serv : public framework::server_base {
   void check_set_config() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::classifier> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::classifier> classifier_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::classifier> next_classifier_;
+  std::string next_config_;
+  mutable framework::datum_cache<std::vector<estimate_result> >
+      analysis_cache_;
   std::string config_;
   jubatus::core::fv_converter::so_factory so_loader_;
 };
@@ -23,34 +23,43 @@ class clustering_impl : public jubatus::server::common::mprpc::rpc_server {
     rpc_server::add<bool(std::string,
         std::vector<jubatus::core::clustering::indexed_point>)>("push",
         jubatus::util::lang::bind(&clustering_impl::push, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<uint32_t(std::string)>("get_revision",
-        jubatus::util::lang::bind(&clustering_impl::get_revision, this));
+        jubatus::util::lang::bind(&clustering_impl::get_revision, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::vector<std::pair<double,
         jubatus::core::fv_converter::datum> > >(std::string)>(
         "get_core_members", jubatus::util::lang::bind(
-        &clustering_impl::get_core_members, this));
+        &clustering_impl::get_core_members, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::vector<std::pair<double, std::string> > >(
         std::string)>("get_core_members_light", jubatus::util::lang::bind(
-        &clustering_impl::get_core_members_light, this));
+        &clustering_impl::get_core_members_light, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<jubatus::core::fv_converter::datum>(
         std::string)>("get_k_center", jubatus::util::lang::bind(
-        &clustering_impl::get_k_center, this));
+        &clustering_impl::get_k_center, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<jubatus::core::fv_converter::datum(std::string,
         jubatus::core::fv_converter::datum)>("get_nearest_center",
         jubatus::util::lang::bind(&clustering_impl::get_nearest_center, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::pair<double,
         jubatus::core::fv_converter::datum> >(std::string,
         jubatus::core::fv_converter::datum)>("get_nearest_members",
         jubatus::util::lang::bind(&clustering_impl::get_nearest_members, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::pair<double, std::string> >(std::string,
         jubatus::core::fv_converter::datum)>("get_nearest_members_light",
         jubatus::util::lang::bind(&clustering_impl::get_nearest_members_light,
-        this, jubatus::util::lang::_2));
+        this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &clustering_impl::clear, this));
+        &clustering_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&clustering_impl::get_config, this));
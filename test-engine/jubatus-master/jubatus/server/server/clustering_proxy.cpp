@@ -20,23 +20,23 @@ int run_proxy(int argc, char* argv[]) {
         jubatus::server::framework::proxy_argv(argc, argv, "clustering"));
     k.register_async_random<bool,
         std::vector<jubatus::core::clustering::indexed_point> >("push");
-    k.register_async_random<uint32_t>("get_revision");
-    k.register_async_random<std::vector<std::vector<std::pair<double,
+    k.register_async_analysis<uint32_t>("get_revision");
+    k.register_async_analysis<std::vector<std::vector<std::pair<double,
         jubatus::core::fv_converter::datum> > > >("get_core_members");
-    k.register_async_random<std::vector<std::vector<std::pair<double,
+    k.register_async_analysis<std::vector<std::vector<std::pair<double,
         std::string> > > >("get_core_members_light");
-    k.register_async_random<std::vector<jubatus::core::fv_converter::datum> >(
+    k.register_async_analysis<std::vector<jubatus::core::fv_converter::datum> >(
         "get_k_center");
-    k.register_async_random<jubatus::core::fv_converter::datum,
+    k.register_async_analysis<jubatus::core::fv_converter::datum,
         jubatus::core::fv_converter::datum>("get_nearest_center");
-    k.register_async_random<std::vector<std::pair<double,
+    k.register_async_analysis<std::vector<std::pair<double,
         jubatus::core::fv_converter::datum> >,
         jubatus::core::fv_converter::datum>("get_nearest_members");
-    k.register_async_random<std::vector<std::pair<double, std::string> >,
+    k.register_async_analysis<std::vector<std::pair<double, std::string> >,
         jubatus::core::fv_converter::datum>("get_nearest_members_light");
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
@@ -79,12 +79,37 @@ uint64_t clustering_serv::user_data_version() const {
 }
 
 void clustering_serv::set_config(const std::string& config) {
+  clustering_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(clustering_.get());
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* clustering_serv::prepare_driver(
+    const std::string& config) {
+  next_clustering_ = make_driver(config);
+  next_config_ = config;
+  return next_clustering_.get();
+}
+
+void clustering_serv::commit_driver() {
+  clustering_.swap(next_clustering_);
+  config_.swap(next_config_);
+  mixer_->set_driver(clustering_.get());
+}
+
+void clustering_serv::discard_driver() {
+  next_clustering_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::clustering> clustering_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config config_root(
       lexical_cast<jubatus::util::text::json::json>(config));
   clustering_serv_config conf =
       core::common::jsonconfig::config_cast_check<clustering_serv_config>(
           config_root);
-  config_ = config;
   shared_ptr<core::fv_converter::datum_to_fv_converter> converter =
     core::fv_converter::make_fv_converter(conf.converter, &so_loader_);
 
@@ -102,7 +127,7 @@ void clustering_serv::set_config(const std::string& config) {
 
   const std::string name = get_server_identifier(argv());
 
-  clustering_.reset(new core::driver::clustering(
+  return shared_ptr<core::driver::clustering>(new core::driver::clustering(
       core::clustering::clustering_factory::create(
           name,
           method,
@@ -110,9 +135,6 @@ void clustering_serv::set_config(const std::string& config) {
           param,
           compressor_param),
       converter));
-  mixer_->set_driver(clustering_.get());
-
-  LOG(INFO) << "config loaded: " << config;
 }
 
 std::string clustering_serv::get_config() const {
@@ -48,6 +48,9 @@ class clustering_serv : public framework::server_base {
   uint64_t user_data_version() const;
 
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
 
   bool push(const std::vector<core::clustering::indexed_point>& points);
@@ -70,8 +73,14 @@ class clustering_serv : public framework::server_base {
   void check_set_config() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::clustering> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::clustering> clustering_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::clustering> next_clustering_;
+  std::string next_config_;
   std::string config_;
   jubatus::core::fv_converter::so_factory so_loader_;
 };
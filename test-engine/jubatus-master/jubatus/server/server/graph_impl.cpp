@@ -20,64 +20,87 @@ class graph_impl : public jubatus::server::common::mprpc::rpc_server {
     p_(new jubatus::server::framework::server_helper<graph_serv>(a, true)) {
 
     rpc_server::add<std::string(std::string)>("create_node",
-        jubatus::util::lang::bind(&graph_impl::create_node, this));
+        jubatus::util::lang::bind(&graph_impl::create_node, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("remove_node",
         jubatus::util::lang::bind(&graph_impl::remove_node, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string, std::map<std::string,
         std::string>)>("update_node", jubatus::util::lang::bind(
         &graph_impl::update_node, this, jubatus::util::lang::_2,
-        jubatus::util::lang::_3));
+        jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<uint64_t(std::string, std::string, edge)>("create_edge",
         jubatus::util::lang::bind(&graph_impl::create_edge, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string, uint64_t, edge)>(
         "update_edge", jubatus::util::lang::bind(&graph_impl::update_edge, this,
         jubatus::util::lang::_2, jubatus::util::lang::_3,
-        jubatus::util::lang::_4));
+        jubatus::util::lang::_4),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string, uint64_t)>("remove_edge",
         jubatus::util::lang::bind(&graph_impl::remove_edge, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<double(std::string, std::string, int32_t,
         jubatus::core::graph::preset_query)>("get_centrality",
         jubatus::util::lang::bind(&graph_impl::get_centrality, this,
         jubatus::util::lang::_2, jubatus::util::lang::_3,
-        jubatus::util::lang::_4));
+        jubatus::util::lang::_4),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string, jubatus::core::graph::preset_query)>(
         "add_centrality_query", jubatus::util::lang::bind(
-        &graph_impl::add_centrality_query, this, jubatus::util::lang::_2));
+        &graph_impl::add_centrality_query, this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, jubatus::core::graph::preset_query)>(
         "add_shortest_path_query", jubatus::util::lang::bind(
-        &graph_impl::add_shortest_path_query, this, jubatus::util::lang::_2));
+        &graph_impl::add_shortest_path_query, this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, jubatus::core::graph::preset_query)>(
         "remove_centrality_query", jubatus::util::lang::bind(
-        &graph_impl::remove_centrality_query, this, jubatus::util::lang::_2));
+        &graph_impl::remove_centrality_query, this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, jubatus::core::graph::preset_query)>(
         "remove_shortest_path_query", jubatus::util::lang::bind(
         &graph_impl::remove_shortest_path_query, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::vector<std::string>(std::string, shortest_path_query)>(
         "get_shortest_path", jubatus::util::lang::bind(
-        &graph_impl::get_shortest_path, this, jubatus::util::lang::_2));
+        &graph_impl::get_shortest_path, this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string)>("update_index",
-        jubatus::util::lang::bind(&graph_impl::update_index, this));
+        jubatus::util::lang::bind(&graph_impl::update_index, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &graph_impl::clear, this));
+        &graph_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<jubatus::core::graph::node_info(std::string, std::string)>(
         "get_node", jubatus::util::lang::bind(&graph_impl::get_node, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<edge(std::string, std::string, uint64_t)>("get_edge",
         jubatus::util::lang::bind(&graph_impl::get_edge, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("create_node_here",
         jubatus::util::lang::bind(&graph_impl::create_node_here, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string)>("remove_global_node",
         jubatus::util::lang::bind(&graph_impl::remove_global_node, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
+    rpc_server::add<bool(std::string, std::string)>("remove_node_here",
+        jubatus::util::lang::bind(&graph_impl::remove_node_here, this,
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, uint64_t, edge)>("create_edge_here",
         jubatus::util::lang::bind(&graph_impl::create_edge_here, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&graph_impl::get_config, this));
@@ -93,12 +116,12 @@ class graph_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   std::string create_node() {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->create_node();
   }
 
   bool remove_node(const std::string& node_id) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->remove_node(node_id);
   }
 
@@ -109,7 +132,7 @@ class graph_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   uint64_t create_edge(const std::string& node_id, const edge& e) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->create_edge(node_id, e);
   }
 
@@ -188,6 +211,11 @@ class graph_impl : public jubatus::server::common::mprpc::rpc_server {
     return get_p()->remove_global_node(node_id);
   }
 
+  bool remove_node_here(const std::string& node_id) {
+    JWLOCK_(p_);
+    return get_p()->remove_node_here(node_id);
+  }
+
   bool create_edge_here(uint64_t edge_id, const edge& e) {
     JWLOCK_(p_);
     return get_p()->create_edge_here(edge_id, e);
@@ -20,49 +20,49 @@ int run_proxy(int argc, char* argv[]) {
         jubatus::server::framework::proxy_argv(argc, argv, "graph"));
     k.register_async_random<std::string>("create_node");
     k.register_async_cht<2, bool>("remove_node",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::pass<bool>));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::pass<bool>));
     k.register_async_cht<2, bool, std::map<std::string, std::string> >(
-        "update_node", jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        "update_node", jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<1, uint64_t, edge>("create_edge",
-        jubatus::util::lang::function<uint64_t(uint64_t, uint64_t)>(
-        &jubatus::server::framework::pass<uint64_t>));
+        jubatus::util::lang::function<void(uint64_t&, uint64_t&)>(
+        &jubatus::server::framework::inplace::pass<uint64_t>));
     k.register_async_cht<2, bool, uint64_t, edge>("update_edge",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<2, bool, uint64_t>("remove_edge",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
-    k.register_async_random<double, std::string, int32_t,
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
+    k.register_async_analysis<double, std::string, int32_t,
         jubatus::core::graph::preset_query>("get_centrality");
     k.register_async_broadcast<bool, jubatus::core::graph::preset_query>(
-        "add_centrality_query", jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        "add_centrality_query", jubatus::util::lang::function<void(bool&,
+        bool&)>(&jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool, jubatus::core::graph::preset_query>(
-        "add_shortest_path_query", jubatus::util::lang::function<bool(bool,
-        bool)>(&jubatus::server::framework::all_and));
+        "add_shortest_path_query", jubatus::util::lang::function<void(bool&,
+        bool&)>(&jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool, jubatus::core::graph::preset_query>(
-        "remove_centrality_query", jubatus::util::lang::function<bool(bool,
-        bool)>(&jubatus::server::framework::all_and));
+        "remove_centrality_query", jubatus::util::lang::function<void(bool&,
+        bool&)>(&jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool, jubatus::core::graph::preset_query>(
-        "remove_shortest_path_query", jubatus::util::lang::function<bool(bool,
-        bool)>(&jubatus::server::framework::all_and));
-    k.register_async_random<std::vector<std::string>, shortest_path_query>(
+        "remove_shortest_path_query", jubatus::util::lang::function<void(bool&,
+        bool&)>(&jubatus::server::framework::inplace::all_and));
+    k.register_async_analysis<std::vector<std::string>, shortest_path_query>(
         "get_shortest_path");
     k.register_async_broadcast<bool>("update_index",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<2, jubatus::core::graph::node_info>("get_node",
-        jubatus::util::lang::function<jubatus::core::graph::node_info(
-        jubatus::core::graph::node_info, jubatus::core::graph::node_info)>(
-        &jubatus::server::framework::pass<jubatus::core::graph::node_info>));
+        jubatus::util::lang::function<void(jubatus::core::graph::node_info&,
+        jubatus::core::graph::node_info&)>(
+        &jubatus::server::framework::inplace::pass<jubatus::core::graph::node_info>));
     k.register_async_cht<2, edge, uint64_t>("get_edge",
-        jubatus::util::lang::function<edge(edge, edge)>(
-        &jubatus::server::framework::pass<edge>));
+        jubatus::util::lang::function<void(edge&, edge&)>(
+        &jubatus::server::framework::inplace::pass<edge>));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
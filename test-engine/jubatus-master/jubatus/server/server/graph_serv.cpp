@@ -23,6 +23,7 @@
 #include "jubatus/util/concurrent/lock.h"
 #include "jubatus/util/text/json.h"
 #include "jubatus/util/system/time_util.h"
+#include "jubatus/util/lang/bind.h"
 #include "jubatus/util/lang/shared_ptr.h"
 
 #include "jubatus/core/common/assert.hpp"
@@ -43,14 +44,16 @@
 #endif
 #ifdef HAVE_ZOOKEEPER_H
 #include "../framework/aggregators.hpp"
+#include "../framework/replica_writer.hpp"
 #endif
+#include "../framework/local_update.hpp"
 #include "../framework/mixer/mixer_factory.hpp"
-#include "graph_client.hpp"
 
 using std::string;
 using std::vector;
 using std::pair;
 using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
 using jubatus::util::text::json::json;
 using jubatus::core::graph::preset_query;
 using jubatus::core::graph::node_info;
@@ -121,6 +124,8 @@ graph_serv::graph_serv(
     std::string counter_path;
     common::build_actor_path(counter_path, a.type, a.name);
     idgen_zk->set_ls(zk_, counter_path);
+
+    replica_writer_.reset(new framework::replica_writer(a));
   }
 #endif
 }
@@ -129,13 +134,38 @@ graph_serv::~graph_serv() {
 }
 
 void graph_serv::set_config(const std::string& config) {
+  graph_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(graph_.get());
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* graph_serv::prepare_driver(
+    const std::string& config) {
+  next_graph_ = make_driver(config);
+  next_config_ = config;
+  return next_graph_.get();
+}
+
+void graph_serv::commit_driver() {
+  graph_.swap(next_graph_);
+  config_.swap(next_config_);
+  mixer_->set_driver(graph_.get());
+  reset_id_generator();
+}
+
+void graph_serv::discard_driver() {
+  next_graph_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::graph> graph_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config conf_root(
       lexical_cast<jubatus::util::text::json::json>(config));
   graph_serv_config conf =
     core::common::jsonconfig::config_cast_check<graph_serv_config>(conf_root);
 
-  config_ = config;
-
 #if 0
   // TODO(oda): we should use optional<jsonconfig::config> instead of
   //            jsonconfig::config ?
@@ -146,13 +176,10 @@ void graph_serv::set_config(const std::string& config) {
   }
 #endif
 
-  graph_.reset(
+  return shared_ptr<core::driver::graph>(
       new core::driver::graph(
           core::graph::graph_factory::create_graph(
               conf.method, conf.parameter)));
-  mixer_->set_driver(graph_.get());
-
-  LOG(INFO) << "config loaded: " << config;
 }
 
 std::string graph_serv::get_config() const {
@@ -171,6 +198,11 @@ void graph_serv::get_status(status_t& status) const {
 
   status_t my_status;
   graph_->get_model()->get_status(my_status);
+#ifdef HAVE_ZOOKEEPER_H
+  if (replica_writer_) {
+    replica_writer_->get_status(my_status);
+  }
+#endif
   status.insert(my_status.begin(), my_status.end());
 }
 
@@ -197,23 +229,16 @@ std::string graph_serv::create_node() { /* no lock here */
                 "no server found in cht: " + argv().name));
       }
       try {
-        selective_create_node_(nodes[0], nid_str);
-      } catch (const std::runtime_error& e) {
+        replica_writer_->write<bool>(
+            nodes,
+            "create_node_here",
+            msgpack::type::tuple<const std::string&, const std::string&>(
+                argv().name, nid_str),
+            jubatus::util::lang::bind(
+                &graph_serv::create_node_locally_, this, nid_str));
+      } catch (const std::exception& e) {
         throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
-            "failed to create node " + nid_str + " (" + e.what() + "): " +
-            nodes[0].first + ":" + lexical_cast<std::string>(nodes[0].second)));
-      }
-
-      for (size_t i = 1; i < nodes.size(); ++i) {
-        try {
-          selective_create_node_(nodes[i], nid_str);
-        } catch (const core::graph::local_node_exists& e) {  // pass through
-        } catch (const core::graph::global_node_exists& e) {  // pass through
-        } catch (const std::runtime_error& e) {  // error !
-          LOG(WARNING) << "cannot create " << i << "th replica "
-                       << "(" << e.what() << "): "
-                       << nodes[i].first << ":" << nodes[i].second;
-        }
+            "failed to create node " + nid_str + ": " + e.what()));
       }
     }
   } else {
@@ -238,6 +263,16 @@ bool graph_serv::update_node(
 }
 
 bool graph_serv::remove_node(const std::string& nid_str) {
+#ifdef HAVE_ZOOKEEPER_H
+  // "remove_node" is not logged in distributed mode; it is replayed as the
+  // removal done here
+  jubatus::util::lang::shared_ptr<framework::local_update> log;
+  if (!argv().is_standalone()) {
+    log.reset(new framework::local_update(*this, "remove_node_here",
+        msgpack::type::tuple<const std::string&, const std::string&>(
+            argv().name, nid_str)));
+  }
+#endif
   // locks manually because we should unlock before global access
   // make sure this function not to be called from other functions
   server::common::unique_wlock lk(rw_mutex());
@@ -269,6 +304,7 @@ bool graph_serv::remove_node(const std::string& nid_str) {
       try {
         // requires unlock before global access to prevent dead-lock
         lk.unlock();
+        log.reset();
 
         c.call("remove_global_node",
                argv().name,
@@ -304,30 +340,27 @@ edge_id_t graph_serv::create_edge(const std::string& id, const edge& ei) {
               "no server found in cht: " + argv().name));
     }
     // TODO(kuenishi): assertion: nodes[0] should be myself
-    {
-      jubatus::util::concurrent::scoped_wlock wirte_lk(rw_mutex());
-      this->create_edge_here(eid, ei);
-    }
+    // the edge is always created here, and then on the other replicas
+    std::vector<std::pair<std::string, int> > targets;
+    targets.push_back(std::make_pair(argv().eth, argv().port));
     for (size_t i = 1; i < nodes.size(); ++i) {
-      try {
-        if (nodes[i].first == argv().eth && nodes[i].second == argv().port) {
-        } else {
-          client::graph c(nodes[i].first,
-                          nodes[i].second,
-                          argv().name,
-                          argv().interconnect_timeout);
-          DLOG(INFO) << "request to "
-              << nodes[i].first << ":" << nodes[i].second;
-          c.create_edge_here(eid, ei);
-        }
-      } catch (const core::graph::local_node_exists& e) {  // pass through
-      } catch (const core::graph::global_node_exists& e) {  // pass through
-      } catch (const std::runtime_error& e) {  // error !
-        LOG(WARNING) << "cannot create " << i << "th replica "
-                     << "(" << e.what() << "): "
-                     << nodes[i].first << ":" << nodes[i].second;
+      if (nodes[i] != targets[0]) {
+        targets.push_back(nodes[i]);
       }
     }
+    try {
+      replica_writer_->write<bool>(
+          targets,
+          "create_edge_here",
+          msgpack::type::tuple<const std::string&, edge_id_t, const edge&>(
+              argv().name, eid, ei),
+          jubatus::util::lang::bind(
+              &graph_serv::create_edge_locally_, this, eid, ei));
+    } catch (const std::exception& e) {
+      throw JUBATUS_EXCEPTION(core::common::exception::runtime_error(
+          "failed to create edge " + lexical_cast<std::string>(eid) + ": " +
+          e.what()));
+    }
   } else {
 #endif
     jubatus::util::concurrent::scoped_wlock write_lk(rw_mutex());
@@ -478,8 +511,17 @@ bool graph_serv::clear() {
   return true;
 }
 
+/*
+ * Creates a replica of the node on this server.
+ * Nodes already existing are not errors, so that replicated create_node
+ * does not fail on them with any write quorum.
+ */
 bool graph_serv::create_node_here(const std::string& nid) {
-  graph_->create_node_here(n2i(nid));
+  try {
+    graph_->create_node_here(n2i(nid));
+  } catch (const core::graph::local_node_exists& e) {  // pass through
+  } catch (const core::graph::global_node_exists& e) {  // pass through
+  }
   return true;
 }
 
@@ -490,32 +532,40 @@ bool graph_serv::remove_global_node(const std::string& nid) {
   return true;
 }  // update internal
 
+bool graph_serv::remove_node_here(const std::string& nid) {
+  graph_->remove_node(n2i(nid));
+  return true;
+}
+
 bool graph_serv::create_edge_here(edge_id_t eid, const edge& ei) {
-  graph_->create_edge_here(eid, n2i(ei.source), n2i(ei.target), ei.property);
+  try {
+    graph_->create_edge_here(
+        eid, n2i(ei.source), n2i(ei.target), ei.property);
+  } catch (const core::graph::local_node_exists& e) {  // pass through
+  } catch (const core::graph::global_node_exists& e) {  // pass through
+  }
   return true;
 }
 
 /*
- * Updates the model on the specified node.
- * If the host/port of the current process is specified, update
- * is processed locally.
- * Caller is responsible for handling exceptions including RPC
- * errors.
+ * Creates the node on this server as a part of replicated create_node.
  */
-void graph_serv::selective_create_node_(
-    const std::pair<std::string, int>& target,
-    const std::string nid_str) {
-  if (target.first == argv().eth && target.second == argv().port) {
-    jubatus::util::concurrent::scoped_wlock write_lk(rw_mutex());
-    this->create_node_here(nid_str);
-  } else {
-    // must not lock here
-    client::graph c(target.first,
-                    target.second,
-                    argv().name,
-                    argv().interconnect_timeout);
-    c.create_node_here(nid_str);
-  }
+bool graph_serv::create_node_locally_(const std::string& nid_str) {
+  // "create_node" is not logged; it is replayed as the creation done here
+  framework::local_update log(*this, "create_node_here",
+      msgpack::type::tuple<const std::string&, const std::string&>(
+          argv().name, nid_str));
+  jubatus::util::concurrent::scoped_wlock write_lk(rw_mutex());
+  return this->create_node_here(nid_str);
+}
+
+bool graph_serv::create_edge_locally_(edge_id_t eid, const edge& ei) {
+  // "create_edge" is not logged; it is replayed as the creation done here
+  framework::local_update log(*this, "create_edge_here",
+      msgpack::type::tuple<const std::string&, edge_id_t, const edge&>(
+          argv().name, eid, ei));
+  jubatus::util::concurrent::scoped_wlock write_lk(rw_mutex());
+  return this->create_edge_here(eid, ei);
 }
 
 void graph_serv::find_from_cht_(
@@ -571,6 +621,19 @@ void graph_serv::load_file(const std::string& path) {
   reset_id_generator();
 }
 
+std::vector<std::string> graph_serv::unlogged_update_methods() const {
+  std::vector<std::string> methods;
+#ifdef HAVE_ZOOKEEPER_H
+  if (!argv().is_standalone()) {
+    // these forward the update to the CHT owners
+    methods.push_back("create_node");
+    methods.push_back("remove_node");
+    methods.push_back("create_edge");
+  }
+#endif
+  return methods;
+}
+
 void graph_serv::reset_id_generator() {
   if (argv().is_standalone()) {
     uint64_t counter = graph_->find_max_int_id() + 1;
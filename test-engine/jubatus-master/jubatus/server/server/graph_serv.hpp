@@ -32,6 +32,9 @@
 
 namespace jubatus {
 namespace server {
+namespace framework {
+class replica_writer;
+}  // namespace framework
 
 typedef uint64_t edge_id_t;
 typedef std::string node_id;
@@ -53,6 +56,9 @@ class graph_serv : public framework::server_base {
   }
 
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
 
   void get_status(status_t& status) const;
@@ -88,19 +94,24 @@ class graph_serv : public framework::server_base {
   bool create_node_here(const std::string& nid);
   bool create_global_node(const std::string& nid);
   bool remove_global_node(const std::string& nid);
+  // replays the local part of remove_node
+  bool remove_node_here(const std::string& nid);
 
   bool create_edge_here(edge_id_t eid, const edge& ei);
 
   // overrides to restore global_id_generator when loading model
   bool load(const std::string& id);
   void load_file(const std::string& path);
+  std::vector<std::string> unlogged_update_methods() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::graph> make_driver(
+      const std::string& config);
+
   void check_set_config() const;
 
-  void selective_create_node_(
-      const std::pair<std::string, int>& target,
-      const std::string nid_str);
+  bool create_node_locally_(const std::string& nid_str);
+  bool create_edge_locally_(edge_id_t eid, const edge& ei);
 
   void find_from_cht_(
       const std::string& key,
@@ -112,10 +123,14 @@ class graph_serv : public framework::server_base {
 
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::graph> graph_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::graph> next_graph_;
+  std::string next_config_;
   std::string config_;
 
   jubatus::util::lang::shared_ptr<common::lock_service> zk_;
   jubatus::util::lang::shared_ptr<common::global_id_generator_base> idgen_;
+  jubatus::util::lang::shared_ptr<framework::replica_writer> replica_writer_;
 };
 
 }  // namespace server
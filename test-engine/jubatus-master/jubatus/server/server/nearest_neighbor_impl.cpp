@@ -22,31 +22,38 @@ class nearest_neighbor_impl : public jubatus::server::common::mprpc::rpc_server
         true)) {
 
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &nearest_neighbor_impl::clear, this));
+        &nearest_neighbor_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string,
         jubatus::core::fv_converter::datum)>("set_row",
         jubatus::util::lang::bind(&nearest_neighbor_impl::set_row, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::vector<std::pair<std::string, float> >(std::string,
         std::string, uint32_t)>("neighbor_row_from_id",
         jubatus::util::lang::bind(&nearest_neighbor_impl::neighbor_row_from_id,
-        this, jubatus::util::lang::_2, jubatus::util::lang::_3));
+        this, jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::pair<std::string, float> >(std::string,
         jubatus::core::fv_converter::datum, uint32_t)>(
         "neighbor_row_from_datum", jubatus::util::lang::bind(
         &nearest_neighbor_impl::neighbor_row_from_datum, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::pair<std::string, float> >(std::string,
         std::string, uint32_t)>("similar_row_from_id",
         jubatus::util::lang::bind(&nearest_neighbor_impl::similar_row_from_id,
-        this, jubatus::util::lang::_2, jubatus::util::lang::_3));
+        this, jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::pair<std::string, float> >(std::string,
         jubatus::core::fv_converter::datum, uint32_t)>("similar_row_from_datum",
         jubatus::util::lang::bind(
         &nearest_neighbor_impl::similar_row_from_datum, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::string>(std::string)>("get_all_rows",
-        jubatus::util::lang::bind(&nearest_neighbor_impl::get_all_rows, this));
+        jubatus::util::lang::bind(&nearest_neighbor_impl::get_all_rows, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&nearest_neighbor_impl::get_config, this));
@@ -19,21 +19,31 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "nearest_neighbor"));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<1, bool, jubatus::core::fv_converter::datum>("set_row",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::pass<bool>));
-    k.register_async_random<std::vector<std::pair<std::string, float> >,
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::pass<bool>));
+    k.register_async_analysis<std::vector<std::pair<std::string, float> >,
         std::string, uint32_t>("neighbor_row_from_id");
-    k.register_async_random<std::vector<std::pair<std::string, float> >,
-        jubatus::core::fv_converter::datum, uint32_t>(
-        "neighbor_row_from_datum");
-    k.register_async_random<std::vector<std::pair<std::string, float> >,
+    k.register_async_scatter_k<std::vector<std::pair<std::string, float> >,
+        jubatus::core::fv_converter::datum, uint32_t>("neighbor_row_from_datum",
+        jubatus::util::lang::function<void(std::vector<std::pair<std::string,
+        float> >&, std::vector<std::pair<std::string, float> >&, size_t)>(
+        &jubatus::server::framework::inplace::bottom_k<std::pair<std::string,
+        float> >));
+    k.register_async_analysis<std::vector<std::pair<std::string, float> >,
         std::string, uint32_t>("similar_row_from_id");
-    k.register_async_random<std::vector<std::pair<std::string, float> >,
-        jubatus::core::fv_converter::datum, uint32_t>("similar_row_from_datum");
-    k.register_async_random<std::vector<std::string> >("get_all_rows");
+    k.register_async_scatter_k<std::vector<std::pair<std::string, float> >,
+        jubatus::core::fv_converter::datum, uint32_t>("similar_row_from_datum",
+        jubatus::util::lang::function<void(std::vector<std::pair<std::string,
+        float> >&, std::vector<std::pair<std::string, float> >&, size_t)>(
+        &jubatus::server::framework::inplace::top_k<std::pair<std::string,
+        float> >));
+    k.register_async_scatter<std::vector<std::string> >("get_all_rows",
+        jubatus::util::lang::function<void(std::vector<std::string>&,
+        std::vector<std::string>&)>(
+        &jubatus::server::framework::inplace::concat<std::string>));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
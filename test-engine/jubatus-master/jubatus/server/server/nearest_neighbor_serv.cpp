@@ -79,14 +79,38 @@ uint64_t nearest_neighbor_serv::user_data_version() const {
 }
 
 void nearest_neighbor_serv::set_config(const std::string& config) {
+  nearest_neighbor_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(nearest_neighbor_.get());
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* nearest_neighbor_serv::prepare_driver(
+    const std::string& config) {
+  next_nearest_neighbor_ = make_driver(config);
+  next_config_ = config;
+  return next_nearest_neighbor_.get();
+}
+
+void nearest_neighbor_serv::commit_driver() {
+  nearest_neighbor_.swap(next_nearest_neighbor_);
+  config_.swap(next_config_);
+  mixer_->set_driver(nearest_neighbor_.get());
+}
+
+void nearest_neighbor_serv::discard_driver() {
+  next_nearest_neighbor_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::nearest_neighbor> nearest_neighbor_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config config_root(
       lexical_cast<jubatus::util::text::json::json>(config));
   nearest_neighbor_serv_config conf =
     core::common::jsonconfig::config_cast_check<nearest_neighbor_serv_config>(
         config_root);
 
-  config_ = config;
-
   core::common::jsonconfig::config param;
   if (conf.parameter) {
     param = *conf.parameter;
@@ -106,10 +130,8 @@ void nearest_neighbor_serv::set_config(const std::string& config) {
   shared_ptr<jubatus::core::nearest_neighbor::nearest_neighbor_base>
       nn(jubatus::core::nearest_neighbor::create_nearest_neighbor(
           conf.method, param, table, my_id));
-  nearest_neighbor_.reset(new core::driver::nearest_neighbor(nn, converter));
-  mixer_->set_driver(nearest_neighbor_.get());
-
-  LOG(INFO) << "config loaded: " << config;
+  return shared_ptr<core::driver::nearest_neighbor>(
+      new core::driver::nearest_neighbor(nn, converter));
 }
 
 std::string nearest_neighbor_serv::get_config() const {
@@ -140,6 +162,7 @@ neighbor_result nearest_neighbor_serv::neighbor_row_from_id(
     size_t size) {
   DLOG(INFO) << __func__;
   check_set_config();
+  check_unpartitioned(__func__, "neighbor_row_from_datum");
 
   return nearest_neighbor_->neighbor_row_from_id(id, size);
 }
@@ -158,6 +181,7 @@ neighbor_result nearest_neighbor_serv::similar_row_from_id(
     size_t ret_num) {
   DLOG(INFO) << __func__;
   check_set_config();
+  check_unpartitioned(__func__, "similar_row_from_datum");
 
   return nearest_neighbor_->similar_row(id, ret_num);
 }
@@ -52,6 +52,9 @@ class nearest_neighbor_serv : public framework::server_base {
   uint64_t user_data_version() const;
 
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
 
   bool clear();
@@ -67,6 +70,9 @@ class nearest_neighbor_serv : public framework::server_base {
   std::vector<std::string> get_all_rows() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::nearest_neighbor> make_driver(
+      const std::string& config);
+
   void check_set_config()const;
   jubatus::util::lang::scoped_ptr<framework::mixer::mixer> mixer_;
 
@@ -76,6 +82,10 @@ class nearest_neighbor_serv : public framework::server_base {
 
   jubatus::util::lang::shared_ptr<core::driver::nearest_neighbor>
     nearest_neighbor_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::nearest_neighbor>
+    next_nearest_neighbor_;
+  std::string next_config_;
   jubatus::core::fv_converter::so_factory so_loader_;
 };
 
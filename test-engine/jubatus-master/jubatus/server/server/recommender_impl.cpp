@@ -22,41 +22,52 @@ class recommender_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<bool(std::string, std::string)>("clear_row",
         jubatus::util::lang::bind(&recommender_impl::clear_row, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string, std::string,
         jubatus::core::fv_converter::datum)>("update_row",
         jubatus::util::lang::bind(&recommender_impl::update_row, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &recommender_impl::clear, this));
+        &recommender_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<jubatus::core::fv_converter::datum(std::string,
         std::string)>("complete_row_from_id", jubatus::util::lang::bind(
         &recommender_impl::complete_row_from_id, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<jubatus::core::fv_converter::datum(std::string,
         jubatus::core::fv_converter::datum)>("complete_row_from_datum",
         jubatus::util::lang::bind(&recommender_impl::complete_row_from_datum,
-        this, jubatus::util::lang::_2));
+        this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<id_with_score>(std::string, std::string,
         uint32_t)>("similar_row_from_id", jubatus::util::lang::bind(
         &recommender_impl::similar_row_from_id, this, jubatus::util::lang::_2,
-        jubatus::util::lang::_3));
+        jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<id_with_score>(std::string,
         jubatus::core::fv_converter::datum, uint32_t)>("similar_row_from_datum",
         jubatus::util::lang::bind(&recommender_impl::similar_row_from_datum,
-        this, jubatus::util::lang::_2, jubatus::util::lang::_3));
+        this, jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<jubatus::core::fv_converter::datum(std::string,
         std::string)>("decode_row", jubatus::util::lang::bind(
-        &recommender_impl::decode_row, this, jubatus::util::lang::_2));
+        &recommender_impl::decode_row, this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<std::vector<std::string>(std::string)>("get_all_rows",
-        jubatus::util::lang::bind(&recommender_impl::get_all_rows, this));
+        jubatus::util::lang::bind(&recommender_impl::get_all_rows, this),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<float(std::string, jubatus::core::fv_converter::datum,
         jubatus::core::fv_converter::datum)>("calc_similarity",
         jubatus::util::lang::bind(&recommender_impl::calc_similarity, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<float(std::string, jubatus::core::fv_converter::datum)>(
         "calc_l2norm", jubatus::util::lang::bind(&recommender_impl::calc_l2norm,
-        this, jubatus::util::lang::_2));
+        this, jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&recommender_impl::get_config, this));
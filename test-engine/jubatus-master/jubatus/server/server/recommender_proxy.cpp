@@ -19,38 +19,41 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "recommender"));
     k.register_async_cht<2, bool>("clear_row",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<2, bool, jubatus::core::fv_converter::datum>(
-        "update_row", jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        "update_row", jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     k.register_async_cht<2, jubatus::core::fv_converter::datum>(
-        "complete_row_from_id",
-        jubatus::util::lang::function<jubatus::core::fv_converter::datum(
-        jubatus::core::fv_converter::datum,
-        jubatus::core::fv_converter::datum)>(
-        &jubatus::server::framework::pass<jubatus::core::fv_converter::datum>));
-    k.register_async_random<jubatus::core::fv_converter::datum,
+        "complete_row_from_id", jubatus::util::lang::function<void(
+        jubatus::core::fv_converter::datum&,
+        jubatus::core::fv_converter::datum&)>(
+        &jubatus::server::framework::inplace::pass<jubatus::core::fv_converter::datum>));
+    k.register_async_analysis<jubatus::core::fv_converter::datum,
         jubatus::core::fv_converter::datum>("complete_row_from_datum");
     k.register_async_cht<2, std::vector<id_with_score>, uint32_t>(
-        "similar_row_from_id",
-        jubatus::util::lang::function<std::vector<id_with_score>(
-        std::vector<id_with_score>, std::vector<id_with_score>)>(
-        &jubatus::server::framework::pass<std::vector<id_with_score> >));
-    k.register_async_random<std::vector<id_with_score>,
-        jubatus::core::fv_converter::datum, uint32_t>("similar_row_from_datum");
+        "similar_row_from_id", jubatus::util::lang::function<void(
+        std::vector<id_with_score>&, std::vector<id_with_score>&)>(
+        &jubatus::server::framework::inplace::pass<std::vector<id_with_score> >));
+    k.register_async_scatter_k<std::vector<id_with_score>,
+        jubatus::core::fv_converter::datum, uint32_t>("similar_row_from_datum",
+        jubatus::util::lang::function<void(std::vector<id_with_score>&,
+        std::vector<id_with_score>&, size_t)>(
+        &jubatus::server::framework::inplace::top_k<id_with_score>));
     k.register_async_cht<2, jubatus::core::fv_converter::datum>("decode_row",
-        jubatus::util::lang::function<jubatus::core::fv_converter::datum(
-        jubatus::core::fv_converter::datum,
-        jubatus::core::fv_converter::datum)>(
-        &jubatus::server::framework::pass<jubatus::core::fv_converter::datum>));
-    k.register_async_random<std::vector<std::string> >("get_all_rows");
-    k.register_async_random<float, jubatus::core::fv_converter::datum,
+        jubatus::util::lang::function<void(jubatus::core::fv_converter::datum&,
+        jubatus::core::fv_converter::datum&)>(
+        &jubatus::server::framework::inplace::pass<jubatus::core::fv_converter::datum>));
+    k.register_async_scatter<std::vector<std::string> >("get_all_rows",
+        jubatus::util::lang::function<void(std::vector<std::string>&,
+        std::vector<std::string>&)>(
+        jubatus::server::framework::inplace::concat_unique<std::string>()));
+    k.register_async_analysis<float, jubatus::core::fv_converter::datum,
         jubatus::core::fv_converter::datum>("calc_similarity");
-    k.register_async_random<float, jubatus::core::fv_converter::datum>(
+    k.register_async_analysis<float, jubatus::core::fv_converter::datum>(
         "calc_l2norm");
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
@@ -40,6 +40,7 @@ using std::vector;
 using std::pair;
 using std::isfinite;
 using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
 using jubatus::util::text::json::json;
 using jubatus::core::fv_converter::datum;
 using jubatus::core::fv_converter::weight_manager;
@@ -71,8 +72,10 @@ recommender_serv::recommender_serv(
     const jubatus::util::lang::shared_ptr<lock_service>& zk)
     : server_base(a),
       mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())),
+      analysis_cache_(a.analysis_cache_size),
       clear_row_cnt_(),
       update_row_cnt_() {
+  register_analysis_cache(analysis_cache_);
 }
 
 recommender_serv::~recommender_serv() {
@@ -82,6 +85,7 @@ void recommender_serv::get_status(status_t& status) const {
   status_t my_status;
   my_status["clear_row_cnt"] = lexical_cast<string>(clear_row_cnt_);
   my_status["update_row_cnt"] = lexical_cast<string>(update_row_cnt_);
+  analysis_cache_.get_status("analysis_cache", my_status);
 
   status.insert(my_status.begin(), my_status.end());
 }
@@ -91,13 +95,39 @@ uint64_t recommender_serv::user_data_version() const {
 }
 
 void recommender_serv::set_config(const std::string &config) {
+  recommender_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(recommender_.get());
+  analysis_cache_.invalidate();
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* recommender_serv::prepare_driver(
+    const std::string& config) {
+  next_recommender_ = make_driver(config);
+  next_config_ = config;
+  return next_recommender_.get();
+}
+
+void recommender_serv::commit_driver() {
+  recommender_.swap(next_recommender_);
+  config_.swap(next_config_);
+  mixer_->set_driver(recommender_.get());
+  analysis_cache_.invalidate();
+}
+
+void recommender_serv::discard_driver() {
+  next_recommender_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::recommender> recommender_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config conf_root(lexical_cast<json>(config));
   recommender_serv_config conf =
     core::common::jsonconfig::config_cast_check<recommender_serv_config>(
       conf_root);
 
-  config_ = config;
-
   core::common::jsonconfig::config param;
   if (conf.parameter) {
     param = *conf.parameter;
@@ -108,14 +138,11 @@ void recommender_serv::set_config(const std::string &config) {
   my_id = common::build_loc_str(argv().eth, argv().port);
 #endif
 
-  recommender_.reset(
+  return shared_ptr<core::driver::recommender>(
       new core::driver::recommender(
           core::recommender::recommender_factory::create_recommender(
               conf.method, param, my_id),
           core::fv_converter::make_fv_converter(conf.converter, &so_loader_)));
-  mixer_->set_driver(recommender_.get());
-
-  LOG(INFO) << "config loaded: " << config;
 }
 
 string recommender_serv::get_config() const {
@@ -128,6 +155,7 @@ bool recommender_serv::clear_row(std::string id) {
 
   ++clear_row_cnt_;
   recommender_->clear_row(id);
+  analysis_cache_.invalidate();
   DLOG(INFO) << "row cleared: " << id;
 
   return true;
@@ -138,6 +166,7 @@ bool recommender_serv::update_row(std::string id, datum dat) {
 
   ++update_row_cnt_;
   recommender_->update_row(id, dat);
+  analysis_cache_.invalidate();
   DLOG(INFO) << "row updated: " << id;
 
   return true;
@@ -150,6 +179,7 @@ bool recommender_serv::clear() {
   update_row_cnt_ = 0;
 
   recommender_->clear();
+  analysis_cache_.invalidate();
   LOG(INFO) << "model cleared: " << argv().name;
 
   return true;
@@ -157,12 +187,14 @@ bool recommender_serv::clear() {
 
 datum recommender_serv::complete_row_from_id(std::string id) {
   check_set_config();
+  check_unpartitioned(__func__, "decode_row and similar_row_from_datum");
 
   return recommender_->complete_row_from_id(id);
 }
 
 datum recommender_serv::complete_row_from_datum(datum dat) {
   check_set_config();
+  check_unpartitioned(__func__, "similar_row_from_datum");
 
   return recommender_->complete_row_from_datum(dat);
 }
@@ -171,6 +203,7 @@ std::vector<id_with_score> recommender_serv::similar_row_from_id(
     std::string id,
     size_t ret_num) {
   check_set_config();
+  check_unpartitioned(__func__, "decode_row and similar_row_from_datum");
 
   // TODO(unno): remove conversion code
   vector<pair<string, float> > res(
@@ -188,14 +221,27 @@ std::vector<id_with_score> recommender_serv::similar_row_from_datum(
     size_t s) {
   check_set_config();
 
+  vector<id_with_score> result;
+  framework::datum_key key = framework::datum_key();
+  uint64_t generation = 0;
+  if (analysis_cache_.enabled()) {
+    key = framework::make_datum_key(data, s);
+    if (analysis_cache_.get(key, result, generation)) {
+      return result;
+    }
+  }
+
   // TODO(unno): remove conversion code
   vector<pair<string, float> > res(
       recommender_->similar_row_from_datum(data, s));
-  vector<id_with_score> result(res.size());
+  result.resize(res.size());
   for (size_t i = 0; i < res.size(); ++i) {
     result[i].id = res[i].first;
     result[i].score = res[i].second;
   }
+  if (analysis_cache_.enabled()) {
+    analysis_cache_.put(key, result, generation);
+  }
   return result;
 }
 
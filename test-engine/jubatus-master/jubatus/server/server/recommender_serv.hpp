@@ -23,6 +23,7 @@
 #include "jubatus/util/lang/shared_ptr.h"
 #include "jubatus/core/driver/recommender.hpp"
 #include "jubatus/core/fv_converter/so_factory.hpp"
+#include "../framework/datum_cache.hpp"
 #include "../framework/server_base.hpp"
 #include "recommender_types.hpp"
 
@@ -50,6 +51,9 @@ class recommender_serv : public framework::server_base {
   uint64_t user_data_version() const;
 
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
 
   bool clear_row(std::string id);
@@ -76,8 +80,16 @@ class recommender_serv : public framework::server_base {
   void check_set_config() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::recommender> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::recommender> recommender_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::recommender> next_recommender_;
+  std::string next_config_;
+  // results of similar_row_from_datum
+  framework::datum_cache<std::vector<id_with_score> > analysis_cache_;
   std::string config_;
   jubatus::core::fv_converter::so_factory so_loader_;
 
@@ -22,13 +22,16 @@ class regression_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<int32_t(std::string, std::vector<scored_datum>)>("train",
         jubatus::util::lang::bind(&regression_impl::train, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::vector<float>(std::string,
         std::vector<jubatus::core::fv_converter::datum>)>("estimate",
         jubatus::util::lang::bind(&regression_impl::estimate, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &regression_impl::clear, this));
+        &regression_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&regression_impl::get_config, this));
@@ -19,11 +19,11 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "regression"));
     k.register_async_random<int32_t, std::vector<scored_datum> >("train");
-    k.register_async_random<std::vector<float>,
+    k.register_async_analysis<std::vector<float>,
         std::vector<jubatus::core::fv_converter::datum> >("estimate");
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
@@ -71,7 +71,9 @@ regression_serv::regression_serv(
     const framework::server_argv& a,
     const jubatus::util::lang::shared_ptr<lock_service>& zk)
     : server_base(a),
-      mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())) {
+      mixer_(create_mixer(a, zk, rw_mutex(), user_data_version())),
+      analysis_cache_(a.analysis_cache_size) {
+  register_analysis_cache(analysis_cache_);
 }
 
 regression_serv::~regression_serv() {
@@ -80,6 +82,7 @@ regression_serv::~regression_serv() {
 void regression_serv::get_status(status_t& status) const {
   status_t my_status;
   regression_->get_status(my_status);
+  analysis_cache_.get_status("analysis_cache", my_status);
   status.insert(my_status.begin(), my_status.end());
 }
 
@@ -88,13 +91,42 @@ uint64_t regression_serv::user_data_version() const {
 }
 
 void regression_serv::set_config(const string& config) {
+  regression_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(regression_.get());
+  analysis_cache_.invalidate();
+
+  // TODO(kuenishi): switch the function when set_config is done
+  // because mixing method differs btwn PA, CW, etc...
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* regression_serv::prepare_driver(
+    const std::string& config) {
+  next_regression_ = make_driver(config);
+  next_config_ = config;
+  return next_regression_.get();
+}
+
+void regression_serv::commit_driver() {
+  regression_.swap(next_regression_);
+  config_.swap(next_config_);
+  mixer_->set_driver(regression_.get());
+  analysis_cache_.invalidate();
+}
+
+void regression_serv::discard_driver() {
+  next_regression_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::regression> regression_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config config_root(lexical_cast<json>(config));
   regression_serv_config conf =
     core::common::jsonconfig::config_cast_check<regression_serv_config>(
       config_root);
 
-  config_ = config;
-
   core::common::jsonconfig::config param;
   if (conf.parameter) {
     param = *conf.parameter;
@@ -102,16 +134,11 @@ void regression_serv::set_config(const string& config) {
 
   shared_ptr<core::storage::storage_base> model = make_model(argv());
 
-  regression_.reset(
+  return shared_ptr<core::driver::regression>(
       new core::driver::regression(
           core::regression::regression_factory::create_regression(
               conf.method, param, model),
           core::fv_converter::make_fv_converter(conf.converter, &so_loader_)));
-  mixer_->set_driver(regression_.get());
-
-  // TODO(kuenishi): switch the function when set_config is done
-  // because mixing method differs btwn PA, CW, etc...
-  LOG(INFO) << "config loaded: " << config;
 }
 
 string regression_serv::get_config() const {
@@ -131,6 +158,7 @@ int regression_serv::train(const vector<scored_datum>& data) {
     DLOG(INFO) << "trained: " << data[i].score;
     count++;
   }
+  analysis_cache_.invalidate();
   // TODO(kuenishi): send count incrementation to mixer
   return count;
 }
@@ -142,7 +170,19 @@ vector<float> regression_serv::estimate(
   vector<float> ret;
 
   for (size_t i = 0; i < data.size(); ++i) {
-    ret.push_back(regression_->estimate(data[i]));
+    if (!analysis_cache_.enabled()) {
+      ret.push_back(regression_->estimate(data[i]));
+      continue;
+    }
+
+    const framework::datum_key key = framework::make_datum_key(data[i]);
+    float score;
+    uint64_t generation;
+    if (!analysis_cache_.get(key, score, generation)) {
+      score = regression_->estimate(data[i]);
+      analysis_cache_.put(key, score, generation);
+    }
+    ret.push_back(score);
   }
   return ret;  // vector<estimate_results> >::ok(ret);
 }
@@ -150,6 +190,7 @@ vector<float> regression_serv::estimate(
 bool regression_serv::clear() {
   check_set_config();
   regression_->clear();
+  analysis_cache_.invalidate();
   LOG(INFO) << "model cleared: " << argv().name;
   return true;
 }
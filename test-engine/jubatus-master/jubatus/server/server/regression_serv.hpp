@@ -24,6 +24,7 @@
 #include "jubatus/util/lang/shared_ptr.h"
 #include "jubatus/core/driver/regression.hpp"
 #include "jubatus/core/fv_converter/so_factory.hpp"
+#include "../framework/datum_cache.hpp"
 #include "../framework/server_base.hpp"
 #include "regression_types.hpp"
 
@@ -49,6 +50,9 @@ class regression_serv : public framework::server_base {
   uint64_t user_data_version() const;
 
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
   int train(const std::vector<scored_datum>& data);
 
@@ -60,8 +64,15 @@ class regression_serv : public framework::server_base {
   void check_set_config() const;
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::regression> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::regression> regression_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::regression> next_regression_;
+  std::string next_config_;
+  mutable framework::datum_cache<float> analysis_cache_;
   std::string config_;
   jubatus::core::fv_converter::so_factory so_loader_;
 };
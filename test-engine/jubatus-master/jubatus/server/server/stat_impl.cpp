@@ -21,28 +21,36 @@ class stat_impl : public jubatus::server::common::mprpc::rpc_server {
 
     rpc_server::add<bool(std::string, std::string, double)>("push",
         jubatus::util::lang::bind(&stat_impl::push, this,
-        jubatus::util::lang::_2, jubatus::util::lang::_3));
+        jubatus::util::lang::_2, jubatus::util::lang::_3),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<double(std::string, std::string)>("sum",
         jubatus::util::lang::bind(&stat_impl::sum, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<double(std::string, std::string)>("stddev",
         jubatus::util::lang::bind(&stat_impl::stddev, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<double(std::string, std::string)>("max",
         jubatus::util::lang::bind(&stat_impl::max, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<double(std::string, std::string)>("min",
         jubatus::util::lang::bind(&stat_impl::min, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<double(std::string, std::string)>("entropy",
         jubatus::util::lang::bind(&stat_impl::entropy, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<double(std::string, std::string, int32_t, double)>("moment",
         jubatus::util::lang::bind(&stat_impl::moment, this,
         jubatus::util::lang::_2, jubatus::util::lang::_3,
-        jubatus::util::lang::_4));
+        jubatus::util::lang::_4),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &stat_impl::clear, this));
+        &stat_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&stat_impl::get_config, this));
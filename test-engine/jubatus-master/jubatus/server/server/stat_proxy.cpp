@@ -19,26 +19,26 @@ int run_proxy(int argc, char* argv[]) {
     jubatus::server::framework::proxy k(
         jubatus::server::framework::proxy_argv(argc, argv, "stat"));
     k.register_async_cht<1, bool, double>("push",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
-    k.register_async_cht<1, double>("sum", jubatus::util::lang::function<double(
-        double, double)>(&jubatus::server::framework::pass<double>));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
+    k.register_async_cht<1, double>("sum", jubatus::util::lang::function<void(
+        double&, double&)>(&jubatus::server::framework::inplace::pass<double>));
     k.register_async_cht<1, double>("stddev",
-        jubatus::util::lang::function<double(double, double)>(
-        &jubatus::server::framework::pass<double>));
-    k.register_async_cht<1, double>("max", jubatus::util::lang::function<double(
-        double, double)>(&jubatus::server::framework::pass<double>));
-    k.register_async_cht<1, double>("min", jubatus::util::lang::function<double(
-        double, double)>(&jubatus::server::framework::pass<double>));
+        jubatus::util::lang::function<void(double&, double&)>(
+        &jubatus::server::framework::inplace::pass<double>));
+    k.register_async_cht<1, double>("max", jubatus::util::lang::function<void(
+        double&, double&)>(&jubatus::server::framework::inplace::pass<double>));
+    k.register_async_cht<1, double>("min", jubatus::util::lang::function<void(
+        double&, double&)>(&jubatus::server::framework::inplace::pass<double>));
     k.register_async_cht<1, double>("entropy",
-        jubatus::util::lang::function<double(double, double)>(
-        &jubatus::server::framework::pass<double>));
+        jubatus::util::lang::function<void(double&, double&)>(
+        &jubatus::server::framework::inplace::pass<double>));
     k.register_async_cht<1, double, int32_t, double>("moment",
-        jubatus::util::lang::function<double(double, double)>(
-        &jubatus::server::framework::pass<double>));
+        jubatus::util::lang::function<void(double&, double&)>(
+        &jubatus::server::framework::inplace::pass<double>));
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
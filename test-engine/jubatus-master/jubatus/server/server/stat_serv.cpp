@@ -29,6 +29,7 @@ using std::string;
 using std::make_pair;
 using jubatus::util::text::json::json;
 using jubatus::util::lang::lexical_cast;
+using jubatus::util::lang::shared_ptr;
 
 using jubatus::server::common::lock_service;
 using jubatus::server::framework::server_argv;
@@ -64,16 +65,38 @@ uint64_t stat_serv::user_data_version() const {
 }
 
 void stat_serv::set_config(const string& config) {
+  stat_ = make_driver(config);
+  config_ = config;
+  mixer_->set_driver(stat_.get());
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* stat_serv::prepare_driver(
+    const std::string& config) {
+  next_stat_ = make_driver(config);
+  next_config_ = config;
+  return next_stat_.get();
+}
+
+void stat_serv::commit_driver() {
+  stat_.swap(next_stat_);
+  config_.swap(next_config_);
+  mixer_->set_driver(stat_.get());
+}
+
+void stat_serv::discard_driver() {
+  next_stat_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::stat> stat_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config conf_root(lexical_cast<json>(config));
   stat_serv_config conf =
       core::common::jsonconfig::config_cast_check<stat_serv_config>(conf_root);
 
-  config_ = config;
-  stat_.reset(
+  return shared_ptr<core::driver::stat>(
       new core::driver::stat(new core::stat::stat(conf.window_size)));
-  mixer_->set_driver(stat_.get());
-
-  LOG(INFO) << "config loaded: " << config;
 }
 
 string stat_serv::get_config() const {
@@ -49,6 +49,9 @@ class stat_serv : public framework::server_base {
   uint64_t user_data_version() const;
 
   void set_config(const std::string&);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
   std::string get_config() const;
   bool push(const std::string& key, double value);
   double sum(const std::string&) const;
@@ -61,8 +64,14 @@ class stat_serv : public framework::server_base {
   bool clear();
 
  private:
+  jubatus::util::lang::shared_ptr<core::driver::stat> make_driver(
+      const std::string& config);
+
   jubatus::util::lang::shared_ptr<framework::mixer::mixer> mixer_;
   jubatus::util::lang::shared_ptr<core::driver::stat> stat_;
+  // the driver being loaded in the background
+  jubatus::util::lang::shared_ptr<core::driver::stat> next_stat_;
+  std::string next_config_;
   std::string config_;
 };
 
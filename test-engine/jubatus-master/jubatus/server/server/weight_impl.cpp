@@ -22,13 +22,16 @@ class weight_impl : public jubatus::server::common::mprpc::rpc_server {
     rpc_server::add<std::vector<feature>(std::string,
         jubatus::core::fv_converter::datum)>("update",
         jubatus::util::lang::bind(&weight_impl::update, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
     rpc_server::add<std::vector<feature>(std::string,
         jubatus::core::fv_converter::datum)>("calc_weight",
         jubatus::util::lang::bind(&weight_impl::calc_weight, this,
-        jubatus::util::lang::_2));
+        jubatus::util::lang::_2),
+        jubatus::server::common::mprpc::ANALYSIS_REQUEST);
     rpc_server::add<bool(std::string)>("clear", jubatus::util::lang::bind(
-        &weight_impl::clear, this));
+        &weight_impl::clear, this),
+        jubatus::server::common::mprpc::UPDATE_REQUEST);
 
     rpc_server::add<std::string(std::string)>("get_config",
         jubatus::util::lang::bind(&weight_impl::get_config, this));
@@ -44,7 +47,7 @@ class weight_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   std::vector<feature> update(const jubatus::core::fv_converter::datum& d) {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->update(d);
   }
 
@@ -55,7 +58,7 @@ class weight_impl : public jubatus::server::common::mprpc::rpc_server {
   }
 
   bool clear() {
-    NOLOCK_(p_);
+    NOLOCK_UPDATE_(p_);
     return get_p()->clear();
   }
 
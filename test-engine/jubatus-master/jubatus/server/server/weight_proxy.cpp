@@ -20,11 +20,11 @@ int run_proxy(int argc, char* argv[]) {
         jubatus::server::framework::proxy_argv(argc, argv, "weight"));
     k.register_async_random<std::vector<feature>,
         jubatus::core::fv_converter::datum>("update");
-    k.register_async_random<std::vector<feature>,
+    k.register_async_analysis<std::vector<feature>,
         jubatus::core::fv_converter::datum>("calc_weight");
     k.register_async_broadcast<bool>("clear",
-        jubatus::util::lang::function<bool(bool, bool)>(
-        &jubatus::server::framework::all_and));
+        jubatus::util::lang::function<void(bool&, bool&)>(
+        &jubatus::server::framework::inplace::all_and));
     return k.run();
   } catch (const jubatus::core::common::exception::jubatus_exception& e) {
     LOG(FATAL) << "exception in proxy main thread: "
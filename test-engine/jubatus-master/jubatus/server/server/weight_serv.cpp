@@ -91,6 +91,30 @@ void weight_serv::get_status(status_t& status) const {
 }
 
 void weight_serv::set_config(const std::string& config) {
+  weight_ = make_driver(config);
+  config_ = config;
+  LOG(INFO) << "config loaded: " << config;
+}
+
+core::driver::driver_base* weight_serv::prepare_driver(
+    const std::string& config) {
+  next_weight_ = make_driver(config);
+  next_config_ = config;
+  return next_weight_.get();
+}
+
+void weight_serv::commit_driver() {
+  weight_.swap(next_weight_);
+  config_.swap(next_config_);
+}
+
+void weight_serv::discard_driver() {
+  next_weight_.reset();
+  next_config_.clear();
+}
+
+shared_ptr<core::driver::weight> weight_serv::make_driver(
+    const std::string& config) {
   core::common::jsonconfig::config config_root(
         jubatus::util::lang::lexical_cast<jubatus::util::text::json::json>(
         config));
@@ -98,12 +122,9 @@ void weight_serv::set_config(const std::string& config) {
       core::common::jsonconfig::config_cast_check<weight_serv_config>(
       config_root);
 
-  weight_.reset(new jubatus::core::driver::weight(
+  return shared_ptr<core::driver::weight>(new jubatus::core::driver::weight(
       jubatus::core::fv_converter::make_fv_converter(
       conf.converter, &so_loader_)));
-
-  config_ = config;
-  LOG(INFO) << "config loaded: " << config;
 }
 
 std::vector<feature> weight_serv::update(
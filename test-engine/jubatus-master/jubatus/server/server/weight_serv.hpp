@@ -45,6 +45,9 @@ class weight_serv : public framework::server_base {
   uint64_t user_data_version() const;
   void get_status(status_t& status) const;
   void set_config(const std::string& config);
+  core::driver::driver_base* prepare_driver(const std::string& config);
+  void commit_driver();
+  void discard_driver();
 
   std::vector<feature> update(
       const jubatus::core::fv_converter::datum& d);
@@ -53,7 +56,13 @@ class weight_serv : public framework::server_base {
   bool clear();
 
  private:
+  shared_ptr<core::driver::weight> make_driver(
+      const std::string& config);
+
   shared_ptr<jubatus::core::driver::weight> weight_;
+  // the driver being loaded in the background
+  shared_ptr<core::driver::weight> next_weight_;
+  std::string next_config_;
   shared_ptr<jubatus::server::framework::mixer::mixer> mixer_;
   std::string config_;
   jubatus::core::fv_converter::so_factory so_loader_;
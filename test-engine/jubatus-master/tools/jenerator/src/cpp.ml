@@ -251,8 +251,31 @@ let gen_client_method names server m =
   ]
 ;;
 
+(* name_async returns the future of the result instead of waiting it *)
+let gen_client_async_method names server m =
+  match m.method_return_type with
+  | None -> []
+  | Some typ ->
+    let args_def = gen_function_args_def names server m.method_arguments in
+    let args = gen_string_literal m.method_name
+      :: "name_"
+      :: List.map (fun f -> f.field_name) m.method_arguments in
+    let future_type =
+      gen_template names server "jubatus::client::common::future" [typ] in
+    let call = gen_call "c_.call" args in
+    [
+      (0, Printf.sprintf "%s %s_async%s {" future_type m.method_name args_def);
+      (1,   "return " ^ future_type ^ "(");
+      (3,       String.sub call 0 (String.length call - 1) ^ ");");
+      (0, "}");
+    ]
+;;
+
 let gen_client names server s =
-  let methods = List.map (gen_client_method names server) s.service_methods in
+  let methods = List.concat (List.map (fun m ->
+    [gen_client_method names server m; gen_client_async_method names server m]
+  ) s.service_methods) in
+  let methods = List.filter (fun b -> b <> []) methods in
   let constructor = [
     (0, s.service_name ^ "(const std::string& host, uint64_t port, const std::string& name, unsigned int timeout_sec)");
     (2,     ": client(host, port, name, timeout_sec) {");
@@ -412,29 +435,51 @@ let gen_bind s m =
   "jubatus::util::lang::bind" ^ gen_args args
 ;;
 
+let gen_request_type m =
+  let _, request, _ = get_decorator m in
+  match request with
+  | Update | Nolock_update -> Some "jubatus::server::common::mprpc::UPDATE_REQUEST"
+  | Analysis | Nolock_analysis -> Some "jubatus::server::common::mprpc::ANALYSIS_REQUEST"
+  | Nolock -> None
+;;
+
 let gen_server_method names s m =
   let func_type = get_func_type names m in
   let method_name_str = gen_string_literal m.method_name in
   let bind = gen_bind s m in
-  let line = Printf.sprintf "rpc_server::add<%s>(%s, %s);"
-    func_type method_name_str bind in
+  let line =
+    match gen_request_type m with
+    | Some request_type ->
+      Printf.sprintf "rpc_server::add<%s>(%s, %s, %s);"
+        func_type method_name_str bind request_type
+    | None ->
+      Printf.sprintf "rpc_server::add<%s>(%s, %s);"
+        func_type method_name_str bind in
   (0, line)
 ;;
 
+(* aggregators fold each response into the result in place *)
 let gen_aggregator names ret_type aggregator =
+  let ns = "jubatus::server::framework::inplace::" in
   match ret_type, aggregator with
   | Bool, All_and ->
-    "jubatus::server::framework::all_and"
+    ns ^ "all_and"
   | Bool, All_or ->
-    "jubatus::server::framework::all_or"
+    ns ^ "all_or"
   | List t, Concat ->
-    gen_template names true "jubatus::server::framework::concat" [t]
+    gen_template names true (ns ^ "concat") [t]
+  | List t, Concat_unique ->
+    gen_template names true (ns ^ "concat_unique") [t]
+  | List t, Top_k ->
+    gen_template names true (ns ^ "top_k") [t]
+  | List t, Bottom_k ->
+    gen_template names true (ns ^ "bottom_k") [t]
   | Map (k, v), Merge ->
-    gen_template names true "jubatus::server::framework::merge" [k; v]
+    gen_template names true (ns ^ "merge") [k; v]
   | Int _, Add | Float _, Add ->
-    gen_template names true "jubatus::server::framework::add" [ret_type]
+    gen_template names true (ns ^ "add") [ret_type]
   | _, Pass ->
-    gen_template names true "jubatus::server::framework::pass" [ret_type]
+    gen_template names true (ns ^ "pass") [ret_type]
   | _, _ ->
     (* TODO(unnonouno): Are other combinations really illegal?*)
     let msg = Printf.sprintf
@@ -443,22 +488,45 @@ let gen_aggregator names ret_type aggregator =
     raise (Invalid_argument msg)
 ;;
 
+let is_k_aggregator = function
+  | Top_k | Bottom_k -> true
+  | _ -> false
+;;
+
+(* stateful aggregators are function objects copied for each request *)
+let is_stateful_aggregator = function
+  | Concat_unique -> true
+  | _ -> false
+;;
+
 let gen_aggregator_function names ret_type aggregator =
   let agg = gen_aggregator names ret_type aggregator in
   let r = gen_type names true ret_type in
   (* TODO(unnonouno): Too complicated. Make it simple! *)
-  let func = Printf.sprintf
-    "jubatus::util::lang::function<%s(%s, %s)>" r r r in
-  func ^ "(&" ^ agg ^ ")"
+  let func =
+    if is_k_aggregator aggregator then
+      (* k best results are aggregated, where k is the last argument *)
+      Printf.sprintf "jubatus::util::lang::function<void(%s&, %s&, size_t)>" r r
+    else
+      Printf.sprintf "jubatus::util::lang::function<void(%s&, %s&)>" r r in
+  if is_stateful_aggregator aggregator then
+    func ^ "(" ^ agg ^ "())"
+  else
+    func ^ "(&" ^ agg ^ ")"
 ;;
 
 let gen_proxy_register names m ret_type =
   let arg_types = List.map (fun f -> f.field_type) m.method_arguments in
   let method_name_str = gen_string_literal m.method_name in
-  let routing, _, agg = get_decorator m in
+  let routing, request, agg = get_decorator m in
   match routing with
   | Random ->
-    let func = gen_template names true "k.register_async_random" (ret_type::arg_types) in
+    (* analysis requests may also be sent to serving-only replicas *)
+    let register =
+      match request with
+      | Analysis | Nolock_analysis -> "k.register_async_analysis"
+      | Update | Nolock | Nolock_update -> "k.register_async_random" in
+    let func = gen_template names true register (ret_type::arg_types) in
     let call = gen_call func [method_name_str] in
     [ (0, call) ]
 
@@ -477,6 +545,16 @@ let gen_proxy_register names m ret_type =
     let call = gen_call func [method_name_str; gen_aggregator_function names ret_type agg] in
     [ (0, call) ]
 
+  | Scatter ->
+    let register =
+      if is_k_aggregator agg then
+        "k.register_async_scatter_k"
+      else
+        "k.register_async_scatter" in
+    let func = gen_template names true register (ret_type::arg_types) in
+    let call = gen_call func [method_name_str; gen_aggregator_function names ret_type agg] in
+    [ (0, call) ]
+
   | Internal -> (* no code generated in proxy *)
     []
 ;;
@@ -557,7 +635,8 @@ let gen_impl_method names m =
     match request with
     | Update -> "JWLOCK_"
     | Analysis -> "JRLOCK_"
-    | Nolock -> "NOLOCK_" in
+    | Nolock_update -> "NOLOCK_UPDATE_"
+    | Nolock | Nolock_analysis -> "NOLOCK_" in
   let lock = gen_call lock_type ["p_"] in
   let call = gen_call ("get_p()->" ^ name) args in
   let call =
@@ -690,7 +769,7 @@ let gen_const m =
   match rw with
   | Update -> ""
   | Analysis -> " const"
-  | Nolock -> " /* nolock!! */"
+  | Nolock | Nolock_update | Nolock_analysis -> " /* nolock!! */"
 ;;
 
 let gen_server_template_header_method names m =
@@ -38,11 +38,22 @@ type field_type = {
   field_name: string;
 } [@@deriving show];;
 
-type routing_type = | Random | Cht of int | Broadcast | Internal [@@deriving show];;
-
-type reqtype = | Update | Analysis | Nolock [@@deriving show];;
-
-type aggtype = | All_and | All_or | Concat | Merge | Add | Ignore | Pass [@@deriving show];;
+(* Scatter is Random, routed like an analysis method, unless the proxy runs
+   with --partitioned, where it is Broadcast.  Scatter is only used for
+   methods that do not update the model. *)
+type routing_type =
+  | Random | Cht of int | Broadcast | Scatter | Internal [@@deriving show];;
+
+(* Nolock_update and Nolock_analysis are not locked by the framework like
+   Nolock, but are scheduled as update/analysis requests respectively *)
+type reqtype =
+  | Update | Analysis | Nolock | Nolock_update | Nolock_analysis
+  [@@deriving show];;
+
+type aggtype =
+  | All_and | All_or | Concat | Concat_unique | Merge | Add | Ignore | Pass
+  | Top_k | Bottom_k
+  [@@deriving show];;
 
 type decorator_type =
   | Routing of routing_type
@@ -112,19 +123,25 @@ let make_decorator = function
   | "#@update"    -> Reqtype(Update)
   | "#@analysis"  -> Reqtype(Analysis)
   | "#@nolock"    -> Reqtype(Nolock)
+  | "#@nolock_update"   -> Reqtype(Nolock_update)
+  | "#@nolock_analysis" -> Reqtype(Nolock_analysis)
 
   | "#@random"    -> Routing(Random)
   | "#@broadcast" -> Routing(Broadcast)
+  | "#@scatter"   -> Routing(Scatter)
   | "#@internal"  -> Routing(Internal)
   | "#@cht"       -> Routing(Cht(2))
 
   | "#@all_and"   -> Aggtype(All_and)
   | "#@all_or"    -> Aggtype(All_or)
   | "#@concat"    -> Aggtype(Concat)
+  | "#@concat_unique" -> Aggtype(Concat_unique)
   | "#@merge"     -> Aggtype(Merge)
   | "#@add"       -> Aggtype(Add)
   | "#@ignore"    -> Aggtype(Ignore)
   | "#@pass"      -> Aggtype(Pass)
+  | "#@top_k"     -> Aggtype(Top_k)
+  | "#@bottom_k"  -> Aggtype(Bottom_k)
   | other ->
     raise (Unknown_type other)
 ;;
@@ -140,6 +157,7 @@ let routing_to_string = function
   | Random -> "random";
   | Cht(i) -> "cht(" ^ string_of_int i ^ ")";
   | Broadcast -> "broadcast";
+  | Scatter -> "scatter";
   | Internal -> ""
 ;;
 
@@ -147,16 +165,21 @@ let aggtype_to_string = function
   | All_and -> "all_and"
   | All_or  -> "all_or"
   | Concat  -> "concat"
+  | Concat_unique -> "concat_unique"
   | Merge   -> "merge"
   | Add     -> "add"
   | Ignore  -> "ignore" (* or raise sth? *)
   | Pass    -> "pass"
+  | Top_k   -> "top_k"
+  | Bottom_k -> "bottom_k"
 ;;
 
 let reqtype_to_string = function
   | Update   -> "update"
   | Analysis -> "analysis"
   | Nolock   -> "nolock"
+  | Nolock_update   -> "nolock_update"
+  | Nolock_analysis -> "nolock_analysis"
 ;;
 
 let decorator_to_string = function